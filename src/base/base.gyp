@@ -95,6 +95,7 @@
       'type': 'static_library',
       'toolsets': ['host', 'target'],
       'sources': [
+        '<(gen_out_dir)/char_class_table.inc',
         '<(gen_out_dir)/character_set.inc',
         'environ.cc',
         'file/recursive.cc',
@@ -107,6 +108,7 @@
         'random.cc',
         'strings/unicode.cc',
         'strings/internal/utf8_internal.cc',
+        'strings/internal/utf8_scan.cc',
         'system_util.cc',
         'text_normalizer.cc',
         'util.cc',
@@ -115,6 +117,7 @@
       'dependencies': [
         'clock',
         'flags',
+        'gen_char_class_table#host',
         'gen_character_set#host',
         'hash',
         'singleton',
@@ -243,6 +246,26 @@
         'absl.gyp:absl_strings',
       ],
     },
+    {
+      'target_name': 'gen_char_class_table',
+      'type': 'none',
+      'toolsets': ['host'],
+      'actions': [
+        {
+          'action_name': 'gen_char_class_table',
+          'inputs': [
+            'gen_char_class_table.py',
+          ],
+          'outputs': [
+            '<(gen_out_dir)/char_class_table.inc',
+          ],
+          'action': [
+            '<(python)', 'gen_char_class_table.py',
+            '--output=<(gen_out_dir)/char_class_table.inc'
+          ],
+        },
+      ],
+    },
     {
       'target_name': 'gen_character_set',
       'type': 'none',
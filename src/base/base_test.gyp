@@ -197,6 +197,7 @@
       'type': 'executable',
       'sources': [
         'strings/internal/utf8_internal_test.cc',
+        'strings/internal/utf8_scan_test.cc',
         'strings/unicode_test.cc',
       ],
       'dependencies': [
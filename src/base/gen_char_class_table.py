@@ -0,0 +1,221 @@
+# -*- coding: utf-8 -*-
+# Copyright 2010-2021, Google Inc.
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met:
+#
+#     * Redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer.
+#     * Redistributions in binary form must reproduce the above
+# copyright notice, this list of conditions and the following disclaimer
+# in the documentation and/or other materials provided with the
+# distribution.
+#     * Neither the name of Google Inc. nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+"""Generates char_class_table.inc file.
+
+The table maps a code point to its script type (Util::ScriptType) and form
+type (Util::FormType) in two levels. The first level maps each block of 256
+code points to one of the distinct blocks in the second level.
+"""
+import argparse
+import sys
+
+# The order must be the same as Util::ScriptType.
+SCRIPT_TYPES = [
+    'UNKNOWN_SCRIPT',
+    'KATAKANA',
+    'HIRAGANA',
+    'KANJI',
+    'NUMBER',
+    'ALPHABET',
+    'EMOJI',
+]
+
+# Code point ranges (inclusive) of each script type. If a code point is in
+# multiple ranges, the first one wins.
+# TODO(yukawa, team): Make a mechanism to keep this classifier up-to-date
+#   based on the original data from Unicode.org.
+SCRIPT_RANGES = [
+    ('NUMBER', 0x0030, 0x0039),  # ascii number
+    ('NUMBER', 0xFF10, 0xFF19),  # full width number
+    ('ALPHABET', 0x0041, 0x005A),  # ascii upper
+    ('ALPHABET', 0x0061, 0x007A),  # ascii lower
+    ('ALPHABET', 0xFF21, 0xFF3A),  # fullwidth ascii upper
+    ('ALPHABET', 0xFF41, 0xFF5A),  # fullwidth ascii lower
+    # As of Unicode 6.0.2, each block has the following characters assigned.
+    # [U+3400, U+4DB5]:   CJK Unified Ideographs Extension A
+    # [U+4E00, U+9FCB]:   CJK Unified Ideographs
+    # [U+4E00, U+FAD9]:   CJK Compatibility Ideographs
+    # [U+20000, U+2A6D6]: CJK Unified Ideographs Extension B
+    # [U+2A700, U+2B734]: CJK Unified Ideographs Extension C
+    # [U+2B740, U+2B81D]: CJK Unified Ideographs Extension D
+    # [U+2F800, U+2FA1D]: CJK Compatibility Ideographs
+    ('KANJI', 0x3005, 0x3005),  # IDEOGRAPHIC ITERATION MARK "々"
+    ('KANJI', 0x3400, 0x4DBF),  # CJK Unified Ideographs Extension A
+    ('KANJI', 0x4E00, 0x9FFF),  # CJK Unified Ideographs
+    ('KANJI', 0xF900, 0xFAFF),  # CJK Compatibility Ideographs
+    ('KANJI', 0x20000, 0x2A6DF),  # CJK Unified Ideographs Extension B
+    ('KANJI', 0x2A700, 0x2B73F),  # CJK Unified Ideographs Extension C
+    ('KANJI', 0x2B740, 0x2B81F),  # CJK Unified Ideographs Extension D
+    ('KANJI', 0x2F800, 0x2FA1F),  # CJK Compatibility Ideographs
+    ('HIRAGANA', 0x3041, 0x309F),  # hiragana
+    ('HIRAGANA', 0x1B001, 0x1B001),  # HIRAGANA LETTER ARCHAIC YE
+    ('KATAKANA', 0x30A1, 0x30FF),  # full width katakana
+    ('KATAKANA', 0x31F0, 0x31FF),  # Katakana Phonetic Extensions for Ainu
+    ('KATAKANA', 0xFF65, 0xFF9F),  # half width katakana
+    ('KATAKANA', 0x1B000, 0x1B000),  # KATAKANA LETTER ARCHAIC E
+    ('EMOJI', 0x02300, 0x023F3),  # Miscellaneous Technical
+    ('EMOJI', 0x02700, 0x027BF),  # Dingbats
+    ('EMOJI', 0x1F000, 0x1F02F),  # Mahjong tiles
+    ('EMOJI', 0x1F030, 0x1F09F),  # Domino tiles
+    ('EMOJI', 0x1F0A0, 0x1F0FF),  # Playing cards
+    ('EMOJI', 0x1F100, 0x1F2FF),  # Enclosed Alphanumeric Supplement
+    ('EMOJI', 0x1F200, 0x1F2FF),  # Enclosed Ideographic Supplement
+    ('EMOJI', 0x1F300, 0x1F5FF),  # Miscellaneous Symbols And Pictographs
+    ('EMOJI', 0x1F600, 0x1F64F),  # Emoticons
+    ('EMOJI', 0x1F680, 0x1F6FF),  # Transport And Map Symbols
+    ('EMOJI', 0x1F700, 0x1F77F),  # Alchemical Symbols
+    ('EMOJI', 0x26CE, 0x26CE),  # Ophiuchus
+]
+
+# Code point ranges (inclusive) of HALF_WIDTH. The others are FULL_WIDTH.
+# 'Unicode Standard Annex #11: EAST ASIAN WIDTH'
+# http://www.unicode.org/reports/tr11/
+# Characters marked as 'Na' and 'H' in
+# http://www.unicode.org/Public/UNIDATA/EastAsianWidth.txt
+HALF_WIDTH_RANGES = [
+    (0x0020, 0x007F),  # ascii
+    (0x27E6, 0x27ED),  # narrow mathematical symbols
+    (0x2985, 0x2986),  # narrow white parentheses
+    (0x00A2, 0x00A3),  # CENT SIGN, POUND SIGN
+    (0x00A5, 0x00A6),  # YEN SIGN, BROKEN BAR
+    (0x00AC, 0x00AC),  # NOT SIGN
+    (0x00AF, 0x00AF),  # MACRON
+    (0x20A9, 0x20A9),  # WON SIGN
+    (0xFF61, 0xFF9F),  # half-width katakana
+    (0xFFA0, 0xFFBE),  # half-width hangul
+    (0xFFC2, 0xFFCF),  # half-width hangul
+    (0xFFD2, 0xFFD7),  # half-width hangul
+    (0xFFDA, 0xFFDC),  # half-width hangul
+    (0xFFE8, 0xFFEE),  # half-width symbols
+]
+
+# Bit layout of each entry.
+SCRIPT_TYPE_MASK = 0x07
+HALF_WIDTH_BIT = 0x08
+
+BLOCK_BITS = 8
+BLOCK_SIZE = 1 << BLOCK_BITS
+
+
+def GetTableSize():
+  """Returns the table size, beyond which all are UNKNOWN_SCRIPT/FULL_WIDTH."""
+  max_code_point = max(
+      [last for _, _, last in SCRIPT_RANGES]
+      + [last for _, last in HALF_WIDTH_RANGES]
+  )
+  return (max_code_point // BLOCK_SIZE + 1) * BLOCK_SIZE
+
+
+def GenerateClasses(table_size):
+  """Returns the list of the class of each code point."""
+  classes = [0] * table_size
+  assigned = [False] * table_size
+  for script_type, first, last in SCRIPT_RANGES:
+    value = SCRIPT_TYPES.index(script_type)
+    assert value <= SCRIPT_TYPE_MASK
+    for code_point in range(first, last + 1):
+      if not assigned[code_point]:
+        classes[code_point] = value
+        assigned[code_point] = True
+  for first, last in HALF_WIDTH_RANGES:
+    for code_point in range(first, last + 1):
+      classes[code_point] |= HALF_WIDTH_BIT
+  return classes
+
+
+def GenerateCharClassTable(classes):
+  """Generates lines of char_class_table.inc file."""
+  blocks = []
+  block_index = []
+  block_ids = {}
+  for start in range(0, len(classes), BLOCK_SIZE):
+    block = tuple(classes[start : start + BLOCK_SIZE])
+    if block not in block_ids:
+      block_ids[block] = len(blocks)
+      blocks.append((start, block))
+    block_index.append(block_ids[block])
+  assert len(blocks) <= 256
+
+  lines = [
+      '// This file is generated by base/gen_char_class_table.py\n',
+      '// Do not edit me!\n',
+      '\n',
+      'namespace {\n',
+      'constexpr char32_t kCharClassTableSize = 0x%X;\n' % len(classes),
+      'constexpr int kCharClassBlockBits = %d;\n' % BLOCK_BITS,
+      'constexpr uint8_t kCharClassScriptTypeMask = 0x%02X;\n'
+      % SCRIPT_TYPE_MASK,
+      'constexpr uint8_t kCharClassHalfWidthBit = 0x%02X;\n' % HALF_WIDTH_BIT,
+      'constexpr uint8_t kCharClassBlockIndex[%d] = {\n' % len(block_index),
+  ]
+  for i in range(0, len(block_index), 16):
+    lines.append(
+        '    %s,\n' % ', '.join(str(index) for index in block_index[i : i + 16])
+    )
+  lines.extend([
+      '};\n',
+      'constexpr uint8_t kCharClassBlocks[%d][%d] = {\n'
+      % (len(blocks), BLOCK_SIZE),
+  ])
+  for start, block in blocks:
+    lines.append(
+        '    {  // First seen at U+%04X - U+%04X\n'
+        % (start, start + BLOCK_SIZE - 1)
+    )
+    for i in range(0, BLOCK_SIZE, 16):
+      lines.append(
+          '        %s,\n' % ', '.join('0x%02X' % c for c in block[i : i + 16])
+      )
+    lines.append('    },\n')
+  lines.extend(['};\n', '}  // namespace\n'])
+  return lines
+
+
+def ParseArgs():
+  """Parses command line options."""
+  parser = argparse.ArgumentParser()
+  parser.add_argument(
+      '--output',
+      type=argparse.FileType('w', encoding='utf-8'),
+      default=sys.stdout,
+      help='output file path. If not specified, output to stdout.',
+  )
+  return parser.parse_args()
+
+
+def main():
+  args = ParseArgs()
+  classes = GenerateClasses(GetTableSize())
+  args.output.writelines(GenerateCharClassTable(classes))
+
+
+if __name__ == '__main__':
+  main()
@@ -29,6 +29,8 @@
 
 #include "base/hash.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <limits>
 
@@ -79,61 +81,53 @@ void Mix(T &a, T &b, T &c) {
   c ^= (b >> 15);
 }
 
-}  // namespace
-
-uint32_t Fingerprint32(absl::string_view str) {
-  return Fingerprint32WithSeed(str, kFingerPrint32Seed);
+// Mixes a 12-byte block into the state.
+inline void MixBlock(const char *block, uint32_t &a, uint32_t &b,
+                     uint32_t &c) {
+  a += ToUint32(block[0], block[1], block[2], block[3]);
+  b += ToUint32(block[4], block[5], block[6], block[7]);
+  c += ToUint32(block[8], block[9], block[10], block[11]);
+  Mix(a, b, c);
 }
 
-uint32_t Fingerprint32WithSeed(absl::string_view str, uint32_t seed) {
-  DCHECK_LE(str.size(), std::numeric_limits<uint32_t>::max());
-  const uint32_t str_len = static_cast<uint32_t>(str.size());
-  uint32_t a = 0x9e3779b9;
-  uint32_t b = a;
-  uint32_t c = seed;
-
-  while (str.size() >= 12) {
-    a += ToUint32(str[0], str[1], str[2], str[3]);
-    b += ToUint32(str[4], str[5], str[6], str[7]);
-    c += ToUint32(str[8], str[9], str[10], str[11]);
-    Mix(a, b, c);
-    str.remove_prefix(12);
-  }
-
+// Mixes the last `tail` (shorter than 12 bytes) and the total length into the
+// state, and returns the 32-bit fingerprint.
+inline uint32_t Finish(absl::string_view tail, uint32_t str_len, uint32_t a,
+                       uint32_t b, uint32_t c) {
   c += str_len;
-  switch (str.size()) {
+  switch (tail.size()) {
     case 11:
-      c += uint32_t{str[10]} << 24;
+      c += uint32_t{tail[10]} << 24;
       ABSL_FALLTHROUGH_INTENDED;
     case 10:
-      c += uint32_t{str[9]} << 16;
+      c += uint32_t{tail[9]} << 16;
       ABSL_FALLTHROUGH_INTENDED;
     case 9:
-      c += uint32_t{str[8]} << 8;
+      c += uint32_t{tail[8]} << 8;
       ABSL_FALLTHROUGH_INTENDED;
     case 8:
-      b += uint32_t{str[7]} << 24;
+      b += uint32_t{tail[7]} << 24;
       ABSL_FALLTHROUGH_INTENDED;
     case 7:
-      b += uint32_t{str[6]} << 16;
+      b += uint32_t{tail[6]} << 16;
       ABSL_FALLTHROUGH_INTENDED;
     case 6:
-      b += uint32_t{str[5]} << 8;
+      b += uint32_t{tail[5]} << 8;
       ABSL_FALLTHROUGH_INTENDED;
     case 5:
-      b += uint32_t{str[4]};
+      b += uint32_t{tail[4]};
       ABSL_FALLTHROUGH_INTENDED;
     case 4:
-      a += uint32_t{str[3]} << 24;
+      a += uint32_t{tail[3]} << 24;
       ABSL_FALLTHROUGH_INTENDED;
     case 3:
-      a += uint32_t{str[2]} << 16;
+      a += uint32_t{tail[2]} << 16;
       ABSL_FALLTHROUGH_INTENDED;
     case 2:
-      a += uint32_t{str[1]} << 8;
+      a += uint32_t{tail[1]} << 8;
       ABSL_FALLTHROUGH_INTENDED;
     case 1:
-      a += uint32_t{str[0]};
+      a += uint32_t{tail[0]};
       break;
   }
   Mix(a, b, c);
@@ -141,18 +135,79 @@ uint32_t Fingerprint32WithSeed(absl::string_view str, uint32_t seed) {
   return c;
 }
 
+uint64_t CombineFingerprint(uint32_t hi, uint32_t lo) {
+  uint64_t result = static_cast<uint64_t>(hi) << 32 | static_cast<uint64_t>(lo);
+  if ((hi == 0) && (lo < 2)) {
+    result ^= 0x130f9bef94a0a928uLL;
+  }
+  return result;
+}
+
+}  // namespace
+
+uint32_t Fingerprint32(absl::string_view str) {
+  return Fingerprint32WithSeed(str, kFingerPrint32Seed);
+}
+
+uint32_t Fingerprint32WithSeed(absl::string_view str, uint32_t seed) {
+  DCHECK_LE(str.size(), std::numeric_limits<uint32_t>::max());
+  const uint32_t str_len = static_cast<uint32_t>(str.size());
+  uint32_t a = 0x9e3779b9;
+  uint32_t b = a;
+  uint32_t c = seed;
+
+  while (str.size() >= 12) {
+    MixBlock(str.data(), a, b, c);
+    str.remove_prefix(12);
+  }
+  return Finish(str, str_len, a, b, c);
+}
+
 uint64_t Fingerprint(absl::string_view str) {
   return FingerprintWithSeed(str, kFingerPrintSeed0);
 }
 
 uint64_t FingerprintWithSeed(absl::string_view str, uint32_t seed) {
-  const uint32_t hi = Fingerprint32WithSeed(str, seed);
-  const uint32_t lo = Fingerprint32WithSeed(str, kFingerPrintSeed1);
-  uint64_t result = static_cast<uint64_t>(hi) << 32 | static_cast<uint64_t>(lo);
-  if ((hi == 0) && (lo < 2)) {
-    result ^= 0x130f9bef94a0a928uLL;
+  return CombineFingerprint(Fingerprint32WithSeed(str, seed),
+                            Fingerprint32WithSeed(str, kFingerPrintSeed1));
+}
+
+FingerprintBuilder::FingerprintBuilder()
+    : hi_{0x9e3779b9, 0x9e3779b9, kFingerPrintSeed0},
+      lo_{0x9e3779b9, 0x9e3779b9, kFingerPrintSeed1} {}
+
+void FingerprintBuilder::MixBlock(const char *block) {
+  ::mozc::MixBlock(block, hi_[0], hi_[1], hi_[2]);
+  ::mozc::MixBlock(block, lo_[0], lo_[1], lo_[2]);
+}
+
+void FingerprintBuilder::Append(absl::string_view str) {
+  length_ += str.size();
+  if (buffer_size_ > 0) {
+    const size_t size = std::min(str.size(), sizeof(buffer_) - buffer_size_);
+    std::copy_n(str.data(), size, buffer_ + buffer_size_);
+    buffer_size_ += size;
+    str.remove_prefix(size);
+    if (buffer_size_ < sizeof(buffer_)) {
+      return;
+    }
+    MixBlock(buffer_);
+    buffer_size_ = 0;
   }
-  return result;
+  while (str.size() >= sizeof(buffer_)) {
+    MixBlock(str.data());
+    str.remove_prefix(sizeof(buffer_));
+  }
+  std::copy(str.begin(), str.end(), buffer_);
+  buffer_size_ = str.size();
+}
+
+uint64_t FingerprintBuilder::Fingerprint() const {
+  DCHECK_LE(length_, std::numeric_limits<uint32_t>::max());
+  const absl::string_view tail(buffer_, buffer_size_);
+  const uint32_t length = static_cast<uint32_t>(length_);
+  return CombineFingerprint(Finish(tail, length, hi_[0], hi_[1], hi_[2]),
+                            Finish(tail, length, lo_[0], lo_[1], lo_[2]));
 }
 
 }  // namespace mozc
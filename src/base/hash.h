@@ -42,6 +42,34 @@ namespace mozc {
 uint64_t Fingerprint(absl::string_view str);
 uint64_t FingerprintWithSeed(absl::string_view str, uint32_t seed);
 
+// Incrementally calculates Fingerprint() of a concatenation of strings without
+// building the concatenated string. The builder is copyable, so the state
+// after a common prefix can be reused for several suffixes:
+//
+//   FingerprintBuilder prefix;
+//   prefix.Append(left);
+//   FingerprintBuilder builder = prefix;
+//   builder.Append(right);
+//   builder.Fingerprint();  // == Fingerprint(absl::StrCat(left, right))
+class FingerprintBuilder {
+ public:
+  FingerprintBuilder();
+
+  void Append(absl::string_view str);
+  uint64_t Fingerprint() const;
+
+ private:
+  void MixBlock(const char* block);
+
+  // States for the upper and lower 32 bits.
+  uint32_t hi_[3];
+  uint32_t lo_[3];
+  // Bytes not mixed yet. Full 12-byte blocks are mixed eagerly.
+  char buffer_[12];
+  size_t buffer_size_ = 0;
+  size_t length_ = 0;
+};
+
 // Calculates 32-bit fingerprint.
 uint32_t Fingerprint32(absl::string_view str);
 uint32_t Fingerprint32WithSeed(absl::string_view str, uint32_t seed);
@@ -29,6 +29,7 @@
 
 #include "base/hash.h"
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
 
@@ -97,5 +98,25 @@ TEST(HashTest, Fingerprint32WithSeed_IntegralTypes) {
   }
 }
 
+TEST(HashTest, FingerprintBuilder) {
+  const std::string str = "0123456789abcdefghijklmnopqrstuvwxyzあいうえお";
+  for (size_t i = 0; i <= str.size(); ++i) {
+    for (size_t j = i; j <= str.size(); ++j) {
+      FingerprintBuilder builder;
+      builder.Append(str.substr(0, i));
+      const FingerprintBuilder prefix = builder;
+      builder.Append(str.substr(i, j - i));
+      builder.Append(str.substr(j));
+      EXPECT_EQ(builder.Fingerprint(), Fingerprint(str)) << i << ", " << j;
+
+      FingerprintBuilder copy = prefix;
+      copy.Append(str.substr(i, j - i));
+      EXPECT_EQ(copy.Fingerprint(), Fingerprint(str.substr(0, j)))
+          << i << ", " << j;
+    }
+  }
+  EXPECT_EQ(FingerprintBuilder().Fingerprint(), Fingerprint(""));
+}
+
 }  // namespace
 }  // namespace mozc
@@ -47,6 +47,8 @@ using japanese::HiraganaToFullwidthRomanji;
 using japanese::HiraganaToHalfwidthKatakana;
 using japanese::HiraganaToKatakana;
 using japanese::HiraganaToRomanji;
+using japanese::HiraganaToTransliterations;
+using japanese::HiraganaTransliterations;
 using japanese::KatakanaToHiragana;
 using japanese::NormalizeVoicedSoundMark;
 using japanese::RomanjiToHiragana;
@@ -47,7 +47,6 @@
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
-#include "absl/strings/str_replace.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "base/strings/internal/double_array.h"
@@ -198,11 +197,39 @@ constexpr absl::string_view kOldTwenty = "廿";
 
 }  // namespace
 
+void NumberUtil::NumberStringList::Add(absl::string_view value,
+                                       absl::string_view description,
+                                       NumberString::Style style) {
+  const size_t begin = buffer_.size();
+  absl::StrAppend(&buffer_, value);
+  AddSince(begin, description, style);
+}
+
+void NumberUtil::NumberStringList::AppendTo(
+    std::vector<NumberString> *output) const {
+  DCHECK(output);
+  output->reserve(output->size() + items_.size());
+  for (size_t i = 0; i < items_.size(); ++i) {
+    const Entry entry = (*this)[i];
+    output->emplace_back(std::string(entry.value), entry.description,
+                         entry.style);
+  }
+}
+
 bool NumberUtil::ArabicToKanji(absl::string_view input_num,
                                std::vector<NumberString> *output) {
   DCHECK(output);
+  NumberStringList numbers;
+  const bool result = ArabicToKanji(input_num, &numbers);
+  numbers.AppendTo(output);
+  return result;
+}
+
+bool NumberUtil::ArabicToKanji(absl::string_view input_num,
+                               NumberStringList *output) {
+  DCHECK(output);
   constexpr absl::string_view kNumZero = "零";
-  constexpr int kDigitsInBigRank = 4;
+  constexpr size_t kDigitsInBigRank = 4;
 
   if (!IsDecimalInteger(input_num)) {
     return false;
@@ -214,8 +241,7 @@ bool NumberUtil::ArabicToKanji(absl::string_view input_num,
     for (i = 0; i < input_num.size() && input_num[i] == kAsciiZero; ++i) {
     }
     if (i == input_num.size()) {
-      output->emplace_back(std::string(kNumZero), "大字",
-                           NumberString::NUMBER_OLD_KANJI);
+      output->Add(kNumZero, "大字", NumberString::NUMBER_OLD_KANJI);
       return true;
     }
   }
@@ -226,22 +252,31 @@ bool NumberUtil::ArabicToKanji(absl::string_view input_num,
     return false;
   }
 
-  // Fill '0' in the beginning of input_num to make its length
-  // (N * kDigitsInBigRank).
-  const int filled_zero_num =
+  // Digits are read as if '0's were filled in the beginning of input_num to
+  // make its length (N * kDigitsInBigRank), and each kDigitsInBigRank-digits
+  // piece gets a bigger rank.
+  const size_t filled_zero_num =
       (kDigitsInBigRank - (input_num.size() % kDigitsInBigRank)) %
       kDigitsInBigRank;
-  std::string input =
-      absl::StrCat(std::string(filled_zero_num, kAsciiZero), input_num);
-
-  // Segment into kDigitsInBigRank-digits pieces
-  std::vector<absl::string_view> ranked_numbers;
-  for (int i = static_cast<int>(input.size()) - kDigitsInBigRank; i >= 0;
-       i -= kDigitsInBigRank) {
-    ranked_numbers.emplace_back(input.data() + i, kDigitsInBigRank);
-  }
-  const size_t rank_size = ranked_numbers.size();
+  const size_t rank_size =
+      (filled_zero_num + input_num.size()) / kDigitsInBigRank;
+  const auto filled_digit = [&](size_t i) {
+    return i < filled_zero_num ? kAsciiZero : input_num[i - filled_zero_num];
+  };
+  // Returns true if the zero-filled input is equal to |str|.
+  const auto filled_input_equals = [&](absl::string_view str) {
+    if (rank_size * kDigitsInBigRank != str.size()) {
+      return false;
+    }
+    for (size_t i = 0; i < str.size(); ++i) {
+      if (filled_digit(i) != str[i]) {
+        return false;
+      }
+    }
+    return true;
+  };
 
+  std::string &buffer = output->buffer_;
   for (size_t variation_index = 0;
        variation_index < std::size(kKanjiVariations); ++variation_index) {
     const NumberStringVariation &variation = kKanjiVariations[variation_index];
@@ -264,57 +299,70 @@ bool NumberUtil::ArabicToKanji(absl::string_view input_num,
       bigger_ranks = kNumKanjiBiggerRanks;
     }
 
-    std::string result;
+    const size_t begin = buffer.size();
 
     // Converts each segment, and merges them with rank Kanjis.
     for (int rank = rank_size - 1; rank >= 0; --rank) {
-      const absl::string_view segment = ranked_numbers[rank];
-      std::string segment_result;
+      const size_t offset = (rank_size - 1 - rank) * kDigitsInBigRank;
+      const size_t segment_begin = buffer.size();
       bool leading = true;
-      for (size_t i = 0; i < segment.size(); ++i) {
-        if (leading && segment[i] == kAsciiZero) {
+      for (size_t i = 0; i < kDigitsInBigRank; ++i) {
+        const char digit = filled_digit(offset + i);
+        if (leading && digit == kAsciiZero) {
           continue;
         }
 
         leading = false;
         if (style == NumberString::NUMBER_ARABIC_AND_KANJI_HALFWIDTH ||
             style == NumberString::NUMBER_ARABIC_AND_KANJI_FULLWIDTH) {
-          absl::StrAppend(&segment_result, digits[segment[i] - kAsciiZero]);
+          absl::StrAppend(&buffer, digits[digit - kAsciiZero]);
         } else {
-          if (segment[i] == kAsciiZero) {
+          if (digit == kAsciiZero) {
             continue;
           }
           // In "大字" style, "壱" is also required on every rank.
           if (style == NumberString::NUMBER_OLD_KANJI ||
-              i == kDigitsInBigRank - 1 || segment[i] != kAsciiOne) {
-            absl::StrAppend(&segment_result, digits[segment[i] - kAsciiZero]);
+              i == kDigitsInBigRank - 1 || digit != kAsciiOne) {
+            absl::StrAppend(&buffer, digits[digit - kAsciiZero]);
           }
-          absl::StrAppend(&segment_result, ranks[kDigitsInBigRank - i]);
+          absl::StrAppend(&buffer, ranks[kDigitsInBigRank - i]);
         }
       }
-      if (!segment_result.empty()) {
-        absl::StrAppend(&result, segment_result, bigger_ranks[rank]);
+      if (buffer.size() != segment_begin) {
+        absl::StrAppend(&buffer, bigger_ranks[rank]);
       }
     }
 
     const absl::string_view description = variation.description;
     // Add simply converted numbers.
-    output->emplace_back(std::move(result), description, style);
+    output->AddSince(begin, description, style);
 
     // Add specialized style numbers.
     if (style == NumberString::NUMBER_OLD_KANJI) {
-      if (absl::StrContains(output->back().value, kOldTwoTen)) {
-        std::string tmp = absl::StrReplaceAll(output->back().value,
-                                              {{kOldTwoTen, kOldTwenty}});
-        output->emplace_back(std::move(tmp), description, style);
+      const size_t end = buffer.size();
+      if (absl::StrContains(absl::string_view(buffer).substr(begin),
+                            kOldTwoTen)) {
+        // Copies the number just added, replacing "弐拾" with "廿".
+        const size_t replaced_begin = buffer.size();
+        for (size_t pos = begin; pos < end;) {
+          if (absl::StartsWith(absl::string_view(buffer).substr(pos),
+                               kOldTwoTen)) {
+            absl::StrAppend(&buffer, kOldTwenty);
+            pos += kOldTwoTen.size();
+          } else {
+            buffer.push_back(buffer[pos]);
+            ++pos;
+          }
+        }
+        output->AddSince(replaced_begin, description, style);
       }
 
       // for single kanji
-      if (input == "0010") {
-        output->emplace_back("拾", description, style);
+      if (filled_input_equals("0010")) {
+        output->Add("拾", description, style);
       }
-      if (input == "1000") {
-        output->emplace_back("阡", description, style);
+      if (filled_input_equals("1000")) {
+        output->Add("阡", description, style);
       }
     }
   }
@@ -336,6 +384,15 @@ constexpr NumberStringVariation kNumDigitsVariations[] = {
 bool NumberUtil::ArabicToSeparatedArabic(absl::string_view input_num,
                                          std::vector<NumberString> *output) {
   DCHECK(output);
+  NumberStringList numbers;
+  const bool result = ArabicToSeparatedArabic(input_num, &numbers);
+  numbers.AppendTo(output);
+  return result;
+}
+
+bool NumberUtil::ArabicToSeparatedArabic(absl::string_view input_num,
+                                         NumberStringList *output) {
+  DCHECK(output);
 
   if (!IsDecimalNumber(input_num)) {
     return false;
@@ -356,35 +413,35 @@ bool NumberUtil::ArabicToSeparatedArabic(absl::string_view input_num,
     return false;
   }
 
+  std::string &buffer = output->buffer_;
   for (size_t i = 0; i < std::size(kNumDigitsVariations); ++i) {
     const NumberStringVariation &variation = kNumDigitsVariations[i];
     const absl::Span<const absl::string_view> digits = variation.digits;
-    std::string result;
+    const size_t begin = buffer.size();
 
     // integral part
     for (absl::string_view::size_type j = 0; j < integer.size(); ++j) {
       // We don't add separator first
       if (j != 0 && (integer.size() - j) % 3 == 0) {
-        absl::StrAppend(&result, variation.separator);
+        absl::StrAppend(&buffer, variation.separator);
       }
       const uint32_t d = static_cast<uint32_t>(integer[j] - kAsciiZero);
       if (d <= 9 && !digits[d].empty()) {
-        absl::StrAppend(&result, digits[d]);
+        absl::StrAppend(&buffer, digits[d]);
       }
     }
 
     // fractional part
     if (!fraction.empty()) {
       DCHECK_EQ(fraction[0], '.');
-      absl::StrAppend(&result, variation.point);
+      absl::StrAppend(&buffer, variation.point);
       for (absl::string_view::size_type j = 1; j < fraction.size(); ++j) {
-        absl::StrAppend(&result,
+        absl::StrAppend(&buffer,
                         digits[static_cast<int>(fraction[j] - kAsciiZero)]);
       }
     }
 
-    output->emplace_back(std::move(result), variation.description,
-                         variation.style);
+    output->AddSince(begin, variation.description, variation.style);
   }
   return true;
 }
@@ -405,22 +462,31 @@ constexpr NumberStringVariation kSingleDigitsVariations[] = {
 bool NumberUtil::ArabicToWideArabic(absl::string_view input_num,
                                     std::vector<NumberString> *output) {
   DCHECK(output);
+  NumberStringList numbers;
+  const bool result = ArabicToWideArabic(input_num, &numbers);
+  numbers.AppendTo(output);
+  return result;
+}
+
+bool NumberUtil::ArabicToWideArabic(absl::string_view input_num,
+                                    NumberStringList *output) {
+  DCHECK(output);
 
   if (!IsDecimalInteger(input_num)) {
     return false;
   }
 
+  std::string &buffer = output->buffer_;
   for (size_t i = 0; i < std::size(kSingleDigitsVariations); ++i) {
     const NumberStringVariation &variation = kSingleDigitsVariations[i];
-    std::string result;
+    const size_t begin = buffer.size();
     for (absl::string_view::size_type j = 0; j < input_num.size(); ++j) {
       absl::StrAppend(
-          &result,
+          &buffer,
           variation.digits[static_cast<int>(input_num[j] - kAsciiZero)]);
     }
-    if (!result.empty()) {
-      output->emplace_back(std::move(result), variation.description,
-                           variation.style);
+    if (buffer.size() != begin) {
+      output->AddSince(begin, variation.description, variation.style);
     }
   }
   return true;
@@ -448,6 +514,15 @@ constexpr NumberStringVariation kSpecialNumericVariations[] = {
 bool NumberUtil::ArabicToOtherForms(absl::string_view input_num,
                                     std::vector<NumberString> *output) {
   DCHECK(output);
+  NumberStringList numbers;
+  const bool result = ArabicToOtherForms(input_num, &numbers);
+  numbers.AppendTo(output);
+  return result;
+}
+
+bool NumberUtil::ArabicToOtherForms(absl::string_view input_num,
+                                    NumberStringList *output) {
+  DCHECK(output);
 
   if (!IsDecimalInteger(input_num)) {
     return false;
@@ -463,7 +538,7 @@ bool NumberUtil::ArabicToOtherForms(absl::string_view input_num,
         "00000000000000000000000000000000000000000000000000";
 
     if (input_num == kNumGoogol) {
-      output->emplace_back("Googol", "", NumberString::DEFAULT_STYLE);
+      output->Add("Googol", "", NumberString::DEFAULT_STYLE);
       converted = true;
     }
   }
@@ -478,8 +553,7 @@ bool NumberUtil::ArabicToOtherForms(absl::string_view input_num,
   for (size_t i = 0; i < std::size(kSpecialNumericVariations); ++i) {
     const NumberStringVariation &variation = kSpecialNumericVariations[i];
     if (n < variation.numbers_size && !variation.digits[n].empty()) {
-      output->emplace_back(std::string(variation.digits[n]),
-                           variation.description, variation.style);
+      output->Add(variation.digits[n], variation.description, variation.style);
       converted = true;
     }
   }
@@ -490,6 +564,15 @@ bool NumberUtil::ArabicToOtherForms(absl::string_view input_num,
 bool NumberUtil::ArabicToOtherRadixes(absl::string_view input_num,
                                       std::vector<NumberString> *output) {
   DCHECK(output);
+  NumberStringList numbers;
+  const bool result = ArabicToOtherRadixes(input_num, &numbers);
+  numbers.AppendTo(output);
+  return result;
+}
+
+bool NumberUtil::ArabicToOtherRadixes(absl::string_view input_num,
+                                      NumberStringList *output) {
+  DCHECK(output);
 
   if (!IsDecimalInteger(input_num)) {
     return false;
@@ -500,27 +583,32 @@ bool NumberUtil::ArabicToOtherRadixes(absl::string_view input_num,
     return false;
   }
 
+  std::string &buffer = output->buffer_;
+
   // Hexadecimal
   if (n > 9) {
-    output->emplace_back(absl::StrFormat("0x%x", static_cast<uint64_t>(n)),
-                         "16進数", NumberString::NUMBER_HEX);
+    const size_t begin = buffer.size();
+    absl::StrAppendFormat(&buffer, "0x%x", n);
+    output->AddSince(begin, "16進数", NumberString::NUMBER_HEX);
   }
 
   // Octal
   if (n > 7) {
-    output->emplace_back(absl::StrFormat("0%o", static_cast<uint64_t>(n)),
-                         "8進数", NumberString::NUMBER_OCT);
+    const size_t begin = buffer.size();
+    absl::StrAppendFormat(&buffer, "0%o", n);
+    output->AddSince(begin, "8進数", NumberString::NUMBER_OCT);
   }
 
   // Binary
   if (n > 1) {
-    std::string binary;
+    const size_t begin = buffer.size();
+    absl::StrAppend(&buffer, "0b");
+    const size_t digits_begin = buffer.size();
     for (uint64_t num = n; num; num >>= 1) {
-      binary.push_back(kAsciiZero + static_cast<char>(num & 0x1));
+      buffer.push_back(kAsciiZero + static_cast<char>(num & 0x1));
     }
-    std::reverse(binary.begin(), binary.end());
-    output->emplace_back(absl::StrCat("0b", binary), "2進数",
-                         NumberString::NUMBER_BIN);
+    std::reverse(buffer.begin() + digits_begin, buffer.end());
+    output->AddSince(begin, "2進数", NumberString::NUMBER_BIN);
   }
 
   return (n > 1);
@@ -30,6 +30,7 @@
 #ifndef MOZC_BASE_NUMBER_UTIL_H_
 #define MOZC_BASE_NUMBER_UTIL_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
 #include <utility>
@@ -108,6 +109,64 @@ class NumberUtil {
     Style style;
   };
 
+  // A list of converted numbers whose values share one string buffer.
+  // Conversion functions write each value directly into the buffer, so no
+  // string is allocated per variation, and Clear() keeps the capacity for the
+  // next number.
+  class NumberStringList {
+   public:
+    // View of an entry, valid until the list is modified.
+    struct Entry {
+      absl::string_view value;
+      absl::string_view description;
+      NumberString::Style style;
+    };
+
+    NumberStringList() = default;
+    NumberStringList(const NumberStringList &) = delete;
+    NumberStringList &operator=(const NumberStringList &) = delete;
+
+    size_t size() const { return items_.size(); }
+    bool empty() const { return items_.empty(); }
+    Entry operator[](size_t i) const {
+      const Item &item = items_[i];
+      return {absl::string_view(buffer_).substr(item.begin, item.size),
+              item.description, item.style};
+    }
+
+    // Appends a copy of |value|.  |description| is not copied and must
+    // outlive the list; the descriptions of NumberUtil are static strings.
+    void Add(absl::string_view value, absl::string_view description,
+             NumberString::Style style);
+
+    // Appends copies of all the entries to |output|.
+    void AppendTo(std::vector<NumberString> *output) const;
+
+    void Clear() {
+      buffer_.clear();
+      items_.clear();
+    }
+
+   private:
+    friend class NumberUtil;
+
+    struct Item {
+      size_t begin;
+      size_t size;
+      absl::string_view description;
+      NumberString::Style style;
+    };
+
+    // Adds the characters appended to |buffer_| since |begin| as an entry.
+    void AddSince(size_t begin, absl::string_view description,
+                  NumberString::Style style) {
+      items_.push_back({begin, buffer_.size() - begin, description, style});
+    }
+
+    std::string buffer_;
+    std::vector<Item> items_;
+  };
+
   // Following five functions are main functions to convert number strings.
   // They receive two arguments:
   //   - input_num: a string consisting of Arabic numeric characters.
@@ -115,6 +174,8 @@ class NumberUtil {
   // If |input_num| is invalid or cannot represent as the form, these
   // functions do nothing.  If a method finds more than one representations,
   // it pushes all candidates into the output.
+  // Each function has an overload appending to a NumberStringList, which
+  // avoids allocating a string per result and is preferred on hot paths.
 
   // Converts half-width Arabic number string to Kan-su-ji string.
   //   - input_num: a string which *must* be half-width number string.
@@ -123,24 +184,32 @@ class NumberUtil {
   // if invalid string is set, this function do nothing.
   static bool ArabicToKanji(absl::string_view input_num,
                             std::vector<NumberString> *output);
+  static bool ArabicToKanji(absl::string_view input_num,
+                            NumberStringList *output);
 
   // Converts half-width Arabic number string to Separated Arabic string.
   // (e.g. 1234567890 are converted to 1,234,567,890)
   // Arguments are same as ArabicToKanji (above).
   static bool ArabicToSeparatedArabic(absl::string_view input_num,
                                       std::vector<NumberString> *output);
+  static bool ArabicToSeparatedArabic(absl::string_view input_num,
+                                      NumberStringList *output);
 
   // Converts half-width Arabic number string to full-width Arabic number
   // string.
   // Arguments are same as ArabicToKanji (above).
   static bool ArabicToWideArabic(absl::string_view input_num,
                                  std::vector<NumberString> *output);
+  static bool ArabicToWideArabic(absl::string_view input_num,
+                                 NumberStringList *output);
 
   // Converts half-width Arabic number to various styles.
   // Arguments are same as ArabicToKanji (above).
   //   - Roman style (i) (ii) ...
   static bool ArabicToOtherForms(absl::string_view input_num,
                                  std::vector<NumberString> *output);
+  static bool ArabicToOtherForms(absl::string_view input_num,
+                                 NumberStringList *output);
 
   // Converts half-width Arabic number to various radices (2,8,16).
   // Arguments are same as ArabicToKanji (above).
@@ -148,6 +217,8 @@ class NumberUtil {
   // converted only if it can be stored in an unsigned 64-bit integer.
   static bool ArabicToOtherRadixes(absl::string_view input_num,
                                    std::vector<NumberString> *output);
+  static bool ArabicToOtherRadixes(absl::string_view input_num,
+                                   NumberStringList *output);
 
   // Converts the string to a 32-/64-bit signed/unsigned int.  Returns true if
   // success or false if the string is in the wrong format.
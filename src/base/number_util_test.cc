@@ -773,5 +773,74 @@ TEST(NumberUtilTest, ArabicToOtherRadixesTest) {
   EXPECT_FALSE(NumberUtil::ArabicToOtherRadixes(arabic, &output));
 }
 
+TEST(NumberUtilTest, NumberStringList) {
+  NumberUtil::NumberStringList numbers;
+  EXPECT_TRUE(numbers.empty());
+
+  numbers.Add("20", "", NumberUtil::NumberString::DEFAULT_STYLE);
+  EXPECT_TRUE(NumberUtil::ArabicToKanji("20", &numbers));
+  EXPECT_TRUE(NumberUtil::ArabicToOtherRadixes("20", &numbers));
+  ASSERT_EQ(numbers.size(), 7);
+  EXPECT_EQ(numbers[0].value, "20");
+  EXPECT_EQ(numbers[1].value, "二十");
+  EXPECT_EQ(numbers[1].description, "漢数字");
+  EXPECT_EQ(numbers[1].style, NumberUtil::NumberString::NUMBER_KANJI);
+  EXPECT_EQ(numbers[2].value, "弐拾");
+  EXPECT_EQ(numbers[3].value, "廿");
+  EXPECT_EQ(numbers[3].style, NumberUtil::NumberString::NUMBER_OLD_KANJI);
+  EXPECT_EQ(numbers[4].value, "0x14");
+  EXPECT_EQ(numbers[5].value, "024");
+  EXPECT_EQ(numbers[6].value, "0b10100");
+  EXPECT_EQ(numbers[6].description, "2進数");
+
+  // A cleared list is reused for the other inputs.
+  struct TestCase {
+    absl::string_view input;
+    std::vector<absl::string_view> expected;
+  };
+  const TestCase kTestCases[] = {
+      {"0", {"〇", "０", "零", "⁰", "₀"}},
+      {"10",
+       {"一〇", "１０", "10", "１０", "十", "壱拾", "拾", "Ⅹ", "ⅹ", "⑩",
+        "0xa", "012", "0b1010"}},
+      {"1000",
+       {"一〇〇〇", "１０００", "1,000", "１，０００", "千", "壱阡", "阡",
+        "0x3e8", "01750", "0b1111101000"}},
+      {"12345678",
+       {"一二三四五六七八", "１２３４５６７８", "12,345,678",
+        "１２，３４５，６７８", "1234万5678", "１２３４万５６７８",
+        "千二百三十四万五千六百七十八", "壱阡弐百参拾四萬五阡六百七拾八",
+        "0xbc614e", "057060516", "0b101111000110000101001110"}},
+      {"3.14", {"3.14", "３．１４"}},
+      {"123456789012345678901",
+       {"一二三四五六七八九〇一二三四五六七八九〇一",
+        "１２３４５６７８９０１２３４５６７８９０１",
+        "123,456,789,012,345,678,901",
+        "１２３，４５６，７８９，０１２，３４５，６７８，９０１"}},
+  };
+  for (const TestCase &test_case : kTestCases) {
+    SCOPED_TRACE(test_case.input);
+    numbers.Clear();
+    NumberUtil::ArabicToWideArabic(test_case.input, &numbers);
+    NumberUtil::ArabicToSeparatedArabic(test_case.input, &numbers);
+    NumberUtil::ArabicToKanji(test_case.input, &numbers);
+    NumberUtil::ArabicToOtherForms(test_case.input, &numbers);
+    NumberUtil::ArabicToOtherRadixes(test_case.input, &numbers);
+    ASSERT_EQ(numbers.size(), test_case.expected.size());
+    for (size_t i = 0; i < numbers.size(); ++i) {
+      EXPECT_EQ(numbers[i].value, test_case.expected[i]);
+    }
+
+    std::vector<NumberUtil::NumberString> copied;
+    numbers.AppendTo(&copied);
+    ASSERT_EQ(copied.size(), test_case.expected.size());
+    for (size_t i = 0; i < copied.size(); ++i) {
+      EXPECT_EQ(copied[i].value, test_case.expected[i]);
+      EXPECT_EQ(copied[i].description, numbers[i].description);
+      EXPECT_EQ(copied[i].style, numbers[i].style);
+    }
+  }
+}
+
 }  // namespace
 }  // namespace mozc
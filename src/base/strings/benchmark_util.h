@@ -0,0 +1,62 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Helpers shared by the benchmark binaries of the string libraries.
+
+#ifndef MOZC_BASE_STRINGS_BENCHMARK_UTIL_H_
+#define MOZC_BASE_STRINGS_BENCHMARK_UTIL_H_
+
+#include <cstddef>
+#include <iostream>
+#include <ostream>
+
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "base/stopwatch.h"
+
+namespace mozc::strings {
+
+// Calls `f` `iterations` times and prints the average time per call with
+// `name`. `f` returns a number derived from its result, which is summed up and
+// printed so that the calls are not optimized out.
+template <typename F>
+void Measure(absl::string_view name, const int iterations, F f) {
+  size_t sum = 0;
+  const Stopwatch stopwatch = Stopwatch::StartNew();
+  for (int i = 0; i < iterations; ++i) {
+    sum += f();
+  }
+  const absl::Duration elapsed = stopwatch.GetElapsed();
+  std::cout << "  " << name << ": " << elapsed / iterations
+            << " per iteration (checksum " << sum << ")" << std::endl;
+}
+
+}  // namespace mozc::strings
+
+#endif  // MOZC_BASE_STRINGS_BENCHMARK_UTIL_H_
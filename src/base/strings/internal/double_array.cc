@@ -29,14 +29,15 @@
 
 #include "base/strings/internal/double_array.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <string>
 #include <utility>
 #include <vector>
 
-#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "base/strings/internal/utf8_internal.h"
 #include "base/strings/unicode.h"
 
@@ -90,24 +91,46 @@ inline int AdvanceInputBy(const char *ctable, const LookupResult result,
 
 std::string ConvertUsingDoubleArray(const DoubleArray *da, const char *ctable,
                                     const absl::string_view input) {
-  int mblen = 0;
   std::string output;
+  ConvertUsingDoubleArray(da, ctable, input, &output);
+  return output;
+}
+
+void ConvertUsingDoubleArray(const DoubleArray *da, const char *ctable,
+                             const absl::string_view input,
+                             std::string *output) {
+  const DoubleArrayRule rule = {da, ctable};
+  ConvertUsingDoubleArrays({&rule, 1}, input, output);
+}
+
+void ConvertUsingDoubleArrays(const absl::Span<const DoubleArrayRule> rules,
+                              const absl::string_view input,
+                              std::string *output) {
+  // Most rules don't change the length much.
+  output->reserve(output->size() + input.size());
+  int mblen = 0;
   for (size_t i = 0; i < input.size(); i += mblen) {
-    const LookupResult result = LookupDoubleArray(da, input.substr(i));
-    if (result.seekto > 0) {
-      // Each entry in ctable consists of:
-      // - null-terminated string
-      // - one byte offset to rewind the input
-      const absl::string_view s(ctable + result.index);
-      absl::StrAppend(&output, s);
-      mblen = AdvanceInputBy(ctable, result, s.size());
-    } else {
-      // Not found in the table. Copy from input.
+    const absl::string_view rest = input.substr(i);
+    bool found = false;
+    for (const DoubleArrayRule &rule : rules) {
+      const LookupResult result = LookupDoubleArray(rule.da, rest);
+      if (result.seekto > 0) {
+        // Each entry in ctable consists of:
+        // - null-terminated string
+        // - one byte offset to rewind the input
+        const absl::string_view s(rule.table + result.index);
+        output->append(s.data(), s.size());
+        mblen = AdvanceInputBy(rule.table, result, s.size());
+        found = true;
+        break;
+      }
+    }
+    if (!found) {
+      // Not found in the tables. Copy from input.
       mblen = OneCharLen(input[i]);
-      absl::StrAppend(&output, input.substr(i, mblen));
+      output->append(input.data() + i, std::min<size_t>(mblen, rest.size()));
     }
   }
-  return output;
 }
 
 std::vector<std::pair<absl::string_view, absl::string_view>>
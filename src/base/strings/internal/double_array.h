@@ -36,6 +36,7 @@
 #include <vector>
 
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 
 namespace mozc::japanese::internal {
 
@@ -47,6 +48,23 @@ struct DoubleArray {
 std::string ConvertUsingDoubleArray(const DoubleArray *da, const char *table,
                                     absl::string_view input);
 
+// Appends the conversion of input to *output.
+void ConvertUsingDoubleArray(const DoubleArray *da, const char *table,
+                             absl::string_view input, std::string *output);
+
+// A conversion rule, i.e., a double array and its table.
+struct DoubleArrayRule {
+  const DoubleArray *da;
+  const char *table;
+};
+
+// Appends the conversion of input with multiple rules to *output in a single
+// pass. At each position, the first rule that matches is used.
+// This is equivalent to applying the rules one by one only if no rule matches
+// the output of another rule, which the caller needs to ensure.
+void ConvertUsingDoubleArrays(absl::Span<const DoubleArrayRule> rules,
+                              absl::string_view input, std::string *output);
+
 std::vector<std::pair<absl::string_view, absl::string_view>>
 AlignUsingDoubleArray(const DoubleArray *da, const char *ctable,
                       absl::string_view input);
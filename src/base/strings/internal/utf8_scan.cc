@@ -0,0 +1,170 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "base/strings/internal/utf8_scan.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "absl/numeric/bits.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define MOZC_UTF8_SCAN_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define MOZC_UTF8_SCAN_NEON
+#endif  // __SSE2__ || _M_X64
+
+namespace mozc::utf8_internal {
+namespace {
+
+constexpr bool IsAscii(const char c) { return static_cast<uint8_t>(c) < 0x80; }
+
+constexpr bool IsTrailingByte(const char c) {
+  return (static_cast<uint8_t>(c) & 0xc0) == 0x80;
+}
+
+#if defined(MOZC_UTF8_SCAN_SSE2)
+
+constexpr size_t kBlockSize = 16;
+
+inline __m128i LoadBlock(const char* ptr) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+}
+
+// Returns true if all the bytes in the block are ASCII.
+inline bool IsAsciiBlock(const char* ptr) {
+  return _mm_movemask_epi8(LoadBlock(ptr)) == 0;
+}
+
+// Returns the number of bytes in the block that aren't trailing bytes.
+inline size_t LeadingBytesInBlock(const char* ptr) {
+  // Trailing bytes are [-128, -65] as signed chars.
+  const __m128i trailing = _mm_cmplt_epi8(LoadBlock(ptr), _mm_set1_epi8(-64));
+  return kBlockSize -
+         absl::popcount(static_cast<uint32_t>(_mm_movemask_epi8(trailing)));
+}
+
+#elif defined(MOZC_UTF8_SCAN_NEON)
+
+constexpr size_t kBlockSize = 16;
+
+inline bool IsAsciiBlock(const char* ptr) {
+  return vmaxvq_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(ptr))) < 0x80;
+}
+
+inline size_t LeadingBytesInBlock(const char* ptr) {
+  // Leading bytes are [-64, 127] as signed chars.
+  const uint8x16_t leading =
+      vcgeq_s8(vld1q_s8(reinterpret_cast<const int8_t*>(ptr)), vdupq_n_s8(-64));
+  return vaddvq_u8(vshrq_n_u8(leading, 7));
+}
+
+#else  // MOZC_UTF8_SCAN_SSE2
+
+// Processes a 64-bit word at a time.
+constexpr size_t kBlockSize = 8;
+constexpr uint64_t kHighBits = 0x8080808080808080;
+
+inline uint64_t LoadBlock(const char* ptr) {
+  uint64_t word;
+  std::memcpy(&word, ptr, sizeof(word));
+  return word;
+}
+
+inline bool IsAsciiBlock(const char* ptr) {
+  return (LoadBlock(ptr) & kHighBits) == 0;
+}
+
+inline size_t LeadingBytesInBlock(const char* ptr) {
+  // Trailing bytes have the highest bit set and the second highest bit unset.
+  // Shifting by one moves the second highest bit of each byte to the highest.
+  const uint64_t word = LoadBlock(ptr);
+  const uint64_t trailing = word & ~(word << 1) & kHighBits;
+  return kBlockSize - absl::popcount(trailing);
+}
+
+#endif  // MOZC_UTF8_SCAN_SSE2
+
+inline bool HasBlock(const char* ptr, const char* last) {
+  return static_cast<size_t>(last - ptr) >= kBlockSize;
+}
+
+}  // namespace
+
+size_t AsciiPrefixLength(const char* const first, const char* const last) {
+  const char* ptr = first;
+  while (HasBlock(ptr, last) && IsAsciiBlock(ptr)) {
+    ptr += kBlockSize;
+  }
+  while (ptr != last && IsAscii(*ptr)) {
+    ++ptr;
+  }
+  return ptr - first;
+}
+
+size_t CountLeadingBytes(const char* first, const char* const last) {
+  size_t count = 0;
+  for (; HasBlock(first, last); first += kBlockSize) {
+    count += LeadingBytesInBlock(first);
+  }
+  for (; first != last; ++first) {
+    count += !IsTrailingByte(*first);
+  }
+  return count;
+}
+
+const char* SkipLeadingBytes(const char* first, const char* const last,
+                             size_t n) {
+  // Skip whole blocks while they have no more than n characters, then find the
+  // exact position in the remaining bytes.
+  while (HasBlock(first, last)) {
+    const size_t count = LeadingBytesInBlock(first);
+    if (count > n) {
+      break;
+    }
+    n -= count;
+    first += kBlockSize;
+  }
+  for (; first != last; ++first) {
+    if (IsTrailingByte(*first)) {
+      continue;
+    }
+    if (n == 0) {
+      return first;
+    }
+    --n;
+  }
+  return last;
+}
+
+}  // namespace mozc::utf8_internal
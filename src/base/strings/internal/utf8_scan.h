@@ -0,0 +1,58 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// Block-wise scanning primitives for UTF-8 strings. They process 16 bytes at a
+// time with SSE2 on x86-64 and NEON on AArch64, and 8 bytes at a time with
+// plain 64-bit word operations elsewhere. Both are baseline instruction sets
+// on these architectures, so no runtime dispatch is needed.
+
+#ifndef MOZC_BASE_STRINGS_INTERNAL_UTF8_SCAN_H_
+#define MOZC_BASE_STRINGS_INTERNAL_UTF8_SCAN_H_
+
+#include <cstddef>
+
+namespace mozc::utf8_internal {
+
+// Returns the number of leading ASCII bytes (0x00-0x7f) in [first, last).
+size_t AsciiPrefixLength(const char* first, const char* last);
+
+// Returns the number of bytes in [first, last) that aren't trailing bytes
+// (0x80-0xbf). It equals the number of characters if [first, last) is a valid
+// UTF-8 string.
+size_t CountLeadingBytes(const char* first, const char* last);
+
+// Returns the pointer to the (n + 1)-th byte in [first, last) that isn't a
+// trailing byte, or last if there are not as many. In other words, it skips n
+// characters of a valid UTF-8 string.
+const char* SkipLeadingBytes(const char* first, const char* last, size_t n);
+
+}  // namespace mozc::utf8_internal
+
+#endif  // MOZC_BASE_STRINGS_INTERNAL_UTF8_SCAN_H_
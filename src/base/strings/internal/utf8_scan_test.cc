@@ -0,0 +1,102 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "base/strings/internal/utf8_scan.h"
+
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "testing/gunit.h"
+
+namespace mozc::utf8_internal {
+namespace {
+
+// Wrappers taking string_view.
+size_t AsciiPrefixLength(const absl::string_view sv) {
+  return utf8_internal::AsciiPrefixLength(sv.data(), sv.data() + sv.size());
+}
+
+size_t CountLeadingBytes(const absl::string_view sv) {
+  return utf8_internal::CountLeadingBytes(sv.data(), sv.data() + sv.size());
+}
+
+size_t SkipLeadingBytes(const absl::string_view sv, const size_t n) {
+  return utf8_internal::SkipLeadingBytes(sv.data(), sv.data() + sv.size(), n) -
+         sv.data();
+}
+
+TEST(Utf8ScanTest, AsciiPrefixLength) {
+  EXPECT_EQ(AsciiPrefixLength(""), 0);
+  EXPECT_EQ(AsciiPrefixLength("Mozc"), 4);
+  EXPECT_EQ(AsciiPrefixLength("あMozc"), 0);
+  EXPECT_EQ(AsciiPrefixLength("Mozcは便利"), 4);
+
+  // Non-ASCII bytes at every position of blocks.
+  const std::string ascii(40, 'a');
+  for (size_t i = 0; i <= ascii.size(); ++i) {
+    std::string str = ascii;
+    str.insert(i, "あ");
+    EXPECT_EQ(AsciiPrefixLength(str), i);
+  }
+  EXPECT_EQ(AsciiPrefixLength(ascii), ascii.size());
+}
+
+TEST(Utf8ScanTest, CountLeadingBytes) {
+  EXPECT_EQ(CountLeadingBytes(""), 0);
+  EXPECT_EQ(CountLeadingBytes("Mozc"), 4);
+  EXPECT_EQ(CountLeadingBytes("私の名前は中野です"), 9);
+  EXPECT_EQ(CountLeadingBytes("Mozc は便利 😀"), 10);
+  EXPECT_EQ(CountLeadingBytes("\x80\xbf"), 0);
+  EXPECT_EQ(CountLeadingBytes("\xc0\xff\x7f"), 3);
+
+  std::string str;
+  for (size_t i = 0; i < 40; ++i) {
+    EXPECT_EQ(CountLeadingBytes(str), i);
+    str.append(i % 2 == 0 ? "あ" : "a");
+  }
+}
+
+TEST(Utf8ScanTest, SkipLeadingBytes) {
+  EXPECT_EQ(SkipLeadingBytes("", 0), 0);
+  EXPECT_EQ(SkipLeadingBytes("", 1), 0);
+  EXPECT_EQ(SkipLeadingBytes("Mozc", 2), 2);
+  EXPECT_EQ(SkipLeadingBytes("Mozc", 5), 4);
+  EXPECT_EQ(SkipLeadingBytes("あいうえお", 0), 0);
+  EXPECT_EQ(SkipLeadingBytes("あいうえお", 3), 9);
+
+  const std::string str = "あいうえおかきくけこさしすせそ";
+  for (size_t i = 0; i <= 15; ++i) {
+    EXPECT_EQ(SkipLeadingBytes(str, i), i * 3);
+  }
+  EXPECT_EQ(SkipLeadingBytes(str, 16), str.size());
+}
+
+}  // namespace
+}  // namespace mozc::utf8_internal
@@ -40,76 +40,194 @@
 namespace mozc::japanese {
 
 using ::mozc::japanese::internal::ConvertUsingDoubleArray;
+using ::mozc::japanese::internal::ConvertUsingDoubleArrays;
+using ::mozc::japanese::internal::DoubleArrayRule;
 
 std::string HiraganaToKatakana(const absl::string_view input) {
-  return ConvertUsingDoubleArray(internal::hiragana_to_katakana_da,
-                                 internal::hiragana_to_katakana_table, input);
+  std::string output;
+  HiraganaToKatakana(input, &output);
+  return output;
+}
+
+void HiraganaToKatakana(const absl::string_view input, std::string *output) {
+  ConvertUsingDoubleArray(internal::hiragana_to_katakana_da,
+                          internal::hiragana_to_katakana_table, input, output);
 }
 
 std::string HiraganaToHalfwidthKatakana(const absl::string_view input) {
+  std::string output;
+  HiraganaToHalfwidthKatakana(input, &output);
+  return output;
+}
+
+void HiraganaToHalfwidthKatakana(const absl::string_view input,
+                                 std::string *output) {
   // combine two rules
-  return FullWidthKatakanaToHalfWidthKatakana(HiraganaToKatakana(input));
+  const std::string katakana = HiraganaToKatakana(input);
+  FullWidthKatakanaToHalfWidthKatakana(katakana, output);
 }
 
 std::string HiraganaToRomanji(const absl::string_view input) {
-  return ConvertUsingDoubleArray(internal::hiragana_to_romanji_da,
-                                 internal::hiragana_to_romanji_table, input);
+  std::string output;
+  HiraganaToRomanji(input, &output);
+  return output;
+}
+
+void HiraganaToRomanji(const absl::string_view input, std::string *output) {
+  ConvertUsingDoubleArray(internal::hiragana_to_romanji_da,
+                          internal::hiragana_to_romanji_table, input, output);
 }
 
 std::string HalfWidthAsciiToFullWidthAscii(const absl::string_view input) {
-  return ConvertUsingDoubleArray(
+  std::string output;
+  HalfWidthAsciiToFullWidthAscii(input, &output);
+  return output;
+}
+
+void HalfWidthAsciiToFullWidthAscii(const absl::string_view input,
+                                    std::string *output) {
+  ConvertUsingDoubleArray(
       internal::halfwidthascii_to_fullwidthascii_da,
-      internal::halfwidthascii_to_fullwidthascii_table, input);
+      internal::halfwidthascii_to_fullwidthascii_table, input, output);
 }
 
 std::string FullWidthAsciiToHalfWidthAscii(const absl::string_view input) {
-  return ConvertUsingDoubleArray(
+  std::string output;
+  FullWidthAsciiToHalfWidthAscii(input, &output);
+  return output;
+}
+
+void FullWidthAsciiToHalfWidthAscii(const absl::string_view input,
+                                    std::string *output) {
+  ConvertUsingDoubleArray(
       internal::fullwidthascii_to_halfwidthascii_da,
-      internal::fullwidthascii_to_halfwidthascii_table, input);
+      internal::fullwidthascii_to_halfwidthascii_table, input, output);
 }
 
 std::string HiraganaToFullwidthRomanji(const absl::string_view input) {
-  return HalfWidthAsciiToFullWidthAscii(HiraganaToRomanji(input));
+  std::string output;
+  HiraganaToFullwidthRomanji(input, &output);
+  return output;
+}
+
+void HiraganaToFullwidthRomanji(const absl::string_view input,
+                                std::string *output) {
+  const std::string romanji = HiraganaToRomanji(input);
+  HalfWidthAsciiToFullWidthAscii(romanji, output);
 }
 
 std::string RomanjiToHiragana(const absl::string_view input) {
-  return ConvertUsingDoubleArray(internal::romanji_to_hiragana_da,
-                                 internal::romanji_to_hiragana_table, input);
+  std::string output;
+  RomanjiToHiragana(input, &output);
+  return output;
+}
+
+void RomanjiToHiragana(const absl::string_view input, std::string *output) {
+  ConvertUsingDoubleArray(internal::romanji_to_hiragana_da,
+                          internal::romanji_to_hiragana_table, input, output);
 }
 
-std::string KatakanaToHiragana(absl::string_view input) {
-  return ConvertUsingDoubleArray(internal::katakana_to_hiragana_da,
-                                 internal::katakana_to_hiragana_table, input);
+std::string KatakanaToHiragana(const absl::string_view input) {
+  std::string output;
+  KatakanaToHiragana(input, &output);
+  return output;
+}
+
+void KatakanaToHiragana(const absl::string_view input, std::string *output) {
+  ConvertUsingDoubleArray(internal::katakana_to_hiragana_da,
+                          internal::katakana_to_hiragana_table, input, output);
 }
 
 std::string HalfWidthKatakanaToFullWidthKatakana(absl::string_view input) {
-  return ConvertUsingDoubleArray(
+  std::string output;
+  HalfWidthKatakanaToFullWidthKatakana(input, &output);
+  return output;
+}
+
+void HalfWidthKatakanaToFullWidthKatakana(const absl::string_view input,
+                                          std::string *output) {
+  ConvertUsingDoubleArray(
       internal::halfwidthkatakana_to_fullwidthkatakana_da,
-      internal::halfwidthkatakana_to_fullwidthkatakana_table, input);
+      internal::halfwidthkatakana_to_fullwidthkatakana_table, input, output);
 }
 
 std::string FullWidthKatakanaToHalfWidthKatakana(absl::string_view input) {
-  return ConvertUsingDoubleArray(
+  std::string output;
+  FullWidthKatakanaToHalfWidthKatakana(input, &output);
+  return output;
+}
+
+void FullWidthKatakanaToHalfWidthKatakana(const absl::string_view input,
+                                          std::string *output) {
+  ConvertUsingDoubleArray(
       internal::fullwidthkatakana_to_halfwidthkatakana_da,
-      internal::fullwidthkatakana_to_halfwidthkatakana_table, input);
+      internal::fullwidthkatakana_to_halfwidthkatakana_table, input, output);
 }
 
 std::string FullWidthToHalfWidth(const absl::string_view input) {
-  return FullWidthKatakanaToHalfWidthKatakana(
-      FullWidthAsciiToHalfWidthAscii(input));
+  std::string output;
+  FullWidthToHalfWidth(input, &output);
+  return output;
+}
+
+void FullWidthToHalfWidth(const absl::string_view input, std::string *output) {
+  // The ASCII and katakana rules don't overlap, so they are applied in a
+  // single pass.
+  constexpr DoubleArrayRule kRules[] = {
+      {internal::fullwidthascii_to_halfwidthascii_da,
+       internal::fullwidthascii_to_halfwidthascii_table},
+      {internal::fullwidthkatakana_to_halfwidthkatakana_da,
+       internal::fullwidthkatakana_to_halfwidthkatakana_table},
+  };
+  ConvertUsingDoubleArrays(kRules, input, output);
 }
 
 std::string HalfWidthToFullWidth(const absl::string_view input) {
-  return HalfWidthKatakanaToFullWidthKatakana(
-      HalfWidthAsciiToFullWidthAscii(input));
+  std::string output;
+  HalfWidthToFullWidth(input, &output);
+  return output;
+}
+
+void HalfWidthToFullWidth(const absl::string_view input, std::string *output) {
+  constexpr DoubleArrayRule kRules[] = {
+      {internal::halfwidthascii_to_fullwidthascii_da,
+       internal::halfwidthascii_to_fullwidthascii_table},
+      {internal::halfwidthkatakana_to_fullwidthkatakana_da,
+       internal::halfwidthkatakana_to_fullwidthkatakana_table},
+  };
+  ConvertUsingDoubleArrays(kRules, input, output);
 }
 
 // TODO(tabata): Add another function to split voice mark
 // of some UNICODE only characters (required to display
 // and commit for old clients)
 std::string NormalizeVoicedSoundMark(const absl::string_view input) {
-  return ConvertUsingDoubleArray(internal::normalize_voiced_sound_da,
-                                 internal::normalize_voiced_sound_table, input);
+  std::string output;
+  NormalizeVoicedSoundMark(input, &output);
+  return output;
+}
+
+void NormalizeVoicedSoundMark(const absl::string_view input,
+                              std::string *output) {
+  ConvertUsingDoubleArray(
+      internal::normalize_voiced_sound_da,
+      internal::normalize_voiced_sound_table, input, output);
+}
+
+void HiraganaToTransliterations(const absl::string_view input,
+                                HiraganaTransliterations *output) {
+  output->full_katakana.clear();
+  HiraganaToKatakana(input, &output->full_katakana);
+  output->half_katakana.clear();
+  FullWidthToHalfWidth(output->full_katakana, &output->half_katakana);
+
+  // Use full_romanji as a temporary buffer for the raw romaji.
+  output->full_romanji.clear();
+  HiraganaToRomanji(input, &output->full_romanji);
+  output->half_romanji.clear();
+  FullWidthAsciiToHalfWidthAscii(output->full_romanji, &output->half_romanji);
+  output->full_romanji.clear();
+  HalfWidthAsciiToFullWidthAscii(output->half_romanji, &output->full_romanji);
 }
 
 std::vector<std::pair<absl::string_view, absl::string_view>>
@@ -0,0 +1,124 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// Measures the buffer-reusing and fused transliteration functions against
+// calling the string-returning functions one by one.
+//
+// Usage:
+//   japanese_benchmark_main --length=32 --iterations=100000
+
+#include <cstdint>
+#include <iostream>
+#include <ostream>
+#include <string>
+
+#include "absl/flags/flag.h"
+#include "absl/log/check.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "base/init_mozc.h"
+#include "base/strings/benchmark_util.h"
+#include "base/strings/japanese.h"
+
+ABSL_FLAG(int32_t, length, 32, "the number of repetitions of each text");
+ABSL_FLAG(int32_t, iterations, 100000, "the number of iterations");
+
+namespace mozc {
+namespace {
+
+using ::mozc::strings::Measure;
+
+std::string Repeat(absl::string_view unit, int length) {
+  std::string result;
+  for (int i = 0; i < length; ++i) {
+    absl::StrAppend(&result, unit);
+  }
+  return result;
+}
+
+// The width conversion applied as two separate passes.
+std::string TwoPassFullWidthToHalfWidth(absl::string_view input) {
+  return japanese::FullWidthKatakanaToHalfWidthKatakana(
+      japanese::FullWidthAsciiToHalfWidthAscii(input));
+}
+
+void RunTransliterations(absl::string_view label, const std::string &text) {
+  const int iterations = absl::GetFlag(FLAGS_iterations);
+  std::cout << label << " (" << text.size() << " bytes)" << std::endl;
+
+  Measure("separate calls", iterations, [&] {
+    const std::string full_katakana = japanese::HiraganaToKatakana(text);
+    const std::string half_katakana =
+        japanese::FullWidthToHalfWidth(full_katakana);
+    const std::string half_romanji = japanese::FullWidthAsciiToHalfWidthAscii(
+        japanese::HiraganaToRomanji(text));
+    const std::string full_romanji =
+        japanese::HalfWidthAsciiToFullWidthAscii(half_romanji);
+    return full_katakana.size() + half_katakana.size() + half_romanji.size() +
+           full_romanji.size();
+  });
+  japanese::HiraganaTransliterations forms;
+  Measure("HiraganaToTransliterations", iterations, [&] {
+    japanese::HiraganaToTransliterations(text, &forms);
+    return forms.full_katakana.size() + forms.half_katakana.size() +
+           forms.half_romanji.size() + forms.full_romanji.size();
+  });
+}
+
+void RunWidth(absl::string_view label, const std::string &text) {
+  const int iterations = absl::GetFlag(FLAGS_iterations);
+  std::cout << label << " (" << text.size() << " bytes)" << std::endl;
+  CHECK_EQ(japanese::FullWidthToHalfWidth(text),
+           TwoPassFullWidthToHalfWidth(text));
+
+  Measure("FullWidthToHalfWidth (two passes)", iterations,
+          [&] { return TwoPassFullWidthToHalfWidth(text).size(); });
+  Measure("FullWidthToHalfWidth", iterations,
+          [&] { return japanese::FullWidthToHalfWidth(text).size(); });
+  std::string buffer;
+  Measure("FullWidthToHalfWidth (reused buffer)", iterations, [&] {
+    buffer.clear();
+    japanese::FullWidthToHalfWidth(text, &buffer);
+    return buffer.size();
+  });
+}
+
+}  // namespace
+}  // namespace mozc
+
+int main(int argc, char **argv) {
+  mozc::InitMozc(argv[0], &argc, &argv);
+  const int length = absl::GetFlag(FLAGS_length);
+  mozc::RunTransliterations("Hiragana",
+                            mozc::Repeat("きょうはいいてんきです", length));
+  mozc::RunWidth("Katakana and ASCII",
+                 mozc::Repeat("ＭｏｚｃはコンピュータのＩＭＥです。", length));
+  return 0;
+}
@@ -33,7 +33,9 @@
 #include <utility>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "base/strings/unicode.h"
 #include "testing/gunit.h"
 
 namespace mozc::japanese {
@@ -186,6 +188,62 @@ TEST(JapaneseUtilTest, FullWidthAndHalfWidth) {
   EXPECT_EQ(output, " 　");  // Not changed
 }
 
+TEST(JapaneseUtilTest, FullWidthAndHalfWidthInSinglePass) {
+  // FullWidthToHalfWidth and HalfWidthToFullWidth apply the ASCII and katakana
+  // rules in a single pass. Check that they are the same as applying them one
+  // by one for all the characters in BMP and their pairs with voiced sound
+  // marks.
+  for (char32_t c = 1; c < 0x10000; ++c) {
+    if (c >= 0xd800 && c <= 0xdfff) {
+      continue;
+    }
+    for (const absl::string_view suffix : {"", "ﾞ", "ﾟ", "゛", "゜", "a"}) {
+      std::string input;
+      strings::StrAppendChar32(&input, c);
+      absl::StrAppend(&input, suffix);
+      EXPECT_EQ(FullWidthToHalfWidth(input),
+                FullWidthKatakanaToHalfWidthKatakana(
+                    FullWidthAsciiToHalfWidthAscii(input)))
+          << input;
+      EXPECT_EQ(HalfWidthToFullWidth(input),
+                HalfWidthKatakanaToFullWidthKatakana(
+                    HalfWidthAsciiToFullWidthAscii(input)))
+          << input;
+    }
+  }
+}
+
+TEST(JapaneseUtilTest, AppendToBuffer) {
+  std::string output = "prefix:";
+  HiraganaToKatakana("あいう", &output);
+  EXPECT_EQ(output, "prefix:アイウ");
+  FullWidthToHalfWidth("ｇｏｏｇｌｅグーグル", &output);
+  EXPECT_EQ(output, "prefix:アイウgoogleｸﾞｰｸﾞﾙ");
+  HiraganaToHalfwidthKatakana("がっこう", &output);
+  EXPECT_EQ(output, "prefix:アイウgoogleｸﾞｰｸﾞﾙｶﾞｯｺｳ");
+}
+
+TEST(JapaneseUtilTest, HiraganaToTransliterations) {
+  HiraganaTransliterations t13ns;
+  t13ns.full_katakana = "garbage";
+  for (const absl::string_view input :
+       {"", "きゃっち", "ぐーぐる", "ａｂｃ", "1ねん", "ｱｲｳ"}) {
+    HiraganaToTransliterations(input, &t13ns);
+    const std::string full_katakana = HiraganaToKatakana(input);
+    const std::string half_romanji =
+        FullWidthAsciiToHalfWidthAscii(HiraganaToRomanji(input));
+    EXPECT_EQ(t13ns.full_katakana, full_katakana);
+    EXPECT_EQ(t13ns.half_katakana, FullWidthToHalfWidth(full_katakana));
+    EXPECT_EQ(t13ns.half_romanji, half_romanji);
+    EXPECT_EQ(t13ns.full_romanji, HalfWidthAsciiToFullWidthAscii(half_romanji));
+  }
+  HiraganaToTransliterations("きゃっち", &t13ns);
+  EXPECT_EQ(t13ns.full_katakana, "キャッチ");
+  EXPECT_EQ(t13ns.half_katakana, "ｷｬｯﾁ");
+  EXPECT_EQ(t13ns.half_romanji, "kyatti");
+  EXPECT_EQ(t13ns.full_romanji, "ｋｙａｔｔｉ");
+}
+
 TEST(JapaneseUtilTest, AlignTest) {
   using V = std::vector<std::pair<absl::string_view, absl::string_view>>;
 
@@ -30,18 +30,48 @@
 #include "base/strings/unicode.h"
 
 #include <cstddef>
+#include <cstdint>
 #include <string>
 #include <string_view>
 
 #include "absl/strings/string_view.h"
 #include "base/strings/internal/utf8_internal.h"
+#include "base/strings/internal/utf8_scan.h"
 
 namespace mozc {
 namespace strings {
+namespace {
+
+// Decodes a three-byte sequence whose leading byte is one of E1..EC and EE..EF,
+// which covers kana and most of kanji. These leading bytes accept any trailing
+// bytes in 80..BF. Returns 0 for the other sequences.
+inline char32_t DecodeCommonThreeBytes(const char *const ptr,
+                                       const char *const last) {
+  const uint8_t b0 = ptr[0];
+  if (b0 < 0xe1 || b0 > 0xef || b0 == 0xed || last - ptr < 3) {
+    return 0;
+  }
+  const uint8_t b1 = ptr[1], b2 = ptr[2];
+  if ((b1 & 0xc0) != 0x80 || (b2 & 0xc0) != 0x80) {
+    return 0;
+  }
+  return ((b0 & 0x0f) << 12) | ((b1 & 0x3f) << 6) | (b2 & 0x3f);
+}
+
+}  // namespace
 
 bool IsValidUtf8(const absl::string_view sv) {
   const char *const last = sv.data() + sv.size();
   for (const char *ptr = sv.data(); ptr != last;) {
+    // Skip runs of ASCII characters in blocks.
+    if (static_cast<uint8_t>(*ptr) < 0x80) {
+      ptr += utf8_internal::AsciiPrefixLength(ptr, last);
+      continue;
+    }
+    if (DecodeCommonThreeBytes(ptr, last) != 0) {
+      ptr += 3;
+      continue;
+    }
     const utf8_internal::DecodeResult dr = utf8_internal::Decode(ptr, last);
     if (!dr.ok()) {
       return false;
@@ -51,11 +81,35 @@ bool IsValidUtf8(const absl::string_view sv) {
   return true;
 }
 
+size_t CharsLen(const absl::string_view sv) {
+  return utf8_internal::CountLeadingBytes(sv.data(), sv.data() + sv.size());
+}
+
 std::u32string Utf8ToUtf32(const absl::string_view sv) {
-  const Utf8AsChars32 c32s{sv};
-  // Most strings in Mozc are fairly short, so it's faster to depend on
-  // automatic growth rather than calling reserve(CharsLen()).
-  return std::u32string(c32s.begin(), c32s.end());
+  // CharsLen() counts the characters in blocks, so it's cheaper to reserve
+  // the size than to depend on automatic growth. The result can be longer for
+  // ill-formed strings, as each ill-formed sequence is replaced with U+FFFD.
+  std::u32string result;
+  result.reserve(CharsLen(sv));
+  const char *const last = sv.data() + sv.size();
+  for (const char *ptr = sv.data(); ptr != last;) {
+    // Copy runs of ASCII characters without decoding them.
+    if (static_cast<uint8_t>(*ptr) < 0x80) {
+      const size_t len = utf8_internal::AsciiPrefixLength(ptr, last);
+      result.append(ptr, ptr + len);
+      ptr += len;
+      continue;
+    }
+    if (const char32_t c = DecodeCommonThreeBytes(ptr, last); c != 0) {
+      result.push_back(c);
+      ptr += 3;
+      continue;
+    }
+    const utf8_internal::DecodeResult dr = utf8_internal::Decode(ptr, last);
+    result.push_back(dr.code_point());
+    ptr += dr.bytes_seen();
+  }
+  return result;
 }
 
 std::string Utf32ToUtf8(const std::u32string_view sv) {
@@ -67,23 +121,19 @@ std::string Utf32ToUtf8(const std::u32string_view sv) {
   return result;
 }
 
-absl::string_view Utf8Substring(absl::string_view sv, size_t pos) {
-  while (pos > 0) {
-    sv.remove_prefix(OneCharLen(sv.front()));
-    --pos;
-  }
-  return sv;
+absl::string_view Utf8Substring(const absl::string_view sv, const size_t pos) {
+  const char *const last = sv.data() + sv.size();
+  const char *const first =
+      utf8_internal::SkipLeadingBytes(sv.data(), last, pos);
+  return absl::string_view(first, last - first);
 }
 
 absl::string_view Utf8Substring(absl::string_view sv, const size_t pos,
-                                size_t count) {
+                                const size_t count) {
   sv = Utf8Substring(sv, pos);
-  size_t i = 0;
-  while (i < sv.size() && count > 0) {
-    i += OneCharLen(sv[i]);
-    --count;
-  }
-  return sv.substr(0, i);
+  const char *const last =
+      utf8_internal::SkipLeadingBytes(sv.data(), sv.data() + sv.size(), count);
+  return absl::string_view(sv.data(), last - sv.data());
 }
 
 }  // namespace strings
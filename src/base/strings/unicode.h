@@ -81,12 +81,11 @@ bool IsValidUtf8(absl::string_view sv);
 //
 // REQUIRES: The UTF-8 string must be valid. This implementation only sees the
 // leading byte of each character and doesn't check if it's well-formed.
+// The string_view version counts the leading bytes in blocks of bytes.
 // Complexity: linear
 template <typename InputIterator>
 size_t CharsLen(InputIterator first, InputIterator last);
-inline size_t CharsLen(const absl::string_view sv) {
-  return CharsLen(sv.begin(), sv.end());
-}
+size_t CharsLen(absl::string_view sv);
 
 // Returns the number of Unicode characters between [0, n]. It stops counting at
 // n. This is faster than CharsLen if you just want to check the length against
@@ -0,0 +1,127 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// Measures the block-wise UTF-8 scanning functions against per-character
+// loops for ASCII, Japanese and mixed texts.
+//
+// Usage:
+//   unicode_benchmark_main --length=64 --iterations=100000
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <ostream>
+#include <string>
+
+#include "absl/flags/flag.h"
+#include "absl/log/check.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "base/init_mozc.h"
+#include "base/strings/benchmark_util.h"
+#include "base/strings/unicode.h"
+#include "base/util.h"
+
+ABSL_FLAG(int32_t, length, 64, "the number of characters in each text");
+ABSL_FLAG(int32_t, iterations, 100000, "the number of iterations");
+
+namespace mozc {
+namespace {
+
+using ::mozc::strings::Measure;
+
+std::string Repeat(absl::string_view unit, int length) {
+  const size_t unit_len = strings::CharsLen(unit);
+  std::string result;
+  for (int i = 0; i < length; ++i) {
+    absl::StrAppend(&result, strings::Utf8Substring(unit, i % unit_len, 1));
+  }
+  return result;
+}
+
+// Per-character implementations for comparison.
+bool ScalarIsValidUtf8(absl::string_view sv) {
+  for (const UnicodeChar c : Utf8AsUnicodeChar(sv)) {
+    if (!c.ok()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::u32string ScalarUtf8ToUtf32(absl::string_view sv) {
+  const Utf8AsChars32 chars(sv);
+  return std::u32string(chars.begin(), chars.end());
+}
+
+absl::string_view ScalarUtf8Substring(absl::string_view sv, size_t pos) {
+  for (; pos > 0; --pos) {
+    sv.remove_prefix(strings::OneCharLen(sv.front()));
+  }
+  return sv;
+}
+
+void Run(absl::string_view label, const std::string &text) {
+  const int iterations = absl::GetFlag(FLAGS_iterations);
+  const size_t len = strings::CharsLen(text);
+  std::cout << label << " (" << text.size() << " bytes)" << std::endl;
+  CHECK_EQ(len, strings::CharsLen(text.begin(), text.end()));
+  CHECK_EQ(strings::Utf8ToUtf32(text), ScalarUtf8ToUtf32(text));
+
+  Measure("CharsLen", iterations, [&] { return strings::CharsLen(text); });
+  Measure("CharsLen (scalar)", iterations,
+          [&] { return strings::CharsLen(text.begin(), text.end()); });
+  Measure("IsValidUtf8", iterations,
+          [&] { return strings::IsValidUtf8(text); });
+  Measure("IsValidUtf8 (scalar)", iterations,
+          [&] { return ScalarIsValidUtf8(text); });
+  Measure("Utf8ToUtf32", iterations,
+          [&] { return strings::Utf8ToUtf32(text).size(); });
+  Measure("Utf8ToUtf32 (scalar)", iterations,
+          [&] { return ScalarUtf8ToUtf32(text).size(); });
+  Measure("Utf8Substring", iterations,
+          [&] { return strings::Utf8Substring(text, len / 2).size(); });
+  Measure("Utf8Substring (scalar)", iterations,
+          [&] { return ScalarUtf8Substring(text, len / 2).size(); });
+  Measure("Util::GetScriptType", iterations,
+          [&] { return static_cast<size_t>(Util::GetScriptType(text)); });
+}
+
+}  // namespace
+}  // namespace mozc
+
+int main(int argc, char **argv) {
+  mozc::InitMozc(argv[0], &argc, &argv);
+  const int length = absl::GetFlag(FLAGS_length);
+  mozc::Run("ASCII", mozc::Repeat("abcdefghijklmnopqrstuvwxyz", length));
+  mozc::Run("Hiragana", mozc::Repeat("あいうえおかきくけこ", length));
+  mozc::Run("Mixed", mozc::Repeat("Mozcは便利です。2024年", length));
+  return 0;
+}
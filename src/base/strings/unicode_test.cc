@@ -29,12 +29,15 @@
 
 #include "base/strings/unicode.h"
 
+#include <cstddef>
 #include <iterator>
 #include <string>
 #include <string_view>
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/random/random.h"
+#include "absl/strings/escaping.h"
 #include "absl/strings/string_view.h"
 #include "testing/gmock.h"
 #include "testing/gunit.h"
@@ -159,6 +162,100 @@ TEST(UnicodeTest, Utf8Substring) {
   EXPECT_EQ(Utf8Substring("日本語", 2, 0), "");
 }
 
+// Randomized tests comparing the block-wise implementations with per-character
+// loops on strings long enough to span multiple blocks.
+class UnicodeFuzzTest : public ::testing::Test {
+ protected:
+  // Returns a random valid UTF-8 string with the given number of characters.
+  std::string RandomUtf8(const size_t num_chars) {
+    std::string result;
+    for (size_t i = 0; i < num_chars; ++i) {
+      char32_t c;
+      switch (absl::Uniform(gen_, 0, 4)) {
+        case 0:
+          c = absl::Uniform<char32_t>(gen_, 0, 0x80);
+          break;
+        case 1:
+          c = absl::Uniform<char32_t>(gen_, 0x80, 0x800);
+          break;
+        case 2:
+          // Skip surrogates.
+          c = absl::Uniform<char32_t>(gen_, 0x800, 0xd800);
+          break;
+        default:
+          c = absl::Uniform<char32_t>(gen_, 0x10000, 0x110000);
+          break;
+      }
+      StrAppendChar32(&result, c);
+    }
+    return result;
+  }
+
+  // Returns a random byte string, mostly made of valid UTF-8 characters.
+  std::string RandomBytes(const size_t num_chars) {
+    std::string result = RandomUtf8(num_chars);
+    const int errors = absl::Uniform(gen_, 0, 3);
+    for (int i = 0; i < errors && !result.empty(); ++i) {
+      result[absl::Uniform<size_t>(gen_, 0, result.size())] =
+          absl::Uniform<int>(gen_, 0x80, 0x100);
+    }
+    return result;
+  }
+
+  static constexpr int kIterations = 2000;
+  static constexpr size_t kMaxChars = 80;
+
+  absl::BitGen gen_;
+};
+
+TEST_F(UnicodeFuzzTest, CharsLen) {
+  for (int i = 0; i < kIterations; ++i) {
+    const std::string str = RandomUtf8(absl::Uniform(gen_, 0u, kMaxChars));
+    EXPECT_EQ(CharsLen(str), CharsLen(str.begin(), str.end())) << str;
+  }
+}
+
+TEST_F(UnicodeFuzzTest, IsValidUtf8) {
+  for (int i = 0; i < kIterations; ++i) {
+    const std::string str = RandomBytes(absl::Uniform(gen_, 0u, kMaxChars));
+    bool expected = true;
+    for (const UnicodeChar c : Utf8AsUnicodeChar(str)) {
+      expected &= c.ok();
+    }
+    EXPECT_EQ(IsValidUtf8(str), expected) << absl::CHexEscape(str);
+  }
+}
+
+TEST_F(UnicodeFuzzTest, Utf8ToUtf32) {
+  for (int i = 0; i < kIterations; ++i) {
+    const std::string str = RandomBytes(absl::Uniform(gen_, 0u, kMaxChars));
+    const Utf8AsChars32 chars(str);
+    EXPECT_EQ(Utf8ToUtf32(str), std::u32string(chars.begin(), chars.end()))
+        << absl::CHexEscape(str);
+  }
+}
+
+TEST_F(UnicodeFuzzTest, Utf8Substring) {
+  for (int i = 0; i < kIterations; ++i) {
+    const std::string str = RandomUtf8(absl::Uniform(gen_, 0u, kMaxChars));
+    const size_t len = CharsLen(str.begin(), str.end());
+    const size_t pos = absl::Uniform<size_t>(gen_, 0, len + 1);
+    const size_t count = absl::Uniform<size_t>(gen_, 0, len + 2);
+    absl::string_view expected = str;
+    for (size_t j = 0; j < pos; ++j) {
+      expected.remove_prefix(OneCharLen(expected.front()));
+    }
+    EXPECT_EQ(Utf8Substring(str, pos), expected) << str << ", " << pos;
+    size_t size = 0;
+    for (size_t j = 0; j < count && size < expected.size(); ++j) {
+      size += OneCharLen(expected[size]);
+    }
+    expected = expected.substr(0, size);
+    EXPECT_EQ(Utf8Substring(str, pos, count), expected)
+        << str << ", " << pos << ", " << count;
+  }
+}
+
 struct Utf8AsCharsTestParam {
   template <typename Sink>
   friend void AbslStringify(Sink& sink, const Utf8AsCharsTestParam& param) {
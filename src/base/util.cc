@@ -786,113 +786,39 @@ bool Util::IsEnglishTransliteration(absl::string_view value) {
   return true;
 }
 
-#define INRANGE(w, a, b) ((w) >= (a) && (w) <= (b))
+namespace {
+// constexpr uint8_t kCharClassBlockIndex[]
+// constexpr uint8_t kCharClassBlocks[][]
+#include "base/char_class_table.inc"
+
+static_assert(Util::UNKNOWN_SCRIPT == 0 && Util::KATAKANA == 1 &&
+                  Util::HIRAGANA == 2 && Util::KANJI == 3 &&
+                  Util::NUMBER == 4 && Util::ALPHABET == 5 &&
+                  Util::EMOJI == 6,
+              "The order must be the same as gen_char_class_table.py");
+
+// Returns the entry of the character class table. The lower bits are the
+// script type and kCharClassHalfWidthBit is set for HALF_WIDTH.
+uint8_t GetCharClass(const char32_t w) {
+  if (w >= kCharClassTableSize) {
+    // UNKNOWN_SCRIPT and FULL_WIDTH.
+    return 0;
+  }
+  const uint8_t block = kCharClassBlockIndex[w >> kCharClassBlockBits];
+  return kCharClassBlocks[block][w & ((1 << kCharClassBlockBits) - 1)];
+}
+}  // namespace
 
-// script type
-// TODO(yukawa, team): Make a mechanism to keep this classifier up-to-date
-//   based on the original data from Unicode.org.
+// The script type and the form type are looked up from the table generated by
+// base/gen_char_class_table.py, which also has the ranges of each type.
 Util::ScriptType Util::GetScriptType(char32_t w) {
-  if (INRANGE(w, 0x0030, 0x0039) ||  // ascii number
-      INRANGE(w, 0xFF10, 0xFF19)) {  // full width number
-    return NUMBER;
-  } else if (INRANGE(w, 0x0041, 0x005A) ||  // ascii upper
-             INRANGE(w, 0x0061, 0x007A) ||  // ascii lower
-             INRANGE(w, 0xFF21, 0xFF3A) ||  // fullwidth ascii upper
-             INRANGE(w, 0xFF41, 0xFF5A)) {  // fullwidth ascii lower
-    return ALPHABET;
-  } else if (w == 0x3005 ||  // IDEOGRAPHIC ITERATION MARK "々"
-             INRANGE(w, 0x3400,
-                     0x4DBF) ||  // CJK Unified Ideographs Extension A
-             INRANGE(w, 0x4E00, 0x9FFF) ||  // CJK Unified Ideographs
-             INRANGE(w, 0xF900, 0xFAFF) ||  // CJK Compatibility Ideographs
-             INRANGE(w, 0x20000,
-                     0x2A6DF) ||  // CJK Unified Ideographs Extension B
-             INRANGE(w, 0x2A700,
-                     0x2B73F) ||  // CJK Unified Ideographs Extension C
-             INRANGE(w, 0x2B740,
-                     0x2B81F) ||  // CJK Unified Ideographs Extension D
-             INRANGE(w, 0x2F800, 0x2FA1F)) {  // CJK Compatibility Ideographs
-    // As of Unicode 6.0.2, each block has the following characters assigned.
-    // [U+3400, U+4DB5]:   CJK Unified Ideographs Extension A
-    // [U+4E00, U+9FCB]:   CJK Unified Ideographs
-    // [U+4E00, U+FAD9]:   CJK Compatibility Ideographs
-    // [U+20000, U+2A6D6]: CJK Unified Ideographs Extension B
-    // [U+2A700, U+2B734]: CJK Unified Ideographs Extension C
-    // [U+2B740, U+2B81D]: CJK Unified Ideographs Extension D
-    // [U+2F800, U+2FA1D]: CJK Compatibility Ideographs
-    return KANJI;
-  } else if (INRANGE(w, 0x3041, 0x309F) ||  // hiragana
-             w == 0x1B001) {                // HIRAGANA LETTER ARCHAIC YE
-    return HIRAGANA;
-  } else if (INRANGE(w, 0x30A1, 0x30FF) ||  // full width katakana
-             INRANGE(w, 0x31F0,
-                     0x31FF) ||  // Katakana Phonetic Extensions for Ainu
-             INRANGE(w, 0xFF65, 0xFF9F) ||  // half width katakana
-             w == 0x1B000) {                // KATAKANA LETTER ARCHAIC E
-    return KATAKANA;
-  } else if (INRANGE(w, 0x02300, 0x023F3) ||  // Miscellaneous Technical
-             INRANGE(w, 0x02700, 0x027BF) ||  // Dingbats
-             INRANGE(w, 0x1F000, 0x1F02F) ||  // Mahjong tiles
-             INRANGE(w, 0x1F030, 0x1F09F) ||  // Domino tiles
-             INRANGE(w, 0x1F0A0, 0x1F0FF) ||  // Playing cards
-             INRANGE(w, 0x1F100,
-                     0x1F2FF) ||  // Enclosed Alphanumeric Supplement
-             INRANGE(w, 0x1F200, 0x1F2FF) ||  // Enclosed Ideographic Supplement
-             INRANGE(w, 0x1F300,
-                     0x1F5FF) ||  // Miscellaneous Symbols And Pictographs
-             INRANGE(w, 0x1F600, 0x1F64F) ||  // Emoticons
-             INRANGE(w, 0x1F680, 0x1F6FF) ||  // Transport And Map Symbols
-             INRANGE(w, 0x1F700, 0x1F77F) ||  // Alchemical Symbols
-             w == 0x26CE) {                   // Ophiuchus
-    return EMOJI;
-  }
-
-  return UNKNOWN_SCRIPT;
+  return static_cast<ScriptType>(GetCharClass(w) & kCharClassScriptTypeMask);
 }
 
 Util::FormType Util::GetFormType(char32_t w) {
-  // 'Unicode Standard Annex #11: EAST ASIAN WIDTH'
-  // http://www.unicode.org/reports/tr11/
-
-  // Characters marked as 'Na' in
-  // http://www.unicode.org/Public/UNIDATA/EastAsianWidth.txt
-  if (INRANGE(w, 0x0020, 0x007F) ||  // ascii
-      INRANGE(w, 0x27E6, 0x27ED) ||  // narrow mathematical symbols
-      INRANGE(w, 0x2985, 0x2986)) {  // narrow white parentheses
-    return HALF_WIDTH;
-  }
-
-  // Other characters marked as 'Na' in
-  // http://www.unicode.org/Public/UNIDATA/EastAsianWidth.txt
-  if (INRANGE(w, 0x00A2, 0x00AF)) {
-    switch (w) {
-      case 0x00A2:  // CENT SIGN
-      case 0x00A3:  // POUND SIGN
-      case 0x00A5:  // YEN SIGN
-      case 0x00A6:  // BROKEN BAR
-      case 0x00AC:  // NOT SIGN
-      case 0x00AF:  // MACRON
-        return HALF_WIDTH;
-    }
-  }
-
-  // Characters marked as 'H' in
-  // http://www.unicode.org/Public/UNIDATA/EastAsianWidth.txt
-  if (w == 0x20A9 ||                 // WON SIGN
-      INRANGE(w, 0xFF61, 0xFF9F) ||  // half-width katakana
-      INRANGE(w, 0xFFA0, 0xFFBE) ||  // half-width hangul
-      INRANGE(w, 0xFFC2, 0xFFCF) ||  // half-width hangul
-      INRANGE(w, 0xFFD2, 0xFFD7) ||  // half-width hangul
-      INRANGE(w, 0xFFDA, 0xFFDC) ||  // half-width hangul
-      INRANGE(w, 0xFFE8, 0xFFEE)) {  // half-width symbols
-    return HALF_WIDTH;
-  }
-
-  return FULL_WIDTH;
+  return (GetCharClass(w) & kCharClassHalfWidthBit) ? HALF_WIDTH : FULL_WIDTH;
 }
 
-#undef INRANGE
-
 // Returns the script type of the first character in `str`.
 Util::ScriptType Util::GetFirstScriptType(absl::string_view str,
                                           size_t *mblen) {
@@ -979,6 +905,14 @@ bool Util::IsScriptType(absl::string_view str, Util::ScriptType type) {
   return true;
 }
 
+uint32_t Util::GetScriptTypeMask(absl::string_view str) {
+  uint32_t mask = 0;
+  for (const char32_t w : Utf8AsChars32(str)) {
+    mask |= 1 << GetScriptType(w);
+  }
+  return mask;
+}
+
 // return true if the string contains script_type char
 bool Util::ContainsScriptType(absl::string_view str, ScriptType type) {
   for (ConstChar32Iterator iter(str); !iter.Done(); iter.Next()) {
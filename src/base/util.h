@@ -213,6 +213,10 @@ class Util {
   // return true if the string contains script_type char
   static bool ContainsScriptType(absl::string_view str, ScriptType type);
 
+  // Returns the logical sum of (1 << script type) of all the characters in
+  // str, e.g. (1 << HIRAGANA) | (1 << KANJI) for "漢字かな".
+  static uint32_t GetScriptTypeMask(absl::string_view str);
+
   // See 'Unicode Standard Annex #11: EAST ASIAN WIDTH'
   // http://www.unicode.org/reports/tr11/
   // http://www.unicode.org/Public/UNIDATA/EastAsianWidth.txt
@@ -773,6 +773,19 @@ TEST(UtilTest, ScriptType) {
   EXPECT_EQ(Util::GetScriptType("\xf3\xbe\x80\x83"), Util::UNKNOWN_SCRIPT);
 }
 
+TEST(UtilTest, GetScriptTypeMask) {
+  EXPECT_EQ(Util::GetScriptTypeMask(""), 0);
+  EXPECT_EQ(Util::GetScriptTypeMask("くどう"), 1 << Util::HIRAGANA);
+  EXPECT_EQ(Util::GetScriptTypeMask("グーグル"), 1 << Util::KATAKANA);
+  EXPECT_EQ(Util::GetScriptTypeMask("漢字かなABC"),
+            (1 << Util::KANJI) | (1 << Util::HIRAGANA) | (1 << Util::ALPHABET));
+  EXPECT_EQ(Util::GetScriptTypeMask("０１２@"),
+            (1 << Util::NUMBER) | (1 << Util::UNKNOWN_SCRIPT));
+  // U+1F466, BOY/smile emoji and U+2F884
+  EXPECT_EQ(Util::GetScriptTypeMask("\xF0\x9F\x91\xA6\xF0\xAF\xA2\x84"),
+            (1 << Util::EMOJI) | (1 << Util::KANJI));
+}
+
 TEST(UtilTest, ScriptTypeWithoutSymbols) {
   EXPECT_EQ(Util::GetScriptTypeWithoutSymbols("くど う"), Util::HIRAGANA);
   EXPECT_EQ(Util::GetScriptTypeWithoutSymbols("京 都"), Util::KANJI);
@@ -95,6 +95,14 @@ constexpr absl::Duration kDefaultTimeout = absl::Seconds(30);  // 30 sec for opt
 // called from Destructor. When an application calls DeleteSession
 // explicitly, the default timeout is used.
 constexpr absl::Duration kDeleteSessionOnDestructorTimeout = absl::Seconds(1);
+
+std::string GetPreeditText(const commands::Output &output) {
+  std::string preedit;
+  for (const commands::Preedit::Segment &segment : output.preedit().segment()) {
+    preedit.append(segment.value());
+  }
+  return preedit;
+}
 }  // namespace
 
 Client::Client()
@@ -104,7 +112,9 @@ Client::Client()
       server_status_(SERVER_UNKNOWN),
       server_protocol_version_(0),
       server_process_id_(0),
-      last_mode_(commands::DIRECT) {
+      last_mode_(commands::DIRECT),
+      last_input_sequence_(0),
+      session_restored_(false) {
   response_.reserve(kResultBufferSize);
   client_factory_ = IPCClientFactory::GetIPCClientFactory();
 
@@ -270,6 +280,7 @@ void Client::PushHistory(const commands::Input &input,
   if (output.has_mode()) {
     last_mode_ = output.mode();
   }
+  last_preedit_ = GetPreeditText(output);
 
   // don't insert a new input when history_inputs_.size()
   // reaches to the maximum size. This prevents DOS attack.
@@ -288,6 +299,7 @@ void Client::PushHistory(const commands::Input &input,
 // Clear the history and push IMEOn command for initialize session.
 void Client::ResetHistory() {
   history_inputs_.clear();
+  last_preedit_.clear();
 #if defined(__APPLE__)
   // On Mac, we should send ON key at the first of each input session
   // excepting the very first session, because when the session is restored,
@@ -394,8 +406,11 @@ bool Client::EnsureCallCommand(commands::Input *input,
   if (server_status_ == SERVER_SHUTDOWN ||
       server_status_ == SERVER_INVALID_SESSION) {
     if (EnsureSession()) {
-      // playback the history to restore the previous state.
-      PlaybackHistory();
+      // playback the history to restore the previous state unless the server
+      // has restored it from its snapshot.
+      if (!session_restored_) {
+        PlaybackHistory();
+      }
       InitInput(input);
 #ifdef DEBUG
       // The debug binary dumps query of death at the first trial.
@@ -451,9 +466,18 @@ void Client::set_client_capability(const commands::Capability &capability) {
 }
 
 bool Client::CreateSession() {
+  const uint64_t previous_id = id_;
+  // Call() overwrites it with the input sequence of the restored session.
+  const uint64_t last_input_sequence = last_input_sequence_;
   id_ = 0;
+  session_restored_ = false;
   commands::Input input;
   input.set_type(commands::Input::CREATE_SESSION);
+  // Lets the server restore the previous session from its snapshot when the
+  // session is lost by the server restart.
+  if (previous_id != 0) {
+    input.set_id(previous_id);
+  }
 
   *input.mutable_capability() = client_capability_;
 
@@ -481,6 +505,24 @@ bool Client::CreateSession() {
   }
 
   id_ = output.id();
+  if (output.session_restored()) {
+    // Trusts the restored session only when it has processed all the inputs
+    // of the lost session and shows what the user saw. Otherwise (e.g., the
+    // snapshot was saved before the last inputs), discards it and falls back
+    // to the history playback.
+    session_restored_ = output.input_sequence() == last_input_sequence &&
+                        GetPreeditText(output) == last_preedit_;
+    if (!session_restored_) {
+      MOZC_VLOG(1) << "Restored session is inconsistent. Reset the context.";
+      commands::Input reset_input;
+      InitInput(&reset_input);
+      reset_input.set_type(commands::Input::SEND_COMMAND);
+      reset_input.mutable_command()->set_type(
+          commands::SessionCommand::RESET_CONTEXT);
+      commands::Output reset_output;
+      Call(reset_input, &reset_output);
+    }
+  }
   return true;
 }
 
@@ -717,6 +759,9 @@ bool Client::Call(const commands::Input &input, commands::Output *output) {
 
   MOZC_VLOG(2) << "commands::Output: " << std::endl << *output;
 
+  if (output->has_input_sequence()) {
+    last_input_sequence_ = output->input_sequence();
+  }
   return true;
 }
 
@@ -821,6 +866,21 @@ void Client::Reset() {
   server_process_id_ = 0;
 }
 
+bool Client::ReleaseSession() {
+  const bool result = DeleteSession();
+  // The next session must not restore this one even if DeleteSession failed.
+  id_ = 0;
+  if (server_status_ == SERVER_OK) {
+    server_status_ = SERVER_INVALID_SESSION;
+  }
+  history_inputs_.clear();
+  last_preedit_.clear();
+  last_mode_ = commands::DIRECT;
+  last_input_sequence_ = 0;
+  session_restored_ = false;
+  return result;
+}
+
 bool Client::TranslateProtoBufToMozcToolArg(const commands::Output &output,
                                             std::string *mode) {
   if (!output.has_launch_tool_mode() || mode == nullptr) {
@@ -149,6 +149,12 @@ class Client : public ClientInterface {
 
   void Reset() override;
 
+  // Deletes the current session and clears the input history while keeping
+  // the server status, so that this client can be reused for another
+  // session without checking the server again.  A new session is created by
+  // the next command.
+  bool ReleaseSession();
+
   void EnableCascadingWindow(bool enable) override;
 
   void set_timeout(absl::Duration timeout) override;
@@ -267,6 +273,14 @@ class Client : public ClientInterface {
   std::vector<KeyInformation> direct_mode_keys_;
   // Remember the composition mode of input session for playback.
   commands::CompositionMode last_mode_;
+  // The preedit text of the last consumed output, used to verify the session
+  // restored by the server.
+  std::string last_preedit_;
+  // The input sequence of the last output, used to verify the session
+  // restored by the server.
+  uint64_t last_input_sequence_;
+  // True if the current session is restored from the server-side snapshot.
+  bool session_restored_;
   commands::Capability client_capability_;
 };
 
@@ -31,6 +31,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -272,6 +273,39 @@ TEST_F(ClientTest, SendKey) {
   EXPECT_EQ(input.type(), commands::Input::SEND_KEY);
 }
 
+TEST_F(ClientTest, ReleaseSession) {
+  const int mock_id = 123;
+  EXPECT_TRUE(SetupConnection(mock_id));
+
+  commands::KeyEvent key_event;
+  key_event.set_special_key(commands::KeyEvent::ENTER);
+
+  commands::Output mock_output;
+  mock_output.set_id(mock_id);
+  mock_output.set_consumed(true);
+  SetMockOutput(mock_output);
+
+  commands::Output output;
+  EXPECT_TRUE(client_->SendKey(key_event, &output));
+
+  EXPECT_TRUE(client_->ReleaseSession());
+  commands::Input input;
+  GetGeneratedInput(&input);
+  EXPECT_EQ(input.id(), mock_id);
+  EXPECT_EQ(input.type(), commands::Input::DELETE_SESSION);
+
+  // The next command creates a new session without starting the server.
+  server_launcher_->set_start_server_called(false);
+  const int new_mock_id = 456;
+  mock_output.set_id(new_mock_id);
+  SetMockOutput(mock_output);
+  EXPECT_TRUE(client_->SendKey(key_event, &output));
+  EXPECT_FALSE(server_launcher_->start_server_called());
+  GetGeneratedInput(&input);
+  EXPECT_EQ(input.id(), new_mock_id);
+  EXPECT_EQ(input.type(), commands::Input::SEND_KEY);
+}
+
 TEST_F(ClientTest, SendKeyWithContext) {
   const int mock_id = 123;
   EXPECT_TRUE(SetupConnection(mock_id));
@@ -1266,5 +1300,193 @@ TEST_F(SessionPlaybackTest, ConsumedTest) {
   client_->GetHistoryInputs(&history);
   EXPECT_EQ(history.size(), 2);
 }
+
+// Handles the inputs in process, emulating a server that can restart and
+// restore the lost session from its snapshot.
+class FakeSessionServer : public IPCClientFactoryInterface {
+ public:
+  std::unique_ptr<IPCClientInterface> NewClient(
+      const std::string &name, const std::string &path_name) override {
+    return std::make_unique<FakeIPCClient>(this);
+  }
+
+  std::unique_ptr<IPCClientInterface> NewClient(
+      const std::string &name) override {
+    return NewClient(name, "");
+  }
+
+  // Drops the session. The next CREATE_SESSION restores the lost session
+  // with |restored_sequence| as its input sequence if it is set.
+  void Restart(std::optional<uint64_t> restored_sequence) {
+    session_id_ = 0;
+    restored_sequence_ = restored_sequence;
+  }
+
+  const std::vector<commands::Input> &inputs() const { return inputs_; }
+
+ private:
+  class FakeIPCClient : public IPCClientInterface {
+   public:
+    explicit FakeIPCClient(FakeSessionServer *server) : server_(server) {}
+
+    bool Connected() const override { return true; }
+
+    bool Call(const std::string &request, std::string *response,
+              absl::Duration timeout) override {
+      commands::Input input;
+      if (!input.ParseFromString(request)) {
+        return false;
+      }
+      return server_->Handle(input).SerializeToString(response);
+    }
+
+    uint32_t GetServerProtocolVersion() const override {
+      return IPC_PROTOCOL_VERSION;
+    }
+
+    const std::string &GetServerProductVersion() const override {
+      return product_version_;
+    }
+
+    uint32_t GetServerProcessId() const override { return 0; }
+
+    IPCErrorType GetLastIPCError() const override { return IPC_NO_ERROR; }
+
+   private:
+    FakeSessionServer *server_;
+    const std::string product_version_ = Version::GetMozcVersion();
+  };
+
+  commands::Output Handle(const commands::Input &input) {
+    inputs_.push_back(input);
+    commands::Output output;
+    switch (input.type()) {
+      case commands::Input::CREATE_SESSION:
+        session_id_ = ++last_session_id_;
+        output.set_id(session_id_);
+        input_sequence_ = 0;
+        if (input.has_id() && restored_sequence_.has_value()) {
+          input_sequence_ = *restored_sequence_;
+          output.set_session_restored(true);
+          output.set_input_sequence(input_sequence_);
+        }
+        restored_sequence_.reset();
+        break;
+      case commands::Input::SEND_KEY:
+      case commands::Input::SEND_COMMAND:
+        // Leaves the id unset for an unknown session.
+        if (input.id() == session_id_) {
+          output.set_id(session_id_);
+          output.set_consumed(true);
+          output.set_input_sequence(++input_sequence_);
+        }
+        break;
+      default:
+        output.set_id(input.id());
+        break;
+    }
+    return output;
+  }
+
+  uint64_t last_session_id_ = 0;
+  uint64_t session_id_ = 0;
+  uint64_t input_sequence_ = 0;
+  std::optional<uint64_t> restored_sequence_;
+  std::vector<commands::Input> inputs_;
+};
+
+class FakeServerLauncher : public ServerLauncherInterface {
+ public:
+  bool StartServer(ClientInterface *client) override { return true; }
+  bool ForceTerminateServer(const absl::string_view name) override {
+    return true;
+  }
+  bool WaitServer(uint32_t pid) override { return true; }
+  void OnFatal(ServerLauncherInterface::ServerErrorType type) override {}
+  void set_server_program(const absl::string_view server_path) override {}
+  const std::string &server_program() const override {
+    return server_program_;
+  }
+  void set_restricted(bool restricted) override {}
+  void set_suppress_error_dialog(bool suppress) override {}
+
+ private:
+  const std::string server_program_;
+};
+
+class SessionRestoreTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    client_ = std::make_unique<Client>();
+    client_->SetIPCClientFactory(&server_);
+    client_->SetServerLauncher(std::make_unique<FakeServerLauncher>());
+  }
+
+  // Sends two keys, restarts the server and sends another key. Returns the
+  // inputs the server received after the restart.
+  std::vector<commands::Input> SendKeysAcrossRestart(
+      std::optional<uint64_t> restored_sequence) {
+    commands::KeyEvent key_event;
+    key_event.set_key_code('a');
+    commands::Output output;
+    EXPECT_TRUE(client_->SendKey(key_event, &output));
+    EXPECT_TRUE(client_->SendKey(key_event, &output));
+    const size_t num_inputs = server_.inputs().size();
+    server_.Restart(restored_sequence);
+    EXPECT_TRUE(client_->SendKey(key_event, &output));
+    EXPECT_TRUE(output.consumed());
+    return std::vector<commands::Input>(
+        server_.inputs().begin() + num_inputs, server_.inputs().end());
+  }
+
+  static std::vector<commands::Input::CommandType> GetTypes(
+      const std::vector<commands::Input> &inputs) {
+    std::vector<commands::Input::CommandType> types;
+    for (const commands::Input &input : inputs) {
+      types.push_back(input.type());
+    }
+    return types;
+  }
+
+  FakeSessionServer server_;
+  std::unique_ptr<Client> client_;
+};
+
+TEST_F(SessionRestoreTest, RestoredAndConsistent) {
+  const std::vector<commands::Input> inputs = SendKeysAcrossRestart(2);
+  // The restored session has processed both keys, so no playback is needed.
+  const std::vector<commands::Input::CommandType> expected = {
+      commands::Input::SEND_KEY,
+      commands::Input::CREATE_SESSION,
+      commands::Input::SEND_KEY,
+  };
+  EXPECT_EQ(GetTypes(inputs), expected);
+  EXPECT_EQ(inputs[1].id(), inputs[0].id());
+}
+
+TEST_F(SessionRestoreTest, RestoredButStale) {
+  // The snapshot was saved before the second key.
+  const std::vector<commands::Input> inputs = SendKeysAcrossRestart(1);
+  const std::vector<commands::Input::CommandType> expected = {
+      commands::Input::SEND_KEY,     commands::Input::CREATE_SESSION,
+      commands::Input::SEND_COMMAND, commands::Input::SEND_KEY,
+      commands::Input::SEND_KEY,     commands::Input::SEND_KEY,
+  };
+  ASSERT_EQ(GetTypes(inputs), expected);
+  EXPECT_EQ(inputs[2].command().type(),
+            commands::SessionCommand::RESET_CONTEXT);
+}
+
+TEST_F(SessionRestoreTest, NotRestored) {
+  const std::vector<commands::Input> inputs =
+      SendKeysAcrossRestart(std::nullopt);
+  const std::vector<commands::Input::CommandType> expected = {
+      commands::Input::SEND_KEY, commands::Input::CREATE_SESSION,
+      commands::Input::SEND_KEY, commands::Input::SEND_KEY,
+      commands::Input::SEND_KEY,
+  };
+  EXPECT_EQ(GetTypes(inputs), expected);
+}
+
 }  // namespace client
 }  // namespace mozc
@@ -123,6 +123,27 @@ transliteration::TransliterationType GetTransliterationType(
   return default_type;
 }
 
+// Changes the letter case of the ASCII output for the mode.
+void ApplyLetterCase(const transliteration::TransliterationType mode,
+                     std::string *output) {
+  switch (mode) {
+    case transliteration::HALF_ASCII_UPPER:
+    case transliteration::FULL_ASCII_UPPER:
+      Util::UpperString(output);
+      break;
+    case transliteration::HALF_ASCII_LOWER:
+    case transliteration::FULL_ASCII_LOWER:
+      Util::LowerString(output);
+      break;
+    case transliteration::HALF_ASCII_CAPITALIZED:
+    case transliteration::FULL_ASCII_CAPITALIZED:
+      Util::CapitalizeString(output);
+      break;
+    default:
+      break;
+  }
+}
+
 std::string Transliterate(const transliteration::TransliterationType mode,
                           const absl::string_view input) {
   // When the mode is HALF_KATAKANA, Full width ASCII is also
@@ -134,37 +155,19 @@ std::string Transliterate(const transliteration::TransliterationType mode,
 
   switch (mode) {
     case transliteration::HALF_ASCII:
-      return japanese_util::FullWidthAsciiToHalfWidthAscii(input);
-    case transliteration::HALF_ASCII_UPPER: {
-      std::string output = japanese_util::FullWidthAsciiToHalfWidthAscii(input);
-      Util::UpperString(&output);
-      return output;
-    }
-    case transliteration::HALF_ASCII_LOWER: {
-      std::string output = japanese_util::FullWidthAsciiToHalfWidthAscii(input);
-      Util::LowerString(&output);
-      return output;
-    }
+    case transliteration::HALF_ASCII_UPPER:
+    case transliteration::HALF_ASCII_LOWER:
     case transliteration::HALF_ASCII_CAPITALIZED: {
       std::string output = japanese_util::FullWidthAsciiToHalfWidthAscii(input);
-      Util::CapitalizeString(&output);
+      ApplyLetterCase(mode, &output);
       return output;
     }
     case transliteration::FULL_ASCII:
-      return japanese_util::HalfWidthAsciiToFullWidthAscii(input);
-    case transliteration::FULL_ASCII_UPPER: {
-      std::string output = japanese_util::HalfWidthAsciiToFullWidthAscii(input);
-      Util::UpperString(&output);
-      return output;
-    }
-    case transliteration::FULL_ASCII_LOWER: {
-      std::string output = japanese_util::HalfWidthAsciiToFullWidthAscii(input);
-      Util::LowerString(&output);
-      return output;
-    }
+    case transliteration::FULL_ASCII_UPPER:
+    case transliteration::FULL_ASCII_LOWER:
     case transliteration::FULL_ASCII_CAPITALIZED: {
       std::string output = japanese_util::HalfWidthAsciiToFullWidthAscii(input);
-      Util::CapitalizeString(&output);
+      ApplyLetterCase(mode, &output);
       return output;
     }
     case transliteration::FULL_KATAKANA:
@@ -915,11 +918,27 @@ std::string Composer::GetSubTransliteration(
 void Composer::GetSubTransliterations(
     const size_t position, const size_t size,
     transliteration::Transliterations *transliterations) const {
+  // The ASCII types share the transliterated text and differ only in the
+  // letter cases, so the text is transliterated once for half and full width
+  // each instead of once for each type.
+  const std::string half_ascii =
+      GetSubTransliteration(transliteration::HALF_ASCII, position, size);
+  const std::string full_ascii =
+      GetSubTransliteration(transliteration::FULL_ASCII, position, size);
   for (size_t i = 0; i < transliteration::NUM_T13N_TYPES; ++i) {
     const transliteration::TransliterationType t13n_type =
         transliteration::TransliterationTypeArray[i];
-    const std::string t13n = GetSubTransliteration(t13n_type, position, size);
-    transliterations->push_back(t13n);
+    std::string t13n;
+    if (transliteration::T13n::IsInHalfAsciiTypes(t13n_type)) {
+      t13n = half_ascii;
+      ApplyLetterCase(t13n_type, &t13n);
+    } else if (transliteration::T13n::IsInFullAsciiTypes(t13n_type)) {
+      t13n = full_ascii;
+      ApplyLetterCase(t13n_type, &t13n);
+    } else {
+      t13n = GetSubTransliteration(t13n_type, position, size);
+    }
+    transliterations->push_back(std::move(t13n));
   }
 }
 
@@ -47,6 +47,8 @@
         'internal/special_key.cc',
         'internal/transliterators.cc',
         'table.cc',
+        'typing_corrector.cc',
+        'typing_model.cc',
       ],
       'dependencies': [
         'key_event_util',
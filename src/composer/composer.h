@@ -86,6 +86,7 @@ class Composer final {
   bool Empty() const;
 
   void SetTable(const Table *table);
+  const Table *GetTable() const { return table_; }
 
   void SetRequest(const commands::Request *request);
   void SetConfig(const config::Config *config);
@@ -42,6 +42,8 @@
         'internal/special_key_test.cc',
         'internal/transliterators_test.cc',
         'table_test.cc',
+        'typing_corrector_test.cc',
+        'typing_model_test.cc',
       ],
       'dependencies': [
         '<(mozc_oss_src_dir)/base/absl.gyp:absl_strings',
@@ -0,0 +1,157 @@
+# -*- coding: utf-8 -*-
+# Copyright 2010-2021, Google Inc.
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met:
+#
+#     * Redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer.
+#     * Redistributions in binary form must reproduce the above
+# copyright notice, this list of conditions and the following disclaimer
+# in the documentation and/or other materials provided with the
+# distribution.
+#     * Neither the name of Google Inc. nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+"""Typing model generator.
+
+Compiles typing model TSV files, whose lines are "<keys>\t<cost>", into the
+binary tables read by composer::TypingModel.  See typing_model.h for the
+layout.
+
+How to run this script:
+gen_typing_model.py --output_dir=out_dir typing_model_12keys-hiragana.tsv ...
+"""
+
+import argparse
+import bisect
+import codecs
+import os
+import struct
+from typing import Dict, List
+
+# The last index of the cost table means that there is no entry.
+_MAPPING_TABLE_SIZE = 255
+_NO_ENTRY = 255
+
+
+def ReadTypingModel(file: str) -> Dict[str, int]:
+  """Reads a typing model TSV file.
+
+  Keys can start with "#", so the lines are not filtered as comments.
+
+  Args:
+    file: The TSV file.
+
+  Returns:
+    Dictionary from keys to costs.
+  """
+  model = {}
+  with codecs.open(file, 'r', encoding='utf-8') as f:
+    for line in f:
+      line = line.rstrip('\r\n')
+      if not line:
+        continue
+      key, cost = line.split('\t')
+      if not key or not key.isascii():
+        raise ValueError('Keys must be non-empty ASCII strings: %r' % key)
+      model[key] = int(cost)
+  return model
+
+
+def GetMappingTable(costs: List[int]) -> List[int]:
+  """Returns representative costs to quantize |costs| into one byte.
+
+  Args:
+    costs: All the costs of a model.
+
+  Returns:
+    Sorted costs of _MAPPING_TABLE_SIZE entries taken at regular intervals of
+    the sorted |costs|.
+  """
+  sorted_costs = sorted(set(costs))
+  if len(sorted_costs) <= _MAPPING_TABLE_SIZE:
+    table = sorted_costs
+  else:
+    step = len(sorted_costs) / _MAPPING_TABLE_SIZE
+    table = [sorted_costs[int(i * step)] for i in range(_MAPPING_TABLE_SIZE)]
+  return table + [table[-1]] * (_MAPPING_TABLE_SIZE - len(table))
+
+
+def GetNearestIndex(mapping_table: List[int], cost: int) -> int:
+  index = bisect.bisect_left(mapping_table, cost)
+  if index == len(mapping_table):
+    return index - 1
+  if index > 0:
+    lower, upper = mapping_table[index - 1], mapping_table[index]
+    if cost - lower < upper - cost:
+      return index - 1
+  return index
+
+
+def CompileTypingModel(model: Dict[str, int]) -> bytes:
+  """Returns the binary image of |model|."""
+  characters = ''.join(sorted(set(''.join(model.keys()))))
+  char_to_digit = {c: i + 1 for i, c in enumerate(characters)}
+  radix = len(characters) + 1
+  ngram_size = max(len(key) for key in model)
+
+  mapping_table = GetMappingTable(list(model.values()))
+  cost_table = bytearray([_NO_ENTRY] * (radix**ngram_size))
+  for key, cost in model.items():
+    index = 0
+    for c in reversed(key):
+      index = index * radix + char_to_digit[c]
+    cost_table[index] = GetNearestIndex(mapping_table, cost)
+
+  encoded_characters = characters.encode('ascii')
+  padding = b'\0' * (-len(encoded_characters) % 4)
+  return b''.join([
+      struct.pack('<II', len(encoded_characters), ngram_size),
+      struct.pack('<%di' % (_MAPPING_TABLE_SIZE + 1), *mapping_table, 0),
+      encoded_characters,
+      padding,
+      bytes(cost_table),
+  ])
+
+
+def ParseArgs() -> argparse.Namespace:
+  """Parse command line args.
+
+  Returns:
+    Parsed command line args.
+  """
+  parser = argparse.ArgumentParser()
+  parser.add_argument(
+      '--output_dir',
+      dest='output_dir',
+      help='Directory to write "<input basename>.data" files.')
+  parser.add_argument('inputs', nargs='+', help='Typing model TSV files.')
+  return parser.parse_args()
+
+
+def main() -> None:
+  args = ParseArgs()
+  for input_file in args.inputs:
+    name = os.path.splitext(os.path.basename(input_file))[0]
+    with open(os.path.join(args.output_dir, name + '.data'), 'wb') as f:
+      f.write(CompileTypingModel(ReadTypingModel(input_file)))
+
+
+if __name__ == '__main__':
+  main()
@@ -562,13 +562,14 @@ const Table &Table::GetDefaultTable() {
 // ========================================
 // TableContainer
 // ========================================
-TableManager::TableManager()
-    : custom_roman_table_fingerprint_(Fingerprint32("")) {}
+namespace {
 
-const Table *TableManager::GetTable(const mozc::commands::Request &request,
-                                    const mozc::config::Config &config) {
+// Returns the key identifying the table built for the request and the config.
+// It covers every field InitializeWithRequestAndConfig reads.
+uint64_t GetTableKey(const commands::Request &request,
+                     const config::Config &config) {
   // calculate the hash depending on the request and the config
-  uint32_t hash = request.special_romanji_table();
+  uint64_t hash = request.special_romanji_table();
   hash = hash * (mozc::config::Config_PreeditMethod_PreeditMethod_MAX + 1) +
          config.preedit_method();
   hash = hash * (mozc::config::Config_PunctuationMethod_PunctuationMethod_MAX +
@@ -577,26 +578,44 @@ const Table *TableManager::GetTable(const mozc::commands::Request &request,
   hash = hash * (mozc::config::Config_SymbolMethod_SymbolMethod_MAX + 1) +
          config.symbol_method();
 
-  // When custom_roman_table is set, force to create new table.
-  bool update_custom_roman_table = false;
-  if ((config.preedit_method() == config::Config::ROMAN) &&
+  // custom_roman_table is used only for the ROMAN preedit method.
+  if (config.preedit_method() == config::Config::ROMAN &&
       config.has_custom_roman_table() && !config.custom_roman_table().empty()) {
+    hash = FingerprintWithSeed(config.custom_roman_table(),
+                               static_cast<uint32_t>(hash));
+  }
+  return hash;
+}
+
+}  // namespace
+
+TableManager::TableManager()
+    : custom_roman_table_fingerprint_(Fingerprint32("")) {}
+
+const Table *TableManager::GetTable(const mozc::commands::Request &request,
+                                    const mozc::config::Config &config) {
+  const uint64_t key = GetTableKey(request, config);
+
+  // When custom_roman_table is updated, release the tables built from the
+  // previous one.
+  const bool use_custom_roman_table =
+      config.preedit_method() == config::Config::ROMAN &&
+      config.has_custom_roman_table() && !config.custom_roman_table().empty();
+  if (use_custom_roman_table) {
     const uint32_t custom_roman_table_fingerprint =
         Fingerprint32(config.custom_roman_table());
     if (custom_roman_table_fingerprint != custom_roman_table_fingerprint_) {
-      update_custom_roman_table = true;
       custom_roman_table_fingerprint_ = custom_roman_table_fingerprint;
+      for (const uint64_t custom_table_key : custom_table_keys_) {
+        table_map_.erase(custom_table_key);
+      }
+      custom_table_keys_.clear();
     }
   }
 
-  const auto iterator = table_map_.find(hash);
+  const auto iterator = table_map_.find(key);
   if (iterator != table_map_.end()) {
-    if (update_custom_roman_table) {
-      // Delete the previous table to update the table.
-      table_map_.erase(iterator);
-    } else {
-      return iterator->second.get();
-    }
+    return iterator->second.get();
   }
 
   auto table = std::make_unique<Table>();
@@ -605,11 +624,17 @@ const Table *TableManager::GetTable(const mozc::commands::Request &request,
   }
 
   const Table *ret = table.get();
-  table_map_[hash] = std::move(table);
+  table_map_[key] = std::move(table);
+  if (use_custom_roman_table) {
+    custom_table_keys_.insert(key);
+  }
   return ret;
 }
 
-void TableManager::ClearCaches() { table_map_.clear(); }
+void TableManager::ClearCaches() {
+  table_map_.clear();
+  custom_table_keys_.clear();
+}
 
 }  // namespace composer
 }  // namespace mozc
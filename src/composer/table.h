@@ -151,6 +151,8 @@ class Table final {
   bool case_sensitive_ = false;
 };
 
+// Cache of the tables for the requests and the configs. SessionHandler owns
+// one instance and shares its tables with all sessions.
 class TableManager {
  public:
   TableManager();
@@ -164,12 +166,16 @@ class TableManager {
 
  private:
   // Table caches.
-  // Key uint32_t is calculated hash and unique for
+  // Key uint64_t is calculated hash and unique for
   //  commands::Request::SpecialRomanjiTable
   //  config::Config::PreeditMethod
   //  config::Config::PunctuationMethod
   //  config::Config::SymbolMethod
-  absl::flat_hash_map<uint32_t, std::unique_ptr<const Table>> table_map_;
+  //  config::Config::custom_roman_table
+  absl::flat_hash_map<uint64_t, std::unique_ptr<const Table>> table_map_;
+  // Keys in table_map_ built from Config::custom_roman_table. They are
+  // released when the custom table is updated.
+  absl::flat_hash_set<uint64_t> custom_table_keys_;
   // Fingerprint for Config::custom_roman_table;
   uint32_t custom_roman_table_fingerprint_;
 };
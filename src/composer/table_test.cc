@@ -1064,5 +1064,36 @@ TEST_F(TableTest, TableManager) {
   }
 }
 
+TEST_F(TableTest, TableManagerKeysCustomRomanTables) {
+  TableManager table_manager;
+
+  commands::Request request;
+  request.set_special_romanji_table(Request::DEFAULT_TABLE);
+  config::Config config;
+  config.set_preedit_method(Config::ROMAN);
+
+  // Different custom roman tables produce different tables.
+  config.set_custom_roman_table("a\t[A]\n");
+  const Table *custom_table1 = table_manager.GetTable(request, config);
+  ASSERT_NE(custom_table1, nullptr);
+  EXPECT_EQ(table_manager.GetTable(request, config), custom_table1);
+
+  config.set_custom_roman_table("a\t[B]\n");
+  const Table *custom_table2 = table_manager.GetTable(request, config);
+  ASSERT_NE(custom_table2, nullptr);
+  EXPECT_NE(custom_table2, custom_table1);
+  EXPECT_EQ(table_manager.GetTable(request, config), custom_table2);
+
+  // The table without the custom roman table is not affected.
+  config.clear_custom_roman_table();
+  const Table *table = table_manager.GetTable(request, config);
+  ASSERT_NE(table, nullptr);
+  EXPECT_NE(table, custom_table2);
+  config.set_custom_roman_table("a\t[C]\n");
+  ASSERT_NE(table_manager.GetTable(request, config), nullptr);
+  config.clear_custom_roman_table();
+  EXPECT_EQ(table_manager.GetTable(request, config), table);
+}
+
 }  // namespace
 }  // namespace mozc::composer
@@ -0,0 +1,214 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "composer/typing_corrector.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/log/check.h"
+#include "absl/strings/string_view.h"
+#include "composer/composer.h"
+#include "composer/query.h"
+#include "composer/table.h"
+#include "composer/typing_model.h"
+#include "protocol/commands.pb.h"
+#include "protocol/config.pb.h"
+
+namespace mozc::composer {
+namespace {
+
+// Marks the boundaries of the keys in the typing model.
+constexpr char kBoundary = '^';
+
+// Costs are -500 * log(prob) while the scores of TypeCorrectedQuery are in
+// log10, so a cost difference is divided by 500 * log(10).
+constexpr float kCostPerLog10 = 1151.29;
+
+// The longest n-gram of TypingModel.
+constexpr size_t kMaxNgramSize = 4;
+
+}  // namespace
+
+TypingCorrector::TypingCorrector(const Table *table, const TypingModel *model,
+                                 const commands::Request *request,
+                                 const config::Config *config,
+                                 size_t beam_size, size_t max_queries)
+    : table_(table),
+      model_(model),
+      request_(request),
+      config_(config),
+      beam_size_(beam_size),
+      max_queries_(max_queries) {
+  DCHECK(table_);
+  DCHECK(model_);
+  DCHECK(request_);
+  DCHECK(config_);
+  DCHECK_GT(beam_size_, 0);
+  DCHECK_LE(model_->ngram_size(), kMaxNgramSize);
+  Reset();
+}
+
+void TypingCorrector::Reset() {
+  keys_.clear();
+  keys_cost_ = 0;
+  beam_.clear();
+  beam_.emplace_back();
+}
+
+void TypingCorrector::InsertCharacter(char key) {
+  keys_cost_ += GetTransitionCost(keys_, key);
+  keys_.push_back(key);
+
+  // Expansions of the hypotheses, which are copied to the next beam only if
+  // they survive.
+  struct Expansion {
+    size_t parent;
+    char key;
+    int cost;
+    int corrections;
+  };
+  std::vector<Expansion> expansions;
+  expansions.reserve(beam_.size() * (model_->characters().size() + 1));
+  for (size_t i = 0; i < beam_.size(); ++i) {
+    const Hypothesis &hypothesis = beam_[i];
+    expansions.push_back({i, key,
+                          hypothesis.cost + GetTransitionCost(hypothesis.keys,
+                                                              key),
+                          hypothesis.corrections});
+    if (!model_->HasKey(key) || hypothesis.corrections >= kMaxCorrections) {
+      continue;
+    }
+    for (const char c : model_->characters()) {
+      if (c == key || c == kBoundary) {
+        continue;
+      }
+      expansions.push_back(
+          {i, c,
+           hypothesis.cost + kCorrectionPenalty +
+               GetTransitionCost(hypothesis.keys, c),
+           hypothesis.corrections + 1});
+    }
+  }
+
+  const size_t size = std::min(beam_size_, expansions.size());
+  std::partial_sort(expansions.begin(), expansions.begin() + size,
+                    expansions.end(),
+                    [](const Expansion &lhs, const Expansion &rhs) {
+                      return lhs.cost < rhs.cost;
+                    });
+  next_beam_.resize(size);
+  for (size_t i = 0; i < size; ++i) {
+    const Expansion &expansion = expansions[i];
+    Hypothesis &hypothesis = next_beam_[i];
+    hypothesis.keys.assign(beam_[expansion.parent].keys);
+    hypothesis.keys.push_back(expansion.key);
+    hypothesis.cost = expansion.cost;
+    hypothesis.corrections = expansion.corrections;
+  }
+  std::swap(beam_, next_beam_);
+}
+
+void TypingCorrector::InsertCharacters(absl::string_view keys) {
+  for (const char key : keys) {
+    InsertCharacter(key);
+  }
+}
+
+std::vector<TypeCorrectedQuery> TypingCorrector::GetQueries() const {
+  std::vector<TypeCorrectedQuery> queries;
+  if (keys_.empty()) {
+    return queries;
+  }
+  const std::string typed_query = GetQuery(keys_);
+  for (const Hypothesis &hypothesis : beam_) {
+    if (queries.size() >= max_queries_) {
+      break;
+    }
+    // Corrections are worth looking up only if they are more probable than
+    // the typed keys even after paying the penalties.
+    if (hypothesis.cost >= keys_cost_) {
+      break;
+    }
+    if (hypothesis.corrections == 0) {
+      continue;
+    }
+    std::string query = GetQuery(hypothesis.keys);
+    if (query.empty() || query == typed_query ||
+        absl::c_any_of(queries, [&query](const TypeCorrectedQuery &q) {
+          return q.correction == query;
+        })) {
+      continue;
+    }
+    TypeCorrectedQuery &corrected = queries.emplace_back();
+    corrected.correction = std::move(query);
+    corrected.type = TypeCorrectedQuery::CORRECTION;
+    corrected.score = (keys_cost_ - hypothesis.cost) / kCostPerLog10;
+    corrected.bias = corrected.score;
+  }
+  return queries;
+}
+
+int TypingCorrector::GetTransitionCost(absl::string_view history,
+                                       char key) const {
+  // The last (n - 1) keys of the history, padded with kBoundary as in the
+  // typing models, e.g., "^^a" for the first key of trigram models.
+  char ngram[kMaxNgramSize];
+  size_t size = 0;
+  for (size_t i = model_->ngram_size() - 1; i > 0; --i) {
+    ngram[size++] =
+        (i > history.size()) ? kBoundary : history[history.size() - i];
+  }
+  ngram[size++] = key;
+
+  for (size_t begin = 0; begin < size; ++begin) {
+    const int cost =
+        model_->GetCost(absl::string_view(ngram + begin, size - begin));
+    if (cost != TypingModel::kInfinity) {
+      return cost;
+    }
+  }
+  // Unknown keys are never replaced, so their cost doesn't matter.
+  return 0;
+}
+
+std::string TypingCorrector::GetQuery(absl::string_view keys) const {
+  Composer composer(table_, request_, config_);
+  for (const char key : keys) {
+    composer.InsertCharacter(std::string(1, key));
+  }
+  return composer.GetQueryForPrediction();
+}
+
+}  // namespace mozc::composer
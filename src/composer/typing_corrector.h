@@ -0,0 +1,112 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef MOZC_COMPOSER_TYPING_CORRECTOR_H_
+#define MOZC_COMPOSER_TYPING_CORRECTOR_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "composer/query.h"
+#include "composer/table.h"
+#include "composer/typing_model.h"
+#include "protocol/commands.pb.h"
+#include "protocol/config.pb.h"
+
+namespace mozc::composer {
+
+// Generates typing corrected queries from the typed keys by a beam search
+// over the keys of a TypingModel.  Each typed key can be replaced with
+// another key of the model at kCorrectionPenalty, and the key sequences are
+// scored by the n-gram costs of the model.  The queries are the compositions
+// of the best key sequences, so no supplemental model is needed.
+//
+// Keys are inserted one by one as they are typed, and each insertion costs
+// O(beam_size * number of keys of the model) n-gram lookups.
+class TypingCorrector {
+ public:
+  // Cost of replacing a typed key, about -500 * log(1 / 50).
+  static constexpr int kCorrectionPenalty = 2000;
+  // Maximum number of replaced keys in a query.
+  static constexpr int kMaxCorrections = 2;
+
+  // All the pointers must outlive the corrector.
+  TypingCorrector(const Table *table, const TypingModel *model,
+                  const commands::Request *request,
+                  const config::Config *config, size_t beam_size,
+                  size_t max_queries);
+
+  TypingCorrector(const TypingCorrector &) = delete;
+  TypingCorrector &operator=(const TypingCorrector &) = delete;
+
+  void Reset();
+
+  // Appends a typed key.  Keys unknown to the model are never replaced.
+  void InsertCharacter(char key);
+  void InsertCharacters(absl::string_view keys);
+
+  // Returns the corrected queries which are more probable than the typed keys,
+  // better ones first.  The score and the bias are log10 probability ratios to
+  // the typed keys, so they are always positive.
+  std::vector<TypeCorrectedQuery> GetQueries() const;
+
+  const std::string &keys() const { return keys_; }
+
+ private:
+  struct Hypothesis {
+    std::string keys;
+    int cost = 0;
+    int corrections = 0;
+  };
+
+  // Returns the cost of |key| following |history|, backing off to shorter
+  // contexts for unseen n-grams.
+  int GetTransitionCost(absl::string_view history, char key) const;
+  std::string GetQuery(absl::string_view keys) const;
+
+  const Table *table_;
+  const TypingModel *model_;
+  const commands::Request *request_;
+  const config::Config *config_;
+  const size_t beam_size_;
+  const size_t max_queries_;
+
+  std::string keys_;
+  int keys_cost_ = 0;
+  // Sorted by cost.
+  std::vector<Hypothesis> beam_;
+  std::vector<Hypothesis> next_beam_;
+};
+
+}  // namespace mozc::composer
+
+#endif  // MOZC_COMPOSER_TYPING_CORRECTOR_H_
@@ -0,0 +1,134 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// Measures the latency of TypingCorrector per keystroke with the typing model
+// in the OSS data set.
+//
+// Usage:
+//   typing_corrector_benchmark_main --keys=watashinonamaeha --iterations=1000
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/log/check.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "base/init_mozc.h"
+#include "base/stopwatch.h"
+#include "composer/query.h"
+#include "composer/table.h"
+#include "composer/typing_corrector.h"
+#include "composer/typing_model.h"
+#include "data_manager/oss/oss_data_manager.h"
+#include "protocol/commands.pb.h"
+#include "protocol/config.pb.h"
+
+ABSL_FLAG(std::string, keys, "watashinonamaehanakanodesu",
+          "the keys to be typed");
+ABSL_FLAG(std::string, table, "QWERTY_MOBILE_TO_HIRAGANA",
+          "the special romanji table of the request");
+ABSL_FLAG(int32_t, beam_size, 16, "the beam size of the corrector");
+ABSL_FLAG(int32_t, iterations, 1000, "the number of iterations");
+
+namespace mozc {
+namespace {
+
+void Report(absl::string_view name, absl::Duration elapsed, int count) {
+  std::cout << name << ": " << elapsed / count << " per keystroke ("
+            << elapsed << " in total)" << std::endl;
+}
+
+void Run() {
+  const std::string keys = absl::GetFlag(FLAGS_keys);
+  const int iterations = absl::GetFlag(FLAGS_iterations);
+  CHECK(!keys.empty());
+  CHECK_GT(iterations, 0);
+
+  commands::Request::SpecialRomanjiTable special_romanji_table;
+  CHECK(commands::Request::SpecialRomanjiTable_Parse(
+      absl::GetFlag(FLAGS_table), &special_romanji_table))
+      << "Unknown table: " << absl::GetFlag(FLAGS_table);
+  commands::Request request;
+  request.set_special_romanji_table(special_romanji_table);
+  const config::Config config;
+  composer::Table table;
+  CHECK(table.InitializeWithRequestAndConfig(request, config));
+
+  const oss::OssDataManager data_manager;
+  const absl::string_view section =
+      composer::TypingModel::GetSectionName(special_romanji_table);
+  CHECK(!section.empty()) << "No typing model for "
+                          << absl::GetFlag(FLAGS_table);
+  const std::unique_ptr<const composer::TypingModel> model =
+      composer::TypingModel::Create(data_manager.GetTypingModelData(section));
+  CHECK(model) << "Typing model is missing or broken: " << section;
+
+  composer::TypingCorrector corrector(&table, model.get(), &request, &config,
+                                      absl::GetFlag(FLAGS_beam_size),
+                                      /* max_queries= */ 5);
+  Stopwatch insert_stopwatch;
+  Stopwatch queries_stopwatch;
+  std::vector<composer::TypeCorrectedQuery> queries;
+  for (int i = 0; i < iterations; ++i) {
+    corrector.Reset();
+    for (const char key : keys) {
+      insert_stopwatch.Start();
+      corrector.InsertCharacter(key);
+      insert_stopwatch.Stop();
+      queries_stopwatch.Start();
+      queries = corrector.GetQueries();
+      queries_stopwatch.Stop();
+    }
+  }
+  const int keystrokes = iterations * keys.size();
+  Report("InsertCharacter", insert_stopwatch.GetElapsed(), keystrokes);
+  Report("GetQueries", queries_stopwatch.GetElapsed(), keystrokes);
+  Report("Total",
+         insert_stopwatch.GetElapsed() + queries_stopwatch.GetElapsed(),
+         keystrokes);
+
+  for (const composer::TypeCorrectedQuery &query : queries) {
+    std::cout << query.correction << "\t" << query.score << std::endl;
+  }
+}
+
+}  // namespace
+}  // namespace mozc
+
+int main(int argc, char **argv) {
+  mozc::InitMozc(argv[0], &argc, &argv);
+  mozc::Run();
+  return 0;
+}
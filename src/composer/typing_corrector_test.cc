@@ -0,0 +1,151 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "composer/typing_corrector.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "composer/query.h"
+#include "composer/table.h"
+#include "composer/typing_model.h"
+#include "protocol/commands.pb.h"
+#include "protocol/config.pb.h"
+#include "testing/gunit.h"
+
+namespace mozc::composer {
+namespace {
+
+constexpr absl::string_view kCharacters = "^aks";
+
+// Builds a bigram model of kCharacters, where "ks" is much less probable than
+// "ka".
+std::string BuildData() {
+  const std::vector<std::pair<std::string, int>> costs = {
+      {"a", 500},   {"k", 500},  {"s", 3000}, {"^a", 500},
+      {"^k", 100},  {"^s", 3000}, {"ka", 100}, {"ks", 5000},
+  };
+  const size_t radix = kCharacters.size() + 1;
+  std::vector<int32_t> mapping_table(256, 0);
+  std::string cost_table(radix * radix, TypingModel::kNoEntry);
+  for (size_t i = 0; i < costs.size(); ++i) {
+    const auto &[key, cost] = costs[i];
+    mapping_table[i] = cost;
+    size_t index = 0;
+    for (auto it = key.rbegin(); it != key.rend(); ++it) {
+      index = index * radix + kCharacters.find(*it) + 1;
+    }
+    cost_table[index] = static_cast<char>(i);
+  }
+
+  std::string data;
+  for (const uint32_t value :
+       {static_cast<uint32_t>(kCharacters.size()), uint32_t{2}}) {
+    data.append(reinterpret_cast<const char *>(&value), sizeof(value));
+  }
+  data.append(reinterpret_cast<const char *>(mapping_table.data()),
+              mapping_table.size() * sizeof(int32_t));
+  data.append(kCharacters);
+  data.append(cost_table);
+  return data;
+}
+
+class TypingCorrectorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    table_.AddRule("a", "あ", "");
+    table_.AddRule("ka", "か", "");
+    table_.AddRule("sa", "さ", "");
+    data_ = BuildData();
+    model_ = TypingModel::Create(data_);
+    ASSERT_NE(model_, nullptr);
+  }
+
+  TypingCorrector CreateCorrector() const {
+    return TypingCorrector(&table_, model_.get(), &request_, &config_,
+                           /* beam_size= */ 16, /* max_queries= */ 5);
+  }
+
+  Table table_;
+  const commands::Request request_;
+  const config::Config config_;
+  std::string data_;
+  std::unique_ptr<const TypingModel> model_;
+};
+
+TEST_F(TypingCorrectorTest, CorrectTypo) {
+  TypingCorrector corrector = CreateCorrector();
+  corrector.InsertCharacters("ks");
+  EXPECT_EQ(corrector.keys(), "ks");
+
+  const std::vector<TypeCorrectedQuery> queries = corrector.GetQueries();
+  ASSERT_FALSE(queries.empty());
+  EXPECT_EQ(queries[0].correction, "か");
+  EXPECT_EQ(queries[0].type, TypeCorrectedQuery::CORRECTION);
+  EXPECT_GT(queries[0].score, 0.0);
+  EXPECT_EQ(queries[0].bias, queries[0].score);
+  for (size_t i = 1; i < queries.size(); ++i) {
+    EXPECT_LE(queries[i].score, queries[i - 1].score);
+    EXPECT_NE(queries[i].correction, "か");
+  }
+}
+
+TEST_F(TypingCorrectorTest, NoCorrectionForProbableKeys) {
+  TypingCorrector corrector = CreateCorrector();
+  corrector.InsertCharacters("ka");
+  EXPECT_TRUE(corrector.GetQueries().empty());
+}
+
+TEST_F(TypingCorrectorTest, UnknownKeys) {
+  TypingCorrector corrector = CreateCorrector();
+  corrector.InsertCharacters("xx");
+  EXPECT_TRUE(corrector.GetQueries().empty());
+}
+
+TEST_F(TypingCorrectorTest, Reset) {
+  TypingCorrector corrector = CreateCorrector();
+  EXPECT_TRUE(corrector.GetQueries().empty());
+  corrector.InsertCharacters("ks");
+  EXPECT_FALSE(corrector.GetQueries().empty());
+
+  corrector.Reset();
+  EXPECT_EQ(corrector.keys(), "");
+  EXPECT_TRUE(corrector.GetQueries().empty());
+  corrector.InsertCharacters("ka");
+  EXPECT_TRUE(corrector.GetQueries().empty());
+}
+
+}  // namespace
+}  // namespace mozc::composer
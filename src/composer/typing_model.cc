@@ -0,0 +1,148 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "composer/typing_model.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "absl/log/log.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "base/bits.h"
+#include "protocol/commands.pb.h"
+
+namespace mozc::composer {
+namespace {
+
+constexpr size_t kMappingTableSize = 256;
+constexpr size_t kHeaderSize =
+    2 * sizeof(uint32_t) + kMappingTableSize * sizeof(int32_t);
+
+}  // namespace
+
+std::unique_ptr<const TypingModel> TypingModel::Create(absl::string_view data) {
+  if (data.size() < kHeaderSize) {
+    LOG(ERROR) << "Typing model is too short: " << data.size();
+    return nullptr;
+  }
+  const char *header = data.data();
+  const size_t characters_size =
+      LittleToHost(LoadUnalignedAdvance<uint32_t>(header));
+  const size_t ngram_size =
+      LittleToHost(LoadUnalignedAdvance<uint32_t>(header));
+  // The cost table index of the longest n-gram must fit in size_t.
+  if (characters_size == 0 || characters_size > 255 || ngram_size == 0 ||
+      ngram_size > 4) {
+    LOG(ERROR) << "Invalid typing model header: " << characters_size << ", "
+               << ngram_size;
+    return nullptr;
+  }
+  const size_t padded_characters_size = (characters_size + 3) / 4 * 4;
+  size_t cost_table_size = 1;
+  for (size_t i = 0; i < ngram_size; ++i) {
+    cost_table_size *= characters_size + 1;
+  }
+  if (data.size() != kHeaderSize + padded_characters_size + cost_table_size) {
+    LOG(ERROR) << "Typing model size mismatch: " << data.size();
+    return nullptr;
+  }
+
+  const absl::Span<const int32_t> mapping_table(
+      reinterpret_cast<const int32_t *>(data.data() + 2 * sizeof(uint32_t)),
+      kMappingTableSize);
+  const absl::string_view characters =
+      data.substr(kHeaderSize, characters_size);
+  const absl::Span<const uint8_t> cost_table(
+      reinterpret_cast<const uint8_t *>(data.data() + kHeaderSize +
+                                        padded_characters_size),
+      cost_table_size);
+  for (size_t i = 1; i < characters.size(); ++i) {
+    if (characters[i - 1] >= characters[i]) {
+      LOG(ERROR) << "Typing model characters are not sorted";
+      return nullptr;
+    }
+  }
+  return std::unique_ptr<const TypingModel>(
+      new TypingModel(characters, ngram_size, mapping_table, cost_table));
+}
+
+absl::string_view TypingModel::GetSectionName(
+    commands::Request::SpecialRomanjiTable special_romanji_table) {
+  switch (special_romanji_table) {
+    case commands::Request::TWELVE_KEYS_TO_HIRAGANA:
+      return kSectionNames[0];
+    case commands::Request::FLICK_TO_HIRAGANA:
+      return kSectionNames[1];
+    case commands::Request::TOGGLE_FLICK_TO_HIRAGANA:
+      return kSectionNames[2];
+    case commands::Request::GODAN_TO_HIRAGANA:
+      return kSectionNames[3];
+    case commands::Request::QWERTY_MOBILE_TO_HIRAGANA:
+      return kSectionNames[4];
+    default:
+      return "";
+  }
+}
+
+TypingModel::TypingModel(absl::string_view characters, size_t ngram_size,
+                         absl::Span<const int32_t> mapping_table,
+                         absl::Span<const uint8_t> cost_table)
+    : characters_(characters),
+      ngram_size_(ngram_size),
+      mapping_table_(mapping_table),
+      cost_table_(cost_table) {
+  for (size_t i = 0; i < characters_.size(); ++i) {
+    digits_[static_cast<uint8_t>(characters_[i])] = i + 1;
+  }
+}
+
+int TypingModel::GetCost(absl::string_view key) const {
+  if (key.empty() || key.size() > ngram_size_) {
+    return kInfinity;
+  }
+  const size_t radix = characters_.size() + 1;
+  size_t index = 0;
+  for (size_t i = key.size(); i > 0; --i) {
+    const uint8_t digit = digits_[static_cast<uint8_t>(key[i - 1])];
+    if (digit == 0) {
+      return kInfinity;
+    }
+    index = index * radix + digit;
+  }
+  const uint8_t cost_index = cost_table_[index];
+  if (cost_index == kNoEntry) {
+    return kInfinity;
+  }
+  return mapping_table_[cost_index];
+}
+
+}  // namespace mozc::composer
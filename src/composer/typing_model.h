@@ -0,0 +1,111 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef MOZC_COMPOSER_TYPING_MODEL_H_
+#define MOZC_COMPOSER_TYPING_MODEL_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "protocol/commands.pb.h"
+
+namespace mozc::composer {
+
+// N-gram costs of key sequences typed on a keyboard layout, compiled from
+// data/typing/typing_model_*.tsv by gen_typing_model.py.  The compiled data
+// is used in place, e.g., from the memory mapped data set, and is laid out
+// in little endian as follows:
+//
+//   uint32_t characters_size;  // n
+//   uint32_t ngram_size;       // k
+//   int32_t mapping_table[256];
+//   char characters[n];        // Sorted ASCII keys, zero padded to 4 bytes.
+//   uint8_t cost_table[(n + 1)^k];
+//
+// The key sequence c_0 c_1 ... c_{m-1} (m <= k) is stored at
+// sum_i (1 + index of c_i in characters) * (n + 1)^i of cost_table, whose
+// value is an index of mapping_table, or kNoEntry.
+class TypingModel {
+ public:
+  static constexpr int kInfinity = (1 << 24);
+  static constexpr uint8_t kNoEntry = 255;
+
+  // Data set sections of the models.
+  static constexpr absl::string_view kSectionNames[] = {
+      "typing_model_12keys-hiragana",
+      "typing_model_flick-hiragana",
+      "typing_model_toggle_flick-hiragana",
+      "typing_model_godan-hiragana",
+      "typing_model_qwerty_mobile-hiragana",
+  };
+
+  // Returns nullptr if |data| is broken.  |data| must outlive the model.
+  static std::unique_ptr<const TypingModel> Create(absl::string_view data);
+
+  // Returns the name of the data set section for |special_romanji_table|, or
+  // an empty string if there is no model for the table.
+  static absl::string_view GetSectionName(
+      commands::Request::SpecialRomanjiTable special_romanji_table);
+
+  TypingModel(const TypingModel &) = delete;
+  TypingModel &operator=(const TypingModel &) = delete;
+
+  // Returns the cost of |key|, or kInfinity if |key| has no entry.
+  int GetCost(absl::string_view key) const;
+
+  // Returns true if |c| is a key of the model.
+  bool HasKey(char c) const {
+    return digits_[static_cast<uint8_t>(c)] != 0;
+  }
+
+  // The keys of the model in ascending order.
+  absl::string_view characters() const { return characters_; }
+  size_t ngram_size() const { return ngram_size_; }
+
+ private:
+  TypingModel(absl::string_view characters, size_t ngram_size,
+              absl::Span<const int32_t> mapping_table,
+              absl::Span<const uint8_t> cost_table);
+
+  const absl::string_view characters_;
+  const size_t ngram_size_;
+  const absl::Span<const int32_t> mapping_table_;
+  const absl::Span<const uint8_t> cost_table_;
+  // Digit of each byte in the cost table index, or 0 for non-keys.
+  std::array<uint8_t, 256> digits_ = {};
+};
+
+}  // namespace mozc::composer
+
+#endif  // MOZC_COMPOSER_TYPING_MODEL_H_
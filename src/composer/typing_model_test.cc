@@ -0,0 +1,158 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "composer/typing_model.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "data_manager/testing/mock_data_manager.h"
+#include "protocol/commands.pb.h"
+#include "testing/gunit.h"
+
+namespace mozc::composer {
+namespace {
+
+using ::mozc::commands::Request;
+
+void AppendUint32(uint32_t value, std::string *data) {
+  for (int i = 0; i < 4; ++i) {
+    data->push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+  }
+}
+
+// Builds the data laid out as gen_typing_model.py does.  The costs are stored
+// in the mapping table as they are.
+std::string BuildData(absl::string_view characters, size_t ngram_size,
+                      const std::vector<std::pair<std::string, int>> &costs) {
+  const size_t radix = characters.size() + 1;
+  size_t cost_table_size = 1;
+  for (size_t i = 0; i < ngram_size; ++i) {
+    cost_table_size *= radix;
+  }
+  std::vector<int32_t> mapping_table(256, 0);
+  std::string cost_table(cost_table_size, TypingModel::kNoEntry);
+  for (size_t i = 0; i < costs.size(); ++i) {
+    const auto &[key, cost] = costs[i];
+    mapping_table[i] = cost;
+    size_t index = 0;
+    for (auto it = key.rbegin(); it != key.rend(); ++it) {
+      index = index * radix + characters.find(*it) + 1;
+    }
+    cost_table[index] = static_cast<char>(i);
+  }
+
+  std::string data;
+  AppendUint32(characters.size(), &data);
+  AppendUint32(ngram_size, &data);
+  for (const int32_t cost : mapping_table) {
+    AppendUint32(cost, &data);
+  }
+  data.append(characters);
+  data.append((4 - characters.size() % 4) % 4, '\0');
+  data.append(cost_table);
+  return data;
+}
+
+TEST(TypingModelTest, GetCost) {
+  const std::string data =
+      BuildData("^abc", 3, {{"a", 100}, {"b", 200}, {"^a", 50}, {"ab", 30},
+                            {"^ab", 10}});
+  std::unique_ptr<const TypingModel> model = TypingModel::Create(data);
+  ASSERT_NE(model, nullptr);
+  EXPECT_EQ(model->characters(), "^abc");
+  EXPECT_EQ(model->ngram_size(), 3);
+
+  EXPECT_EQ(model->GetCost("a"), 100);
+  EXPECT_EQ(model->GetCost("b"), 200);
+  EXPECT_EQ(model->GetCost("^a"), 50);
+  EXPECT_EQ(model->GetCost("ab"), 30);
+  EXPECT_EQ(model->GetCost("^ab"), 10);
+
+  EXPECT_EQ(model->GetCost(""), TypingModel::kInfinity);
+  EXPECT_EQ(model->GetCost("c"), TypingModel::kInfinity);
+  EXPECT_EQ(model->GetCost("ba"), TypingModel::kInfinity);
+  EXPECT_EQ(model->GetCost("x"), TypingModel::kInfinity);
+  EXPECT_EQ(model->GetCost("ax"), TypingModel::kInfinity);
+  EXPECT_EQ(model->GetCost("^aba"), TypingModel::kInfinity);
+
+  EXPECT_TRUE(model->HasKey('a'));
+  EXPECT_TRUE(model->HasKey('c'));
+  EXPECT_FALSE(model->HasKey('x'));
+  EXPECT_FALSE(model->HasKey('\0'));
+}
+
+TEST(TypingModelTest, BrokenData) {
+  const std::string data = BuildData("abc", 2, {{"a", 100}});
+  ASSERT_NE(TypingModel::Create(data), nullptr);
+
+  EXPECT_EQ(TypingModel::Create(""), nullptr);
+  EXPECT_EQ(TypingModel::Create(absl::string_view(data).substr(1)), nullptr);
+  EXPECT_EQ(TypingModel::Create(data + "x"), nullptr);
+  EXPECT_EQ(TypingModel::Create(BuildData("", 2, {})), nullptr);
+  EXPECT_EQ(TypingModel::Create(BuildData("abc", 0, {})), nullptr);
+  EXPECT_EQ(TypingModel::Create(BuildData("abc", 5, {})), nullptr);
+  EXPECT_EQ(TypingModel::Create(BuildData("acb", 2, {})), nullptr);
+  EXPECT_EQ(TypingModel::Create(BuildData("aab", 2, {})), nullptr);
+}
+
+TEST(TypingModelTest, GetSectionName) {
+  EXPECT_EQ(TypingModel::GetSectionName(Request::TWELVE_KEYS_TO_HIRAGANA),
+            "typing_model_12keys-hiragana");
+  EXPECT_EQ(TypingModel::GetSectionName(Request::FLICK_TO_HIRAGANA),
+            "typing_model_flick-hiragana");
+  EXPECT_EQ(TypingModel::GetSectionName(Request::TOGGLE_FLICK_TO_HIRAGANA),
+            "typing_model_toggle_flick-hiragana");
+  EXPECT_EQ(TypingModel::GetSectionName(Request::GODAN_TO_HIRAGANA),
+            "typing_model_godan-hiragana");
+  EXPECT_EQ(TypingModel::GetSectionName(Request::QWERTY_MOBILE_TO_HIRAGANA),
+            "typing_model_qwerty_mobile-hiragana");
+  EXPECT_EQ(TypingModel::GetSectionName(Request::DEFAULT_TABLE), "");
+}
+
+TEST(TypingModelTest, DataSet) {
+  const testing::MockDataManager data_manager;
+  for (const absl::string_view name : TypingModel::kSectionNames) {
+    SCOPED_TRACE(name);
+    std::unique_ptr<const TypingModel> model =
+        TypingModel::Create(data_manager.GetTypingModelData(name));
+    ASSERT_NE(model, nullptr);
+    EXPECT_NE(model->GetCost(model->characters().substr(0, 1)),
+              TypingModel::kInfinity);
+  }
+}
+
+}  // namespace
+}  // namespace mozc::composer
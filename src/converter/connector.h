@@ -30,8 +30,10 @@
 #ifndef MOZC_CONVERTER_CONNECTOR_H_
 #define MOZC_CONVERTER_CONNECTOR_H_
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <vector>
 
@@ -53,6 +55,9 @@ class Connector final {
                                           size_t connection_size,
                                           int cache_size);
 
+  // Thread-safe: the cost cache is updated with relaxed atomic stores, so the
+  // same instance can be queried concurrently, e.g., by the per-segment
+  // N-best searches in ImmutableConverter.
   int GetTransitionCost(uint16_t rid, uint16_t lid) const;
   int GetResolution() const { return resolution_; }
 
@@ -70,8 +75,10 @@ class Connector final {
   const uint16_t *default_cost_ = nullptr;
   int resolution_ = 0;
   uint32_t cache_hash_mask_ = 0;
-  mutable std::vector<uint32_t> cache_key_;
-  mutable std::vector<int> cache_value_;
+  // Each entry packs the encoded (rid, lid) key into the upper 32 bits and
+  // the cost into the lower 32 bits so that a key and its value are always
+  // read and written together.
+  std::unique_ptr<std::atomic<uint64_t>[]> cache_;
 };
 
 class Connector::Row final {
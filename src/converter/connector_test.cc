@@ -39,6 +39,7 @@
 #include "absl/random/random.h"
 #include "absl/status/statusor.h"
 #include "base/mmap.h"
+#include "base/thread.h"
 #include "base/vlog.h"
 #include "data_manager/connection_file_reader.h"
 #include "testing/gmock.h"
@@ -93,6 +94,48 @@ TEST(ConnectorTest, CompareWithRawData) {
   }
 }
 
+TEST(ConnectorTest, ConcurrentLookup) {
+  const std::string path = testing::GetSourceFileOrDie(
+      {MOZC_SRC_COMPONENTS("data_manager"), "testing", "connection.data"});
+  absl::StatusOr<Mmap> cmmap = Mmap::Map(path);
+  ASSERT_OK(cmmap) << cmmap.status();
+  // Use a small cache so that the threads keep evicting each other's entries.
+  auto status_or_connector =
+      Connector::Create(cmmap->begin(), cmmap->size(), 16);
+  ASSERT_OK(status_or_connector);
+  const Connector connector = std::move(status_or_connector).value();
+
+  const std::string connection_text_path = testing::GetSourceFileOrDie(
+      {MOZC_DICT_DIR_COMPONENTS, "test", "dictionary",
+       "connection_single_column.txt"});
+  std::vector<ConnectionDataEntry> data;
+  for (ConnectionFileReader reader(connection_text_path); !reader.done();
+       reader.Next()) {
+    data.push_back(
+        {reader.rid_of_left_node(), reader.lid_of_right_node(), reader.cost()});
+  }
+
+  constexpr int kNumThreads = 4;
+  std::vector<int> num_errors(kNumThreads, 0);
+  std::vector<BackgroundFuture<void>> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&, t] {
+      // Each thread scans the entries from a different offset.
+      for (size_t i = 0; i < data.size(); ++i) {
+        const ConnectionDataEntry &entry =
+            data[(i + t * data.size() / kNumThreads) % data.size()];
+        if (connector.GetTransitionCost(entry.rid, entry.lid) != entry.cost) {
+          ++num_errors[t];
+        }
+      }
+    });
+  }
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads[t].Wait();
+    EXPECT_EQ(num_errors[t], 0);
+  }
+}
+
 TEST(ConnectorTest, BrokenData) {
   const std::string path = testing::GetSourceFileOrDie(
       {MOZC_SRC_COMPONENTS("data_manager"), "testing", "connection.data"});
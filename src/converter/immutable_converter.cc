@@ -43,15 +43,18 @@
 #include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/flags/flag.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "base/container/trie.h"
 #include "base/japanese_util.h"
 #include "base/strings/unicode.h"
+#include "base/thread.h"
 #include "base/util.h"
 #include "base/vlog.h"
 #include "converter/connector.h"
@@ -72,6 +75,13 @@
 #include "protocol/config.pb.h"
 #include "request/conversion_request.h"
 
+// Spawning the threads costs about as much as searching a few segments, and
+// no measurement has shown a win on the interactive path yet, so the searches
+// run on the calling thread by default.
+ABSL_FLAG(int32_t, nbest_search_threads, 1,
+          "The maximum number of threads searching the segments of a "
+          "MULTI_SEGMENTS conversion. 1 searches them sequentially.");
+
 namespace mozc {
 namespace {
 
@@ -86,6 +96,13 @@ constexpr int kMaxCost = 32767;
 constexpr int kMinCost = -32767;
 constexpr int kDefaultNumberCost = 3000;
 
+// When --nbest_search_threads opts in, the per-segment N-best searches run on
+// up to kMaxNBestWorkers threads if at least kMinExpandSizeForParallelNBest
+// candidates are requested. Smaller searches are cheaper than spawning the
+// threads.
+constexpr size_t kMaxNBestWorkers = 4;
+constexpr size_t kMinExpandSizeForParallelNBest = 16;
+
 bool IsMobileRequest(const ConversionRequest &request) {
   return request.request().mixed_conversion();
 }
@@ -109,7 +126,7 @@ class KeyCorrectedNodeListBuilder : public BaseNodeListBuilder {
       return TRAVERSE_NEXT_KEY;
     }
     Node *node = NewNodeFromToken(token);
-    node->key.assign(original_lookup_key_.data() + pos_, offset);
+    node->key = original_lookup_key_.substr(pos_, offset);
     node->wcost += KeyCorrector::GetCorrectedCostPenalty(node->key);
 
     // Push back |node| to the end.
@@ -132,7 +149,8 @@ class KeyCorrectedNodeListBuilder : public BaseNodeListBuilder {
   Node *tail_;
 };
 
-void InsertCorrectedNodes(size_t pos, const std::string &key,
+// |key| should be Lattice::arena_key() as the nodes refer to its substrings.
+void InsertCorrectedNodes(size_t pos, absl::string_view key,
                           const ConversionRequest &request,
                           const KeyCorrector *key_corrector,
                           const DictionaryInterface *dictionary,
@@ -172,8 +190,9 @@ bool ContainsWhiteSpacesOnly(const absl::string_view s) {
   return true;
 }
 
-void DecomposeNumberAndSuffix(const std::string &input, std::string *number,
-                              std::string *suffix) {
+void DecomposeNumberAndSuffix(absl::string_view input,
+                              absl::string_view *number,
+                              absl::string_view *suffix) {
   const char *begin = input.data();
   const char *end = input.data() + input.size();
   size_t pos = 0;
@@ -185,12 +204,13 @@ void DecomposeNumberAndSuffix(const std::string &input, std::string *number,
     }
     break;
   }
-  number->assign(input, 0, pos);
-  suffix->assign(input, pos, input.size() - pos);
+  *number = input.substr(0, pos);
+  *suffix = input.substr(pos);
 }
 
-void DecomposePrefixAndNumber(const std::string &input, std::string *prefix,
-                              std::string *number) {
+void DecomposePrefixAndNumber(absl::string_view input,
+                              absl::string_view *prefix,
+                              absl::string_view *number) {
   const char *begin = input.data();
   const char *end = input.data() + input.size() - 1;
   size_t pos = input.size();
@@ -202,8 +222,8 @@ void DecomposePrefixAndNumber(const std::string &input, std::string *prefix,
     }
     break;
   }
-  prefix->assign(input, 0, pos);
-  number->assign(input, pos, input.size() - pos);
+  *prefix = input.substr(0, pos);
+  *number = input.substr(pos);
 }
 
 void NormalizeHistorySegments(Segments *segments) {
@@ -349,8 +369,68 @@ class FirstInnerSegmentCandidateChecker {
   Trie<bool> trie_;
 };
 
+// Best (cost, Node) for each POS id, i.e. for lnode's rid or rnode's lid.
+// The table is indexed directly by the id, and each entry is stamped with the
+// generation in which it was set, so that Clear() is O(1) at each position
+// instead of resetting the whole table.
+class BestTable {
+ public:
+  struct Entry {
+    uint32_t generation = 0;
+    int cost = INT_MAX;
+    Node *node = nullptr;
+  };
+
+  // Invalidates all the entries.
+  void Clear() {
+    if (++generation_ == 0) {
+      // The generation wrapped around. Reset the stamps so that the entries
+      // set in the past generations are not taken as valid.
+      entries_.assign(entries_.size(), Entry());
+      generation_ = 1;
+    }
+    ids_.clear();
+  }
+
+  // Returns the entry for |id| if it's set after the last Clear().
+  Entry *Find(uint16_t id) {
+    if (id >= entries_.size() || entries_[id].generation != generation_) {
+      return nullptr;
+    }
+    return &entries_[id];
+  }
+
+  // Sets the entry for |id|. It must not be set after the last Clear().
+  Entry *Insert(uint16_t id, int cost, Node *node) {
+    if (id >= entries_.size()) {
+      entries_.resize(id + 1);
+    }
+    DCHECK_NE(entries_[id].generation, generation_);
+    entries_[id] = {generation_, cost, node};
+    ids_.push_back(id);
+    return &entries_[id];
+  }
+
+  // Returns the ids set after the last Clear() in the insertion order.
+  std::vector<uint16_t> &ids() { return ids_; }
+
+ private:
+  std::vector<Entry> entries_;
+  std::vector<uint16_t> ids_;
+  uint32_t generation_ = 1;
+};
+
 }  // namespace
 
+struct ImmutableConverter::PredictionViterbiTables {
+  // lbest: the best lnode for each rid. rbest: the best lnode for each lid of
+  // rnodes.
+  BestTable lbest, rbest;
+  // The costs of lbest in the ascending order of rid, and the buffer for the
+  // costs of the transitions from them.
+  std::vector<int> lcosts, costs;
+};
+
 ImmutableConverter::ImmutableConverter(const engine::Modules &modules)
     : dictionary_(modules.GetDictionary()),
       suffix_dictionary_(modules.GetSuffixDictionary()),
@@ -365,7 +445,9 @@ ImmutableConverter::ImmutableConverter(const engine::Modules &modules)
       number_id_(pos_matcher_->GetNumberId()),
       unknown_id_(pos_matcher_->GetUnknownId()),
       last_to_first_name_transition_cost_(
-          connector_.GetTransitionCost(last_name_id_, first_name_id_)) {
+          connector_.GetTransitionCost(last_name_id_, first_name_id_)),
+      max_nbest_workers_(std::clamp<int32_t>(
+          absl::GetFlag(FLAGS_nbest_search_threads), 1, kMaxNBestWorkers)) {
   DCHECK(dictionary_);
   DCHECK(suffix_dictionary_);
   DCHECK(suppression_dictionary_);
@@ -374,6 +456,8 @@ ImmutableConverter::ImmutableConverter(const engine::Modules &modules)
   DCHECK(pos_group_);
 }
 
+ImmutableConverter::~ImmutableConverter() = default;
+
 void ImmutableConverter::InsertDummyCandidates(Segment *segment,
                                                size_t expand_size) const {
   const Segment::Candidate *top_candidate =
@@ -507,8 +591,9 @@ bool ImmutableConverter::ResegmentArabicNumberAndSuffix(
         pos_matcher_->IsNumber(compound_node->lid) &&
         !pos_matcher_->IsNumber(compound_node->rid) &&
         IsNumber(compound_node->value[0]) && IsNumber(compound_node->key[0])) {
-      std::string number_value, number_key;
-      std::string suffix_value, suffix_key;
+      // The decomposed parts refer to the strings of |compound_node|.
+      absl::string_view number_value, number_key;
+      absl::string_view suffix_value, suffix_key;
       DecomposeNumberAndSuffix(compound_node->value, &number_value,
                                &suffix_value);
       DecomposeNumberAndSuffix(compound_node->key, &number_key, &suffix_key);
@@ -583,8 +668,9 @@ bool ImmutableConverter::ResegmentPrefixAndArabicNumber(
         !IsNumber(compound_node->key[0]) &&
         IsNumber(compound_node->value[compound_node->value.size() - 1]) &&
         IsNumber(compound_node->key[compound_node->key.size() - 1])) {
-      std::string number_value, number_key;
-      std::string prefix_value, prefix_key;
+      // The decomposed parts refer to the strings of |compound_node|.
+      absl::string_view number_value, number_key;
+      absl::string_view prefix_value, prefix_key;
       DecomposePrefixAndNumber(compound_node->value, &prefix_value,
                                &number_value);
       DecomposePrefixAndNumber(compound_node->key, &prefix_key, &number_key);
@@ -694,7 +780,7 @@ bool ImmutableConverter::ResegmentPersonalName(size_t pos,
              rnode != nullptr; rnode = rnode->bnext) {
           if ((lnode->value.size() + rnode->value.size()) ==
                   compound_node->value.size() &&
-              (lnode->value + rnode->value) == compound_node->value &&
+              absl::EndsWith(compound_node->value, rnode->value) &&
               segmenter_->IsBoundary(*lnode, *rnode, false)) {  // Constraint 3.
             const int32_t cost = lnode->wcost + GetCost(lnode, rnode);
             if (cost < best_cost) {  // choose the smallest ones
@@ -801,9 +887,11 @@ Node *ImmutableConverter::Lookup(const int begin_pos,
                                  const ConversionRequest &request,
                                  bool is_reverse, bool is_prediction,
                                  Lattice *lattice) const {
-  const std::string &key = lattice->key();
+  // Look up the arena copy of the key so that the character type based nodes
+  // can refer to it.
+  const absl::string_view key = lattice->arena_key();
   CHECK_LT(begin_pos, key.size());
-  const absl::string_view key_substr = absl::string_view{key}.substr(begin_pos);
+  const absl::string_view key_substr = key.substr(begin_pos);
 
   lattice->node_allocator()->set_max_nodes_size(8192);
   Node *result_node = nullptr;
@@ -853,8 +941,8 @@ Node *ImmutableConverter::AddCharacterTypeBasedNodes(
     }
 
     new_node->wcost = kMaxCost;
-    new_node->value.assign(it.view());
-    new_node->key.assign(it.view());
+    new_node->value = it.view();
+    new_node->key = it.view();
     new_node->node_type = Node::NOR_NODE;
     new_node->bnext = nodes;
     nodes = new_node;
@@ -894,8 +982,8 @@ Node *ImmutableConverter::AddCharacterTypeBasedNodes(
     new_node->wcost = kMaxCost / 2;
     const absl::string_view key_substr_up_to_it =
         key_substr.substr(0, it.to_address() - key_substr.data());
-    new_node->value.assign(key_substr_up_to_it);
-    new_node->key.assign(key_substr_up_to_it);
+    new_node->value = key_substr_up_to_it;
+    new_node->key = key_substr_up_to_it;
     new_node->node_type = Node::NOR_NODE;
     new_node->bnext = nodes;
     nodes = new_node;
@@ -1157,8 +1245,23 @@ bool ImmutableConverter::PredictionViterbi(const Segments &segments,
   for (const Segment &segment : segments.history_segments()) {
     history_length += segment.key().size();
   }
-  PredictionViterbiInternal(0, history_length, lattice);
-  PredictionViterbiInternal(history_length, key_length, lattice);
+  std::unique_ptr<PredictionViterbiTables> tables;
+  {
+    absl::MutexLock lock(&prediction_viterbi_tables_mutex_);
+    if (!prediction_viterbi_tables_.empty()) {
+      tables = std::move(prediction_viterbi_tables_.back());
+      prediction_viterbi_tables_.pop_back();
+    }
+  }
+  if (tables == nullptr) {
+    tables = std::make_unique<PredictionViterbiTables>();
+  }
+  PredictionViterbiInternal(0, history_length, *tables, lattice);
+  PredictionViterbiInternal(history_length, key_length, *tables, lattice);
+  {
+    absl::MutexLock lock(&prediction_viterbi_tables_mutex_);
+    prediction_viterbi_tables_.push_back(std::move(tables));
+  }
 
   Node *node = lattice->eos_nodes();
   CHECK(node->bnext == nullptr);
@@ -1177,99 +1280,70 @@ bool ImmutableConverter::PredictionViterbi(const Segments &segments,
   return true;
 }
 
-namespace {
-
-// Mapping from lnode's rid to (cost, Node) of best way/cost, and vice versa.
-// Note that, the average number of lid/rid variation is less than 30 in
-// most cases. So, in order to avoid too many allocations for internal
-// nodes of std::map, we use vector of key-value pairs.
-using CostAndNode = std::pair<int, Node *>;
-using BestMap = std::vector<std::pair<int, CostAndNode>>;
-
-BestMap::iterator LowerBound(BestMap &best_map,
-                             const std::pair<int, CostAndNode> &key) {
-  return std::lower_bound(
-      best_map.begin(), best_map.end(), key,
-      [](const std::pair<int, CostAndNode> &l,
-         const std::pair<int, CostAndNode> &r) { return l.first < r.first; });
-}
-
-}  // namespace
-
-void ImmutableConverter::PredictionViterbiInternal(int calc_begin_pos,
-                                                   int calc_end_pos,
-                                                   Lattice *lattice) const {
+void ImmutableConverter::PredictionViterbiInternal(
+    int calc_begin_pos, int calc_end_pos, PredictionViterbiTables &tables,
+    Lattice *lattice) const {
   CHECK_LE(calc_begin_pos, calc_end_pos);
 
-  BestMap lbest, rbest;
-  lbest.reserve(128);
-  rbest.reserve(128);
-
-  const CostAndNode kInvalidValue(INT_MAX, nullptr);
+  BestTable &lbest = tables.lbest;
+  BestTable &rbest = tables.rbest;
+  std::vector<int> &lcosts = tables.lcosts;
+  std::vector<int> &costs = tables.costs;
 
   for (size_t pos = calc_begin_pos; pos <= calc_end_pos; ++pos) {
-    lbest.clear();
+    lbest.Clear();
     for (Node *lnode = lattice->end_nodes(pos); lnode != nullptr;
          lnode = lnode->enext) {
-      const int rid = lnode->rid;
-      const BestMap::value_type key(rid, kInvalidValue);
-      const BestMap::iterator iter = LowerBound(lbest, key);
-      if (iter == lbest.end() || iter->first != rid) {
-        lbest.insert(
-            iter, BestMap::value_type(rid, std::make_pair(lnode->cost, lnode)));
-      } else if (lnode->cost < iter->second.first) {
-        iter->second.first = lnode->cost;
-        iter->second.second = lnode;
+      BestTable::Entry *entry = lbest.Find(lnode->rid);
+      if (entry == nullptr) {
+        lbest.Insert(lnode->rid, lnode->cost, lnode);
+      } else if (lnode->cost < entry->cost) {
+        entry->cost = lnode->cost;
+        entry->node = lnode;
       }
     }
 
-    if (lbest.empty()) {
+    if (lbest.ids().empty()) {
       continue;
     }
 
-    rbest.clear();
-    Node *rnode_begin = lattice->begin_nodes(pos);
-    for (Node *rnode = rnode_begin; rnode != nullptr; rnode = rnode->bnext) {
-      if (rnode->end_pos > calc_end_pos) {
-        continue;
-      }
-      const BestMap::value_type key(rnode->lid, kInvalidValue);
-      const BestMap::const_iterator iter = LowerBound(rbest, key);
-      if (iter == rbest.end() || iter->first != rnode->lid) {
-        rbest.insert(iter, key);
-      }
+    // Sort rids so that ties are broken by the smallest rid.
+    std::vector<uint16_t> &lids = lbest.ids();
+    std::sort(lids.begin(), lids.end());
+    lcosts.clear();
+    for (const uint16_t rid : lids) {
+      lcosts.push_back(lbest.Find(rid)->cost);
     }
+    costs.resize(lids.size());
 
-    if (rbest.empty()) {
-      continue;
-    }
-
-    for (BestMap::iterator liter = lbest.begin(); liter != lbest.end();
-         ++liter) {
-      for (BestMap::iterator riter = rbest.begin(); riter != rbest.end();
-           ++riter) {
-        const int cost = liter->second.first + connector_.GetTransitionCost(
-                                                   liter->first, riter->first);
-        if (cost < riter->second.first) {
-          riter->second.first = cost;
-          riter->second.second = liter->second.second;
-        }
-      }
-    }
-
-    for (Node *rnode = rnode_begin; rnode != nullptr; rnode = rnode->bnext) {
+    rbest.Clear();
+    for (Node *rnode = lattice->begin_nodes(pos); rnode != nullptr;
+         rnode = rnode->bnext) {
       if (rnode->end_pos > calc_end_pos) {
         continue;
       }
-      const BestMap::value_type key(rnode->lid, kInvalidValue);
-      const BestMap::const_iterator iter = LowerBound(rbest, key);
-      if (iter == rbest.end() || iter->first != rnode->lid ||
-          iter->second.second == nullptr) {
+      BestTable::Entry *entry = rbest.Find(rnode->lid);
+      if (entry == nullptr) {
+        // Find the best lnode for this lid. The transition costs are looked up
+        // first so that the min-reduction is a simple loop over the arrays.
+        for (size_t i = 0; i < lids.size(); ++i) {
+          costs[i] = connector_.GetTransitionCost(lids[i], rnode->lid);
+        }
+        for (size_t i = 0; i < lids.size(); ++i) {
+          costs[i] += lcosts[i];
+        }
+        const size_t best =
+            std::min_element(costs.begin(), costs.end()) - costs.begin();
+        entry = costs[best] < INT_MAX
+                    ? rbest.Insert(rnode->lid, costs[best],
+                                   lbest.Find(lids[best])->node)
+                    : rbest.Insert(rnode->lid, INT_MAX, nullptr);
+      }
+      if (entry->node == nullptr) {
         continue;
       }
-
-      rnode->cost = iter->second.first + rnode->wcost;
-      rnode->prev = iter->second.second;
+      rnode->cost = entry->cost + rnode->wcost;
+      rnode->prev = entry->node;
     }
   }
 }
@@ -1552,8 +1626,8 @@ bool ImmutableConverter::MakeLatticeNodesForHistorySegments(
     rnode->lid = candidate.lid;
     rnode->rid = candidate.rid;
     rnode->wcost = 0;
-    rnode->value = candidate.value;
-    rnode->key = segment.key();
+    rnode->value = lattice->NewString(candidate.value);
+    rnode->key = lattice->NewString(segment.key());
     rnode->node_type = Node::HIS_NODE;
     rnode->bnext = nullptr;
     lattice->Insert(segments_pos, rnode);
@@ -1576,8 +1650,8 @@ bool ImmutableConverter::MakeLatticeNodesForHistorySegments(
       // TODO(team): Figure out a better way to set the cost using
       // boundary.def-like approach.
       rnode2->wcost = 0;
-      rnode2->value = candidate.value;
-      rnode2->key = segment.key();
+      rnode2->value = rnode->value;
+      rnode2->key = rnode->key;
       rnode2->node_type = Node::HIS_NODE;
       rnode2->bnext = nullptr;
       lattice->Insert(segments_pos, rnode2);
@@ -1625,11 +1699,8 @@ bool ImmutableConverter::MakeLatticeNodesForHistorySegments(
         CHECK(new_node);
 
         // get the suffix part ("たくや/卓也")
-        new_node->key.assign(compound_node->key, rnode->key.size(),
-                             compound_node->key.size() - rnode->key.size());
-        new_node->value.assign(
-            compound_node->value, rnode->value.size(),
-            compound_node->value.size() - rnode->value.size());
+        new_node->key = compound_node->key.substr(rnode->key.size());
+        new_node->value = compound_node->value.substr(rnode->value.size());
 
         // rid/lid are derived from the compound.
         // lid is just an approximation
@@ -1715,8 +1786,8 @@ void ImmutableConverter::MakeLatticeNodesForConversionSegments(
       }
       CHECK(rnode != nullptr);
       lattice->Insert(pos, rnode);
-      InsertCorrectedNodes(pos, key, request, key_corrector.get(), dictionary_,
-                           lattice);
+      InsertCorrectedNodes(pos, lattice->arena_key(), request,
+                           key_corrector.get(), dictionary_, lattice);
     }
   }
 }
@@ -1761,8 +1832,8 @@ void ImmutableConverter::Resegment(const Segments &segments,
       rnode->lid = candidate.lid;
       rnode->rid = candidate.rid;
       rnode->wcost = kMinCost;
-      rnode->value = candidate.value;
-      rnode->key = segment.key();
+      rnode->value = lattice->NewString(candidate.value);
+      rnode->key = lattice->NewString(segment.key());
       rnode->node_type = Node::CON_NODE;
       rnode->bnext = nullptr;
       lattice->Insert(segments_pos, rnode);
@@ -1931,15 +2002,22 @@ void ImmutableConverter::InsertCandidates(const ConversionRequest &request,
 
   const bool is_single_segment =
       (type == SINGLE_SEGMENT || type == FIRST_INNER_SEGMENT);
-  NBestGenerator nbest_generator(suppression_dictionary_, segmenter_,
-                                 connector_, pos_matcher_, &lattice,
-                                 suggestion_filter_);
 
   std::string original_key;
   for (const Segment &segment : segments->conversion_segments()) {
     original_key.append(segment.key());
   }
 
+  // First, fixes the segment boundaries and the target segments. This step
+  // adds segments to |segments|, so it has to be done sequentially.
+  struct NBestTask {
+    const Node *begin_node;
+    const Node *end_node;
+    NBestGenerator::Options options;
+    Segment *segment;
+    bool is_con_node;
+  };
+  std::vector<NBestTask> tasks;
   size_t begin_pos = std::string::npos;
   for (Node *node = prev->next; node->next != nullptr; node = node->next) {
     if (begin_pos == std::string::npos) {
@@ -1969,22 +2047,73 @@ void ImmutableConverter::InsertCandidates(const ConversionRequest &request,
           NBestGenerator::BUILD_FROM_ONLY_FIRST_INNER_SEGMENT;
       options.candidate_mode |= NBestGenerator::FILL_INNER_SEGMENT_INFO;
     }
-    nbest_generator.Reset(prev, node->next, options);
-    nbest_generator.SetCandidates(request, original_key, expand_size, segment);
+    tasks.push_back({prev, node->next, options, segment,
+                     node->node_type == Node::CON_NODE});
 
+    if (type == ONLY_FIRST_SEGMENT) {
+      break;
+    }
+    begin_pos = std::string::npos;
+    prev = node;
+  }
+
+  // Then, runs the N-best search of each segment. The searches only read the
+  // lattice and the shared modules, and every segment owns its candidates, so
+  // the segments of MULTI_SEGMENTS are searched concurrently. Each worker owns
+  // one generator (and hence one CandidateFilter), which is reset per segment.
+  // The other types may insert into the same segment more than once and are
+  // searched sequentially.
+  const auto search = [&](const NBestTask &task,
+                          NBestGenerator &nbest_generator) {
+    nbest_generator.Reset(task.begin_node, task.end_node, task.options);
+    nbest_generator.SetCandidates(request, original_key, expand_size,
+                                  task.segment);
+  };
+  const auto finish = [&](const NBestTask &task) {
     if (type == MULTI_SEGMENTS || type == SINGLE_SEGMENT) {
-      InsertDummyCandidates(segment, expand_size);
+      InsertDummyCandidates(task.segment, expand_size);
+    }
+    if (task.is_con_node) {
+      task.segment->set_segment_type(Segment::FIXED_VALUE);
     }
+  };
 
-    if (node->node_type == Node::CON_NODE) {
-      segment->set_segment_type(Segment::FIXED_VALUE);
+  const size_t num_workers =
+      (type == MULTI_SEGMENTS && expand_size >= kMinExpandSizeForParallelNBest)
+          ? std::min(tasks.size(), max_nbest_workers_)
+          : 1;
+  if (num_workers <= 1) {
+    NBestGenerator nbest_generator(suppression_dictionary_, segmenter_,
+                                   connector_, pos_matcher_, &lattice,
+                                   suggestion_filter_);
+    for (const NBestTask &task : tasks) {
+      search(task, nbest_generator);
+      finish(task);
     }
+    return;
+  }
 
-    if (type == ONLY_FIRST_SEGMENT) {
-      break;
+  // Segments are assigned round-robin so that the long and the short ones are
+  // spread over the workers. The calling thread works as the first worker.
+  const auto run_worker = [&](size_t worker) {
+    NBestGenerator nbest_generator(suppression_dictionary_, segmenter_,
+                                   connector_, pos_matcher_, &lattice,
+                                   suggestion_filter_);
+    for (size_t i = worker; i < tasks.size(); i += num_workers) {
+      search(tasks[i], nbest_generator);
     }
-    begin_pos = std::string::npos;
-    prev = node;
+  };
+  std::vector<BackgroundFuture<void>> workers;
+  workers.reserve(num_workers - 1);
+  for (size_t worker = 1; worker < num_workers; ++worker) {
+    workers.emplace_back(run_worker, worker);
+  }
+  run_worker(0);
+  for (const BackgroundFuture<void> &worker : workers) {
+    worker.Wait();
+  }
+  for (const NBestTask &task : tasks) {
+    finish(task);
   }
 }
 
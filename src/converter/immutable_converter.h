@@ -32,11 +32,14 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "absl/base/attributes.h"
+#include "absl/base/thread_annotations.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "converter/connector.h"
 #include "converter/immutable_converter_interface.h"
@@ -61,7 +64,7 @@ class ImmutableConverter : public ImmutableConverterInterface {
   explicit ImmutableConverter(const engine::Modules &modules);
   ImmutableConverter(const ImmutableConverter &) = delete;
   ImmutableConverter &operator=(const ImmutableConverter &) = delete;
-  ~ImmutableConverter() override = default;
+  ~ImmutableConverter() override;
 
   ABSL_MUST_USE_RESULT bool ConvertForRequest(
       const ConversionRequest &request, Segments *segments) const override;
@@ -72,7 +75,10 @@ class ImmutableConverter : public ImmutableConverterInterface {
   FRIEND_TEST(ImmutableConverterTest, DummyCandidatesInnerSegmentBoundary);
   FRIEND_TEST(ImmutableConverterTest, MakeLatticeKatakana);
   FRIEND_TEST(ImmutableConverterTest, NotConnectedTest);
+  FRIEND_TEST(ImmutableConverterTest, ParallelNBestMatchesSequential);
+  FRIEND_TEST(ImmutableConverterTest, PredictionViterbiTieBreak);
   FRIEND_TEST(ImmutableConverterTest, PredictiveNodesOnlyForConversionKey);
+  FRIEND_TEST(NBestGeneratorTest, BeamAndStats);
   FRIEND_TEST(NBestGeneratorTest, InnerSegmentBoundary);
   FRIEND_TEST(NBestGeneratorTest, MultiSegmentConnectionTest);
   FRIEND_TEST(NBestGeneratorTest, SingleSegmentConnectionTest);
@@ -128,8 +134,12 @@ class ImmutableConverter : public ImmutableConverterInterface {
 
   bool Viterbi(const Segments &segments, Lattice *lattice) const;
 
+  // Buffers of PredictionViterbiInternal(), defined in the .cc file.
+  struct PredictionViterbiTables;
+
   bool PredictionViterbi(const Segments &segments, Lattice *lattice) const;
   void PredictionViterbiInternal(int calc_begin_pos, int calc_end_pos,
+                                 PredictionViterbiTables &tables,
                                  Lattice *lattice) const;
 
   // TODO(toshiyuki): Change parameter order for mutable |segments|.
@@ -214,6 +224,18 @@ class ImmutableConverter : public ImmutableConverterInterface {
 
   // Cache for transition cost.
   const int32_t last_to_first_name_transition_cost_;
+
+  // The maximum number of threads searching the segments of MULTI_SEGMENTS,
+  // taken from --nbest_search_threads. Tests set it directly.
+  size_t max_nbest_workers_;
+
+  // The tables of PredictionViterbi() are sized by the number of POS ids, so
+  // they are reused across calls. Each call takes one out of this list, so
+  // concurrent calls don't share them.
+  mutable absl::Mutex prediction_viterbi_tables_mutex_;
+  mutable std::vector<std::unique_ptr<PredictionViterbiTables>>
+      prediction_viterbi_tables_
+          ABSL_GUARDED_BY(prediction_viterbi_tables_mutex_);
 };
 
 }  // namespace mozc
@@ -42,6 +42,7 @@
 #include "absl/strings/match.h"
 #include "absl/strings/string_view.h"
 #include "base/util.h"
+#include "converter/connector.h"
 #include "converter/lattice.h"
 #include "converter/node.h"
 #include "converter/segments.h"
@@ -392,6 +393,108 @@ TEST(ImmutableConverterTest, NotConnectedTest) {
   EXPECT_TRUE(tested);
 }
 
+TEST(ImmutableConverterTest, PredictionViterbiTieBreak) {
+  std::unique_ptr<MockDataAndImmutableConverter> data_and_converter(
+      new MockDataAndImmutableConverter);
+  ImmutableConverter *converter = data_and_converter->GetConverter();
+  const Connector &connector = converter->connector_;
+
+  // Two lnodes ending at the same position and an rnode after them. The wcosts
+  // are chosen so that the paths through both lnodes cost the same. Then the
+  // lnode with the smaller rid must be the best one regardless of the order
+  // of the nodes in the lattice.
+  constexpr uint16_t kLid = 10;
+  constexpr uint16_t kSmallRid = 20;
+  constexpr uint16_t kLargeRid = 30;
+  constexpr uint16_t kRnodeLid = 40;
+  const int small_rid_cost = connector.GetTransitionCost(kSmallRid, kRnodeLid);
+  const int large_rid_cost = connector.GetTransitionCost(kLargeRid, kRnodeLid);
+
+  Segments segments;
+  segments.add_segment()->set_key("ab");
+  for (const bool small_rid_first : {true, false}) {
+    SCOPED_TRACE(small_rid_first);
+    Lattice lattice;
+    lattice.SetKey("ab");
+    Node *small_rid_node = lattice.NewNode();
+    small_rid_node->key = small_rid_node->value = "a";
+    small_rid_node->lid = kLid;
+    small_rid_node->rid = kSmallRid;
+    small_rid_node->wcost = 1000 + large_rid_cost;
+    Node *large_rid_node = lattice.NewNode();
+    large_rid_node->key = large_rid_node->value = "A";
+    large_rid_node->lid = kLid;
+    large_rid_node->rid = kLargeRid;
+    large_rid_node->wcost = 1000 + small_rid_cost;
+    // Lattice::Insert() prepends the nodes to the list of the end position, so
+    // the node linked first comes last in the list.
+    if (small_rid_first) {
+      large_rid_node->bnext = small_rid_node;
+      lattice.Insert(0, large_rid_node);
+    } else {
+      small_rid_node->bnext = large_rid_node;
+      lattice.Insert(0, small_rid_node);
+    }
+    Node *rnode = lattice.NewNode();
+    rnode->key = rnode->value = "b";
+    rnode->lid = kRnodeLid;
+    rnode->rid = 0;
+    rnode->wcost = 1000;
+    lattice.Insert(1, rnode);
+
+    ASSERT_TRUE(converter->PredictionViterbi(segments, &lattice));
+    ASSERT_EQ(small_rid_node->cost + small_rid_cost,
+              large_rid_node->cost + large_rid_cost);
+    EXPECT_EQ(rnode->prev, small_rid_node);
+    EXPECT_EQ(rnode->cost,
+              small_rid_node->cost + small_rid_cost + rnode->wcost);
+    EXPECT_EQ(lattice.eos_nodes()->prev, rnode);
+  }
+}
+
+TEST(ImmutableConverterTest, ParallelNBestMatchesSequential) {
+  std::unique_ptr<MockDataAndImmutableConverter> data_and_converter(
+      new MockDataAndImmutableConverter);
+  ImmutableConverter *converter = data_and_converter->GetConverter();
+
+  const commands::Request request;
+  ConversionRequest conversion_request;
+  conversion_request.set_request(&request);
+  // Large enough to search the segments in parallel.
+  conversion_request.set_max_conversion_candidates_size(32);
+
+  const auto convert = [&](size_t max_nbest_workers) {
+    converter->max_nbest_workers_ = max_nbest_workers;
+    Segments segments;
+    segments.add_segment()->set_key("わたしのなまえはなかのです");
+    EXPECT_TRUE(converter->ConvertForRequest(conversion_request, &segments));
+    return segments;
+  };
+  const Segments sequential = convert(1);
+  const Segments parallel = convert(4);
+
+  ASSERT_GT(sequential.conversion_segments_size(), 1);
+  ASSERT_EQ(parallel.conversion_segments_size(),
+            sequential.conversion_segments_size());
+  for (size_t i = 0; i < sequential.conversion_segments_size(); ++i) {
+    SCOPED_TRACE(i);
+    const Segment &expected = sequential.conversion_segment(i);
+    const Segment &actual = parallel.conversion_segment(i);
+    EXPECT_EQ(actual.key(), expected.key());
+    EXPECT_EQ(actual.segment_type(), expected.segment_type());
+    ASSERT_EQ(actual.candidates_size(), expected.candidates_size());
+    for (size_t j = 0; j < expected.candidates_size(); ++j) {
+      SCOPED_TRACE(j);
+      EXPECT_EQ(actual.candidate(j).key, expected.candidate(j).key);
+      EXPECT_EQ(actual.candidate(j).value, expected.candidate(j).value);
+      EXPECT_EQ(actual.candidate(j).cost, expected.candidate(j).cost);
+      EXPECT_EQ(actual.candidate(j).wcost, expected.candidate(j).wcost);
+      EXPECT_EQ(actual.candidate(j).lid, expected.candidate(j).lid);
+      EXPECT_EQ(actual.candidate(j).rid, expected.candidate(j).rid);
+    }
+  }
+}
+
 TEST(ImmutableConverterTest, HistoryKeyLengthIsVeryLong) {
   // "あ..." (100 times)
   const std::string kA100 =
@@ -34,6 +34,8 @@
 #include <string>
 #include <vector>
 
+#include "absl/strings/string_view.h"
+
 namespace mozc {
 
 class KeyCorrector final {
@@ -149,7 +151,7 @@ class KeyCorrector final {
 
   // return the cost penalty for the corrected key.
   // The return value is added to the original cost as a penalty.
-  static int GetCorrectedCostPenalty(const std::string &key);
+  static int GetCorrectedCostPenalty(absl::string_view key);
 
   // clear internal data
   void Clear();
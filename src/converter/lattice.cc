@@ -56,7 +56,7 @@ Node *InitBOSNode(Lattice *lattice, uint16_t length) {
   DCHECK(bos_node);
   bos_node->rid = 0;  // 0 is reserved for EOS/BOS
   bos_node->lid = 0;
-  bos_node->key.clear();
+  bos_node->key = absl::string_view();
   bos_node->value = "BOS";
   bos_node->node_type = Node::BOS_NODE;
   bos_node->wcost = 0;
@@ -72,7 +72,7 @@ Node *InitEOSNode(Lattice *lattice, uint16_t length) {
   DCHECK(eos_node);
   eos_node->rid = 0;  // 0 is reserved for EOS/BOS
   eos_node->lid = 0;
-  eos_node->key.clear();
+  eos_node->key = absl::string_view();
   eos_node->value = "EOS";
   eos_node->node_type = Node::EOS_NODE;
   eos_node->wcost = 0;
@@ -154,6 +154,7 @@ void Lattice::SetKey(std::string key) {
   Clear();
   const size_t size = key.size();
   key_ = std::move(key);
+  arena_key_ = node_allocator_->NewString(key_);
   begin_nodes_.resize(size + 4, nullptr);
   end_nodes_.resize(size + 4, nullptr);
   cache_info_.resize(size + 4, 0);
@@ -190,6 +191,7 @@ void Lattice::Insert(size_t pos, Node *node) {
 
 void Lattice::Clear() {
   key_.clear();
+  arena_key_ = absl::string_view();
   begin_nodes_.clear();
   end_nodes_.clear();
   node_allocator_->Free();
@@ -256,6 +258,7 @@ void Lattice::AddSuffix(const absl::string_view suffix_key) {
 
   // update key
   absl::StrAppend(&key_, suffix_key);
+  arena_key_ = node_allocator_->NewString(key_);
 }
 
 void Lattice::ShrinkKey(const size_t new_len) {
@@ -302,6 +305,7 @@ void Lattice::ShrinkKey(const size_t new_len) {
 
   // update key
   key_.erase(new_len);
+  arena_key_ = arena_key_.substr(0, new_len);
 }
 
 void Lattice::ResetNodeCost() {
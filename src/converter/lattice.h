@@ -56,6 +56,11 @@ class Lattice {
   // return key.
   const std::string &key() const { return key_; }
 
+  // Returns the copy of key() in the string arena of the node allocator.
+  // Nodes can refer to its substrings, which stay valid until Clear() even
+  // when the key is updated by UpdateKey().
+  absl::string_view arena_key() const { return arena_key_; }
+
   // Set history end position.
   // For cache, we have to reset lattice when the history size is changed.
   void set_history_end_pos(size_t pos) { history_end_pos_ = pos; }
@@ -65,6 +70,11 @@ class Lattice {
   // allocate new node.
   Node *NewNode() { return node_allocator_->NewNode(); }
 
+  // Copies |str| for the strings of nodes. See NodeAllocator::NewString().
+  absl::string_view NewString(absl::string_view str) {
+    return node_allocator_->NewString(str);
+  }
+
   // return nodes (linked list) starting with |pos|.
   // To traverse all nodes, use Node::bnext member.
   Node *begin_nodes(size_t pos) const { return begin_nodes_[pos]; }
@@ -129,6 +139,7 @@ class Lattice {
  private:
   // TODO(team): Splitting the cache module may make this module simpler.
   std::string key_;
+  absl::string_view arena_key_;
   size_t history_end_pos_;
   std::vector<Node *> begin_nodes_;
   std::vector<Node *> end_nodes_;
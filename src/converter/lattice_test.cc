@@ -31,9 +31,12 @@
 
 #include <cstddef>
 #include <string>
+#include <vector>
 
 #include "absl/container/btree_set.h"
+#include "absl/strings/string_view.h"
 #include "converter/node.h"
+#include "converter/node_allocator.h"
 #include "testing/gunit.h"
 
 namespace mozc {
@@ -118,7 +121,7 @@ void InsertNodes(Lattice *lattice) {
   const size_t key_size = lattice->key().size();
   for (size_t i = 0; i < key_size; ++i) {
     Node *node = lattice->NewNode();
-    node->key.assign(lattice->key(), i, key_size - i);
+    node->key = lattice->arena_key().substr(i);
     lattice->Insert(i, node);
   }
 }
@@ -221,4 +224,54 @@ TEST(LatticeTest, ShrinkKeyTest) {
     }
   }
 }
+
+TEST(LatticeTest, NodeStringsSurviveKeyUpdates) {
+  Lattice lattice;
+  lattice.SetKey("abcd");
+  EXPECT_EQ(lattice.arena_key(), "abcd");
+  InsertNodes(&lattice);
+
+  Node *node = lattice.NewNode();
+  {
+    const std::string value = "value";
+    node->value = lattice.NewString(value);
+  }
+  lattice.Insert(0, node);
+
+  // Grow the key enough to reallocate the buffer of Lattice::key().
+  lattice.UpdateKey("abcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyz");
+  EXPECT_EQ(lattice.arena_key(), lattice.key());
+
+  EXPECT_EQ(node->value, "value");
+  absl::btree_set<absl::string_view> keys;
+  for (const Node *n = lattice.begin_nodes(0); n != nullptr; n = n->bnext) {
+    keys.insert(n->key);
+  }
+  EXPECT_TRUE(keys.contains("abcd"));
+  EXPECT_TRUE(keys.contains(""));
+
+  lattice.ShrinkKey(3);
+  EXPECT_EQ(lattice.arena_key(), "abc");
+}
+
+TEST(NodeAllocatorTest, NewString) {
+  NodeAllocator allocator;
+  EXPECT_TRUE(allocator.NewString("").empty());
+
+  std::vector<absl::string_view> strs;
+  std::vector<std::string> expected;
+  for (int i = 0; i < 10000; ++i) {
+    expected.push_back(std::to_string(i));
+    strs.push_back(allocator.NewString(expected.back()));
+  }
+  // Longer than a chunk.
+  expected.push_back(std::string(100000, 'x'));
+  strs.push_back(allocator.NewString(expected.back()));
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(strs[i], expected[i]);
+  }
+  allocator.Free();
+  EXPECT_EQ(allocator.NewString("abc"), "abc");
+}
+
 }  // namespace mozc
@@ -57,45 +57,58 @@ using ::mozc::converter::CandidateFilter;
 using ::mozc::dictionary::PosMatcher;
 using ::mozc::dictionary::SuppressionDictionary;
 
-constexpr int kFreeListSize = 512;
+constexpr int kInitialAgendaSize = 512;
 constexpr int kCostDiff = 3453;  // log prob of 1/1000
 
 }  // namespace
 
-const NBestGenerator::QueueElement *NBestGenerator::CreateNewElement(
-    const Node *node, const QueueElement *next, int32_t fx, int32_t gx,
-    int32_t structure_gx, int32_t w_gx) {
-  QueueElement *elm = freelist_.Alloc();
-  DCHECK(elm);
-  elm->node = node;
-  elm->next = next;
-  elm->fx = fx;
-  elm->gx = gx;
-  elm->structure_gx = structure_gx;
-  elm->w_gx = w_gx;
-  return elm;
-}
-
-bool NBestGenerator::QueueElement::Comparator(
-    const NBestGenerator::QueueElement *q1,
-    const NBestGenerator::QueueElement *q2) {
-  return (q1->fx > q2->fx);
+void NBestGenerator::PushNewElement(const Node *node, ElementIndex next,
+                                    int32_t fx, int32_t gx,
+                                    int32_t structure_gx, int32_t w_gx) {
+  if (options_.max_cost_margin > 0 &&
+      fx - best_cost_ > options_.max_cost_margin) {
+    ++stats_.num_pruned;
+    return;
+  }
+  const ElementIndex index = static_cast<ElementIndex>(elements_.size());
+  DCHECK_NE(index, kNoElement);
+  elements_.push_back({node, next, gx, structure_gx, w_gx});
+  agenda_.Push({fx, index});
+  ++stats_.num_expansions;
+
+  if (options_.max_agenda_size > 0 &&
+      agenda_.Size() >= 2 * options_.max_agenda_size) {
+    stats_.num_pruned += agenda_.Size() - options_.max_agenda_size;
+    agenda_.Truncate(options_.max_agenda_size);
+  }
+  stats_.max_agenda_size = std::max(stats_.max_agenda_size, agenda_.Size());
 }
 
-inline void NBestGenerator::Agenda::Push(
-    const NBestGenerator::QueueElement *element) {
-  priority_queue_.push_back(element);
-  std::push_heap(priority_queue_.begin(), priority_queue_.end(),
-                 QueueElement::Comparator);
+inline void NBestGenerator::Agenda::Push(AgendaEntry entry) {
+  priority_queue_.push_back(entry);
+  std::push_heap(priority_queue_.begin(), priority_queue_.end(), Comparator);
 }
 
 inline void NBestGenerator::Agenda::Pop() {
   DCHECK(!priority_queue_.empty());
-  std::pop_heap(priority_queue_.begin(), priority_queue_.end(),
-                QueueElement::Comparator);
+  std::pop_heap(priority_queue_.begin(), priority_queue_.end(), Comparator);
   priority_queue_.pop_back();
 }
 
+void NBestGenerator::Agenda::Truncate(size_t size) {
+  if (priority_queue_.size() <= size) {
+    return;
+  }
+  // |Comparator| orders the entries from the worst to the best.
+  std::nth_element(priority_queue_.begin(), priority_queue_.begin() + size,
+                   priority_queue_.end(),
+                   [](const AgendaEntry &e1, const AgendaEntry &e2) {
+                     return Comparator(e2, e1);
+                   });
+  priority_queue_.resize(size);
+  std::make_heap(priority_queue_.begin(), priority_queue_.end(), Comparator);
+}
+
 NBestGenerator::NBestGenerator(const SuppressionDictionary *suppression_dic,
                                const Segmenter *segmenter,
                                const Connector &connector,
@@ -107,7 +120,6 @@ NBestGenerator::NBestGenerator(const SuppressionDictionary *suppression_dic,
       connector_(connector),
       pos_matcher_(pos_matcher),
       lattice_(lattice),
-      freelist_(kFreeListSize),
       filter_(suppression_dic, pos_matcher, suggestion_filter) {
   DCHECK(suppression_dictionary_);
   DCHECK(segmenter);
@@ -116,13 +128,15 @@ NBestGenerator::NBestGenerator(const SuppressionDictionary *suppression_dic,
     return;
   }
 
-  agenda_.Reserve(kFreeListSize);
+  agenda_.Reserve(kInitialAgendaSize);
+  elements_.reserve(kInitialAgendaSize);
 }
 
 void NBestGenerator::Reset(const Node *begin_node, const Node *end_node,
                            const Options options) {
   agenda_.Clear();
-  freelist_.Free();
+  elements_.clear();
+  stats_ = Stats();
   top_nodes_.clear();
   filter_.Reset();
   viterbi_result_checked_ = false;
@@ -130,6 +144,7 @@ void NBestGenerator::Reset(const Node *begin_node, const Node *end_node,
 
   begin_node_ = begin_node;
   end_node_ = end_node;
+  best_cost_ = end_node_->cost;
 
   for (Node *node = lattice_->begin_nodes(end_node_->begin_pos);
        node != nullptr; node = node->bnext) {
@@ -142,7 +157,7 @@ void NBestGenerator::Reset(const Node *begin_node, const Node *end_node,
       // Note:
       // node->cost contains nodes' word cost.
       // The word cost part will be adjusted as marginalized cost in Next().
-      agenda_.Push(CreateNewElement(node, nullptr, node->cost, 0, 0, 0));
+      PushNewElement(node, kNoElement, node->cost, 0, 0, 0);
     }
   }
 }
@@ -265,39 +280,36 @@ void NBestGenerator::FillInnerSegmentInfo(
 
 CandidateFilter::ResultType NBestGenerator::MakeCandidateFromElement(
     const ConversionRequest &request, const std::string &original_key,
-    const NBestGenerator::QueueElement *element,
-    Segment::Candidate *candidate) {
+    const ElementIndex element_index, Segment::Candidate *candidate) {
   std::vector<const Node *> nodes;
+  const QueueElement &element = elements_[element_index];
 
   if (options_.candidate_mode &
       CandidateMode::BUILD_FROM_ONLY_FIRST_INNER_SEGMENT) {
-    const QueueElement *elm = element->next;
-    for (; elm->next != nullptr; elm = elm->next) {
+    const QueueElement *elm = &elements_[element.next];
+    for (; elm->next != kNoElement; elm = &elements_[elm->next]) {
       nodes.push_back(elm->node);
-      if (segmenter_->IsBoundary(*elm->node, *elm->next->node, false)) {
+      if (segmenter_->IsBoundary(*elm->node, *elements_[elm->next].node,
+                                 false)) {
         break;
       }
     }
 
-    if (elm == nullptr) {
-      return CandidateFilter::BAD_CANDIDATE;
-    }
-
     // Does not contain the transition cost to the right
-    const int cost = element->gx - elm->gx;
-    const int structure_cost = element->structure_gx - elm->structure_gx;
-    const int wcost = element->w_gx - elm->w_gx;
+    const int cost = element.gx - elm->gx;
+    const int structure_cost = element.structure_gx - elm->structure_gx;
+    const int wcost = element.w_gx - elm->w_gx;
     MakeCandidate(candidate, cost, structure_cost, wcost, nodes);
   } else {
-    for (const QueueElement *elm = element->next; elm->next != nullptr;
-         elm = elm->next) {
+    for (const QueueElement *elm = &elements_[element.next];
+         elm->next != kNoElement; elm = &elements_[elm->next]) {
       nodes.push_back(elm->node);
     }
 
     DCHECK(!nodes.empty());
     DCHECK(!top_nodes_.empty());
 
-    MakeCandidate(candidate, element->gx, element->structure_gx, element->w_gx,
+    MakeCandidate(candidate, element.gx, element.structure_gx, element.w_gx,
                   nodes);
   }
 
@@ -373,6 +385,7 @@ bool NBestGenerator::Next(const ConversionRequest &request,
     // Viterbi-best path.
     switch (InsertTopResult(request, original_key, candidate)) {
       case CandidateFilter::GOOD_CANDIDATE:
+        ++stats_.num_candidates;
         return true;
       case CandidateFilter::STOP_ENUMERATION:
         return false;
@@ -392,10 +405,11 @@ bool NBestGenerator::Next(const ConversionRequest &request,
   int num_trials = 0;
 
   while (!agenda_.IsEmpty()) {
-    const QueueElement *top = agenda_.Top();
-    DCHECK(top);
+    const ElementIndex top_index = agenda_.Top().index;
     agenda_.Pop();
-    const Node *rnode = top->node;
+    // Copied as |elements_| may be reallocated by the expansion below.
+    const QueueElement top = elements_[top_index];
+    const Node *rnode = top.node;
     DCHECK(rnode);
 
     if (num_trials++ > KMaxTrial) {  // too many trials
@@ -406,10 +420,11 @@ bool NBestGenerator::Next(const ConversionRequest &request,
     // reached to the goal.
     if (rnode->end_pos == begin_node_->end_pos) {
       const CandidateFilter::ResultType filter_result =
-          MakeCandidateFromElement(request, original_key, top, candidate);
+          MakeCandidateFromElement(request, original_key, top_index, candidate);
 
       switch (filter_result) {
         case CandidateFilter::GOOD_CANDIDATE:
+          ++stats_.num_candidates;
           return true;
         case CandidateFilter::STOP_ENUMERATION:
           return false;
@@ -427,7 +442,12 @@ bool NBestGenerator::Next(const ConversionRequest &request,
 
     DCHECK_NE(rnode->end_pos, begin_node_->end_pos);
 
-    const QueueElement *best_left_elm = nullptr;
+    // The best left edge element, which is pushed after the loop.
+    const Node *best_left_node = nullptr;
+    int32_t best_left_fx = 0;
+    int32_t best_left_gx = 0;
+    int32_t best_left_structure_gx = 0;
+    int32_t best_left_w_gx = 0;
     const bool is_right_edge = rnode->begin_pos == end_node_->begin_pos;
     const bool is_left_edge = rnode->begin_pos == begin_node_->end_pos;
     DCHECK(!(is_right_edge && is_left_edge));
@@ -514,29 +534,33 @@ bool NBestGenerator::Next(const ConversionRequest &request,
         wcost_diff += kWeakConnectedPenalty / 2;
       }
 
-      const int32_t gx = cost_diff + top->gx;
+      const int32_t gx = cost_diff + top.gx;
       // |lnode->cost| is heuristics function of A* search, h(x).
       // After Viterbi search, we already know an exact value of h(x).
       // f(x) = h(x) + g(x): cost for the path
       const int32_t fx = lnode->cost + gx;
-      const int32_t structure_gx = structure_cost_diff + top->structure_gx;
-      const int32_t w_gx = wcost_diff + top->w_gx;
+      const int32_t structure_gx = structure_cost_diff + top.structure_gx;
+      const int32_t w_gx = wcost_diff + top.w_gx;
       if (is_left_edge) {
         // We only need to only 1 left node here.
         // Even if expand all left nodes, all the |value| part should
         // be identical. Here, we simply use the best left edge node.
         // This hack reduces the number of redundant calls of pop().
-        if (best_left_elm == nullptr || best_left_elm->fx > fx) {
-          best_left_elm =
-              CreateNewElement(lnode, top, fx, gx, structure_gx, w_gx);
+        if (best_left_node == nullptr || best_left_fx > fx) {
+          best_left_node = lnode;
+          best_left_fx = fx;
+          best_left_gx = gx;
+          best_left_structure_gx = structure_gx;
+          best_left_w_gx = w_gx;
         }
       } else {
-        agenda_.Push(CreateNewElement(lnode, top, fx, gx, structure_gx, w_gx));
+        PushNewElement(lnode, top_index, fx, gx, structure_gx, w_gx);
       }
     }
 
-    if (best_left_elm != nullptr) {
-      agenda_.Push(best_left_elm);
+    if (best_left_node != nullptr) {
+      PushNewElement(best_left_node, top_index, best_left_fx, best_left_gx,
+                     best_left_structure_gx, best_left_w_gx);
     }
   }
 
@@ -35,7 +35,6 @@
 #include <string>
 #include <vector>
 
-#include "base/container/freelist.h"
 #include "converter/candidate_filter.h"
 #include "converter/connector.h"
 #include "converter/lattice.h"
@@ -93,6 +92,30 @@ class NBestGenerator {
   struct Options {
     BoundaryCheckMode boundary_mode = STRICT;
     uint32_t candidate_mode = CANDIDATE_MODE_NONE;
+    // Beam of the A* search. If non-zero, the agenda keeps only the best
+    // |max_agenda_size| elements (trimmed lazily when it grows to twice the
+    // size), and paths whose f(x) exceeds the cost of the Viterbi-best path by
+    // more than |max_cost_margin| are not expanded. Zero means unbounded.
+    size_t max_agenda_size = 0;
+    int32_t max_cost_margin = 0;
+  };
+
+  // Statistics of the search since the last Reset().
+  struct Stats {
+    // Number of elements pushed to the agenda.
+    size_t num_expansions = 0;
+    // Number of elements discarded by the beam.
+    size_t num_pruned = 0;
+    // Number of candidates accepted by the filter.
+    size_t num_candidates = 0;
+    // Peak size of the agenda.
+    size_t max_agenda_size = 0;
+
+    double ExpansionsPerCandidate() const {
+      return num_candidates == 0
+                 ? 0.0
+                 : static_cast<double>(num_expansions) / num_candidates;
+    }
   };
 
   // Try to enumerate N-best results between begin_node and end_node.
@@ -113,6 +136,8 @@ class NBestGenerator {
                      const std::string &original_key, size_t expand_size,
                      Segment *segment);
 
+  const Stats &stats() const { return stats_; }
+
  private:
   enum BoundaryCheckResult {
     VALID = 0,
@@ -120,11 +145,14 @@ class NBestGenerator {
     INVALID,
   };
 
+  // Elements are stored in |elements_| and linked by index, so the storage is
+  // reused across Reset() and can grow without invalidating the links.
+  using ElementIndex = uint32_t;
+  static constexpr ElementIndex kNoElement = UINT32_MAX;
+
   struct QueueElement {
     const Node *node;
-    const QueueElement *next;
-    // f(x) = h(x) + g(x): cost function for A* search
-    int32_t fx;
+    ElementIndex next;
     // g(x): current cost
     // After the search, |gx| should contain the candidates' cost.
     // Please refer to the comment in NBestGenerator::Next() of .cc file
@@ -134,11 +162,18 @@ class NBestGenerator {
     // Do not take the transition costs to edge nodes.
     int32_t structure_gx;
     int32_t w_gx;
+  };
 
-    static bool Comparator(const QueueElement *q1, const QueueElement *q2);
+  // An entry of the agenda. Only f(x) and the index are moved around by the
+  // heap operations.
+  struct AgendaEntry {
+    // f(x) = h(x) + g(x): cost function for A* search
+    int32_t fx;
+    ElementIndex index;
   };
+  static_assert(sizeof(AgendaEntry) == 8);
 
-  // This is just a priority_queue of const QueueElement*, but supports
+  // This is just a priority_queue of AgendaEntry, but supports
   // more operations in addition to std::priority_queue.
   class Agenda {
    public:
@@ -147,16 +182,24 @@ class NBestGenerator {
     Agenda &operator=(const Agenda &) = delete;
     ~Agenda() = default;
 
-    const QueueElement *Top() const { return priority_queue_.front(); }
+    const AgendaEntry &Top() const { return priority_queue_.front(); }
     bool IsEmpty() const { return priority_queue_.empty(); }
+    size_t Size() const { return priority_queue_.size(); }
     void Clear() { priority_queue_.clear(); }
     void Reserve(int size) { priority_queue_.reserve(size); }
 
-    void Push(const QueueElement *element);
+    void Push(AgendaEntry entry);
     void Pop();
 
+    // Keeps only the best |size| entries.
+    void Truncate(size_t size);
+
    private:
-    std::vector<const QueueElement *> priority_queue_;
+    static bool Comparator(const AgendaEntry &e1, const AgendaEntry &e2) {
+      return e1.fx > e2.fx;
+    }
+
+    std::vector<AgendaEntry> priority_queue_;
   };
 
   // Iterator:
@@ -177,7 +220,7 @@ class NBestGenerator {
 
   converter::CandidateFilter::ResultType MakeCandidateFromElement(
       const ConversionRequest &request, const std::string &original_key,
-      const QueueElement *element, Segment::Candidate *candidate);
+      ElementIndex element, Segment::Candidate *candidate);
 
   void FillInnerSegmentInfo(const std::vector<const Node *> &nodes,
                             Segment::Candidate *candidate) const;
@@ -195,11 +238,10 @@ class NBestGenerator {
 
   int GetTransitionCost(const Node *lnode, const Node *rnode) const;
 
-  // Create queue element from freelist
-  const QueueElement *CreateNewElement(const Node *node,
-                                       const QueueElement *next, int32_t fx,
-                                       int32_t gx, int32_t structure_gx,
-                                       int32_t w_gx);
+  // Creates a new element and pushes it to the agenda unless it is out of
+  // the beam.
+  void PushNewElement(const Node *node, ElementIndex next, int32_t fx,
+                      int32_t gx, int32_t structure_gx, int32_t w_gx);
 
   // References to relevant modules.
   const dictionary::SuppressionDictionary *suppression_dictionary_;
@@ -212,7 +254,10 @@ class NBestGenerator {
   const Node *end_node_ = nullptr;
 
   Agenda agenda_;
-  FreeList<QueueElement> freelist_;
+  std::vector<QueueElement> elements_;
+  // Cost of the Viterbi-best path, i.e., the lower bound of f(x).
+  int32_t best_cost_ = 0;
+  Stats stats_;
   std::vector<const Node *> top_nodes_;
   converter::CandidateFilter filter_;
   bool viterbi_result_checked_ = false;
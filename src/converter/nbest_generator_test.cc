@@ -159,6 +159,63 @@ TEST_F(NBestGeneratorTest, MultiSegmentConnectionTest) {
   }
 }
 
+TEST_F(NBestGeneratorTest, BeamAndStats) {
+  auto data_and_converter = std::make_unique<MockDataAndImmutableConverter>();
+  ImmutableConverter *converter = data_and_converter->GetConverter();
+
+  Segments segments;
+  const std::string kText = "わたしのなまえはなかのです";
+  {
+    Segment *segment = segments.add_segment();
+    segment->set_segment_type(Segment::FREE);
+    segment->set_key(kText);
+  }
+
+  Lattice lattice;
+  lattice.SetKey(kText);
+  ConversionRequest request;
+  request.set_request_type(ConversionRequest::CONVERSION);
+  converter->MakeLattice(request, &segments, &lattice);
+
+  std::vector<uint16_t> group;
+  converter->MakeGroup(segments, &group);
+  converter->Viterbi(segments, &lattice);
+
+  std::unique_ptr<NBestGenerator> nbest_generator =
+      data_and_converter->CreateNBestGenerator(&lattice);
+
+  constexpr bool kSingleSegment = true;  // For real time conversion
+  const Node *begin_node = lattice.bos_nodes();
+  const Node *end_node = GetEndNode(request, *converter, segments, *begin_node,
+                                    group, kSingleSegment);
+
+  NBestGenerator::Options options = {NBestGenerator::ONLY_EDGE,
+                                     NBestGenerator::FILL_INNER_SEGMENT_INFO};
+  Segment unbounded_segment;
+  nbest_generator->Reset(begin_node, end_node, options);
+  nbest_generator->SetCandidates(request, "", 10, &unbounded_segment);
+  ASSERT_LT(1, unbounded_segment.candidates_size());
+  const NBestGenerator::Stats unbounded_stats = nbest_generator->stats();
+  EXPECT_EQ(unbounded_stats.num_candidates,
+            unbounded_segment.candidates_size());
+  EXPECT_EQ(unbounded_stats.num_pruned, 0);
+  EXPECT_LT(0, unbounded_stats.num_expansions);
+  EXPECT_LT(0.0, unbounded_stats.ExpansionsPerCandidate());
+
+  // The Viterbi-best path is inserted regardless of the beam.
+  options.max_agenda_size = 2;
+  options.max_cost_margin = 1000;
+  Segment bounded_segment;
+  nbest_generator->Reset(begin_node, end_node, options);
+  nbest_generator->SetCandidates(request, "", 10, &bounded_segment);
+  ASSERT_LE(1, bounded_segment.candidates_size());
+  EXPECT_EQ(bounded_segment.candidate(0).value,
+            unbounded_segment.candidate(0).value);
+  const NBestGenerator::Stats &bounded_stats = nbest_generator->stats();
+  EXPECT_LT(0, bounded_stats.num_pruned);
+  EXPECT_LT(bounded_stats.max_agenda_size, 2 * options.max_agenda_size);
+}
+
 TEST_F(NBestGeneratorTest, SingleSegmentConnectionTest) {
   auto data_and_converter = std::make_unique<MockDataAndImmutableConverter>();
   ImmutableConverter *converter = data_and_converter->GetConverter();
@@ -31,8 +31,8 @@
 #define MOZC_CONVERTER_NODE_H_
 
 #include <cstdint>
-#include <string>
 
+#include "absl/strings/string_view.h"
 #include "dictionary/dictionary_token.h"
 
 namespace mozc {
@@ -176,9 +176,14 @@ struct Node {
   // actual_key: The actual search key that corresponds to the value.
   //           Can differ from key when no modifier conversion is enabled.
   // value: The surface form of the word.
-  std::string key;
-  std::string actual_key;
-  std::string value;
+  //
+  // Nodes don't own these strings. They point to the storage which outlives
+  // the lattice, e.g. string literals or the strings allocated by
+  // NodeAllocator::NewString(), which are released in bulk together with the
+  // nodes.
+  absl::string_view key;
+  absl::string_view actual_key;
+  absl::string_view value;
 
   Node() { Init(); }
 
@@ -197,11 +202,14 @@ struct Node {
     cost = 0;
     raw_wcost = 0;
     attributes = 0;
-    key.clear();
-    actual_key.clear();
-    value.clear();
+    key = absl::string_view();
+    actual_key = absl::string_view();
+    value = absl::string_view();
   }
 
+  // Initializes the node from |token| except for the strings, which are left
+  // empty. |token| is usually a temporary decoded by the dictionary, so the
+  // caller should set key and value to copies with a longer lifetime.
   inline void InitFromToken(const dictionary::Token &token) {
     prev = nullptr;
     next = nullptr;
@@ -227,9 +235,9 @@ struct Node {
       attributes |= USER_DICTIONARY;
       attributes |= NO_VARIANTS_EXPANSION;
     }
-    key = token.key;
-    actual_key.clear();
-    value = token.value;
+    key = absl::string_view();
+    actual_key = absl::string_view();
+    value = absl::string_view();
   }
 };
 
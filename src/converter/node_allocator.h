@@ -30,9 +30,14 @@
 #ifndef MOZC_CONVERTER_NODE_ALLOCATOR_H_
 #define MOZC_CONVERTER_NODE_ALLOCATOR_H_
 
+#include <algorithm>
 #include <cstddef>
+#include <cstring>
+#include <memory>
+#include <vector>
 
 #include "absl/log/check.h"
+#include "absl/strings/string_view.h"
 #include "base/container/freelist.h"
 #include "converter/node.h"
 
@@ -53,10 +58,34 @@ class NodeAllocator {
     return node;
   }
 
-  // Frees all nodes allocateed by NewNode().
+  // Copies |str| to the string arena and returns the view of the copy.
+  // Node::key, actual_key and value point to the strings allocated here. The
+  // copy is valid until Free() is called.
+  absl::string_view NewString(absl::string_view str) {
+    if (str.empty()) {
+      return absl::string_view();
+    }
+    if (str.size() > string_chunk_remaining_) {
+      const size_t chunk_size = std::max(str.size(), kStringChunkSize);
+      string_chunks_.push_back(std::make_unique<char[]>(chunk_size));
+      string_chunk_ptr_ = string_chunks_.back().get();
+      string_chunk_remaining_ = chunk_size;
+    }
+    char *copy = string_chunk_ptr_;
+    std::memcpy(copy, str.data(), str.size());
+    string_chunk_ptr_ += str.size();
+    string_chunk_remaining_ -= str.size();
+    return absl::string_view(copy, str.size());
+  }
+
+  // Frees all nodes allocateed by NewNode() and all strings allocated by
+  // NewString().
   void Free() {
     node_freelist_.Free();
     node_count_ = 0;
+    string_chunks_.clear();
+    string_chunk_ptr_ = nullptr;
+    string_chunk_remaining_ = 0;
   }
 
   size_t max_nodes_size() const { return max_nodes_size_; }
@@ -68,9 +97,14 @@ class NodeAllocator {
   size_t node_count() const { return node_count_; }
 
  private:
+  static constexpr size_t kStringChunkSize = 16 * 1024;
+
   FreeList<Node> node_freelist_;
   size_t max_nodes_size_;
   size_t node_count_;
+  std::vector<std::unique_ptr<char[]>> string_chunks_;
+  char *string_chunk_ptr_ = nullptr;
+  size_t string_chunk_remaining_ = 0;
 };
 
 }  // namespace mozc
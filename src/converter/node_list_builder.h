@@ -84,9 +84,16 @@ class BaseNodeListBuilder : public dictionary::DictionaryInterface::Callback {
   Node *result() const { return result_; }
   NodeAllocator *allocator() { return allocator_; }
 
+  // Creates a new node from |token|. The strings of |token| are copied to the
+  // string arena of the allocator, so the node doesn't allocate on the heap.
   Node *NewNodeFromToken(const dictionary::Token &token) {
     Node *new_node = allocator_->NewNode();
     new_node->InitFromToken(token);
+    new_node->key = allocator_->NewString(token.key);
+    // Hiragana or katakana words often have the same key and value.
+    new_node->value = token.value == token.key
+                          ? new_node->key
+                          : allocator_->NewString(token.value);
     new_node->wcost += penalty_;
     return new_node;
   }
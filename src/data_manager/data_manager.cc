@@ -44,6 +44,7 @@
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/match.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
@@ -407,6 +408,14 @@ DataManager::Status DataManager::InitFromReader(const DataSetReader &reader) {
     }
   }
 
+  // Typing models are optional and named "typing_model_<keyboard>".
+  typing_model_data_.clear();
+  for (const auto &[name, data] : reader.name_to_data_map()) {
+    if (absl::StartsWith(name, "typing_model_")) {
+      typing_model_data_.emplace(name, data);
+    }
+  }
+
   if (!reader.Get("version", &data_version_)) {
     LOG(ERROR) << "Cannot find data version";
     return Status::DATA_MISSING;
@@ -613,6 +622,15 @@ void DataManager::GetUsageRewriterData(
 }
 #endif  // NO_USAGE_REWRITER
 
+absl::string_view DataManager::GetTypingModelData(
+    absl::string_view name) const {
+  if (const auto iter = typing_model_data_.find(name);
+      iter != typing_model_data_.end()) {
+    return iter->second;
+  }
+  return absl::string_view();
+}
+
 absl::string_view DataManager::GetDataVersion() const { return data_version_; }
 
 std::optional<std::pair<size_t, size_t>> DataManager::GetOffsetAndSize(
@@ -158,6 +158,8 @@ class DataManager : public DataManagerInterface {
       absl::string_view *string_array_data) const override;
 #endif  // NO_USAGE_REWRITER
 
+  absl::string_view GetTypingModelData(absl::string_view name) const override;
+
   absl::string_view GetDataVersion() const override;
 
   std::optional<std::pair<size_t, size_t>> GetOffsetAndSize(
@@ -214,6 +216,7 @@ class DataManager : public DataManagerInterface {
   absl::string_view usage_conjugation_index_data_;
   absl::string_view usage_items_data_;
   absl::string_view usage_string_array_data_;
+  absl::flat_hash_map<std::string, absl::string_view> typing_model_data_;
   absl::string_view data_version_;
   absl::flat_hash_map<std::string, std::pair<size_t, size_t>> offset_and_size_;
 };
@@ -149,6 +149,12 @@ class DataManagerInterface {
       absl::string_view *zero_query_number_token_array_data,
       absl::string_view *zero_query_number_string_array_data) const = 0;
 
+  // Gets the typing model of the given section, e.g.,
+  // "typing_model_12keys-hiragana". Returns an empty string if the data set
+  // doesn't have the model.
+  virtual absl::string_view GetTypingModelData(
+      absl::string_view name) const = 0;
+
   // Gets the data version string.
   virtual absl::string_view GetDataVersion() const = 0;
 
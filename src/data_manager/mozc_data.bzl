@@ -27,6 +27,15 @@
 # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+# Keyboards of the typing models, which are used to correct typing errors.
+_TYPING_MODEL_KEYBOARDS = [
+    "12keys-hiragana",
+    "flick-hiragana",
+    "toggle_flick-hiragana",
+    "godan-hiragana",
+    "qwerty_mobile-hiragana",
+]
+
 def mozc_dataset(
         name,
         outs,
@@ -86,6 +95,7 @@ def mozc_dataset(
       - suffix: Suffix dictionary data.
       - reading_correction: Reading correction arrays.
       - symbol: Symbol dictionary data.
+      - typing_model: Typing models for typing correction.
       - usage: [Optional] Usage dictionary data.  Available only if usage_dict is
                provided.
       - user_pos: User POS data.
@@ -159,6 +169,7 @@ def mozc_dataset(
         ":" + name + "@zero_query",
         ":" + name + "@zero_query_number",
         ":" + name + "@a11y_description",
+        ":" + name + "@typing_model",
         ":" + name + "@version",
     ]
     arguments = (
@@ -166,11 +177,11 @@ def mozc_dataset(
         "pos_matcher:32:$(@D)/pos_matcher.data " +
         "user_pos_token:32:$(@D)/user_pos_token_array.data " +
         "user_pos_string:32:$(@D)/user_pos_string_array.data " +
-        "coll:32:$(location :" + name + "@collocation) " +
-        "cols:32:$(location :" + name + "@collocation_suppression) " +
+        "coll:512:$(location :" + name + "@collocation) " +
+        "cols:512:$(location :" + name + "@collocation_suppression) " +
         "conn:32:$(location :" + name + "@connection) " +
         "dict:32:$(location :" + name + "@dictionary) " +
-        "sugg:32:$(location :" + name + "@suggestion_filter) " +
+        "sugg:512:$(location :" + name + "@suggestion_filter) " +
         "posg:32:$(location :" + name + "@pos_group) " +
         "bdry:32:$(location :" + name + "@boundary) " +
         "segmenter_sizeinfo:32:$(@D)/segmenter_sizeinfo.data " +
@@ -203,6 +214,10 @@ def mozc_dataset(
         "zero_query_number_string_array:32:$(@D)/zero_query_number_string.data " +
         "a11y_description_token:32:$(@D)/a11y_description_token.data " +
         "a11y_description_string:32:$(@D)/a11y_description_string.data " +
+        " ".join([
+            "typing_model_%s:32:$(@D)/typing_model_%s.data" % (keyboard, keyboard)
+            for keyboard in _TYPING_MODEL_KEYBOARDS
+        ]) + " " +
         "version:32:$(location :" + name + "@version) "
     )
     if usage_dict:
@@ -674,6 +689,23 @@ def mozc_dataset(
         tools = ["//rewriter:gen_a11y_description_rewriter_data"],
     )
 
+    native.genrule(
+        name = name + "@typing_model",
+        srcs = [
+            "//data/typing:typing_model_%s.tsv" % keyboard
+            for keyboard in _TYPING_MODEL_KEYBOARDS
+        ],
+        outs = [
+            "typing_model_%s.data" % keyboard
+            for keyboard in _TYPING_MODEL_KEYBOARDS
+        ],
+        cmd = (
+            "$(location //composer:gen_typing_model) " +
+            "--output_dir=$(@D) $(SRCS)"
+        ),
+        tools = ["//composer:gen_typing_model"],
+    )
+
     native.genrule(
         name = name + "@version",
         srcs = ["//data/version:mozc_version_template.bzl"],
@@ -29,10 +29,17 @@
 
 #include "dictionary/suppression_dictionary.h"
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/hash/hash.h"
 #include "absl/log/log.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
@@ -40,28 +47,119 @@
 namespace mozc {
 namespace dictionary {
 
-bool SuppressionDictionary::AddEntry(std::string key, std::string value)
-    ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
-  if (key.empty() && value.empty()) {
-    LOG(WARNING) << "Both key and value are empty";
-    return false;
+// Immutable contents of the dictionary once published. A small Bloom filter
+// precedes the hash sets so that the common "not suppressed" case is answered
+// by probing a single word.
+class SuppressionDictionary::Snapshot {
+ public:
+  bool empty() const {
+    return keys_values_.empty() && keys_only_.empty() && values_only_.empty();
   }
 
-  if (key.empty()) {
-    values_only_.insert(std::move(value));
-  } else if (value.empty()) {
-    keys_only_.insert(std::move(key));
-  } else {
-    keys_values_.emplace(std::move(key), std::move(value));
+  bool AddEntry(std::string key, std::string value) {
+    if (key.empty() && value.empty()) {
+      LOG(WARNING) << "Both key and value are empty";
+      return false;
+    }
+
+    if (key.empty()) {
+      values_only_.insert(std::move(value));
+    } else if (value.empty()) {
+      keys_only_.insert(std::move(key));
+    } else {
+      keys_values_.emplace(std::move(key), std::move(value));
+    }
+    return true;
   }
 
-  return true;
+  // Builds the pre-filter. Must be called after the last AddEntry().
+  void BuildFilter() {
+    // Roughly 16 bits per entry, rounded up to a power of two words.
+    const size_t num_entries =
+        keys_values_.size() + keys_only_.size() + values_only_.size();
+    size_t num_words = 1;
+    while (num_words * 4 < num_entries) {
+      num_words *= 2;
+    }
+    filter_.assign(num_words, 0);
+    for (const std::string &key : keys_only_) {
+      AddToFilter(Hash(key));
+    }
+    for (const std::string &value : values_only_) {
+      AddToFilter(Hash(value));
+    }
+    for (const auto &[key, value] : keys_values_) {
+      AddToFilter(HashKeyValue(Hash(key), Hash(value)));
+    }
+  }
+
+  bool SuppressEntry(absl::string_view key, absl::string_view value) const {
+    const uint64_t key_hash = Hash(key);
+    const uint64_t value_hash = Hash(value);
+    return (MayContain(key_hash) && keys_only_.contains(key)) ||
+           (MayContain(value_hash) && values_only_.contains(value)) ||
+           (MayContain(HashKeyValue(key_hash, value_hash)) &&
+            keys_values_.contains(std::make_pair(key, value)));
+  }
+
+ private:
+  using KeyValue = std::pair<std::string, std::string>;
+  using KeyValueView = std::pair<absl::string_view, absl::string_view>;
+  struct KeyValueHash : public absl::Hash<KeyValueView> {
+    using is_transparent = void;
+  };
+  struct KeyValueEq : public std::equal_to<KeyValueView> {
+    using is_transparent = void;
+  };
+
+  static uint64_t Hash(absl::string_view str) {
+    return absl::Hash<absl::string_view>()(str);
+  }
+
+  static uint64_t HashKeyValue(uint64_t key_hash, uint64_t value_hash) {
+    return (key_hash * 0x9E3779B97F4A7C15ULL) ^ value_hash;
+  }
+
+  // All the bits for a hash are set in one 64-bit word selected by the upper
+  // bits of the hash.
+  static uint64_t BitMask(uint64_t hash) {
+    return (uint64_t{1} << (hash & 63)) | (uint64_t{1} << ((hash >> 6) & 63)) |
+           (uint64_t{1} << ((hash >> 12) & 63));
+  }
+
+  size_t WordIndex(uint64_t hash) const {
+    return (hash >> 32) & (filter_.size() - 1);
+  }
+
+  void AddToFilter(uint64_t hash) { filter_[WordIndex(hash)] |= BitMask(hash); }
+
+  bool MayContain(uint64_t hash) const {
+    const uint64_t mask = BitMask(hash);
+    return (filter_[WordIndex(hash)] & mask) == mask;
+  }
+
+  absl::flat_hash_set<KeyValue, KeyValueHash, KeyValueEq> keys_values_;
+  absl::flat_hash_set<std::string> keys_only_;
+  absl::flat_hash_set<std::string> values_only_;
+  std::vector<uint64_t> filter_;
+};
+
+SuppressionDictionary::SuppressionDictionary() = default;
+SuppressionDictionary::~SuppressionDictionary() = default;
+
+bool SuppressionDictionary::AddEntry(std::string key, std::string value)
+    ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+  if (!pending_) {
+    // The first edit since Lock() starts from the published contents.
+    const std::shared_ptr<const Snapshot> snapshot = GetSnapshot();
+    pending_ = snapshot ? std::make_unique<Snapshot>(*snapshot)
+                        : std::make_unique<Snapshot>();
+  }
+  return pending_->AddEntry(std::move(key), std::move(value));
 }
 
 void SuppressionDictionary::Clear() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
-  keys_values_.clear();
-  keys_only_.clear();
-  values_only_.clear();
+  pending_ = std::make_unique<Snapshot>();
 }
 
 void SuppressionDictionary::Lock() ABSL_EXCLUSIVE_LOCK_FUNCTION(mutex_) {
@@ -69,37 +167,38 @@ void SuppressionDictionary::Lock() ABSL_EXCLUSIVE_LOCK_FUNCTION(mutex_) {
 }
 
 void SuppressionDictionary::UnLock() ABSL_UNLOCK_FUNCTION(mutex_) {
+  // pending_ is nullptr if nothing has been edited since Lock().
+  if (pending_) {
+    std::shared_ptr<const Snapshot> snapshot;
+    if (!pending_->empty()) {
+      pending_->BuildFilter();
+      snapshot = std::move(pending_);
+    }
+    pending_.reset();
+    {
+      absl::MutexLock l(&snapshot_mutex_);
+      snapshot_.swap(snapshot);
+    }
+    // The previous contents are released here, outside of the lock, unless a
+    // consumer still holds them.
+  }
   mutex_.Unlock();
 }
 
-bool SuppressionDictionary::IsEmpty() const {
-  if (mutex_.TryLock()) {
-    bool is_empty =
-        keys_only_.empty() && values_only_.empty() && keys_values_.empty();
-    mutex_.Unlock();
-    return is_empty;
-  }
-
-  return true;
+std::shared_ptr<const SuppressionDictionary::Snapshot>
+SuppressionDictionary::GetSnapshot() const {
+  absl::ReaderMutexLock l(&snapshot_mutex_);
+  return snapshot_;
 }
 
+bool SuppressionDictionary::IsEmpty() const { return GetSnapshot() == nullptr; }
+
 bool SuppressionDictionary::SuppressEntry(const absl::string_view key,
                                           const absl::string_view value) const {
-  if (mutex_.TryLock()) {
-    if (keys_only_.empty() && values_only_.empty() && keys_values_.empty()) {
-      // Almost all users don't use word suppression function.
-      // We can return false as early as possible.
-      mutex_.Unlock();
-      return false;
-    }
-
-    bool suppress = keys_values_.contains(std::make_pair(key, value)) ||
-                    keys_only_.contains(key) || values_only_.contains(value);
-    mutex_.Unlock();
-    return suppress;
-  }
-
-  return false;
+  // Almost all users don't use word suppression function. We can return false
+  // as early as possible.
+  const std::shared_ptr<const Snapshot> snapshot = GetSnapshot();
+  return snapshot && snapshot->SuppressEntry(key, value);
 }
 
 }  // namespace dictionary
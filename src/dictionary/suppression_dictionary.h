@@ -30,13 +30,10 @@
 #ifndef MOZC_DICTIONARY_SUPPRESSION_DICTIONARY_H_
 #define MOZC_DICTIONARY_SUPPRESSION_DICTIONARY_H_
 
-#include <functional>
+#include <memory>
 #include <string>
-#include <utility>
 
 #include "absl/base/thread_annotations.h"
-#include "absl/container/flat_hash_set.h"
-#include "absl/hash/hash.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
 
@@ -44,15 +41,17 @@ namespace mozc {
 namespace dictionary {
 
 // Provides a functionality to test if a word should be suppressed in conversion
-// results. This class is not thread safe in general use but is safe under
-// single-producer single-consumer model, provided that the usage is correct. In
-// our usage, the producer is UserDictionary::UserDictionaryReloader thread and
-// the consumer is the main converter thread.
+// results. Edits are made by the producer thread (in our usage,
+// UserDictionary::UserDictionaryReloader) under the lock and published as an
+// immutable snapshot when the lock is released. The consumer threads read the
+// latest published snapshot without taking the lock, so they are never blocked
+// by the producer's edits. Only copying the snapshot pointer is serialized.
 class ABSL_LOCKABLE SuppressionDictionary final {
  public:
-  SuppressionDictionary() = default;
+  SuppressionDictionary();
   SuppressionDictionary(const SuppressionDictionary &) = delete;
   SuppressionDictionary &operator=(const SuppressionDictionary &) = delete;
+  ~SuppressionDictionary();
 
   // Methods for the producer thread. The thread must obey this edit pattern:
   //
@@ -66,7 +65,7 @@ class ABSL_LOCKABLE SuppressionDictionary final {
   // lock). Should not be called recursively.
   void Lock() ABSL_EXCLUSIVE_LOCK_FUNCTION();
 
-  // Unlocks the dictionary.
+  // Unlocks the dictionary and publishes the edits made while locked.
   void UnLock() ABSL_UNLOCK_FUNCTION();
 
   // Adds an entry into the dictionary.
@@ -76,33 +75,32 @@ class ABSL_LOCKABLE SuppressionDictionary final {
   // Clears the dictionary.
   void Clear() ABSL_EXCLUSIVE_LOCKS_REQUIRED(this);
 
-  // Methods for the consumer thread. If the producer thread is updating the
-  // dictionary contents, the following methods behave as if the dictionary is
-  // empty.
+  // Methods for the consumer thread. The edits by the producer thread become
+  // visible after UnLock() is called. Until then, the following methods see
+  // the previously published contents.
 
   // Returns true if SuppressionDictionary doesn't have any entries.
   bool IsEmpty() const;
 
   // Returns true if a word having `key` and `value` should be suppressed.
-  // Returns false if the dictionary is locked.
   bool SuppressEntry(absl::string_view key, absl::string_view value) const;
 
  private:
-  using KeyValue = std::pair<std::string, std::string>;
-  using KeyValueView = std::pair<absl::string_view, absl::string_view>;
-  struct KeyValueHash : public absl::Hash<KeyValueView> {
-    using is_transparent = void;
-  };
-  struct KeyValueEq : public std::equal_to<KeyValueView> {
-    using is_transparent = void;
-  };
-
-  absl::flat_hash_set<KeyValue, KeyValueHash, KeyValueEq> keys_values_
-      ABSL_GUARDED_BY(mutex_);
-  absl::flat_hash_set<std::string> keys_only_ ABSL_GUARDED_BY(mutex_);
-  absl::flat_hash_set<std::string> values_only_ ABSL_GUARDED_BY(mutex_);
-
-  mutable absl::Mutex mutex_;
+  class Snapshot;
+
+  // Returns the published contents.
+  std::shared_ptr<const Snapshot> GetSnapshot() const
+      ABSL_LOCKS_EXCLUDED(snapshot_mutex_);
+
+  // The published contents. nullptr when the dictionary is empty, which is the
+  // case for almost all users. |snapshot_mutex_| guards only the pointer and is
+  // never held while the contents are edited.
+  mutable absl::Mutex snapshot_mutex_;
+  std::shared_ptr<const Snapshot> snapshot_ ABSL_GUARDED_BY(snapshot_mutex_);
+  // The contents being edited by the producer thread.
+  std::unique_ptr<Snapshot> pending_ ABSL_GUARDED_BY(mutex_);
+
+  absl::Mutex mutex_;
 };
 
 class ABSL_SCOPED_LOCKABLE SuppressionDictionaryLock final {
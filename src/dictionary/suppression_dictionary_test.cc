@@ -51,7 +51,7 @@ TEST(SuppressionDictionary, BasicTest) {
 
   // repeat 10 times
   for (int i = 0; i < 10; ++i) {
-    // IsEmpty() returns always true when dic is locked
+    // Edits are not visible until the lock is released.
     {
       const SuppressionDictionaryLock l(&dic);
       EXPECT_TRUE(dic.IsEmpty());
@@ -68,10 +68,10 @@ TEST(SuppressionDictionary, BasicTest) {
 
     EXPECT_FALSE(dic.IsEmpty());
 
-    // locked now => SuppressEntry always returns false
+    // The published entries are visible even while the dictionary is locked.
     {
       const SuppressionDictionaryLock l(&dic);
-      EXPECT_FALSE(dic.SuppressEntry("key1", "value1"));
+      EXPECT_TRUE(dic.SuppressEntry("key1", "value1"));
     }
 
     EXPECT_TRUE(dic.SuppressEntry("key1", "value1"));
@@ -98,7 +98,42 @@ TEST(SuppressionDictionary, BasicTest) {
     {
       const SuppressionDictionaryLock l(&dic);
       dic.Clear();
+      EXPECT_FALSE(dic.IsEmpty());
+      EXPECT_TRUE(dic.SuppressEntry("key1", "value1"));
     }
+    EXPECT_TRUE(dic.IsEmpty());
+    EXPECT_FALSE(dic.SuppressEntry("key1", "value1"));
+  }
+}
+
+TEST(SuppressionDictionary, AddEntryKeepsPublishedEntries) {
+  SuppressionDictionary dic;
+  {
+    const SuppressionDictionaryLock l(&dic);
+    EXPECT_TRUE(dic.AddEntry("key1", "value1"));
+  }
+  {
+    const SuppressionDictionaryLock l(&dic);
+    EXPECT_TRUE(dic.AddEntry("key2", ""));
+  }
+  EXPECT_TRUE(dic.SuppressEntry("key1", "value1"));
+  EXPECT_TRUE(dic.SuppressEntry("key2", "value2"));
+  EXPECT_FALSE(dic.SuppressEntry("key3", "value3"));
+}
+
+TEST(SuppressionDictionary, ManyEntries) {
+  SuppressionDictionary dic;
+  {
+    const SuppressionDictionaryLock l(&dic);
+    for (int i = 0; i < 10000; ++i) {
+      EXPECT_TRUE(dic.AddEntry(absl::StrCat("key", i), absl::StrCat("v", i)));
+    }
+  }
+  for (int i = 0; i < 10000; ++i) {
+    EXPECT_TRUE(
+        dic.SuppressEntry(absl::StrCat("key", i), absl::StrCat("v", i)));
+    EXPECT_FALSE(
+        dic.SuppressEntry(absl::StrCat("key", i), absl::StrCat("v", i + 1)));
   }
 }
 
@@ -82,6 +82,11 @@ constexpr char kKeySectionName[] = "k";
 constexpr char kValueSectionName[] = "v";
 constexpr char kTokensSectionName[] = "t";
 constexpr char kPosSectionName[] = "p";
+constexpr char kKeyIndexSectionName[] = "ki";
+constexpr char kValueIndexSectionName[] = "vi";
+constexpr char kTokensIndexSectionName[] = "ti";
+constexpr char kReverseLookupSectionName[] = "r";
+constexpr char kCostsSectionName[] = "c";
 
 //// Constants for validation ////
 // 12 bits
@@ -215,6 +220,26 @@ std::string SystemDictionaryCodec::GetSectionNameForPos() const {
   return kPosSectionName;
 }
 
+std::string SystemDictionaryCodec::GetSectionNameForKeyIndex() const {
+  return kKeyIndexSectionName;
+}
+
+std::string SystemDictionaryCodec::GetSectionNameForValueIndex() const {
+  return kValueIndexSectionName;
+}
+
+std::string SystemDictionaryCodec::GetSectionNameForTokensIndex() const {
+  return kTokensIndexSectionName;
+}
+
+std::string SystemDictionaryCodec::GetSectionNameForReverseLookup() const {
+  return kReverseLookupSectionName;
+}
+
+std::string SystemDictionaryCodec::GetSectionNameForCosts() const {
+  return kCostsSectionName;
+}
+
 void SystemDictionaryCodec::EncodeKey(const absl::string_view src,
                                       std::string *dst) const {
   EncodeDecodeKeyImpl(src, dst);
@@ -55,6 +55,17 @@ class SystemDictionaryCodec : public SystemDictionaryCodecInterface {
   // Return section name for frequent pos map
   std::string GetSectionNameForPos() const override;
 
+  // Return section names for precomputed rank/select directories
+  std::string GetSectionNameForKeyIndex() const override;
+  std::string GetSectionNameForValueIndex() const override;
+  std::string GetSectionNameForTokensIndex() const override;
+
+  // Return section name for reverse lookup index
+  std::string GetSectionNameForReverseLookup() const override;
+
+  // Return section name for the minimum costs of keys and subtrees
+  std::string GetSectionNameForCosts() const override;
+
   // Compresses key string into small bytes.
   void EncodeKey(absl::string_view src, std::string *dst) const override;
 
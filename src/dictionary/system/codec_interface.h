@@ -65,6 +65,19 @@ class SystemDictionaryCodecInterface {
   // Return section name for frequent pos map
   virtual std::string GetSectionNameForPos() const = 0;
 
+  // Return section names for the rank/select directories of key trie, value
+  // trie and tokens array, which are precomputed at build time
+  virtual std::string GetSectionNameForKeyIndex() const = 0;
+  virtual std::string GetSectionNameForValueIndex() const = 0;
+  virtual std::string GetSectionNameForTokensIndex() const = 0;
+
+  // Return section name for reverse lookup index
+  virtual std::string GetSectionNameForReverseLookup() const = 0;
+
+  // Return section name for the minimum token costs of keys and key trie
+  // subtrees
+  virtual std::string GetSectionNameForCosts() const = 0;
+
   // Encode value(word) string
   virtual void EncodeValue(absl::string_view src, std::string *dst) const = 0;
 
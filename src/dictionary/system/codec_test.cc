@@ -321,6 +321,13 @@ class SystemDictionaryCodecMock : public SystemDictionaryCodecInterface {
   std::string GetSectionNameForValue() const override { return "Mock"; }
   std::string GetSectionNameForTokens() const override { return "Mock"; }
   std::string GetSectionNameForPos() const override { return "Mock"; }
+  std::string GetSectionNameForKeyIndex() const override { return "Mock"; }
+  std::string GetSectionNameForValueIndex() const override { return "Mock"; }
+  std::string GetSectionNameForTokensIndex() const override { return "Mock"; }
+  std::string GetSectionNameForReverseLookup() const override {
+    return "Mock";
+  }
+  std::string GetSectionNameForCosts() const override { return "Mock"; }
   void EncodeKey(const absl::string_view src, std::string *dst) const override {
   }
   void DecodeKey(const absl::string_view src, std::string *dst) const override {
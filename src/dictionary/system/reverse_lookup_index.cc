@@ -0,0 +1,133 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "dictionary/system/reverse_lookup_index.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "dictionary/system/codec_interface.h"
+#include "dictionary/system/token_scan_iterator.h"
+#include "storage/louds/bit_vector_based_array.h"
+
+namespace mozc {
+namespace dictionary {
+
+std::unique_ptr<ReverseLookupIndex> ReverseLookupIndex::Build(
+    const SystemDictionaryCodecInterface *codec,
+    const storage::louds::BitVectorBasedArray &token_array) {
+  // Counts the tokens for each value ID.
+  std::vector<uint32_t> counts;
+  for (TokenScanIterator iter(codec, token_array); !iter.Done(); iter.Next()) {
+    const int value_id = iter.Get().value_id;
+    if (value_id == -1) {
+      continue;
+    }
+    if (static_cast<size_t>(value_id) >= counts.size()) {
+      counts.resize(value_id + 1, 0);
+    }
+    ++counts[value_id];
+  }
+
+  const size_t num_value_ids = counts.size();
+  size_t num_key_ids = 0;
+  for (const uint32_t count : counts) {
+    num_key_ids += count;
+  }
+
+  // Fills the header and the offsets, then the key IDs in the scan order.
+  std::vector<uint32_t> buffer(1 + (num_value_ids + 1) + num_key_ids);
+  buffer[0] = num_value_ids;
+  uint32_t *offsets = buffer.data() + 1;
+  uint32_t *key_ids = offsets + num_value_ids + 1;
+  offsets[0] = 0;
+  for (size_t i = 0; i < num_value_ids; ++i) {
+    offsets[i + 1] = offsets[i] + counts[i];
+  }
+  // Reuse |counts| as the next positions to fill.
+  std::copy(offsets, offsets + num_value_ids, counts.begin());
+  for (TokenScanIterator iter(codec, token_array); !iter.Done(); iter.Next()) {
+    const TokenScanIterator::Result &result = iter.Get();
+    if (result.value_id != -1) {
+      key_ids[counts[result.value_id]++] = result.index;
+    }
+  }
+
+  std::unique_ptr<ReverseLookupIndex> index(new ReverseLookupIndex());
+  index->buffer_ = std::move(buffer);
+  CHECK(index->Init(
+      absl::string_view(reinterpret_cast<const char *>(index->buffer_.data()),
+                        index->buffer_.size() * sizeof(uint32_t))));
+  return index;
+}
+
+std::unique_ptr<ReverseLookupIndex> ReverseLookupIndex::Open(
+    absl::string_view image) {
+  std::unique_ptr<ReverseLookupIndex> index(new ReverseLookupIndex());
+  if (!index->Init(image)) {
+    return nullptr;
+  }
+  return index;
+}
+
+bool ReverseLookupIndex::Init(absl::string_view image) {
+  DCHECK_EQ(reinterpret_cast<uintptr_t>(image.data()) % 4, 0);
+  if (image.size() % 4 != 0 || image.size() < 8) {
+    return false;
+  }
+  const absl::Span<const uint32_t> words(
+      reinterpret_cast<const uint32_t *>(image.data()), image.size() / 4);
+  const size_t num_value_ids = words[0];
+  if (words.size() < 2 + num_value_ids) {
+    return false;
+  }
+  const absl::Span<const uint32_t> offsets =
+      words.subspan(1, num_value_ids + 1);
+  const absl::Span<const uint32_t> key_ids = words.subspan(2 + num_value_ids);
+  // Only the both ends are checked to keep opening O(1).  Like the other
+  // sections, the content is trusted as it's generated by the builder.
+  if (offsets.front() != 0 || offsets.back() != key_ids.size()) {
+    return false;
+  }
+  image_ = image;
+  offsets_ = offsets;
+  key_ids_ = key_ids;
+  return true;
+}
+
+}  // namespace dictionary
+}  // namespace mozc
@@ -0,0 +1,103 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef MOZC_DICTIONARY_SYSTEM_REVERSE_LOOKUP_INDEX_H_
+#define MOZC_DICTIONARY_SYSTEM_REVERSE_LOOKUP_INDEX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "dictionary/system/codec_interface.h"
+#include "storage/louds/bit_vector_based_array.h"
+
+namespace mozc {
+namespace dictionary {
+
+// Mapping from the ID in value trie to the IDs in key trie of the tokens
+// having the value, used for reverse lookup (value to reading).  The mapping
+// is stored in the compressed sparse row format of 32-bit words:
+//
+// [number of value IDs: N]
+// [offsets: N + 1 words]
+// [key IDs: "offsets[N]" words]
+//
+// where the key IDs of value ID |i| are in [offsets[i], offsets[i + 1]), in
+// the order of the tokens in the token array.  A key ID appears as many times
+// as the key has tokens with the value.  The image is built by
+// SystemDictionaryBuilder and stored as a section of the dictionary file, so
+// that the index can be opened without scanning the token array.
+class ReverseLookupIndex {
+ public:
+  ReverseLookupIndex(const ReverseLookupIndex &) = delete;
+  ReverseLookupIndex &operator=(const ReverseLookupIndex &) = delete;
+  ~ReverseLookupIndex() = default;
+
+  // Builds the index on the heap by scanning all the tokens in |token_array|.
+  static std::unique_ptr<ReverseLookupIndex> Build(
+      const SystemDictionaryCodecInterface *codec,
+      const storage::louds::BitVectorBasedArray &token_array);
+
+  // Opens the index image written by image().  The |image| is not copied, so
+  // it needs to be aligned to 32-bits and to outlive the returned instance.
+  // Returns nullptr if |image| is broken.
+  static std::unique_ptr<ReverseLookupIndex> Open(absl::string_view image);
+
+  // Returns the key IDs of the tokens whose value ID is |value_id|.
+  absl::Span<const uint32_t> GetKeyIds(int value_id) const {
+    if (value_id < 0 || static_cast<size_t>(value_id) + 1 >= offsets_.size()) {
+      return {};
+    }
+    return key_ids_.subspan(offsets_[value_id],
+                            offsets_[value_id + 1] - offsets_[value_id]);
+  }
+
+  // Returns the serialized image of this index.
+  absl::string_view image() const { return image_; }
+
+ private:
+  ReverseLookupIndex() = default;
+
+  // Sets up the views over |image|.  Returns false if |image| is broken.
+  bool Init(absl::string_view image);
+
+  std::vector<uint32_t> buffer_;  // Owns the image built by Build().
+  absl::string_view image_;
+  absl::Span<const uint32_t> offsets_;
+  absl::Span<const uint32_t> key_ids_;
+};
+
+}  // namespace dictionary
+}  // namespace mozc
+
+#endif  // MOZC_DICTIONARY_SYSTEM_REVERSE_LOOKUP_INDEX_H_
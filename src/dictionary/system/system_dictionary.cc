@@ -64,6 +64,8 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "base/bits.h"
 #include "base/japanese_util.h"
 #include "base/mmap.h"
 #include "base/strings/unicode.h"
@@ -75,7 +77,10 @@
 #include "dictionary/file/dictionary_file.h"
 #include "dictionary/system/codec_interface.h"
 #include "dictionary/system/key_expansion_table.h"
+#include "dictionary/system/reverse_lookup_index.h"
 #include "dictionary/system/token_decode_iterator.h"
+#include "dictionary/system/token_scan_iterator.h"
+#include "dictionary/system/trie_cache_sizes.h"
 #include "dictionary/system/words_info.h"
 #include "request/conversion_request.h"
 #include "storage/louds/bit_vector_based_array.h"
@@ -89,22 +94,50 @@ using ::mozc::storage::louds::LoudsTrie;
 
 namespace {
 
-constexpr int kMinTokenArrayBlobSize = 4;
-
-// TODO(noriyukit): The following parameters may not be well optimized.  In our
-// experiments, Select1 is computational burden, so increasing cache size for
-// lb1/select1 may improve performance.
-constexpr size_t kKeyTrieLb0CacheSize = 1 * 1024;
-constexpr size_t kKeyTrieLb1CacheSize = 1 * 1024;
-constexpr size_t kKeyTrieSelect0CacheSize = 4 * 1024;
-constexpr size_t kKeyTrieSelect1CacheSize = 4 * 1024;
-constexpr size_t kKeyTrieTermvecCacheSize = 1 * 1024;
+// Opens |trie| with the rank/select directories precomputed at build time if
+// the dictionary has them.  Otherwise, computes them with |cache_sizes|.
+bool OpenTrie(const uint8_t *image, const char *index_image,
+              int index_image_size, const TrieCacheSizes &cache_sizes,
+              LoudsTrie *trie) {
+  if (index_image != nullptr &&
+      trie->OpenWithIndexImage(
+          image, reinterpret_cast<const uint8_t *>(index_image),
+          index_image_size)) {
+    return true;
+  }
+  return trie->Open(image, cache_sizes.lb0, cache_sizes.lb1,
+                    cache_sizes.select0, cache_sizes.select1,
+                    cache_sizes.termvec_lb1);
+}
 
-constexpr size_t kValueTrieLb0CacheSize = 1 * 1024;
-constexpr size_t kValueTrieLb1CacheSize = 1 * 1024;
-constexpr size_t kValueTrieSelect0CacheSize = 1 * 1024;
-constexpr size_t kValueTrieSelect1CacheSize = 16 * 1024;
-constexpr size_t kValueTrieTermvecCacheSize = 4 * 1024;
+// Initializes the views of the costs image written by SystemDictionaryBuilder
+// for |key_trie|. The format is as follows:
+// [number of nodes: 4 bytes]
+// [number of keys: 4 bytes]
+// [subtree costs: "number of nodes" * 2 bytes]
+// [key costs: "number of keys" * 2 bytes]
+// Returns false if the image is broken or built for another key trie.
+bool InitCosts(absl::string_view image, const LoudsTrie &key_trie,
+               absl::Span<const uint16_t> *subtree_costs,
+               absl::Span<const uint16_t> *key_costs) {
+  if (image.size() < 8) {
+    return false;
+  }
+  const char *ptr = image.data();
+  const size_t num_nodes = LoadUnalignedAdvance<uint32_t>(ptr);
+  const size_t num_keys = LoadUnalignedAdvance<uint32_t>(ptr);
+  if (num_nodes != static_cast<size_t>(key_trie.GetNumNodes()) ||
+      num_keys != static_cast<size_t>(key_trie.GetNumKeys())) {
+    return false;
+  }
+  if (image.size() < 8 + (num_nodes + num_keys) * sizeof(uint16_t)) {
+    return false;
+  }
+  const uint16_t *costs = reinterpret_cast<const uint16_t *>(ptr);
+  *subtree_costs = absl::MakeConstSpan(costs, num_nodes);
+  *key_costs = absl::MakeConstSpan(costs + num_nodes, num_keys);
+  return true;
+}
 
 // Expansion table format:
 // "<Character to expand>[<Expanded character 1><Expanded character 2>...]"
@@ -152,97 +185,6 @@ inline const uint8_t *GetTokenArrayPtr(const BitVectorBasedArray &token_array,
   return reinterpret_cast<const uint8_t *>(token_array.Get(key_id, &length));
 }
 
-// Iterator for scanning token array.
-// This iterator does not return actual token info but returns
-// id data and the position only.
-// This will be used only for reverse lookup.
-// Forward lookup does not need such iterator because it can access
-// a token directly without linear scan.
-//
-//  Usage:
-//    for (TokenScanIterator iter(codec_, token_array_);
-//         !iter.Done(); iter.Next()) {
-//      const TokenScanIterator::Result &result = iter.Get();
-//      // Do something with |result|.
-//    }
-class TokenScanIterator {
- public:
-  struct Result {
-    // Value id for the current token
-    int value_id;
-    // Index (= key id) for the current token
-    int index;
-    // Offset from the tokens section beginning.
-    // (token_array_->Get(id_in_key_trie) ==
-    //  token_array_->Get(0) + tokens_offset)
-    int tokens_offset;
-  };
-
-  TokenScanIterator(const TokenScanIterator &) = delete;
-  TokenScanIterator &operator=(const TokenScanIterator &) = delete;
-  TokenScanIterator(const SystemDictionaryCodecInterface *codec,
-                    const BitVectorBasedArray &token_array)
-      : codec_(codec),
-        termination_flag_(codec->GetTokensTerminationFlag()),
-        state_(HAS_NEXT),
-        offset_(0),
-        tokens_offset_(0),
-        index_(0) {
-    encoded_tokens_ptr_ = GetTokenArrayPtr(token_array, 0);
-    NextInternal();
-  }
-
-  ~TokenScanIterator() = default;
-
-  const Result &Get() const { return result_; }
-
-  bool Done() const { return state_ == DONE; }
-
-  void Next() {
-    DCHECK_NE(state_, DONE);
-    NextInternal();
-  }
-
- private:
-  enum State {
-    HAS_NEXT,
-    DONE,
-  };
-
-  void NextInternal() {
-    if (encoded_tokens_ptr_[offset_] == termination_flag_) {
-      state_ = DONE;
-      return;
-    }
-    int read_bytes;
-    result_.value_id = -1;
-    result_.index = index_;
-    result_.tokens_offset = tokens_offset_;
-    const bool is_last_token = !(codec_->ReadTokenForReverseLookup(
-        encoded_tokens_ptr_ + offset_, &result_.value_id, &read_bytes));
-    if (is_last_token) {
-      int tokens_size = offset_ + read_bytes - tokens_offset_;
-      if (tokens_size < kMinTokenArrayBlobSize) {
-        tokens_size = kMinTokenArrayBlobSize;
-      }
-      tokens_offset_ += tokens_size;
-      ++index_;
-      offset_ = tokens_offset_;
-    } else {
-      offset_ += read_bytes;
-    }
-  }
-
-  const SystemDictionaryCodecInterface *codec_;
-  const uint8_t *encoded_tokens_ptr_;
-  const uint8_t termination_flag_;
-  State state_;
-  Result result_;
-  int offset_;
-  int tokens_offset_;
-  int index_;
-};
-
 struct ReverseLookupResult {
   ReverseLookupResult() : tokens_offset(-1), id_in_key_trie(-1) {}
   // Offset from the tokens section beginning.
@@ -273,97 +215,6 @@ class SystemDictionary::ReverseLookupCache {
   std::multimap<int, ReverseLookupResult> results;
 };
 
-class SystemDictionary::ReverseLookupIndex {
- public:
-  ReverseLookupIndex(const ReverseLookupIndex &) = delete;
-  ReverseLookupIndex &operator=(const ReverseLookupIndex &) = delete;
-  ReverseLookupIndex(const SystemDictionaryCodecInterface *codec,
-                     const BitVectorBasedArray &token_array) {
-    // Gets id size.
-    int value_id_max = -1;
-    for (TokenScanIterator iter(codec, token_array); !iter.Done();
-         iter.Next()) {
-      const TokenScanIterator::Result &result = iter.Get();
-      value_id_max = std::max(value_id_max, result.value_id);
-    }
-
-    CHECK_GE(value_id_max, 0);
-    index_size_ = value_id_max + 1;
-    index_ = std::make_unique<ReverseLookupResultArray[]>(index_size_);
-
-    // Gets result size for each ids.
-    for (TokenScanIterator iter(codec, token_array); !iter.Done();
-         iter.Next()) {
-      const TokenScanIterator::Result &result = iter.Get();
-      if (result.value_id != -1) {
-        DCHECK_LT(result.value_id, index_size_);
-        ++(index_[result.value_id].size);
-      }
-    }
-
-    for (size_t i = 0; i < index_size_; ++i) {
-      index_[i].results =
-          std::make_unique<ReverseLookupResult[]>(index_[i].size);
-    }
-
-    // Builds index.
-    for (TokenScanIterator iter(codec, token_array); !iter.Done();
-         iter.Next()) {
-      const TokenScanIterator::Result &result = iter.Get();
-      if (result.value_id == -1) {
-        continue;
-      }
-
-      DCHECK_LT(result.value_id, index_size_);
-      ReverseLookupResultArray *result_array = &index_[result.value_id];
-
-      // Finds uninitialized result.
-      size_t result_index = 0;
-      for (result_index = 0; result_index < result_array->size;
-           ++result_index) {
-        const ReverseLookupResult &lookup_result =
-            result_array->results[result_index];
-        if (lookup_result.tokens_offset == -1 &&
-            lookup_result.id_in_key_trie == -1) {
-          result_array->results[result_index].tokens_offset =
-              result.tokens_offset;
-          result_array->results[result_index].id_in_key_trie = result.index;
-          break;
-        }
-      }
-    }
-
-    CHECK(index_ != nullptr);
-  }
-
-  ~ReverseLookupIndex() = default;
-
-  void FillResultMap(const absl::btree_set<int> &id_set,
-                     std::multimap<int, ReverseLookupResult> *result_map) {
-    for (absl::btree_set<int>::const_iterator id_itr = id_set.begin();
-         id_itr != id_set.end(); ++id_itr) {
-      const ReverseLookupResultArray &result_array = index_[*id_itr];
-      for (size_t i = 0; i < result_array.size; ++i) {
-        result_map->insert(std::make_pair(*id_itr, result_array.results[i]));
-      }
-    }
-  }
-
- private:
-  struct ReverseLookupResultArray {
-    ReverseLookupResultArray() : size(0) {}
-    // Use std::unique_ptr for reducing memory consumption as possible.
-    // Using vector requires 90 MB even when we call resize explicitly.
-    // On the other hand, std::unique_ptr requires 57 MB.
-    std::unique_ptr<ReverseLookupResult[]> results;
-    size_t size;
-  };
-
-  // Use scoped array for reducing memory consumption as possible.
-  std::unique_ptr<ReverseLookupResultArray[]> index_;
-  size_t index_size_;
-};
-
 struct SystemDictionary::PredictiveLookupSearchState {
   PredictiveLookupSearchState() : key_pos(0), num_expanded(0) {}
   PredictiveLookupSearchState(const storage::louds::LoudsTrie::Node &n,
@@ -434,8 +285,7 @@ SystemDictionary::Builder::Build() {
       return absl::InvalidArgumentError("Invalid spec type");
   }
 
-  if (!instance->OpenDictionaryFile(
-          (spec_->options & ENABLE_REVERSE_LOOKUP_INDEX) != 0)) {
+  if (!instance->OpenDictionaryFile(spec_->options)) {
     return absl::UnknownError("Failed to create system dictionary");
   }
 
@@ -451,14 +301,17 @@ SystemDictionary::SystemDictionary(
 
 SystemDictionary::~SystemDictionary() = default;
 
-bool SystemDictionary::OpenDictionaryFile(bool enable_reverse_lookup_index) {
+bool SystemDictionary::OpenDictionaryFile(Options options) {
   int len;
 
+  int index_len = 0;
+
   const uint8_t *key_image = reinterpret_cast<const uint8_t *>(
       dictionary_file_->GetSection(codec_->GetSectionNameForKey(), &len));
-  if (!key_trie_.Open(key_image, kKeyTrieLb0CacheSize, kKeyTrieLb1CacheSize,
-                      kKeyTrieSelect0CacheSize, kKeyTrieSelect1CacheSize,
-                      kKeyTrieTermvecCacheSize)) {
+  const char *key_index_image = dictionary_file_->GetSection(
+      codec_->GetSectionNameForKeyIndex(), &index_len);
+  if (!OpenTrie(key_image, key_index_image, index_len, kKeyTrieCacheSizes,
+                &key_trie_)) {
     LOG(ERROR) << "cannot open key trie";
     return false;
   }
@@ -467,17 +320,24 @@ bool SystemDictionary::OpenDictionaryFile(bool enable_reverse_lookup_index) {
 
   const uint8_t *value_image = reinterpret_cast<const uint8_t *>(
       dictionary_file_->GetSection(codec_->GetSectionNameForValue(), &len));
-  if (!value_trie_.Open(value_image, kValueTrieLb0CacheSize,
-                        kValueTrieLb1CacheSize, kValueTrieSelect0CacheSize,
-                        kValueTrieSelect1CacheSize,
-                        kValueTrieTermvecCacheSize)) {
+  const char *value_index_image = dictionary_file_->GetSection(
+      codec_->GetSectionNameForValueIndex(), &index_len);
+  if (!OpenTrie(value_image, value_index_image, index_len,
+                kValueTrieCacheSizes, &value_trie_)) {
     LOG(ERROR) << "can not open value trie";
     return false;
   }
 
   const unsigned char *token_image = reinterpret_cast<const unsigned char *>(
       dictionary_file_->GetSection(codec_->GetSectionNameForTokens(), &len));
-  token_array_.Open(token_image);
+  const char *token_index_image = dictionary_file_->GetSection(
+      codec_->GetSectionNameForTokensIndex(), &index_len);
+  if (token_index_image == nullptr ||
+      !token_array_.OpenWithIndexImage(
+          token_image, reinterpret_cast<const uint8_t *>(token_index_image),
+          index_len)) {
+    token_array_.Open(token_image);
+  }
 
   frequent_pos_ = reinterpret_cast<const uint32_t *>(
       dictionary_file_->GetSection(codec_->GetSectionNameForPos(), &len));
@@ -486,10 +346,31 @@ bool SystemDictionary::OpenDictionaryFile(bool enable_reverse_lookup_index) {
     return false;
   }
 
-  if (enable_reverse_lookup_index) {
+  const char *reverse_lookup_image = dictionary_file_->GetSection(
+      codec_->GetSectionNameForReverseLookup(), &len);
+  if (reverse_lookup_image != nullptr) {
+    reverse_lookup_index_ =
+        ReverseLookupIndex::Open(absl::string_view(reverse_lookup_image, len));
+    LOG_IF(ERROR, reverse_lookup_index_ == nullptr)
+        << "broken reverse lookup section";
+  }
+  if (options & ENABLE_REVERSE_LOOKUP_INDEX) {
     InitReverseLookupIndex();
   }
 
+  if (options & ENABLE_BEST_FIRST_PREDICTIVE_LOOKUP) {
+    const char *costs_image = dictionary_file_->GetSection(
+        codec_->GetSectionNameForCosts(), &len);
+    if (costs_image != nullptr) {
+      if (!InitCosts(absl::string_view(costs_image, len), key_trie_,
+                     &subtree_costs_, &key_costs_)) {
+        LOG(ERROR) << "broken costs section";
+        subtree_costs_ = {};
+        key_costs_ = {};
+      }
+    }
+  }
+
   return true;
 }
 
@@ -497,8 +378,7 @@ void SystemDictionary::InitReverseLookupIndex() {
   if (reverse_lookup_index_ != nullptr) {
     return;
   }
-  reverse_lookup_index_ =
-      std::make_unique<ReverseLookupIndex>(codec_, token_array_);
+  reverse_lookup_index_ = ReverseLookupIndex::Build(codec_, token_array_);
 }
 
 bool SystemDictionary::HasKey(absl::string_view key) const {
@@ -622,6 +502,89 @@ void SystemDictionary::CollectPredictiveNodesInBfsOrder(
   } while (!queue.empty());
 }
 
+void SystemDictionary::CollectPredictiveNodesInCostOrder(
+    absl::string_view encoded_key, const KeyExpansionTable &table, size_t limit,
+    std::vector<PredictiveLookupSearchState> *result) const {
+  // Traverse the nodes for |encoded_key| and its expanded keys.
+  std::vector<PredictiveLookupSearchState> states = {
+      PredictiveLookupSearchState(LoudsTrie::Node(), 0, 0)};
+  std::vector<PredictiveLookupSearchState> next_states;
+  for (size_t pos = 0; pos < encoded_key.size() && !states.empty(); ++pos) {
+    const char target_char = encoded_key[pos];
+    const ExpandedKey &chars = table.ExpandKey(target_char);
+    next_states.clear();
+    for (PredictiveLookupSearchState &state : states) {
+      for (key_trie_.MoveToFirstChild(&state.node);
+           key_trie_.IsValidNode(state.node);
+           key_trie_.MoveToNextSibling(&state.node)) {
+        const char c = key_trie_.GetEdgeLabelToParentNode(state.node);
+        if (!chars.IsHit(c)) {
+          continue;
+        }
+        next_states.emplace_back(
+            state.node, pos + 1,
+            state.num_expanded + static_cast<int>(c != target_char));
+      }
+    }
+    states.swap(next_states);
+  }
+
+  // Best-first search from the above nodes.  A subtree is visited in the order
+  // of its minimum cost, and a key is collected in the order of its own cost,
+  // so that the cheapest keys are found without visiting the other subtrees.
+  struct Entry {
+    uint16_t cost;
+    bool is_key;  // The key of |state.node| or the subtree rooted by it.
+    PredictiveLookupSearchState state;
+  };
+  // Ties are broken by keys first, then shorter keys, then smaller node IDs
+  // to keep the result deterministic.
+  const auto greater = [](const Entry &x, const Entry &y) {
+    if (x.cost != y.cost) {
+      return x.cost > y.cost;
+    }
+    if (x.is_key != y.is_key) {
+      return y.is_key;
+    }
+    if (x.state.key_pos != y.state.key_pos) {
+      return x.state.key_pos > y.state.key_pos;
+    }
+    return x.state.node.node_id() > y.state.node.node_id();
+  };
+  // InitCosts() has checked that the costs cover every node and key.
+  const auto subtree_cost = [this](const LoudsTrie::Node &node) -> uint16_t {
+    return subtree_costs_[node.node_id() - 1];
+  };
+  const auto key_cost = [this](const LoudsTrie::Node &node) -> uint16_t {
+    return key_costs_[key_trie_.GetKeyIdOfTerminalNode(node)];
+  };
+
+  std::priority_queue<Entry, std::vector<Entry>, decltype(greater)> queue(
+      greater);
+  for (const PredictiveLookupSearchState &state : states) {
+    queue.push({subtree_cost(state.node), false, state});
+  }
+  while (!queue.empty() && result->size() < limit) {
+    Entry entry = queue.top();
+    queue.pop();
+    if (entry.is_key) {
+      result->push_back(entry.state);
+      continue;
+    }
+    PredictiveLookupSearchState &state = entry.state;
+    if (key_trie_.IsTerminalNode(state.node)) {
+      queue.push({key_cost(state.node), true, state});
+    }
+    for (key_trie_.MoveToFirstChild(&state.node);
+         key_trie_.IsValidNode(state.node);
+         key_trie_.MoveToNextSibling(&state.node)) {
+      queue.push({subtree_cost(state.node), false,
+                  PredictiveLookupSearchState(state.node, state.key_pos + 1,
+                                              state.num_expanded)});
+    }
+  }
+}
+
 void SystemDictionary::LookupPredictive(
     absl::string_view key, const ConversionRequest &conversion_request,
     Callback *callback) const {
@@ -649,7 +612,12 @@ void SystemDictionary::LookupPredictive(
   constexpr size_t kLookupLimit = 64;
   std::vector<PredictiveLookupSearchState> result;
   result.reserve(kLookupLimit);
-  CollectPredictiveNodesInBfsOrder(encoded_key, table, kLookupLimit, &result);
+  if (subtree_costs_.empty()) {
+    CollectPredictiveNodesInBfsOrder(encoded_key, table, kLookupLimit, &result);
+  } else {
+    CollectPredictiveNodesInCostOrder(encoded_key, table, kLookupLimit,
+                                      &result);
+  }
 
   // Reused buffer and instances inside the following loop.
   char encoded_actual_key_buffer[LoudsTrie::kMaxDepth + 1];
@@ -1090,7 +1058,16 @@ void SystemDictionary::RegisterReverseLookupTokensForValue(
   ReverseLookupCache *results = nullptr;
   ReverseLookupCache non_cached_results;
   if (reverse_lookup_index_ != nullptr) {
-    reverse_lookup_index_->FillResultMap(id_set, &non_cached_results.results);
+    const uint8_t *encoded_tokens_ptr = GetTokenArrayPtr(token_array_, 0);
+    for (const int value_id : id_set) {
+      for (const uint32_t key_id : reverse_lookup_index_->GetKeyIds(value_id)) {
+        ReverseLookupResult result;
+        result.tokens_offset =
+            GetTokenArrayPtr(token_array_, key_id) - encoded_tokens_ptr;
+        result.id_in_key_trie = key_id;
+        non_cached_results.results.emplace(value_id, result);
+      }
+    }
     results = &non_cached_results;
   } else if (reverse_lookup_cache_ != nullptr &&
              reverse_lookup_cache_->IsAvailable(id_set)) {
@@ -49,6 +49,19 @@
         'key_expansion_table.h',
       ],
     },
+    {
+      'target_name': 'reverse_lookup_index',
+      'type': 'static_library',
+      'toolsets': ['target', 'host'],
+      'sources': [
+        'reverse_lookup_index.cc',
+      ],
+      'dependencies': [
+        '<(mozc_oss_src_dir)/base/base.gyp:base_core',
+        '<(mozc_oss_src_dir)/storage/louds/louds.gyp:bit_vector_based_array',
+        'system_dictionary_codec',
+      ],
+    },
     {
       'target_name': 'system_dictionary',
       'type': 'static_library',
@@ -66,6 +79,7 @@
         '<(mozc_oss_src_dir)/dictionary/file/dictionary_file.gyp:codec_factory',
         '<(mozc_oss_src_dir)/dictionary/file/dictionary_file.gyp:dictionary_file',
         'key_expansion_table',
+        'reverse_lookup_index',
         'system_dictionary_codec',
       ],
     },
@@ -94,12 +108,15 @@
       'dependencies': [
         '<(mozc_oss_src_dir)/base/base.gyp:base_core',
         '<(mozc_oss_src_dir)/base/base.gyp:japanese_util',
+        '<(mozc_oss_src_dir)/storage/louds/louds.gyp:bit_vector_based_array',
         '<(mozc_oss_src_dir)/storage/louds/louds.gyp:bit_vector_based_array_builder',
+        '<(mozc_oss_src_dir)/storage/louds/louds.gyp:louds_trie',
         '<(mozc_oss_src_dir)/storage/louds/louds.gyp:louds_trie_builder',
         '<(mozc_oss_src_dir)/dictionary/dictionary_base.gyp:pos_matcher',
         '<(mozc_oss_src_dir)/dictionary/dictionary_base.gyp:text_dictionary_loader',
         '<(mozc_oss_src_dir)/dictionary/file/dictionary_file.gyp:codec',
         '<(mozc_oss_src_dir)/dictionary/file/dictionary_file.gyp:codec_factory',
+        'reverse_lookup_index',
         'system_dictionary_codec',
       ],
     },
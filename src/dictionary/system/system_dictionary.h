@@ -39,11 +39,13 @@
 #include "absl/container/btree_set.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "dictionary/dictionary_interface.h"
 #include "dictionary/file/codec_interface.h"
 #include "dictionary/file/dictionary_file.h"
 #include "dictionary/system/codec_interface.h"
 #include "dictionary/system/key_expansion_table.h"
+#include "dictionary/system/reverse_lookup_index.h"
 #include "request/conversion_request.h"
 #include "storage/louds/bit_vector_based_array.h"
 #include "storage/louds/louds_trie.h"
@@ -59,7 +61,14 @@ class SystemDictionary : public DictionaryInterface {
     // If ENABLE_REVERSE_LOOKUP_INDEX is set, we will have the index in heap
     // from the id in value trie to the id in key trie.
     // That consumes more memory but we can perform reverse lookup more quickly.
+    // Dictionaries having the precomputed index section always use it
+    // regardless of this option.
     ENABLE_REVERSE_LOOKUP_INDEX = 1,
+    // If ENABLE_BEST_FIRST_PREDICTIVE_LOOKUP is set, LookupPredictive()
+    // collects the keys in ascending order of their minimum token cost by
+    // using the subtree costs stored in the dictionary, instead of in BFS
+    // order.  Dictionaries without the costs section ignore this option.
+    ENABLE_BEST_FIRST_PREDICTIVE_LOOKUP = 2,
   };
 
   // Builder class for system dictionary
@@ -158,13 +167,12 @@ class SystemDictionary : public DictionaryInterface {
 
  private:
   class ReverseLookupCache;
-  class ReverseLookupIndex;
   struct PredictiveLookupSearchState;
 
   SystemDictionary(const SystemDictionaryCodecInterface *codec,
                    const DictionaryFileCodecInterface *file_codec);
 
-  bool OpenDictionaryFile(bool enable_reverse_lookup_index);
+  bool OpenDictionaryFile(Options options);
 
   void RegisterReverseLookupTokensForT13N(absl::string_view value,
                                           Callback *callback) const;
@@ -187,6 +195,11 @@ class SystemDictionary : public DictionaryInterface {
   void CollectPredictiveNodesInBfsOrder(
       absl::string_view encoded_key, const KeyExpansionTable &table,
       size_t limit, std::vector<PredictiveLookupSearchState> *result) const;
+  // Collects at most |limit| terminal nodes in ascending order of the key
+  // costs by best-first search on the subtree costs.
+  void CollectPredictiveNodesInCostOrder(
+      absl::string_view encoded_key, const KeyExpansionTable &table,
+      size_t limit, std::vector<PredictiveLookupSearchState> *result) const;
 
   storage::louds::LoudsTrie key_trie_;
   storage::louds::LoudsTrie value_trie_;
@@ -197,6 +210,11 @@ class SystemDictionary : public DictionaryInterface {
   std::unique_ptr<DictionaryFile> dictionary_file_;
   mutable std::unique_ptr<ReverseLookupCache> reverse_lookup_cache_;
   std::unique_ptr<ReverseLookupIndex> reverse_lookup_index_;
+  // The minimum token costs of the key trie subtrees (indexed by node ID - 1)
+  // and of the keys (indexed by key ID).  Empty unless the best-first
+  // predictive lookup is enabled.
+  absl::Span<const uint16_t> subtree_costs_;
+  absl::Span<const uint16_t> key_costs_;
 };
 
 }  // namespace dictionary
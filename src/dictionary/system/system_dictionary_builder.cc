@@ -31,9 +31,11 @@
 
 #include <algorithm>
 #include <climits>
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <ios>
+#include <limits>
 #include <map>
 #include <memory>
 #include <ostream>
@@ -50,28 +52,49 @@
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "base/file_stream.h"
 #include "base/file_util.h"
 #include "base/japanese_util.h"
+#include "base/thread.h"
 #include "base/util.h"
 #include "base/vlog.h"
 #include "dictionary/dictionary_token.h"
 #include "dictionary/file/codec_interface.h"
 #include "dictionary/file/section.h"
 #include "dictionary/system/codec_interface.h"
+#include "dictionary/system/reverse_lookup_index.h"
+#include "dictionary/system/trie_cache_sizes.h"
 #include "dictionary/system/words_info.h"
+#include "storage/louds/bit_vector_based_array.h"
 #include "storage/louds/bit_vector_based_array_builder.h"
+#include "storage/louds/louds_trie.h"
 #include "storage/louds/louds_trie_builder.h"
 
 ABSL_FLAG(bool, preserve_intermediate_dictionary, false,
           "preserve inetemediate dictionary file.");
 ABSL_FLAG(int32_t, min_key_length_to_use_small_cost_encoding, 6,
           "minimum key length to use 1 byte cost encoding.");
+ABSL_FLAG(int32_t, system_dictionary_build_threads, 8,
+          "number of threads to build a system dictionary. The output is "
+          "the same regardless of this value.");
+ABSL_FLAG(bool, build_reverse_lookup_section, false,
+          "write the reverse lookup index, which reverse lookup uses instead "
+          "of scanning the token array.");
+ABSL_FLAG(bool, build_costs_section, false,
+          "write the subtree costs of the key trie, which "
+          "ENABLE_BEST_FIRST_PREDICTIVE_LOOKUP requires.");
 
 namespace mozc {
 namespace dictionary {
 namespace {
 
+// Inputs smaller than this are processed on the calling thread.
+constexpr size_t kMinItemsPerShard = 1024;
+
+// Costs are stored in 16 bits for the best-first predictive lookup.
+constexpr int kMaxStoredCost = std::numeric_limits<uint16_t>::max();
+
 struct TokenGreaterThan {
   bool operator()(const TokenInfo &lhs, const TokenInfo &rhs) const {
     if (lhs.token->lid != rhs.token->lid) {
@@ -87,6 +110,29 @@ struct TokenGreaterThan {
   }
 };
 
+// Calls `func(begin, end)` for the shards of [0, size) on worker threads and
+// waits for all of them. `func` must be safe to call concurrently for disjoint
+// ranges.
+template <typename Func>
+void ParallelForShards(size_t size, const Func &func) {
+  const size_t num_shards = std::max<int32_t>(
+      1, absl::GetFlag(FLAGS_system_dictionary_build_threads));
+  const size_t shard_size = (size + num_shards - 1) / num_shards;
+  if (num_shards == 1 || size < kMinItemsPerShard) {
+    func(0, size);
+    return;
+  }
+  std::vector<BackgroundFuture<void>> shards;
+  shards.reserve(num_shards);
+  for (size_t begin = 0; begin < size; begin += shard_size) {
+    const size_t end = std::min(size, begin + shard_size);
+    shards.emplace_back([&func, begin, end] { func(begin, end); });
+  }
+  for (const BackgroundFuture<void> &shard : shards) {
+    shard.Wait();
+  }
+}
+
 void WriteSectionToFile(const DictionaryFileSection &section,
                         const std::string &filename) {
   if (absl::Status s = FileUtil::SetContents(
@@ -96,6 +142,69 @@ void WriteSectionToFile(const DictionaryFileSection &section,
   }
 }
 
+// Returns the rank/select directories of the trie |image| with |cache_sizes|,
+// which SystemDictionary loads instead of computing them on open.
+std::string BuildTrieIndexImage(absl::string_view image,
+                                const TrieCacheSizes &cache_sizes) {
+  storage::louds::LoudsTrie trie;
+  trie.Open(reinterpret_cast<const uint8_t *>(image.data()), cache_sizes.lb0,
+            cache_sizes.lb1, cache_sizes.select0, cache_sizes.select1,
+            cache_sizes.termvec_lb1);
+  std::string index_image;
+  trie.AppendIndexImage(&index_image);
+  return index_image;
+}
+
+// Returns the image of the minimum costs of the keys and of the subtrees of the
+// key trie, which are used by the best-first predictive lookup.  The format is
+// as follows:
+// [number of nodes: 4 bytes]
+// [number of keys: 4 bytes]
+// [subtree costs: "number of nodes" * 2 bytes, indexed by node ID - 1]
+// [key costs: "number of keys" * 2 bytes, indexed by key ID]
+// [padding to 4 bytes]
+std::string BuildCostsImage(absl::string_view key_trie_image,
+                            absl::Span<const uint16_t> key_costs) {
+  using ::mozc::storage::louds::LoudsTrie;
+  LoudsTrie trie;
+  trie.Open(reinterpret_cast<const uint8_t *>(key_trie_image.data()));
+
+  // Enumerate the nodes in BFS order, which is the order of node IDs.
+  std::vector<LoudsTrie::Node> nodes = {LoudsTrie::Node()};
+  std::vector<int> parents = {-1};
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    DCHECK_EQ(nodes[i].node_id(), i + 1);
+    LoudsTrie::Node child = trie.MoveToFirstChild(nodes[i]);
+    for (; trie.IsValidNode(child); LoudsTrie::MoveToNextSibling(&child)) {
+      nodes.push_back(child);
+      parents.push_back(i);
+    }
+  }
+
+  std::vector<uint16_t> subtree_costs(nodes.size(), kMaxStoredCost);
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    if (trie.IsTerminalNode(nodes[i])) {
+      subtree_costs[i] = key_costs[trie.GetKeyIdOfTerminalNode(nodes[i])];
+    }
+  }
+  // Children always have larger IDs than their parents.
+  for (size_t i = nodes.size() - 1; i > 0; --i) {
+    uint16_t &parent_cost = subtree_costs[parents[i]];
+    parent_cost = std::min(parent_cost, subtree_costs[i]);
+  }
+
+  std::string image;
+  const uint32_t header[2] = {static_cast<uint32_t>(subtree_costs.size()),
+                              static_cast<uint32_t>(key_costs.size())};
+  image.append(reinterpret_cast<const char *>(header), sizeof(header));
+  image.append(reinterpret_cast<const char *>(subtree_costs.data()),
+               subtree_costs.size() * sizeof(uint16_t));
+  image.append(reinterpret_cast<const char *>(key_costs.data()),
+               key_costs.size() * sizeof(uint16_t));
+  image.resize((image.size() + 3) & ~size_t{3}, '\0');
+  return image;
+}
+
 }  // namespace
 
 void SystemDictionaryBuilder::BuildFromTokens(
@@ -112,9 +221,17 @@ void SystemDictionaryBuilder::BuildFromTokensInternal(
     std::vector<Token *> tokens) {
   KeyInfoList key_info_list = ReadTokens(std::move(tokens));
 
-  BuildFrequentPos(key_info_list);
-  BuildValueTrie(key_info_list);
-  BuildKeyTrie(key_info_list);
+  // The following three only read |key_info_list| and write to their own
+  // members, so they run concurrently.
+  {
+    BackgroundFuture<void> value_trie(
+        [this, &key_info_list] { BuildValueTrie(key_info_list); });
+    BackgroundFuture<void> key_trie(
+        [this, &key_info_list] { BuildKeyTrie(key_info_list); });
+    BuildFrequentPos(key_info_list);
+    value_trie.Wait();
+    key_trie.Wait();
+  }
 
   SetIdForValue(&key_info_list);
   SetIdForKey(&key_info_list);
@@ -163,6 +280,46 @@ void SystemDictionaryBuilder::WriteToStream(
       file_codec_->GetSectionName(codec_->GetSectionNameForPos()));
   sections.push_back(frequent_pos_section);
 
+  // Rank/select directories are precomputed here so that opening the
+  // dictionary doesn't need to scan the bit vectors nor allocate memory.
+  const std::string value_trie_index =
+      BuildTrieIndexImage(value_trie_builder_.image(), kValueTrieCacheSizes);
+  sections.emplace_back(
+      value_trie_index.data(), value_trie_index.size(),
+      file_codec_->GetSectionName(codec_->GetSectionNameForValueIndex()));
+  const std::string key_trie_index =
+      BuildTrieIndexImage(key_trie_builder_.image(), kKeyTrieCacheSizes);
+  sections.emplace_back(
+      key_trie_index.data(), key_trie_index.size(),
+      file_codec_->GetSectionName(codec_->GetSectionNameForKeyIndex()));
+  storage::louds::BitVectorBasedArray token_array;
+  token_array.Open(
+      reinterpret_cast<const uint8_t *>(token_array_builder_.image().data()));
+  std::string token_array_index;
+  token_array.AppendIndexImage(&token_array_index);
+  sections.emplace_back(
+      token_array_index.data(), token_array_index.size(),
+      file_codec_->GetSectionName(codec_->GetSectionNameForTokensIndex()));
+
+  // The following sections grow the data set by several MB, so they are
+  // written only for the data sets that use them.
+  // The reverse lookup index lets reverse lookup skip scanning the token array.
+  std::unique_ptr<ReverseLookupIndex> reverse_lookup_index;
+  if (absl::GetFlag(FLAGS_build_reverse_lookup_section)) {
+    reverse_lookup_index = ReverseLookupIndex::Build(codec_, token_array);
+    sections.emplace_back(
+        reverse_lookup_index->image().data(),
+        reverse_lookup_index->image().size(),
+        file_codec_->GetSectionName(codec_->GetSectionNameForReverseLookup()));
+  }
+  std::string costs_image;
+  if (absl::GetFlag(FLAGS_build_costs_section)) {
+    costs_image = BuildCostsImage(key_trie_builder_.image(), key_costs_);
+    sections.emplace_back(
+        costs_image.data(), costs_image.size(),
+        file_codec_->GetSectionName(codec_->GetSectionNameForCosts()));
+  }
+
   if (absl::GetFlag(FLAGS_preserve_intermediate_dictionary) &&
       !intermediate_output_file_base_path.empty()) {
     // Write out intermediate results to files.
@@ -332,20 +489,26 @@ void SystemDictionaryBuilder::BuildValueTrie(const KeyInfoList &key_info_list) {
 }
 
 void SystemDictionaryBuilder::SetIdForValue(KeyInfoList *key_info_list) const {
-  for (KeyInfo &key_info : *key_info_list) {
-    for (TokenInfo &token_info : key_info.tokens) {
-      std::string value_str;
-      codec_->EncodeValue(token_info.token->value, &value_str);
-      token_info.id_in_value_trie = value_trie_builder_.GetId(value_str);
+  ParallelForShards(key_info_list->size(), [&](size_t begin, size_t end) {
+    std::string value_str;
+    for (size_t i = begin; i < end; ++i) {
+      for (TokenInfo &token_info : (*key_info_list)[i].tokens) {
+        value_str.clear();
+        codec_->EncodeValue(token_info.token->value, &value_str);
+        token_info.id_in_value_trie = value_trie_builder_.GetId(value_str);
+      }
     }
-  }
+  });
 }
 
 void SystemDictionaryBuilder::SortTokenInfo(KeyInfoList *key_info_list) const {
-  for (KeyInfo &key_info : *key_info_list) {
-    std::sort(key_info.tokens.begin(), key_info.tokens.end(),
-              TokenGreaterThan());
-  }
+  ParallelForShards(key_info_list->size(), [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      KeyInfo &key_info = (*key_info_list)[i];
+      std::sort(key_info.tokens.begin(), key_info.tokens.end(),
+                TokenGreaterThan());
+    }
+  });
 }
 
 void SystemDictionaryBuilder::SetCostType(KeyInfoList *key_info_list) const {
@@ -445,11 +608,15 @@ void SystemDictionaryBuilder::BuildKeyTrie(const KeyInfoList &key_info_list) {
 }
 
 void SystemDictionaryBuilder::SetIdForKey(KeyInfoList *key_info_list) const {
-  for (KeyInfo &key_info : *key_info_list) {
+  ParallelForShards(key_info_list->size(), [&](size_t begin, size_t end) {
     std::string key_str;
-    codec_->EncodeKey(key_info.key, &key_str);
-    key_info.id_in_key_trie = key_trie_builder_.GetId(key_str);
-  }
+    for (size_t i = begin; i < end; ++i) {
+      KeyInfo &key_info = (*key_info_list)[i];
+      key_str.clear();
+      codec_->EncodeKey(key_info.key, &key_str);
+      key_info.id_in_key_trie = key_trie_builder_.GetId(key_str);
+    }
+  });
 }
 
 void SystemDictionaryBuilder::BuildTokenArray(
@@ -464,10 +631,33 @@ void SystemDictionaryBuilder::BuildTokenArray(
       id_to_keyinfo_table[id] = &key_info;
     }
 
-    for (const KeyInfo *key_info : id_to_keyinfo_table) {
-      std::string tokens_str;
-      codec_->EncodeTokens(key_info->tokens, &tokens_str);
+    // The costs are recorded as decoded, i.e., without the lower 8 bits for
+    // small cost encoding, so that they agree with what lookups see.
+    key_costs_.assign(id_to_keyinfo_table.size(), kMaxStoredCost);
+    for (size_t i = 0; i < id_to_keyinfo_table.size(); ++i) {
+      for (const TokenInfo &token_info : id_to_keyinfo_table[i]->tokens) {
+        int cost = std::clamp<int>(token_info.token->cost, 0, kMaxStoredCost);
+        if (token_info.cost_type == TokenInfo::CAN_USE_SMALL_ENCODING) {
+          cost &= ~0xff;
+        }
+        key_costs_[i] = std::min<int>(key_costs_[i], cost);
+      }
+    }
+
+    // Encoding is independent for each key, so it's done on worker threads.
+    // The results are added in the order of the key IDs afterwards.
+    std::vector<std::string> encoded_tokens(id_to_keyinfo_table.size());
+    ParallelForShards(
+        id_to_keyinfo_table.size(), [&](size_t begin, size_t end) {
+          for (size_t i = begin; i < end; ++i) {
+            codec_->EncodeTokens(id_to_keyinfo_table[i]->tokens,
+                                 &encoded_tokens[i]);
+          }
+        });
+    for (std::string &tokens_str : encoded_tokens) {
       token_array_builder_.Add(tokens_str);
+      // Release the memory as soon as it's copied to the builder.
+      std::string().swap(tokens_str);
     }
   }
 
@@ -110,6 +110,9 @@ class SystemDictionaryBuilder final {
   // mapping from {left_id, right_id} to POS index (0--255)
   std::map<uint32_t, int> frequent_pos_;
 
+  // The minimum cost of the tokens for each key ID.
+  std::vector<uint16_t> key_costs_;
+
   const SystemDictionaryCodecInterface *codec_ =
       SystemDictionaryCodecFactory::GetCodec();
   const DictionaryFileCodecInterface *file_codec_ =
@@ -32,6 +32,7 @@
 #include <algorithm>
 #include <cstdint>
 #include <cstdlib>
+#include <ios>
 #include <iterator>
 #include <limits>
 #include <memory>
@@ -41,12 +42,17 @@
 #include <vector>
 
 #include "absl/container/btree_set.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/flags/declare.h"
 #include "absl/flags/flag.h"
+#include "absl/flags/reflection.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
 #include "base/file/temp_dir.h"
+#include "base/file_stream.h"
 #include "base/file_util.h"
 #include "config/config_handler.h"
 #include "data_manager/testing/mock_data_manager.h"
@@ -54,7 +60,11 @@
 #include "dictionary/dictionary_mock.h"
 #include "dictionary/dictionary_test_util.h"
 #include "dictionary/dictionary_token.h"
+#include "dictionary/file/codec_factory.h"
+#include "dictionary/file/codec_interface.h"
+#include "dictionary/file/section.h"
 #include "dictionary/pos_matcher.h"
+#include "dictionary/system/codec_interface.h"
 #include "dictionary/system/system_dictionary_builder.h"
 #include "dictionary/text_dictionary_loader.h"
 #include "protocol/commands.pb.h"
@@ -69,6 +79,9 @@ ABSL_FLAG(int32_t, dictionary_test_size, 100000,
 ABSL_FLAG(int32_t, dictionary_reverse_lookup_test_size, 1000,
           "Number of tokens to run reverse lookup test.");
 ABSL_DECLARE_FLAG(int32_t, min_key_length_to_use_small_cost_encoding);
+ABSL_DECLARE_FLAG(int32_t, system_dictionary_build_threads);
+ABSL_DECLARE_FLAG(bool, build_reverse_lookup_section);
+ABSL_DECLARE_FLAG(bool, build_costs_section);
 
 namespace mozc {
 namespace dictionary {
@@ -176,6 +189,35 @@ std::unique_ptr<SystemDictionary> SystemDictionaryTest::BuildSystemDictionary(
   return SystemDictionary::Builder(dic_fn_).Build().value();
 }
 
+// Writes the dictionary |src| to |dst| without the sections precomputed at
+// build time, as the dictionaries built before they were introduced.
+void WriteDictionaryWithoutPrecomputedSections(const std::string &src,
+                                               const std::string &dst) {
+  const DictionaryFileCodecInterface *file_codec =
+      DictionaryFileCodecFactory::GetCodec();
+  const SystemDictionaryCodecInterface *codec =
+      SystemDictionaryCodecFactory::GetCodec();
+  const absl::flat_hash_set<std::string> precomputed_sections = {
+      file_codec->GetSectionName(codec->GetSectionNameForKeyIndex()),
+      file_codec->GetSectionName(codec->GetSectionNameForValueIndex()),
+      file_codec->GetSectionName(codec->GetSectionNameForTokensIndex()),
+      file_codec->GetSectionName(codec->GetSectionNameForReverseLookup()),
+  };
+
+  absl::StatusOr<std::string> image = FileUtil::GetContents(src);
+  ASSERT_OK(image);
+  std::vector<DictionaryFileSection> sections;
+  ASSERT_OK(file_codec->ReadSections(image->data(), image->size(), &sections));
+  sections.erase(std::remove_if(sections.begin(), sections.end(),
+                                [&](const DictionaryFileSection &section) {
+                                  return precomputed_sections.contains(
+                                      section.name);
+                                }),
+                 sections.end());
+  OutputFileStream ofs(dst, std::ios::binary | std::ios::out);
+  file_codec->WriteSections(sections, &ofs);
+}
+
 // Returns true if they seem to be same
 bool SystemDictionaryTest::CompareTokensForLookup(const Token &a,
                                                   const Token &b,
@@ -620,6 +662,151 @@ TEST_F(SystemDictionaryTest, LookupPredictiveCutOffEmulatingBFS) {
   EXPECT_FALSE(callback.IsFound(&tokens[1]));
 }
 
+TEST_F(SystemDictionaryTest, LookupPredictiveBestFirst) {
+  // Tokens whose costs are not monotonic in key length, under many other keys
+  // starting with "あ" from test data.
+  Token tokens[] = {
+      {"あいうえおか", "aiueoka", 0, 0, 0, Token::NONE},
+      {"あいうえお", "aiueo", 1, 0, 0, Token::NONE},
+      {"あい", "ai", 30000, 0, 0, Token::NONE},
+  };
+  std::vector<Token *> source_tokens = MakeTokenPointers(&tokens);
+  text_dict_.CollectTokens(&source_tokens);
+  absl::FlagSaver flag_saver;
+  absl::SetFlag(&FLAGS_build_costs_section, true);
+  BuildAndWriteSystemDictionary(source_tokens, 10000, dic_fn_);
+  std::unique_ptr<SystemDictionary> system_dic =
+      SystemDictionary::Builder(dic_fn_)
+          .SetOptions(SystemDictionary::ENABLE_BEST_FIRST_PREDICTIVE_LOOKUP)
+          .Build()
+          .value();
+  ASSERT_TRUE(system_dic);
+
+  // The cheap long keys are found despite the BFS cut-off, while the
+  // expensive short key is not.
+  CheckMultiTokensExistenceCallback callback(
+      {&tokens[0], &tokens[1], &tokens[2]});
+  system_dic->LookupPredictive("あ", convreq_, &callback);
+  EXPECT_TRUE(callback.IsFound(&tokens[0]));
+  EXPECT_TRUE(callback.IsFound(&tokens[1]));
+  EXPECT_FALSE(callback.IsFound(&tokens[2]));
+
+  // Keys are looked up in ascending order of their minimum costs.
+  CollectTokenCallback collect_callback;
+  system_dic->LookupPredictive("あ", convreq_, &collect_callback);
+  ASSERT_FALSE(collect_callback.tokens().empty());
+  int last_key_cost = 0;
+  absl::flat_hash_map<std::string, int> key_costs;
+  for (const Token &token : collect_callback.tokens()) {
+    auto [it, inserted] = key_costs.emplace(token.key, token.cost);
+    if (!inserted) {
+      it->second = std::min(it->second, token.cost);
+    }
+  }
+  std::string last_key;
+  for (const Token &token : collect_callback.tokens()) {
+    if (token.key == last_key) {
+      continue;
+    }
+    EXPECT_LE(last_key_cost, key_costs[token.key]) << token.key;
+    last_key_cost = key_costs[token.key];
+    last_key = token.key;
+  }
+}
+
+TEST_F(SystemDictionaryTest, LookupPredictiveBestFirstRejectsOtherCosts) {
+  std::vector<Token *> source_tokens;
+  text_dict_.CollectTokens(&source_tokens);
+  absl::FlagSaver flag_saver;
+  absl::SetFlag(&FLAGS_build_costs_section, true);
+  BuildAndWriteSystemDictionary(source_tokens, 10000, dic_fn_);
+  const std::string other_fn =
+      FileUtil::JoinPath(temp_dir_.path(), "other.dic");
+  BuildAndWriteSystemDictionary(source_tokens, 100, other_fn);
+
+  // Replaces the costs section with the one built for the other key trie.
+  const DictionaryFileCodecInterface *file_codec =
+      DictionaryFileCodecFactory::GetCodec();
+  const std::string costs_name = file_codec->GetSectionName(
+      SystemDictionaryCodecFactory::GetCodec()->GetSectionNameForCosts());
+  absl::StatusOr<std::string> image = FileUtil::GetContents(dic_fn_);
+  ASSERT_OK(image);
+  absl::StatusOr<std::string> other_image = FileUtil::GetContents(other_fn);
+  ASSERT_OK(other_image);
+  std::vector<DictionaryFileSection> sections, other_sections;
+  ASSERT_OK(file_codec->ReadSections(image->data(), image->size(), &sections));
+  ASSERT_OK(file_codec->ReadSections(other_image->data(), other_image->size(),
+                                     &other_sections));
+  const auto is_costs = [&](const DictionaryFileSection &section) {
+    return section.name == costs_name;
+  };
+  const auto costs = std::find_if(sections.begin(), sections.end(), is_costs);
+  const auto other_costs =
+      std::find_if(other_sections.begin(), other_sections.end(), is_costs);
+  ASSERT_NE(costs, sections.end());
+  ASSERT_NE(other_costs, other_sections.end());
+  *costs = *other_costs;
+  const std::string mismatched_fn =
+      FileUtil::JoinPath(temp_dir_.path(), "mismatched.dic");
+  {
+    OutputFileStream ofs(mismatched_fn, std::ios::binary | std::ios::out);
+    file_codec->WriteSections(sections, &ofs);
+  }
+
+  // The mismatched costs are rejected on open, and the lookup falls back to
+  // the default order.
+  std::unique_ptr<SystemDictionary> system_dic =
+      SystemDictionary::Builder(mismatched_fn)
+          .SetOptions(SystemDictionary::ENABLE_BEST_FIRST_PREDICTIVE_LOOKUP)
+          .Build()
+          .value();
+  std::unique_ptr<SystemDictionary> bfs_dic =
+      SystemDictionary::Builder(dic_fn_).Build().value();
+  CollectTokenCallback callback, bfs_callback;
+  system_dic->LookupPredictive("あ", convreq_, &callback);
+  bfs_dic->LookupPredictive("あ", convreq_, &bfs_callback);
+  ASSERT_FALSE(bfs_callback.tokens().empty());
+  ASSERT_EQ(callback.tokens().size(), bfs_callback.tokens().size());
+  for (size_t i = 0; i < callback.tokens().size(); ++i) {
+    EXPECT_TOKEN_EQ(callback.tokens()[i], bfs_callback.tokens()[i]);
+  }
+}
+
+TEST_F(SystemDictionaryTest, OptionalSectionsAreWrittenOnlyOnRequest) {
+  std::vector<Token *> source_tokens;
+  text_dict_.CollectTokens(&source_tokens);
+  const DictionaryFileCodecInterface *file_codec =
+      DictionaryFileCodecFactory::GetCodec();
+  const SystemDictionaryCodecInterface *codec =
+      SystemDictionaryCodecFactory::GetCodec();
+  const std::string reverse_lookup_name =
+      file_codec->GetSectionName(codec->GetSectionNameForReverseLookup());
+  const std::string costs_name =
+      file_codec->GetSectionName(codec->GetSectionNameForCosts());
+  const auto get_section_names = [&] {
+    BuildAndWriteSystemDictionary(source_tokens, 100, dic_fn_);
+    const std::string image = FileUtil::GetContents(dic_fn_).value();
+    std::vector<DictionaryFileSection> sections;
+    EXPECT_OK(file_codec->ReadSections(image.data(), image.size(), &sections));
+    absl::flat_hash_set<std::string> names;
+    for (const DictionaryFileSection &section : sections) {
+      names.insert(section.name);
+    }
+    return names;
+  };
+
+  absl::FlagSaver flag_saver;
+  absl::flat_hash_set<std::string> names = get_section_names();
+  EXPECT_FALSE(names.contains(reverse_lookup_name));
+  EXPECT_FALSE(names.contains(costs_name));
+
+  absl::SetFlag(&FLAGS_build_reverse_lookup_section, true);
+  absl::SetFlag(&FLAGS_build_costs_section, true);
+  names = get_section_names();
+  EXPECT_TRUE(names.contains(reverse_lookup_name));
+  EXPECT_TRUE(names.contains(costs_name));
+}
+
 TEST_F(SystemDictionaryTest, LookupExact) {
   const std::string k0 = "は";
   const std::string k1 = "はひふへほ";
@@ -723,38 +910,58 @@ TEST_F(SystemDictionaryTest, LookupReverse) {
 TEST_F(SystemDictionaryTest, LookupReverseIndex) {
   const std::vector<std::unique_ptr<Token>> &source_tokens =
       text_dict_.tokens();
+  absl::FlagSaver flag_saver;
+  absl::SetFlag(&FLAGS_build_reverse_lookup_section, true);
   BuildAndWriteSystemDictionary(MakeTokenPointers(&source_tokens),
                                 absl::GetFlag(FLAGS_dictionary_test_size),
                                 dic_fn_);
+  const std::string legacy_dic_fn =
+      FileUtil::JoinPath(temp_dir_.path(), "legacy.dic");
+  WriteDictionaryWithoutPrecomputedSections(dic_fn_, legacy_dic_fn);
 
+  // Reverse lookup by scanning tokens.
   std::unique_ptr<SystemDictionary> system_dic_without_index =
-      SystemDictionary::Builder(dic_fn_)
+      SystemDictionary::Builder(legacy_dic_fn)
           .SetOptions(SystemDictionary::NONE)
           .Build()
           .value();
   ASSERT_TRUE(system_dic_without_index)
-      << "Failed to open dictionary source:" << dic_fn_;
+      << "Failed to open dictionary source:" << legacy_dic_fn;
+  // Reverse lookup by the index built on open.
   std::unique_ptr<SystemDictionary> system_dic_with_index =
-      SystemDictionary::Builder(dic_fn_)
+      SystemDictionary::Builder(legacy_dic_fn)
           .SetOptions(SystemDictionary::ENABLE_REVERSE_LOOKUP_INDEX)
           .Build()
           .value();
   ASSERT_TRUE(system_dic_with_index)
+      << "Failed to open dictionary source:" << legacy_dic_fn;
+  // Reverse lookup by the index precomputed at build time.
+  std::unique_ptr<SystemDictionary> system_dic_with_precomputed_index =
+      SystemDictionary::Builder(dic_fn_)
+          .SetOptions(SystemDictionary::NONE)
+          .Build()
+          .value();
+  ASSERT_TRUE(system_dic_with_precomputed_index)
       << "Failed to open dictionary source:" << dic_fn_;
 
   int size = absl::GetFlag(FLAGS_dictionary_reverse_lookup_test_size);
   for (auto it = source_tokens.begin(); size > 0 && it != source_tokens.end();
        ++it, --size) {
     const Token &t = **it;
-    CollectTokenCallback callback1, callback2;
+    CollectTokenCallback callback1, callback2, callback3;
     system_dic_without_index->LookupReverse(t.value, convreq_, &callback1);
     system_dic_with_index->LookupReverse(t.value, convreq_, &callback2);
+    system_dic_with_precomputed_index->LookupReverse(t.value, convreq_,
+                                                     &callback3);
 
     const std::vector<Token> &tokens1 = callback1.tokens();
     const std::vector<Token> &tokens2 = callback2.tokens();
+    const std::vector<Token> &tokens3 = callback3.tokens();
     ASSERT_EQ(tokens1.size(), tokens2.size());
+    ASSERT_EQ(tokens1.size(), tokens3.size());
     for (size_t i = 0; i < tokens1.size(); ++i) {
       EXPECT_TOKEN_EQ(tokens1[i], tokens2[i]);
+      EXPECT_TOKEN_EQ(tokens1[i], tokens3[i]);
     }
   }
 }
@@ -963,6 +1170,36 @@ TEST_F(SystemDictionaryTest, ShouldNotUseSmallCostEncodingForHeteronyms) {
   }
 }
 
+TEST_F(SystemDictionaryTest, ImageIsIndependentOfBuildThreads) {
+  std::vector<Token *> source_tokens;
+  text_dict_.CollectTokens(&source_tokens);
+
+  const int32_t original_threads =
+      absl::GetFlag(FLAGS_system_dictionary_build_threads);
+  absl::SetFlag(&FLAGS_system_dictionary_build_threads, 1);
+  const std::string single_fn =
+      FileUtil::JoinPath(temp_dir_.path(), "single.dic");
+  BuildAndWriteSystemDictionary(source_tokens, source_tokens.size(),
+                                single_fn);
+  absl::StatusOr<std::string> single_image = FileUtil::GetContents(single_fn);
+  ASSERT_OK(single_image);
+
+  for (const int32_t threads : {2, 3, 8}) {
+    SCOPED_TRACE(threads);
+    absl::SetFlag(&FLAGS_system_dictionary_build_threads, threads);
+    const std::string multi_fn =
+        FileUtil::JoinPath(temp_dir_.path(), "multi.dic");
+    BuildAndWriteSystemDictionary(source_tokens, source_tokens.size(),
+                                  multi_fn);
+    absl::StatusOr<std::string> multi_image = FileUtil::GetContents(multi_fn);
+    ASSERT_OK(multi_image);
+    // Compares sizes first not to dump the whole images on failure.
+    ASSERT_EQ(multi_image->size(), single_image->size());
+    EXPECT_TRUE(*multi_image == *single_image);
+  }
+  absl::SetFlag(&FLAGS_system_dictionary_build_threads, original_threads);
+}
+
 }  // namespace
 }  // namespace dictionary
 }  // namespace mozc
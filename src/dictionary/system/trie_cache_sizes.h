@@ -0,0 +1,74 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// Cache sizes of the rank/select directories of the LOUDS tries in the system
+// dictionary.  They are shared by SystemDictionaryBuilder, which precomputes
+// the directories, and SystemDictionary, which computes them on open when the
+// precomputed ones are not available.
+
+#ifndef MOZC_DICTIONARY_SYSTEM_TRIE_CACHE_SIZES_H_
+#define MOZC_DICTIONARY_SYSTEM_TRIE_CACHE_SIZES_H_
+
+#include <cstddef>
+
+namespace mozc {
+namespace dictionary {
+
+struct TrieCacheSizes {
+  size_t lb0;
+  size_t lb1;
+  size_t select0;
+  size_t select1;
+  size_t termvec_lb1;
+};
+
+// TODO(noriyukit): The following parameters may not be well optimized.  In our
+// experiments, Select1 is computational burden, so increasing cache size for
+// lb1/select1 may improve performance.
+inline constexpr TrieCacheSizes kKeyTrieCacheSizes = {
+    .lb0 = 1 * 1024,
+    .lb1 = 1 * 1024,
+    .select0 = 4 * 1024,
+    .select1 = 4 * 1024,
+    .termvec_lb1 = 1 * 1024,
+};
+
+inline constexpr TrieCacheSizes kValueTrieCacheSizes = {
+    .lb0 = 1 * 1024,
+    .lb1 = 1 * 1024,
+    .select0 = 1 * 1024,
+    .select1 = 16 * 1024,
+    .termvec_lb1 = 4 * 1024,
+};
+
+}  // namespace dictionary
+}  // namespace mozc
+
+#endif  // MOZC_DICTIONARY_SYSTEM_TRIE_CACHE_SIZES_H_
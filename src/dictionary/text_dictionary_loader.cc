@@ -34,6 +34,7 @@
 #include "dictionary/text_dictionary_loader.h"
 
 #include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <iterator>
 #include <limits>
@@ -52,6 +53,7 @@
 #include "absl/strings/string_view.h"
 #include "base/japanese_util.h"
 #include "base/multifile.h"
+#include "base/thread.h"
 #include "base/util.h"
 #include "base/vlog.h"
 #include "dictionary/dictionary_token.h"
@@ -59,6 +61,8 @@
 
 ABSL_FLAG(int32_t, tokens_reserve_size, 1400000,
           "Reserve the specified size of token buffer in advance.");
+ABSL_FLAG(int32_t, text_dictionary_loader_threads, 8,
+          "Number of threads to parse dictionary files.");
 
 namespace mozc {
 namespace dictionary {
@@ -66,6 +70,10 @@ namespace {
 
 using ValueAndKey = std::pair<absl::string_view, absl::string_view>;
 
+// The number of lines read from the dictionary files at once before they are
+// parsed in parallel.
+constexpr size_t kLinesPerBatch = 64 * 1024;
+
 ValueAndKey ToValueAndKey(const std::unique_ptr<Token> &token) {
   return ValueAndKey(token->value, token->key);
 }
@@ -165,16 +173,57 @@ void TextDictionaryLoader::LoadWithLineLimit(
     tokens_.reserve(limit);
   }
 
-  // Read system dictionary.
+  // Read system dictionary. Lines are read in batches, and each batch is split
+  // into shards parsed on worker threads. The tokens are appended in the order
+  // of the lines, so the result doesn't depend on the number of threads.
   {
+    const size_t num_shards = std::max<int32_t>(
+        1, absl::GetFlag(FLAGS_text_dictionary_loader_threads));
     InputMultiFile file(dictionary_filename);
-    std::string line;
-    while (limit > 0 && file.ReadLine(&line)) {
-      Util::ChopReturns(&line);
-      std::unique_ptr<Token> token = ParseTSVLine(line);
-      if (token) {
-        tokens_.push_back(std::move(token));
-        --limit;
+    std::vector<std::string> lines;
+    std::vector<std::unique_ptr<Token>> parsed;
+    bool eof = false;
+    while (limit > 0 && !eof) {
+      lines.clear();
+      while (lines.size() < kLinesPerBatch) {
+        std::string &line = lines.emplace_back();
+        if (!file.ReadLine(&line)) {
+          lines.pop_back();
+          eof = true;
+          break;
+        }
+        Util::ChopReturns(&line);
+      }
+
+      parsed.clear();
+      parsed.resize(lines.size());
+      const auto parse = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          parsed[i] = ParseTSVLine(lines[i]);
+        }
+      };
+      if (num_shards == 1) {
+        parse(0, lines.size());
+      } else {
+        const size_t shard_size = (lines.size() + num_shards - 1) / num_shards;
+        std::vector<BackgroundFuture<void>> shards;
+        for (size_t begin = 0; begin < lines.size(); begin += shard_size) {
+          shards.emplace_back(parse, begin,
+                              std::min(lines.size(), begin + shard_size));
+        }
+        for (const BackgroundFuture<void> &shard : shards) {
+          shard.Wait();
+        }
+      }
+
+      for (std::unique_ptr<Token> &token : parsed) {
+        if (limit <= 0) {
+          break;
+        }
+        if (token) {
+          tokens_.push_back(std::move(token));
+          --limit;
+        }
       }
     }
     LOG(INFO) << tokens_.size() << " tokens from " << dictionary_filename;
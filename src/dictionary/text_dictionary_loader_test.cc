@@ -29,10 +29,14 @@
 
 #include "dictionary/text_dictionary_loader.h"
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "absl/flags/declare.h"
+#include "absl/flags/flag.h"
+#include "absl/strings/str_cat.h"
 #include "base/file/temp_dir.h"
 #include "base/file_util.h"
 #include "data_manager/testing/mock_data_manager.h"
@@ -42,6 +46,8 @@
 #include "testing/gunit.h"
 #include "testing/mozctest.h"
 
+ABSL_DECLARE_FLAG(int32_t, text_dictionary_loader_threads);
+
 namespace mozc {
 namespace dictionary {
 namespace {
@@ -219,6 +225,42 @@ TEST_F(TextDictionaryLoaderTest, LoadMultipleFilesTest) {
   }
 }
 
+TEST_F(TextDictionaryLoaderTest, TokenOrderIsIndependentOfThreads) {
+  // Spans more than one batch of lines read at once by the loader.
+  constexpr int kNumLines = 100000;
+  std::string lines;
+  for (int i = 0; i < kNumLines; ++i) {
+    absl::StrAppend(&lines, "key", i, "\t", i % 10, "\t", i % 20, "\t", i,
+                    "\tvalue", i, "\n");
+  }
+  const std::string filename = FileUtil::JoinPath(temp_dir_.path(), "test.tsv");
+  ASSERT_OK(FileUtil::SetContents(filename, lines));
+  FileUnlinker unlinker(filename);
+
+  const int32_t original_threads =
+      absl::GetFlag(FLAGS_text_dictionary_loader_threads);
+  for (const int32_t threads : {1, 3, 8}) {
+    SCOPED_TRACE(threads);
+    absl::SetFlag(&FLAGS_text_dictionary_loader_threads, threads);
+    for (const int limit : {kNumLines, kNumLines - 1, 70000}) {
+      SCOPED_TRACE(limit);
+      std::unique_ptr<TextDictionaryLoader> loader =
+          CreateTextDictionaryLoader();
+      loader->LoadWithLineLimit(filename, "", limit);
+      const std::vector<std::unique_ptr<Token>> &tokens = loader->tokens();
+      ASSERT_EQ(tokens.size(), limit);
+      for (int i = 0; i < limit; ++i) {
+        ASSERT_EQ(tokens[i]->key, absl::StrCat("key", i));
+        ASSERT_EQ(tokens[i]->value, absl::StrCat("value", i));
+        ASSERT_EQ(tokens[i]->lid, i % 10);
+        ASSERT_EQ(tokens[i]->rid, i % 20);
+        ASSERT_EQ(tokens[i]->cost, i);
+      }
+    }
+  }
+  absl::SetFlag(&FLAGS_text_dictionary_loader_threads, original_threads);
+}
+
 TEST_F(TextDictionaryLoaderTest, ReadingCorrectionTest) {
   std::unique_ptr<TextDictionaryLoader> loader = CreateTextDictionaryLoader();
 
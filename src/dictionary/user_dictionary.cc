@@ -32,6 +32,7 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <iterator>
 #include <limits>
 #include <memory>
 #include <optional>
@@ -46,10 +47,10 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/ascii.h"
-#include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "base/file_util.h"
 #include "base/hash.h"
 #include "base/singleton.h"
@@ -69,32 +70,14 @@
 #include "protocol/config.pb.h"
 #include "protocol/user_dictionary_storage.pb.h"
 #include "request/conversion_request.h"
+#include "storage/louds/louds_trie.h"
+#include "storage/louds/louds_trie_builder.h"
 #include "usage_stats/usage_stats.h"
 
 namespace mozc {
 namespace dictionary {
 namespace {
 
-struct OrderByKey {
-  bool operator()(const UserPos::Token &token, absl::string_view key) const {
-    return token.key < key;
-  }
-
-  bool operator()(absl::string_view key, const UserPos::Token &token) const {
-    return key < token.key;
-  }
-};
-
-struct OrderByKeyPrefix {
-  bool operator()(const UserPos::Token &token, absl::string_view prefix) const {
-    return absl::string_view(token.key).substr(0, prefix.size()) < prefix;
-  }
-
-  bool operator()(absl::string_view prefix, const UserPos::Token &token) const {
-    return prefix < absl::string_view(token.key).substr(0, prefix.size());
-  }
-};
-
 struct OrderByKeyThenById {
   bool operator()(const UserPos::Token &lhs, const UserPos::Token &rhs) const {
     const int comp = lhs.key.compare(rhs.key);
@@ -132,8 +115,13 @@ class UserDictionaryFileManager {
 
 }  // namespace
 
+// Index of user dictionary tokens. Distinct keys are stored in a LOUDS trie
+// and the tokens are grouped by the key ID of the trie, as SystemDictionary
+// does, so that prefix and exact lookups cost proportional to the key length.
 class UserDictionary::TokensIndex {
  public:
+  using TokenSpan = absl::Span<const UserPos::Token>;
+
   TokensIndex(const UserPosInterface *user_pos,
               SuppressionDictionary *suppression_dictionary)
       : user_pos_(user_pos), suppression_dictionary_(suppression_dictionary) {}
@@ -143,20 +131,53 @@ class UserDictionary::TokensIndex {
   bool empty() const { return user_pos_tokens_.empty(); }
   size_t size() const { return user_pos_tokens_.size(); }
 
-  std::vector<UserPos::Token>::const_iterator begin() const {
-    return user_pos_tokens_.begin();
+  // Returns the tokens whose key is exactly |key|, sorted by POS ID.
+  TokenSpan FindExact(absl::string_view key) const {
+    if (empty()) {
+      return TokenSpan();
+    }
+    const int key_id = key_trie_.ExactSearch(key);
+    return key_id < 0 ? TokenSpan() : GetTokens(key_id);
   }
-  std::vector<UserPos::Token>::const_iterator end() const {
-    return user_pos_tokens_.end();
+
+  // Calls |func| with the tokens of every key that is a prefix of |key|, from
+  // the shortest one. |func| returns false to stop the iteration.
+  template <typename Func>
+  void ForEachPrefix(absl::string_view key, Func func) const {
+    if (empty()) {
+      return;
+    }
+    storage::louds::LoudsTrie::Node node;
+    for (const char c : key) {
+      if (!key_trie_.MoveToChildByLabel(c, &node)) {
+        return;
+      }
+      if (key_trie_.IsTerminalNode(node) &&
+          !func(GetTokens(key_trie_.GetKeyIdOfTerminalNode(node)))) {
+        return;
+      }
+    }
+  }
+
+  // Calls |func| with the tokens of every key starting with |key|, in the
+  // lexicographical order of keys. |func| returns false to stop the iteration.
+  template <typename Func>
+  void ForEachPredictive(absl::string_view key, Func func) const {
+    if (empty()) {
+      return;
+    }
+    storage::louds::LoudsTrie::Node node;
+    if (!key_trie_.Traverse(key, &node)) {
+      return;
+    }
+    TraverseSubtree(node, func);
   }
 
   void Load(const user_dictionary::UserDictionaryStorage &storage) {
     user_pos_tokens_.clear();
     absl::flat_hash_set<uint64_t> seen;
     std::vector<UserPos::Token> tokens;
-
-    const SuppressionDictionaryLock l(suppression_dictionary_);
-    suppression_dictionary_->Clear();
+    std::vector<std::pair<std::string, std::string>> suppression_entries;
 
     for (const UserDictionaryStorage::UserDictionary &dic :
          storage.dictionaries()) {
@@ -192,7 +213,7 @@ class UserDictionary::TokensIndex {
 
         if (entry.pos() == user_dictionary::UserDictionary::SUPPRESSION_WORD) {
           // "抑制単語"
-          suppression_dictionary_->AddEntry(std::move(reading), entry.value());
+          suppression_entries.emplace_back(std::move(reading), entry.value());
         } else if (entry.pos() == user_dictionary::UserDictionary::NO_POS) {
           // In theory NO_POS works without this implementation, as it is
           // covered in the UserPos::GetTokens function. However, that function
@@ -231,11 +252,29 @@ class UserDictionary::TokensIndex {
         }
       }
     }
-    user_pos_tokens_.shrink_to_fit();
+    // The suppression dictionary is locked only while its entries are
+    // replaced. SuppressEntry() keeps reading the previous entries until the
+    // new ones are published on unlock.
+    {
+      const SuppressionDictionaryLock l(suppression_dictionary_);
+      suppression_dictionary_->Clear();
+      for (auto &[key, value] : suppression_entries) {
+        suppression_dictionary_->AddEntry(std::move(key), std::move(value));
+      }
+    }
+
+    // The key trie cannot hold empty keys.
+    user_pos_tokens_.erase(
+        std::remove_if(user_pos_tokens_.begin(), user_pos_tokens_.end(),
+                       [](const UserPos::Token &token) {
+                         return token.key.empty();
+                       }),
+        user_pos_tokens_.end());
 
     // Sort first by key and then by POS ID.
     std::sort(user_pos_tokens_.begin(), user_pos_tokens_.end(),
               OrderByKeyThenById());
+    BuildKeyTrie();
 
     MOZC_VLOG(1) << user_pos_tokens_.size() << " user dic entries loaded";
 
@@ -244,9 +283,94 @@ class UserDictionary::TokensIndex {
   }
 
  private:
+  TokenSpan GetTokens(int key_id) const {
+    DCHECK_GE(key_id, 0);
+    DCHECK_LT(key_id + 1, key_offsets_.size());
+    const uint32_t begin = key_offsets_[key_id];
+    return TokenSpan(user_pos_tokens_.data() + begin,
+                     key_offsets_[key_id + 1] - begin);
+  }
+
+  // Visits the terminal nodes under |node| in depth first order. As children
+  // are sorted by the edge label, keys are visited in lexicographical order.
+  template <typename Func>
+  bool TraverseSubtree(storage::louds::LoudsTrie::Node node, Func &func) const {
+    if (key_trie_.IsTerminalNode(node) &&
+        !func(GetTokens(key_trie_.GetKeyIdOfTerminalNode(node)))) {
+      return false;
+    }
+    for (key_trie_.MoveToFirstChild(&node); key_trie_.IsValidNode(node);
+         storage::louds::LoudsTrie::MoveToNextSibling(&node)) {
+      if (!TraverseSubtree(node, func)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Builds the key trie from |user_pos_tokens_| sorted by key, and reorders
+  // the tokens by the key ID so that tokens of a key are contiguous.
+  void BuildKeyTrie() {
+    key_offsets_.clear();
+    if (user_pos_tokens_.empty()) {
+      user_pos_tokens_.shrink_to_fit();
+      return;
+    }
+
+    storage::louds::LoudsTrieBuilder builder;
+    for (const UserPos::Token &token : user_pos_tokens_) {
+      builder.Add(token.key);
+    }
+    builder.Build();
+
+    // Range of tokens in |user_pos_tokens_| for each key ID.
+    struct KeyRange {
+      int key_id;
+      size_t begin;
+      size_t end;
+    };
+    std::vector<KeyRange> ranges;
+    for (size_t begin = 0; begin < user_pos_tokens_.size();) {
+      size_t end = begin + 1;
+      while (end < user_pos_tokens_.size() &&
+             user_pos_tokens_[end].key == user_pos_tokens_[begin].key) {
+        ++end;
+      }
+      ranges.push_back({builder.GetId(user_pos_tokens_[begin].key), begin,
+                        end});
+      begin = end;
+    }
+    std::sort(ranges.begin(), ranges.end(),
+              [](const KeyRange &lhs, const KeyRange &rhs) {
+                return lhs.key_id < rhs.key_id;
+              });
+
+    std::vector<UserPos::Token> tokens;
+    tokens.reserve(user_pos_tokens_.size());
+    key_offsets_.reserve(ranges.size() + 1);
+    for (const KeyRange &range : ranges) {
+      DCHECK_EQ(range.key_id, key_offsets_.size());
+      key_offsets_.push_back(tokens.size());
+      std::move(user_pos_tokens_.begin() + range.begin,
+                user_pos_tokens_.begin() + range.end,
+                std::back_inserter(tokens));
+    }
+    key_offsets_.push_back(tokens.size());
+    user_pos_tokens_ = std::move(tokens);
+
+    trie_image_ = builder.image();
+    CHECK(key_trie_.Open(reinterpret_cast<const uint8_t *>(trie_image_.data())))
+        << "Failed to open the key trie of the user dictionary";
+  }
+
   const UserPosInterface *user_pos_;
   SuppressionDictionary *suppression_dictionary_;
+  // Tokens grouped by the key ID of |key_trie_|. The tokens of the key ID i
+  // are in [key_offsets_[i], key_offsets_[i + 1]).
   std::vector<UserPos::Token> user_pos_tokens_;
+  std::vector<uint32_t> key_offsets_;
+  std::string trie_image_;
+  storage::louds::LoudsTrie key_trie_;
 };
 
 class UserDictionary::UserDictionaryReloader {
@@ -335,8 +459,8 @@ UserDictionary::UserDictionary(std::unique_ptr<const UserPosInterface> user_pos,
       user_pos_(std::move(user_pos)),
       pos_matcher_(pos_matcher),
       suppression_dictionary_(suppression_dictionary),
-      tokens_(std::make_unique<TokensIndex>(user_pos_.get(),
-                                            suppression_dictionary)) {
+      tokens_(std::make_shared<const TokensIndex>(user_pos_.get(),
+                                                  suppression_dictionary)) {
   DCHECK(user_pos_.get());
   DCHECK(suppression_dictionary_);
   Reload();
@@ -362,121 +486,120 @@ bool UserDictionary::HasValue(absl::string_view value) const {
 void UserDictionary::LookupPredictive(
     absl::string_view key, const ConversionRequest &conversion_request,
     Callback *callback) const {
-  absl::ReaderMutexLock l(&mutex_);
-
   if (key.empty()) {
     MOZC_VLOG(2) << "string of length zero is passed.";
     return;
   }
-  if (tokens_->empty()) {
+  const std::shared_ptr<const TokensIndex> tokens_index = GetTokens();
+  if (tokens_index->empty()) {
     return;
   }
   if (conversion_request.config().incognito_mode()) {
     return;
   }
 
-  // Find the starting point of iteration over dictionary contents.
   Token token;
-  for (auto [begin, end] = std::equal_range(tokens_->begin(), tokens_->end(),
-                                            key, OrderByKeyPrefix());
-       begin != end; ++begin) {
-    const UserPos::Token &user_pos_token = *begin;
-    switch (callback->OnKey(user_pos_token.key)) {
+  tokens_index->ForEachPredictive(key, [&](TokensIndex::TokenSpan tokens) {
+    const absl::string_view token_key = tokens.front().key;
+    switch (callback->OnKey(token_key)) {
       case Callback::TRAVERSE_DONE:
-        return;
+        return false;
       case Callback::TRAVERSE_NEXT_KEY:
       case Callback::TRAVERSE_CULL:
-        continue;
+        return true;
       default:
         break;
     }
     // b/333613472: Make sure not to set the additional penalties.
-    if (callback->OnActualKey(user_pos_token.key, user_pos_token.key,
+    if (callback->OnActualKey(token_key, token_key,
                               /* num_expanded= */ 0) ==
         Callback::TRAVERSE_DONE) {
-      return;
+      return false;
     }
-    PopulateTokenFromUserPosToken(user_pos_token, PREDICTIVE, &token);
-    if (callback->OnToken(user_pos_token.key, user_pos_token.key, token) ==
-        Callback::TRAVERSE_DONE) {
-      return;
+    for (const UserPos::Token &user_pos_token : tokens) {
+      PopulateTokenFromUserPosToken(user_pos_token, PREDICTIVE, &token);
+      switch (callback->OnToken(token_key, token_key, token)) {
+        case Callback::TRAVERSE_DONE:
+          return false;
+        case Callback::TRAVERSE_NEXT_KEY:
+          return true;
+        default:
+          break;
+      }
     }
-  }
+    return true;
+  });
 }
 
 // UserDictionary doesn't support kana modifier insensitive lookup.
 void UserDictionary::LookupPrefix(absl::string_view key,
                                   const ConversionRequest &conversion_request,
                                   Callback *callback) const {
-  absl::ReaderMutexLock l(&mutex_);
-
   if (key.empty()) {
     LOG(WARNING) << "string of length zero is passed.";
     return;
   }
-  if (tokens_->empty()) {
+  const std::shared_ptr<const TokensIndex> tokens_index = GetTokens();
+  if (tokens_index->empty()) {
     return;
   }
   if (conversion_request.config().incognito_mode()) {
     return;
   }
 
-  // Find the starting point for iteration over dictionary contents.
-  const absl::string_view first_char = Utf8AsChars(key).front();
   Token token;
-  for (auto it = std::lower_bound(tokens_->begin(), tokens_->end(), first_char,
-                                  OrderByKey());
-       it != tokens_->end(); ++it) {
-    const UserPos::Token &user_pos_token = *it;
-    if (user_pos_token.key > key) {
-      break;
-    }
-    if (user_pos_token.has_attribute(UserPos::Token::SUGGESTION_ONLY)) {
-      continue;
-    }
-    if (!absl::StartsWith(key, user_pos_token.key)) {
-      continue;
-    }
-    switch (callback->OnKey(user_pos_token.key)) {
-      case Callback::TRAVERSE_DONE:
-        return;
-      case Callback::TRAVERSE_NEXT_KEY:
+  tokens_index->ForEachPrefix(key, [&](TokensIndex::TokenSpan tokens) {
+    const absl::string_view token_key = tokens.front().key;
+    bool key_notified = false;
+    for (const UserPos::Token &user_pos_token : tokens) {
+      if (user_pos_token.has_attribute(UserPos::Token::SUGGESTION_ONLY)) {
         continue;
-      case Callback::TRAVERSE_CULL:
-        LOG(FATAL) << "UserDictionary doesn't support culling.";
-        break;
-      default:
-        break;
-    }
-    if (callback->OnActualKey(user_pos_token.key, user_pos_token.key,
-                              /* num_expanded= */ 0) ==
-        Callback::TRAVERSE_DONE) {
-      return;
-    }
-    PopulateTokenFromUserPosToken(user_pos_token, PREFIX, &token);
-    switch (callback->OnToken(user_pos_token.key, user_pos_token.key, token)) {
-      case Callback::TRAVERSE_DONE:
-        return;
-      case Callback::TRAVERSE_CULL:
-        LOG(FATAL) << "UserDictionary doesn't support culling.";
-        break;
-      default:
-        break;
+      }
+      if (!key_notified) {
+        switch (callback->OnKey(token_key)) {
+          case Callback::TRAVERSE_DONE:
+            return false;
+          case Callback::TRAVERSE_NEXT_KEY:
+            return true;
+          case Callback::TRAVERSE_CULL:
+            LOG(FATAL) << "UserDictionary doesn't support culling.";
+            break;
+          default:
+            break;
+        }
+        if (callback->OnActualKey(token_key, token_key,
+                                  /* num_expanded= */ 0) ==
+            Callback::TRAVERSE_DONE) {
+          return false;
+        }
+        key_notified = true;
+      }
+      PopulateTokenFromUserPosToken(user_pos_token, PREFIX, &token);
+      switch (callback->OnToken(token_key, token_key, token)) {
+        case Callback::TRAVERSE_DONE:
+          return false;
+        case Callback::TRAVERSE_NEXT_KEY:
+          return true;
+        case Callback::TRAVERSE_CULL:
+          LOG(FATAL) << "UserDictionary doesn't support culling.";
+          break;
+        default:
+          break;
+      }
     }
-  }
+    return true;
+  });
 }
 
 void UserDictionary::LookupExact(absl::string_view key,
                                  const ConversionRequest &conversion_request,
                                  Callback *callback) const {
-  absl::ReaderMutexLock l(&mutex_);
-  if (key.empty() || tokens_->empty() ||
-      conversion_request.config().incognito_mode()) {
+  if (key.empty() || conversion_request.config().incognito_mode()) {
     return;
   }
-  auto [begin, end] =
-      std::equal_range(tokens_->begin(), tokens_->end(), key, OrderByKey());
-  if (begin == end) {
+  const std::shared_ptr<const TokensIndex> tokens_index = GetTokens();
+  const TokensIndex::TokenSpan tokens = tokens_index->FindExact(key);
+  if (tokens.empty()) {
     return;
   }
   if (callback->OnKey(key) != Callback::TRAVERSE_CONTINUE) {
@@ -488,8 +611,7 @@ void UserDictionary::LookupExact(absl::string_view key,
   }
 
   Token token;
-  for (; begin != end; ++begin) {
-    const UserPos::Token &user_pos_token = *begin;
+  for (const UserPos::Token &user_pos_token : tokens) {
     if (user_pos_token.has_attribute(UserPos::Token::SUGGESTION_ONLY)) {
       continue;
     }
@@ -512,16 +634,10 @@ bool UserDictionary::LookupComment(absl::string_view key,
     return false;
   }
 
-  absl::ReaderMutexLock l(&mutex_);
-  if (tokens_->empty()) {
-    return false;
-  }
+  const std::shared_ptr<const TokensIndex> tokens_index = GetTokens();
 
   // Set the comment that was found first.
-  for (auto [begin, end] = std::equal_range(tokens_->begin(), tokens_->end(),
-                                            key, OrderByKey());
-       begin != end; ++begin) {
-    const UserPos::Token &token = *begin;
+  for (const UserPos::Token &token : tokens_index->FindExact(key)) {
     if (token.value == value && !token.comment.empty()) {
       comment->assign(token.comment);
       return true;
@@ -565,19 +681,20 @@ class FindValueCallback : public DictionaryInterface::Callback {
 
 void UserDictionary::WaitForReloader() { reloader_->Wait(); }
 
-void UserDictionary::Swap(std::unique_ptr<TokensIndex> new_tokens) {
+void UserDictionary::Swap(std::shared_ptr<const TokensIndex> new_tokens) {
   DCHECK(new_tokens);
-  absl::WriterMutexLock l(&mutex_);
-  tokens_.swap(new_tokens);
+  // The previous index is released outside of the lock, or later when the
+  // last reader drops its snapshot.
+  std::shared_ptr<const TokensIndex> old_tokens;
+  {
+    absl::MutexLock l(&tokens_mutex_);
+    old_tokens = std::exchange(tokens_, std::move(new_tokens));
+  }
 }
 
 bool UserDictionary::Load(
     const user_dictionary::UserDictionaryStorage &storage) {
-  size_t size = 0;
-  {
-    absl::ReaderMutexLock l(&mutex_);
-    size = tokens_->size();
-  }
+  const size_t size = GetTokens()->size();
 
   // If UserDictionary is pretty big, we first remove the
   // current dictionary to save memory usage.
@@ -588,13 +705,12 @@ bool UserDictionary::Load(
 #endif  // __ANDROID__
 
   if (size >= kVeryBigUserDictionarySize) {
-    auto placeholder_empty_tokens =
-        std::make_unique<TokensIndex>(user_pos_.get(), suppression_dictionary_);
-    Swap(std::move(placeholder_empty_tokens));
+    Swap(std::make_shared<const TokensIndex>(user_pos_.get(),
+                                             suppression_dictionary_));
   }
 
   auto tokens =
-      std::make_unique<TokensIndex>(user_pos_.get(), suppression_dictionary_);
+      std::make_shared<TokensIndex>(user_pos_.get(), suppression_dictionary_);
   tokens->Load(storage);
   Swap(std::move(tokens));
   return true;
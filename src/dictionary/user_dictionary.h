@@ -113,15 +113,26 @@ class UserDictionary : public UserDictionaryInterface {
   class TokensIndex;
   class UserDictionaryReloader;
 
-  // Swaps internal tokens index to |new_tokens|.
-  void Swap(std::unique_ptr<TokensIndex> new_tokens);
+  // Publishes |new_tokens| as the current tokens index. Lookups running
+  // concurrently keep using the snapshot they have already acquired.
+  void Swap(std::shared_ptr<const TokensIndex> new_tokens);
+
+  // Returns the current snapshot of the tokens index. The lock is held only
+  // to copy the pointer, so lookups never wait for a reload.
+  std::shared_ptr<const TokensIndex> GetTokens() const
+      ABSL_LOCKS_EXCLUDED(tokens_mutex_) {
+    absl::ReaderMutexLock l(&tokens_mutex_);
+    return tokens_;
+  }
 
   std::unique_ptr<UserDictionaryReloader> reloader_;
   std::unique_ptr<const UserPosInterface> user_pos_;
   const PosMatcher pos_matcher_;
   SuppressionDictionary *suppression_dictionary_;
-  std::unique_ptr<TokensIndex> tokens_ ABSL_GUARDED_BY(mutex_);
-  mutable absl::Mutex mutex_;
+  // Immutable tokens index. The mutex guards only the pointer; the index is
+  // built and released outside of it.
+  mutable absl::Mutex tokens_mutex_;
+  std::shared_ptr<const TokensIndex> tokens_ ABSL_GUARDED_BY(tokens_mutex_);
 
   friend class UserDictionaryTest;
 };
@@ -42,12 +42,16 @@
 #include "absl/log/check.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
 #include "base/file/temp_dir.h"
 #include "base/file_util.h"
 #include "base/random.h"
 #include "base/singleton.h"
+#include "base/thread.h"
 #include "config/config_handler.h"
 #include "data_manager/testing/mock_data_manager.h"
 #include "dictionary/dictionary_interface.h"
@@ -190,6 +194,28 @@ class UserPosMock : public UserPosInterface {
   static constexpr absl::string_view kVerb = "動詞ワ行五段";
 };
 
+// UserPosMock that blocks on expanding the key "block": it notifies
+// |loading| and waits for |resume|.
+class BlockingUserPosMock : public UserPosMock {
+ public:
+  BlockingUserPosMock(absl::Notification *loading, absl::Notification *resume)
+      : loading_(loading), resume_(resume) {}
+
+  bool GetTokens(absl::string_view key, absl::string_view value,
+                 absl::string_view pos, absl::string_view locale,
+                 std::vector<UserPos::Token> *tokens) const override {
+    if (key == "block") {
+      loading_->Notify();
+      resume_->WaitForNotification();
+    }
+    return UserPosMock::GetTokens(key, value, pos, locale, tokens);
+  }
+
+ private:
+  absl::Notification *loading_;
+  absl::Notification *resume_;
+};
+
 class UserDictionaryTest : public testing::TestWithTempUserProfile {
  protected:
   UserDictionaryTest()
@@ -212,8 +238,14 @@ class UserDictionaryTest : public testing::TestWithTempUserProfile {
   // Workaround for the constructor of UserDictionary being protected.
   // Creates a user dictionary with mock pos data.
   std::unique_ptr<UserDictionary> CreateDictionaryWithMockPos() {
+    return CreateDictionaryWithUserPos(std::make_unique<UserPosMock>());
+  }
+
+  // Creates a user dictionary with the given pos data.
+  std::unique_ptr<UserDictionary> CreateDictionaryWithUserPos(
+      std::unique_ptr<const UserPosInterface> user_pos) {
     return std::make_unique<UserDictionary>(
-        std::make_unique<UserPosMock>(),
+        std::move(user_pos),
         dictionary::PosMatcher(mock_data_manager_.GetPosMatcherData()),
         suppression_dictionary_.get());
   }
@@ -427,6 +459,78 @@ TEST_F(UserDictionaryTest, TestLookupPrefixCallback) {
   dic->LookupPrefix("start", convreq_, &mock_callback);
 }
 
+TEST_F(UserDictionaryTest, LookupCallsOnKeyOncePerKey) {
+  std::unique_ptr<UserDictionary> dic(CreateDictionaryWithMockPos());
+  // Wait for async reload called from the constructor.
+  dic->WaitForReloader();
+
+  {
+    UserDictionaryStorage storage("");
+    UserDictionaryTest::LoadFromString(
+        "star\tstar\tnoun\n"
+        "star\tSTAR\tnoun\n"
+        "start\tstart\tnoun\n"
+        "start\tSTART\tnoun\n",
+        &storage);
+    dic->Load(storage.GetProto());
+  }
+
+  constexpr auto kContinue = DictionaryInterface::Callback::TRAVERSE_CONTINUE;
+  for (const bool predictive : {true, false}) {
+    MockCallback mock_callback;
+    // OnKey() and OnActualKey() are called once for the tokens of each key.
+    for (const absl::string_view key : {"star", "start"}) {
+      EXPECT_CALL(mock_callback, OnKey(Eq(key))).WillOnce(Return(kContinue));
+      EXPECT_CALL(mock_callback, OnActualKey(Eq(key), Eq(key), Eq(0)))
+          .WillOnce(Return(kContinue));
+      EXPECT_CALL(mock_callback, OnToken(Eq(key), Eq(key), _))
+          .Times(2)
+          .WillRepeatedly(Return(kContinue));
+    }
+    if (predictive) {
+      dic->LookupPredictive("sta", convreq_, &mock_callback);
+    } else {
+      dic->LookupPrefix("starting", convreq_, &mock_callback);
+    }
+  }
+}
+
+TEST_F(UserDictionaryTest, LookupSkipsKeyOnTraverseNextKey) {
+  std::unique_ptr<UserDictionary> dic(CreateDictionaryWithMockPos());
+  // Wait for async reload called from the constructor.
+  dic->WaitForReloader();
+
+  {
+    UserDictionaryStorage storage("");
+    UserDictionaryTest::LoadFromString(
+        "star\tstar\tnoun\n"
+        "star\tSTAR\tnoun\n"
+        "start\tstart\tnoun\n"
+        "start\tSTART\tnoun\n",
+        &storage);
+    dic->Load(storage.GetProto());
+  }
+
+  constexpr auto kContinue = DictionaryInterface::Callback::TRAVERSE_CONTINUE;
+  for (const bool predictive : {true, false}) {
+    MockCallback mock_callback;
+    // TRAVERSE_NEXT_KEY from OnToken() skips the rest of the tokens of the
+    // key, and the lookup continues with the next key.
+    for (const absl::string_view key : {"star", "start"}) {
+      EXPECT_CALL(mock_callback, OnKey(Eq(key))).WillOnce(Return(kContinue));
+      EXPECT_CALL(mock_callback, OnActualKey(Eq(key), Eq(key), Eq(0)))
+          .WillOnce(Return(kContinue));
+      EXPECT_CALL(mock_callback, OnToken(Eq(key), Eq(key), _))
+          .WillOnce(Return(DictionaryInterface::Callback::TRAVERSE_NEXT_KEY));
+    }
+    if (predictive) {
+      dic->LookupPredictive("sta", convreq_, &mock_callback);
+    } else {
+      dic->LookupPrefix("starting", convreq_, &mock_callback);
+    }
+  }
+}
+
 TEST_F(UserDictionaryTest, TestLookupPredictive) {
   std::unique_ptr<UserDictionary> dic(CreateDictionaryWithMockPos());
   // Wait for async reload called from the constructor.
@@ -807,6 +911,109 @@ TEST_F(UserDictionaryTest, AsyncLoadTest) {
   }
 }
 
+TEST_F(UserDictionaryTest, ConcurrentLookupDuringLoad) {
+  std::unique_ptr<UserDictionary> dic(CreateDictionaryWithMockPos());
+  // Wait for async reload called from the constructor.
+  dic->WaitForReloader();
+
+  // Both dictionaries have several entries matching the same lookup, so a
+  // partially loaded dictionary would return a mixture of them.
+  UserDictionaryStorage storage0("");
+  UserDictionaryTest::LoadFromString(kUserDictionary0, &storage0);
+  UserDictionaryStorage storage1("");
+  UserDictionaryTest::LoadFromString(
+      "st\tst\tnoun\n"
+      "sta\tsta\tnoun\n"
+      "star\tSTAR\tnoun\n"
+      "start\tSTART\tnoun\n",
+      &storage1);
+
+  auto lookup = [&dic, this] {
+    CollectTokenCallback callback;
+    dic->LookupPrefix("starting", convreq_, &callback);
+    std::vector<std::string> results;
+    for (const Token &token : callback.tokens()) {
+      results.push_back(absl::StrCat(token.key, "\t", token.value));
+    }
+    std::sort(results.begin(), results.end());
+    return results;
+  };
+  dic->Load(storage1.GetProto());
+  const std::vector<std::string> expected1 = lookup();
+  dic->Load(storage0.GetProto());
+  const std::vector<std::string> expected0 = lookup();
+  ASSERT_FALSE(expected0.empty());
+  ASSERT_FALSE(expected1.empty());
+  ASSERT_NE(expected0, expected1);
+
+  // Readers always see one of the complete dictionaries while the index is
+  // swapped on this thread.
+  std::vector<Thread> readers;
+  for (int i = 0; i < 4; ++i) {
+    readers.emplace_back([&lookup, &expected0, &expected1] {
+      for (int j = 0; j < 1000; ++j) {
+        const std::vector<std::string> results = lookup();
+        EXPECT_TRUE(results == expected0 || results == expected1)
+            << absl::StrJoin(results, ",");
+      }
+    });
+  }
+  for (int i = 0; i < 100; ++i) {
+    dic->Load((i % 2 == 0 ? storage1 : storage0).GetProto());
+  }
+  for (Thread &reader : readers) {
+    reader.Join();
+  }
+}
+
+TEST_F(UserDictionaryTest, LookupDoesNotWaitForLoad) {
+  absl::Notification loading, resume;
+  std::unique_ptr<UserDictionary> dic = CreateDictionaryWithUserPos(
+      std::make_unique<BlockingUserPosMock>(&loading, &resume));
+  // Wait for async reload called from the constructor.
+  dic->WaitForReloader();
+
+  UserDictionaryStorage storage0("");
+  UserDictionaryTest::LoadFromString(kUserDictionary0, &storage0);
+  dic->Load(storage0.GetProto());
+  UserDictionaryStorage storage1("");
+  UserDictionaryTest::LoadFromString(
+      "block\tblock\tnoun\n"
+      "star\tSTAR\tnoun\n",
+      &storage1);
+
+  auto lookup = [&dic, this] {
+    CollectTokenCallback callback;
+    dic->LookupPrefix("starting", convreq_, &callback);
+    std::vector<std::string> values;
+    for (const Token &token : callback.tokens()) {
+      values.push_back(token.value);
+    }
+    std::sort(values.begin(), values.end());
+    return values;
+  };
+  const std::vector<std::string> expected0 = lookup();
+  ASSERT_FALSE(expected0.empty());
+
+  // Blocks the loader in the middle of building the new index.
+  Thread loader([&dic, &storage1] { dic->Load(storage1.GetProto()); });
+  loading.WaitForNotification();
+
+  // A lookup finishes with the previous index meanwhile.
+  absl::Notification looked_up;
+  std::vector<std::string> values;
+  Thread reader([&] {
+    values = lookup();
+    looked_up.Notify();
+  });
+  EXPECT_TRUE(looked_up.WaitForNotificationWithTimeout(absl::Seconds(10)));
+  resume.Notify();
+  reader.Join();
+  loader.Join();
+  EXPECT_EQ(values, expected0);
+  EXPECT_THAT(lookup(), ElementsAre("STAR"));
+}
+
 TEST_F(UserDictionaryTest, TestSuppressionDictionary) {
   std::unique_ptr<UserDictionary> user_dic(CreateDictionaryWithMockPos());
   user_dic->WaitForReloader();
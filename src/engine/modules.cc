@@ -40,7 +40,9 @@
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "composer/typing_model.h"
 #include "converter/connector.h"
 #include "converter/segmenter.h"
 #include "data_manager/data_manager_interface.h"
@@ -56,6 +58,7 @@
 #include "dictionary/user_pos.h"
 #include "prediction/single_kanji_prediction_aggregator.h"
 #include "prediction/suggestion_filter.h"
+#include "protocol/commands.pb.h"
 
 using ::mozc::dictionary::DictionaryImpl;
 using ::mozc::dictionary::PosGroup;
@@ -172,11 +175,36 @@ absl::Status Modules::Init(
   zero_query_number_dict_.Init(zero_query_number_token_array_data,
                                zero_query_number_string_array_data);
 
+  // Typing models are optional.
+  for (const absl::string_view name : composer::TypingModel::kSectionNames) {
+    const absl::string_view data = data_manager_->GetTypingModelData(name);
+    if (data.empty()) {
+      continue;
+    }
+    std::unique_ptr<const composer::TypingModel> typing_model =
+        composer::TypingModel::Create(data);
+    if (!typing_model) {
+      return absl::DataLossError(
+          absl::StrCat("modules.cc: typing model is broken: ", name));
+    }
+    typing_models_[name] = std::move(typing_model);
+  }
+
   initialized_ = true;
   return absl::Status();
 #undef RETURN_IF_NULL
 }
 
+const composer::TypingModel *Modules::GetTypingModel(
+    commands::Request::SpecialRomanjiTable table) const {
+  const absl::string_view name = composer::TypingModel::GetSectionName(table);
+  if (const auto iter = typing_models_.find(name);
+      iter != typing_models_.end()) {
+    return iter->second.get();
+  }
+  return nullptr;
+}
+
 void Modules::PresetPosMatcher(
     std::unique_ptr<const dictionary::PosMatcher> pos_matcher) {
   DCHECK(!initialized_) << "Module is already initialized";
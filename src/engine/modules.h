@@ -33,8 +33,11 @@
 #include <memory>
 #include <utility>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "composer/typing_model.h"
 #include "converter/connector.h"
 #include "converter/segmenter.h"
 #include "data_manager/data_manager_interface.h"
@@ -46,6 +49,7 @@
 #include "prediction/single_kanji_prediction_aggregator.h"
 #include "prediction/suggestion_filter.h"
 #include "prediction/zero_query_dict.h"
+#include "protocol/commands.pb.h"
 
 namespace mozc {
 namespace engine {
@@ -113,6 +117,11 @@ class Modules {
     return zero_query_number_dict_;
   }
 
+  // Returns the typing model for the keyboard of `table`, or nullptr if the
+  // data set doesn't have it.
+  const composer::TypingModel *GetTypingModel(
+      commands::Request::SpecialRomanjiTable table) const;
+
   const engine::SupplementalModelInterface *GetSupplementalModel() const {
     return supplemental_model_;
   }
@@ -137,6 +146,10 @@ class Modules {
       single_kanji_prediction_aggregator_;
   ZeroQueryDict zero_query_dict_;
   ZeroQueryDict zero_query_number_dict_;
+  // Typing models keyed by TypingModel::kSectionNames.
+  absl::flat_hash_map<absl::string_view,
+                      std::unique_ptr<const composer::TypingModel>>
+      typing_models_;
 
   // SupplementalModel used for homonym correction.
   // Module doesn't have the ownership of supplemental_model_,
@@ -38,6 +38,7 @@
 #include "dictionary/pos_matcher.h"
 #include "dictionary/suppression_dictionary.h"
 #include "dictionary/user_dictionary_stub.h"
+#include "protocol/commands.pb.h"
 #include "testing/gmock.h"
 #include "testing/gunit.h"
 
@@ -64,6 +65,18 @@ TEST(ModulesTest, Init) {
   EXPECT_NE(modules.GetPosGroup(), nullptr);
 }
 
+TEST(ModulesTest, GetTypingModel) {
+  Modules modules;
+  ASSERT_OK(modules.Init(std::make_unique<testing::MockDataManager>()));
+
+  EXPECT_NE(modules.GetTypingModel(commands::Request::TWELVE_KEYS_TO_HIRAGANA),
+            nullptr);
+  EXPECT_NE(
+      modules.GetTypingModel(commands::Request::QWERTY_MOBILE_TO_HIRAGANA),
+      nullptr);
+  EXPECT_EQ(modules.GetTypingModel(commands::Request::DEFAULT_TABLE), nullptr);
+}
+
 TEST(ModulesTest, Preset) {
   Modules modules;
 
@@ -52,6 +52,9 @@
 #include "base/util.h"
 #include "base/vlog.h"
 #include "composer/query.h"
+#include "composer/table.h"
+#include "composer/typing_corrector.h"
+#include "composer/typing_model.h"
 #include "converter/converter_interface.h"
 #include "converter/immutable_converter_interface.h"
 #include "converter/node_list_builder.h"
@@ -98,6 +101,80 @@ using ::mozc::dictionary::Token;
 constexpr size_t kSuggestionMaxResultsSize = 256;
 constexpr size_t kPredictionMaxResultsSize = 100000;
 
+// Maximum number of unigram results kept for PREDICTION. Up to
+// kPredictionMaxResultsSize entries are looked up, but only the ones with the
+// smallest word costs are kept for the costly rescoring. This is ten times as
+// large as the number of candidates shown on mobile.
+constexpr size_t kPredictionMaxKeptResultsSize = 2000;
+
+// Appends results to a vector, keeping at most |max_size| of them with the
+// smallest word costs (ResultWCostLess). Once the limit is reached, the kept
+// results form a max-heap so that a dominated entry is dropped before its
+// strings are copied to a Result.
+class ResultCollector {
+ public:
+  // Keeps all the results.
+  explicit ResultCollector(std::vector<Result> *results)
+      : ResultCollector(results, results->max_size()) {}
+
+  ResultCollector(std::vector<Result> *results, size_t max_size)
+      : results_(results), begin_(results->size()), max_size_(max_size) {
+    DCHECK_GT(max_size_, 0);
+  }
+
+  ResultCollector(const ResultCollector &) = delete;
+  ResultCollector &operator=(const ResultCollector &) = delete;
+
+  // Returns true if a result with |wcost| and |value| would be dropped. The
+  // entry is counted as dropped.
+  bool Drop(int wcost, absl::string_view value) {
+    if (size() < max_size_) {
+      return false;
+    }
+    const Result &worst = (*results_)[begin_];
+    const bool dominated =
+        wcost == worst.wcost
+            ? !result_internal::ValueLess(value, worst.value)
+            : wcost > worst.wcost;
+    num_dropped_ += dominated;
+    return dominated;
+  }
+
+  // Adds |result|, replacing the worst result if full. Drop() should be
+  // checked beforehand.
+  void Add(Result result) {
+    if (size() < max_size_) {
+      results_->push_back(std::move(result));
+      if (size() == max_size_) {
+        std::make_heap(results_->begin() + begin_, results_->end(),
+                       ResultWCostLess());
+      }
+      return;
+    }
+    ++num_dropped_;
+    std::pop_heap(results_->begin() + begin_, results_->end(),
+                  ResultWCostLess());
+    results_->back() = std::move(result);
+    std::push_heap(results_->begin() + begin_, results_->end(),
+                   ResultWCostLess());
+  }
+
+  // Returns the vector which the results are appended to.
+  std::vector<Result> *results() const { return results_; }
+
+  // Returns the number of results collected by this instance.
+  size_t size() const { return results_->size() - begin_; }
+
+  // Returns the number of results dropped or replaced by the better ones.
+  size_t num_dropped() const { return num_dropped_; }
+
+ private:
+  std::vector<Result> *results_;
+  const size_t begin_;
+  const size_t max_size_;
+  size_t num_dropped_ = 0;
+};
+
 // Returns true if the |target| may be redundant result.
 bool MaybeRedundant(const absl::string_view reference,
                     const absl::string_view target) {
@@ -249,7 +326,7 @@ class DictionaryPredictionAggregator::PredictiveLookupCallback
                            Segment::Candidate::SourceInfo source_info,
                            int zip_code_id, int unknown_id,
                            absl::string_view non_expanded_original_key,
-                           std::vector<Result> *results)
+                           ResultCollector *collector)
       : penalty_(0),
         types_(types),
         limit_(limit),
@@ -259,7 +336,7 @@ class DictionaryPredictionAggregator::PredictiveLookupCallback
         zip_code_id_(zip_code_id),
         unknown_id_(unknown_id),
         non_expanded_original_key_(non_expanded_original_key),
-        results_(results) {}
+        collector_(collector) {}
 
   PredictiveLookupCallback(const PredictiveLookupCallback &) = delete;
   PredictiveLookupCallback &operator=(const PredictiveLookupCallback &) =
@@ -317,13 +394,20 @@ class DictionaryPredictionAggregator::PredictiveLookupCallback
       return TRAVERSE_CONTINUE;
     }
 
-    results_->push_back(Result());
-    results_->back().InitializeByTokenAndTypes(token, types_);
-    results_->back().wcost += penalty_;
-    results_->back().source_info |= source_info_;
-    results_->back().non_expanded_original_key =
-        std::string(non_expanded_original_key_);
-    return (results_->size() < limit_) ? TRAVERSE_CONTINUE : TRAVERSE_DONE;
+    if (!collector_->Drop(token.cost + penalty_, token.value)) {
+      Result result;
+      result.InitializeByTokenAndTypes(token, types_);
+      result.wcost += penalty_;
+      result.source_info |= source_info_;
+      result.non_expanded_original_key =
+          std::string(non_expanded_original_key_);
+      collector_->Add(std::move(result));
+    }
+    // The dropped results are counted so that the lookup stops at the same
+    // number of entries.
+    return (collector_->results()->size() + collector_->num_dropped() < limit_)
+               ? TRAVERSE_CONTINUE
+               : TRAVERSE_DONE;
   }
 
  protected:
@@ -336,7 +420,7 @@ class DictionaryPredictionAggregator::PredictiveLookupCallback
   const int zip_code_id_;
   const int unknown_id_;
   absl::string_view non_expanded_original_key_;
-  std::vector<Result> *results_ = nullptr;
+  ResultCollector *collector_ = nullptr;
 
  private:
   // When the key is number, number token will be noisy if
@@ -385,10 +469,10 @@ class DictionaryPredictionAggregator::PredictiveBigramLookupCallback
                                  Segment::Candidate::SourceInfo source_info,
                                  int zip_code_id, int unknown_id,
                                  absl::string_view non_expanded_original_key,
-                                 std::vector<Result> *results)
+                                 ResultCollector *collector)
       : PredictiveLookupCallback(
             types, limit, original_key_len, subsequent_chars, source_info,
-            zip_code_id, unknown_id, non_expanded_original_key, results),
+            zip_code_id, unknown_id, non_expanded_original_key, collector),
         history_value_(history_value) {}
 
   PredictiveBigramLookupCallback(const PredictiveBigramLookupCallback &) =
@@ -954,10 +1038,11 @@ PredictionType DictionaryPredictionAggregator::AggregateUnigramCandidate(
   const size_t cutoff_threshold =
       GetCandidateCutoffThreshold(request.request_type());
   const size_t prev_results_size = results->size();
-  GetPredictiveResults(*dictionary_, "", request, segments, UNIGRAM,
-                       cutoff_threshold, Segment::Candidate::SOURCE_INFO_NONE,
-                       zip_code_id_, unknown_id_, results);
-  const size_t unigram_results_size = results->size() - prev_results_size;
+  const size_t unigram_results_size = GetPredictiveResults(
+      *dictionary_, "", request, segments, UNIGRAM, cutoff_threshold,
+      std::min(cutoff_threshold, kPredictionMaxKeptResultsSize),
+      Segment::Candidate::SOURCE_INFO_NONE, zip_code_id_, unknown_id_,
+      results);
 
   // If size reaches max_results_size (== cutoff_threshold).
   // we don't show the candidates, since disambiguation from
@@ -1108,10 +1193,12 @@ void DictionaryPredictionAggregator::LookupUnigramCandidateForMixedConversion(
   const size_t cutoff_threshold = kPredictionMaxResultsSize;
 
   std::vector<Result> raw_result;
-  // No history key
+  // No history key. The results with large word costs are dropped while
+  // looking up, as the redundancy check below also prefers small ones.
   GetPredictiveResults(dictionary, "", request, segments, UNIGRAM,
-                       cutoff_threshold, Segment::Candidate::SOURCE_INFO_NONE,
-                       zip_code_id, unknown_id, &raw_result);
+                       cutoff_threshold, kPredictionMaxKeptResultsSize,
+                       Segment::Candidate::SOURCE_INFO_NONE, zip_code_id,
+                       unknown_id, &raw_result);
 
   // Hereafter, we split "Needed Results" and "(maybe) Unneeded Results."
   // The algorithm is:
@@ -1332,20 +1419,21 @@ void DictionaryPredictionAggregator::CheckBigramResult(
   MOZC_WORD_LOG(*result, "Valid bigram.");
 }
 
-void DictionaryPredictionAggregator::GetPredictiveResults(
+size_t DictionaryPredictionAggregator::GetPredictiveResults(
     const DictionaryInterface &dictionary, const absl::string_view history_key,
     const ConversionRequest &request, const Segments &segments,
-    PredictionTypes types, size_t lookup_limit,
+    PredictionTypes types, size_t lookup_limit, size_t max_results_size,
     Segment::Candidate::SourceInfo source_info, int zip_code_id, int unknown_id,
     std::vector<Result> *results) {
+  ResultCollector collector(results, max_results_size);
   if (!request.has_composer()) {
     std::string input_key(history_key);
     input_key.append(segments.conversion_segment(0).key());
     PredictiveLookupCallback callback(types, lookup_limit, input_key.size(),
                                       nullptr, source_info, zip_code_id,
-                                      unknown_id, "", results);
+                                      unknown_id, "", &collector);
     dictionary.LookupPredictive(input_key, request, &callback);
-    return;
+    return collector.size() + collector.num_dropped();
   }
 
   // If we have ambiguity for the input, get expanded key.
@@ -1361,9 +1449,9 @@ void DictionaryPredictionAggregator::GetPredictiveResults(
     input_key = absl::StrCat(history_key, base);
     PredictiveLookupCallback callback(types, lookup_limit, input_key.size(),
                                       nullptr, source_info, zip_code_id,
-                                      unknown_id, "", results);
+                                      unknown_id, "", &collector);
     dictionary.LookupPredictive(input_key, request, &callback);
-    return;
+    return collector.size() + collector.num_dropped();
   }
 
   // `non_expanded_original_key` keeps the original key request before
@@ -1379,9 +1467,10 @@ void DictionaryPredictionAggregator::GetPredictiveResults(
     input_key = absl::StrCat(history_key, base, expanded_char);
     PredictiveLookupCallback callback(
         types, lookup_limit, input_key.size(), nullptr, source_info,
-        zip_code_id, unknown_id, non_expanded_original_key, results);
+        zip_code_id, unknown_id, non_expanded_original_key, &collector);
     dictionary.LookupPredictive(input_key, request, &callback);
   }
+  return collector.size() + collector.num_dropped();
 }
 
 void DictionaryPredictionAggregator::GetPredictiveResultsForBigram(
@@ -1390,12 +1479,13 @@ void DictionaryPredictionAggregator::GetPredictiveResultsForBigram(
     const Segments &segments, PredictionTypes types, size_t lookup_limit,
     Segment::Candidate::SourceInfo source_info, int unknown_id_,
     std::vector<Result> *results) const {
+  ResultCollector collector(results);
   if (!request.has_composer()) {
     std::string input_key(history_key);
     input_key.append(segments.conversion_segment(0).key());
     PredictiveBigramLookupCallback callback(
         types, lookup_limit, input_key.size(), nullptr, history_value,
-        source_info, zip_code_id_, unknown_id_, "", results);
+        source_info, zip_code_id_, unknown_id_, "", &collector);
     dictionary.LookupPredictive(input_key, request, &callback);
     return;
   }
@@ -1415,7 +1505,7 @@ void DictionaryPredictionAggregator::GetPredictiveResultsForBigram(
   PredictiveBigramLookupCallback callback(
       types, lookup_limit, input_key.size(),
       expanded.empty() ? nullptr : &expanded, history_value, source_info,
-      zip_code_id_, unknown_id_, non_expanded_original_key, results);
+      zip_code_id_, unknown_id_, non_expanded_original_key, &collector);
   dictionary.LookupPredictive(input_key, request, &callback);
 }
 
@@ -1424,14 +1514,16 @@ void DictionaryPredictionAggregator::GetPredictiveResultsForEnglishKey(
     const absl::string_view input_key, PredictionTypes types,
     size_t lookup_limit, std::vector<Result> *results) const {
   const size_t prev_results_size = results->size();
+  ResultCollector collector(results);
   if (Util::IsUpperAscii(input_key)) {
     // For upper case key, look up its lower case version and then transform
     // the results to upper case.
     std::string key(input_key);
     Util::LowerString(&key);
-    PredictiveLookupCallback callback(types, lookup_limit, key.size(), nullptr,
-                                      Segment::Candidate::SOURCE_INFO_NONE,
-                                      zip_code_id_, unknown_id_, "", results);
+    PredictiveLookupCallback callback(
+        types, lookup_limit, key.size(), nullptr,
+        Segment::Candidate::SOURCE_INFO_NONE, zip_code_id_, unknown_id_, "",
+        &collector);
     dictionary.LookupPredictive(key, request, &callback);
     for (size_t i = prev_results_size; i < results->size(); ++i) {
       Util::UpperString(&(*results)[i].value);
@@ -1441,19 +1533,20 @@ void DictionaryPredictionAggregator::GetPredictiveResultsForEnglishKey(
     // the results to capital.
     std::string key(input_key);
     Util::LowerString(&key);
-    PredictiveLookupCallback callback(types, lookup_limit, key.size(), nullptr,
-                                      Segment::Candidate::SOURCE_INFO_NONE,
-                                      zip_code_id_, unknown_id_, "", results);
+    PredictiveLookupCallback callback(
+        types, lookup_limit, key.size(), nullptr,
+        Segment::Candidate::SOURCE_INFO_NONE, zip_code_id_, unknown_id_, "",
+        &collector);
     dictionary.LookupPredictive(key, request, &callback);
     for (size_t i = prev_results_size; i < results->size(); ++i) {
       Util::CapitalizeString(&(*results)[i].value);
     }
   } else {
     // For other cases (lower and as-is), just look up directly.
-    PredictiveLookupCallback callback(types, lookup_limit, input_key.size(),
-                                      nullptr,
-                                      Segment::Candidate::SOURCE_INFO_NONE,
-                                      zip_code_id_, unknown_id_, "", results);
+    PredictiveLookupCallback callback(
+        types, lookup_limit, input_key.size(), nullptr,
+        Segment::Candidate::SOURCE_INFO_NONE, zip_code_id_, unknown_id_, "",
+        &collector);
     dictionary.LookupPredictive(input_key, request, &callback);
   }
   // If input mode is FULL_ASCII, then convert the results to full-width.
@@ -1587,7 +1680,7 @@ void DictionaryPredictionAggregator::AggregateSuffixPrediction(
   const size_t cutoff_threshold = kPredictionMaxResultsSize;
   const std::string kEmptyHistoryKey = "";
   GetPredictiveResults(*suffix_dictionary_, kEmptyHistoryKey, request, segments,
-                       SUFFIX, cutoff_threshold,
+                       SUFFIX, cutoff_threshold, cutoff_threshold,
                        Segment::Candidate::SOURCE_INFO_NONE, zip_code_id_,
                        unknown_id_, results);
 }
@@ -1615,7 +1708,7 @@ void DictionaryPredictionAggregator::AggregateZeroQuerySuffixPrediction(
     const std::string kEmptyHistoryKey = "";
     GetPredictiveResults(
         *suffix_dictionary_, kEmptyHistoryKey, request, segments, SUFFIX,
-        cutoff_threshold,
+        cutoff_threshold, cutoff_threshold,
         Segment::Candidate::DICTIONARY_PREDICTOR_ZERO_QUERY_SUFFIX,
         zip_code_id_, unknown_id_, results);
   }
@@ -1665,6 +1758,33 @@ void DictionaryPredictionAggregator::AggregateEnglishPredictionUsingRawInput(
   }
 }
 
+namespace {
+
+// Parameters of the typing corrector used when the supplemental model is not
+// available.
+constexpr size_t kTypingCorrectorBeamSize = 16;
+constexpr size_t kTypingCorrectorMaxQueries = 5;
+
+// Corrects the raw keys of the composition with the typing model of the
+// keyboard in the data set.
+std::optional<std::vector<TypeCorrectedQuery>>
+CorrectCompositionWithTypingModel(const engine::Modules &modules,
+                                  const ConversionRequest &request) {
+  const composer::TypingModel *typing_model =
+      modules.GetTypingModel(request.request().special_romanji_table());
+  const composer::Table *table = request.composer().GetTable();
+  if (typing_model == nullptr || table == nullptr) {
+    return std::nullopt;
+  }
+  composer::TypingCorrector corrector(
+      table, typing_model, &request.request(), &request.config(),
+      kTypingCorrectorBeamSize, kTypingCorrectorMaxQueries);
+  corrector.InsertCharacters(request.composer().GetRawString());
+  return corrector.GetQueries();
+}
+
+}  // namespace
+
 void DictionaryPredictionAggregator::AggregateTypingCorrectedPrediction(
     const ConversionRequest &request, const Segments &segments,
     PredictionTypes base_selected_types, std::vector<Result> *results) const {
@@ -1678,14 +1798,15 @@ void DictionaryPredictionAggregator::AggregateTypingCorrectedPrediction(
     return;
   }
 
+  // Uses the typing model in the data set only when the supplemental model is
+  // not available. When it is, its decision not to correct is respected.
   const engine::SupplementalModelInterface *supplemental_model =
       modules_.GetSupplementalModel();
-  if (supplemental_model == nullptr) {
-    return;
-  }
-
   const std::optional<std::vector<TypeCorrectedQuery>> corrected =
-      supplemental_model->CorrectComposition(request, segments.history_key());
+      supplemental_model != nullptr
+          ? supplemental_model->CorrectComposition(request,
+                                                   segments.history_key())
+          : CorrectCompositionWithTypingModel(modules_, request);
   if (!corrected) {
     return;
   }
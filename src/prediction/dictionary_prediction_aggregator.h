@@ -148,12 +148,17 @@ class DictionaryPredictionAggregator : public PredictionAggregatorInterface {
                          const ConversionRequest &request,
                          Result *result) const;
 
-  static void GetPredictiveResults(
+  // Looks up the entries predicted from history_key + the conversion key and
+  // appends them to |results|. The lookup stops at |lookup_limit| entries, of
+  // which at most |max_results_size| ones with the smallest word costs are
+  // kept. Returns the number of the entries looked up, including the ones
+  // which were not kept.
+  static size_t GetPredictiveResults(
       const dictionary::DictionaryInterface &dictionary,
       absl::string_view history_key, const ConversionRequest &request,
       const Segments &segments, PredictionTypes types, size_t lookup_limit,
-      Segment::Candidate::SourceInfo source_info, int zip_code_id,
-      int unknown_id, std::vector<Result> *results);
+      size_t max_results_size, Segment::Candidate::SourceInfo source_info,
+      int zip_code_id, int unknown_id, std::vector<Result> *results);
 
   void GetPredictiveResultsForBigram(
       const dictionary::DictionaryInterface &dictionary,
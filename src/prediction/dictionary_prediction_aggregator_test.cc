@@ -50,6 +50,8 @@
 #include "base/util.h"
 #include "composer/query.h"
 #include "composer/table.h"
+#include "composer/typing_corrector.h"
+#include "composer/typing_model.h"
 #include "config/config_handler.h"
 #include "converter/converter_interface.h"
 #include "converter/converter_mock.h"
@@ -418,6 +420,7 @@ class MockDataAndAggregator {
     return single_kanji_prediction_aggregator_;
   }
   const PosMatcher &pos_matcher() const { return *modules_.GetPosMatcher(); }
+  const engine::Modules &modules() const { return modules_; }
   const DictionaryPredictionAggregatorTestPeer &aggregator() {
     return *aggregator_;
   }
@@ -1111,6 +1114,51 @@ TEST_F(DictionaryPredictionAggregatorTest,
   }
 }
 
+TEST_F(DictionaryPredictionAggregatorTest,
+       LookupUnigramCandidateForMixedConversionKeepsBestResults) {
+  constexpr char kHiraganaA[] = "あ";
+  constexpr auto kPosId = MockDictionary::kDefaultPosId;
+  constexpr int kZipcodeId = 100;
+  constexpr int kUnknownId = 100;
+
+  // More entries than kept. The values are not redundant to each other.
+  constexpr size_t kNumTokens = 5000;
+  std::vector<Token> tokens;
+  for (size_t i = 0; i < kNumTokens; ++i) {
+    // Shuffle the costs so that the kept results are replaced.
+    const int cost = static_cast<int>((i * 7919) % kNumTokens);
+    tokens.emplace_back(kHiraganaA, absl::StrFormat("v%05d", cost), cost,
+                        kPosId, kPosId, Token::NONE);
+  }
+  MockDictionary mock_dict;
+  EXPECT_CALL(mock_dict, LookupPredictive(_, _, _)).Times(AnyNumber());
+  EXPECT_CALL(mock_dict, LookupPredictive(StrEq(kHiraganaA), _, _))
+      .WillRepeatedly(InvokeCallbackWithTokens(tokens));
+
+  table_->LoadFromFile("system://12keys-hiragana.tsv");
+  composer_->SetTable(table_.get());
+  InsertInputSequence(kHiraganaA, composer_.get());
+  Segments segments;
+  segments.add_segment()->set_key(kHiraganaA);
+
+  std::vector<Result> results;
+  DictionaryPredictionAggregatorTestPeer::
+      LookupUnigramCandidateForMixedConversion(
+          mock_dict, *prediction_convreq_, segments, kZipcodeId, kUnknownId,
+          &results);
+  ASSERT_FALSE(results.empty());
+  EXPECT_LT(results.size(), kNumTokens);
+  // The kept results are the best ones.
+  std::vector<int> wcosts;
+  for (const Result &result : results) {
+    wcosts.push_back(result.wcost);
+  }
+  std::sort(wcosts.begin(), wcosts.end());
+  for (size_t i = 0; i < wcosts.size(); ++i) {
+    EXPECT_EQ(wcosts[i], static_cast<int>(i));
+  }
+}
+
 TEST_F(DictionaryPredictionAggregatorTest, MobileUnigram) {
   std::unique_ptr<MockDataAndAggregator> data_and_aggregator =
       CreateAggregatorWithMockData();
@@ -2090,6 +2138,74 @@ TEST_F(DictionaryPredictionAggregatorTest,
   }
 }
 
+TEST_F(DictionaryPredictionAggregatorTest,
+       AggregateTypingCorrectedPredictionWithTypingModel) {
+  std::unique_ptr<MockDataAndAggregator> data_and_aggregator =
+      CreateAggregatorWithMockData();
+  const DictionaryPredictionAggregatorTestPeer &aggregator =
+      data_and_aggregator->aggregator();
+  EXPECT_CALL(*data_and_aggregator->mutable_dictionary(),
+              LookupPredictive(StrEq("わたし"), _, _))
+      .WillRepeatedly(InvokeCallbackWithKeyValues({{"わたし", "私"}}));
+
+  // No supplemental model is set, so the typing model in the data set is used.
+  config_->set_use_typing_correction(true);
+  request_->set_special_romanji_table(
+      commands::Request::QWERTY_MOBILE_TO_HIRAGANA);
+  ASSERT_TRUE(table_->InitializeWithRequestAndConfig(*request_, *config_));
+  const composer::TypingModel *typing_model =
+      data_and_aggregator->modules().GetTypingModel(
+          commands::Request::QWERTY_MOBILE_TO_HIRAGANA);
+  ASSERT_NE(typing_model, nullptr);
+
+  auto set_up_input = [&](absl::string_view keys, Segments *segments) {
+    composer_->Reset();
+    composer_->InsertCharacter(std::string(keys));
+    InitSegmentsWithKey(composer_->GetStringForPreedit(), segments);
+  };
+
+  {
+    // "wataahi" is corrected to "わたし" among others.
+    Segments segments;
+    set_up_input("wataahi", &segments);
+    composer::TypingCorrector corrector(table_.get(), typing_model,
+                                        request_.get(), config_.get(),
+                                        /* beam_size= */ 16,
+                                        /* max_queries= */ 5);
+    corrector.InsertCharacters("wataahi");
+    const std::vector<TypeCorrectedQuery> queries = corrector.GetQueries();
+    const auto query = std::find_if(
+        queries.begin(), queries.end(),
+        [](const TypeCorrectedQuery &q) { return q.correction == "わたし"; });
+    ASSERT_NE(query, queries.end());
+    int expected_wcost = MockDictionary::kDefaultCost;
+    expected_wcost -= 1150 * query->bias;
+
+    std::vector<Result> results;
+    aggregator.AggregateTypingCorrectedPrediction(*prediction_convreq_,
+                                                  segments, &results);
+    const auto result =
+        std::find_if(results.begin(), results.end(), [](const Result &r) {
+          return r.key == "わたし" && r.value == "私";
+        });
+    ASSERT_NE(result, results.end());
+    EXPECT_TRUE(result->types & TYPING_CORRECTION);
+    EXPECT_EQ(result->typing_correction_score, query->score);
+    EXPECT_EQ(result->wcost, expected_wcost);
+  }
+  {
+    // No correction for the probable keys.
+    Segments segments;
+    set_up_input("watashi", &segments);
+    std::vector<Result> results;
+    aggregator.AggregateTypingCorrectedPrediction(*prediction_convreq_,
+                                                  segments, &results);
+    for (const Result &result : results) {
+      EXPECT_FALSE(result.types & TYPING_CORRECTION) << result.value;
+    }
+  }
+}
+
 TEST_F(DictionaryPredictionAggregatorTest, ZeroQuerySuggestionAfterNumbers) {
   std::unique_ptr<MockDataAndAggregator> data_and_aggregator =
       CreateAggregatorWithMockData();
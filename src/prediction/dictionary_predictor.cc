@@ -603,7 +603,9 @@ void DictionaryPredictor::MaybeApplyPostCorrection(
 int DictionaryPredictor::CalculateSingleKanjiCostOffset(
     const ConversionRequest &request, uint16_t rid,
     const absl::string_view input_key, absl::Span<const Result> results,
+    absl::Span<const int> lm_costs,
     absl::flat_hash_map<PrefixPenaltyKey, int> *cache) const {
+  DCHECK_EQ(results.size(), lm_costs.size());
   // Make a map from reference value to min-cost result.
   // Reference entry:
   //  - single-char REALTIME or UNIGRAM entry
@@ -613,7 +615,8 @@ int DictionaryPredictor::CalculateSingleKanjiCostOffset(
   // as the fallback.
   absl::flat_hash_map<absl::string_view, int> min_cost_map;
   int fallback_cost = -1;
-  for (const auto &result : results) {
+  for (size_t i = 0; i < results.size(); ++i) {
+    const Result &result = results[i];
     if (result.removed) {
       continue;
     }
@@ -623,7 +626,7 @@ int DictionaryPredictor::CalculateSingleKanjiCostOffset(
     }
 
     if (result.value == input_key) {
-      const int cost = GetLMCost(result, rid);
+      const int cost = lm_costs[i];
       if (fallback_cost == -1 || fallback_cost > cost) {
         fallback_cost = cost;
       }
@@ -633,7 +636,7 @@ int DictionaryPredictor::CalculateSingleKanjiCostOffset(
          Util::CharsLen(result.value) != 1)) {
       continue;
     }
-    int lm_cost = GetLMCost(result, rid);
+    int lm_cost = lm_costs[i];
     if (result.candidate_attributes &
         Segment::Candidate::PARTIALLY_KEY_CONSUMED) {
       lm_cost += CalculatePrefixPenalty(request, input_key, result,
@@ -956,6 +959,39 @@ int DictionaryPredictor::GetLMCost(const Result &result, int rid) const {
   return lm_cost;
 }
 
+std::vector<int> DictionaryPredictor::GetLMCosts(
+    absl::Span<const Result> results, int rid) const {
+  // Transition costs to lid from |rid| and from BOS.
+  struct TransitionCosts {
+    int with_context;
+    int without_context;
+  };
+  absl::flat_hash_map<uint16_t, TransitionCosts> transition_costs;
+
+  std::vector<int> lm_costs(results.size());
+  for (size_t i = 0; i < results.size(); ++i) {
+    const Result &result = results[i];
+    const auto [it, inserted] = transition_costs.try_emplace(result.lid);
+    TransitionCosts &costs = it->second;
+    if (inserted) {
+      costs.with_context = connector_.GetTransitionCost(rid, result.lid);
+      costs.without_context = connector_.GetTransitionCost(0, result.lid);
+    }
+
+    // Same as GetLMCost().
+    if (result.types & PredictionType::SUFFIX) {
+      lm_costs[i] = costs.with_context + result.wcost;
+    } else {
+      lm_costs[i] =
+          std::min(costs.with_context, costs.without_context) + result.wcost;
+    }
+    if (!(result.types & PredictionType::REALTIME)) {
+      lm_costs[i] += segmenter_->GetSuffixPenalty(result.rid);
+    }
+  }
+  return lm_costs;
+}
+
 void DictionaryPredictor::SetPredictionCost(
     ConversionRequest::RequestType request_type, const Segments &segments,
     std::vector<Result> *results) const {
@@ -980,9 +1016,10 @@ void DictionaryPredictor::SetPredictionCost(
   const size_t bigram_key_len = Util::CharsLen(bigram_key);
   const size_t unigram_key_len = Util::CharsLen(input_key);
 
+  const std::vector<int> lm_costs = GetLMCosts(*results, rid);
   for (size_t i = 0; i < results->size(); ++i) {
     const Result &result = (*results)[i];
-    const int cost = GetLMCost(result, rid);
+    const int cost = lm_costs[i];
     const size_t query_len = (result.types & PredictionType::BIGRAM)
                                  ? bigram_key_len
                                  : unigram_key_len;
@@ -1063,13 +1100,15 @@ void DictionaryPredictor::SetPredictionCostForMixedConversion(
 
   absl::flat_hash_map<PrefixPenaltyKey, int32_t> prefix_penalty_cache;
   const std::string &input_key = segments.conversion_segment(0).key();
+  const std::vector<int> lm_costs = GetLMCosts(*results, rid);
   const int single_kanji_offset = CalculateSingleKanjiCostOffset(
-      request, rid, input_key, *results, &prefix_penalty_cache);
+      request, rid, input_key, *results, lm_costs, &prefix_penalty_cache);
 
   const KeyValueView history = GetHistoryKeyAndValue(segments);
 
-  for (Result &result : *results) {
-    int cost = GetLMCost(result, rid);
+  for (size_t i = 0; i < results->size(); ++i) {
+    Result &result = (*results)[i];
+    int cost = lm_costs[i];
     MOZC_WORD_LOG(result, absl::StrCat("GetLMCost: ", cost));
     if (result.lid == result.rid && !pos_matcher_.IsSuffixWord(result.rid) &&
         !pos_matcher_.IsFunctional(result.rid) &&
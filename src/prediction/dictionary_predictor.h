@@ -193,6 +193,10 @@ class DictionaryPredictor : public PredictorInterface {
   // If |rid| is unknown, set 0 as a default value.
   int GetLMCost(const Result &result, int rid) const;
 
+  // Returns GetLMCost() of each of |results|.  The results share only a few
+  // POS ids, so the transition costs are looked up once per distinct lid.
+  std::vector<int> GetLMCosts(absl::Span<const Result> results, int rid) const;
+
   // Given the results aggregated by aggregates, remove
   // miss-spelled results from the |results|.
   // we don't directly remove miss-spelled result but set
@@ -258,9 +262,11 @@ class DictionaryPredictor : public PredictorInterface {
   // Returns the cost offset for SINGLE_KANJI results.
   // Aggregated SINGLE_KANJI results does not have LM based wcost(word cost),
   // so we want to add the offset based on the other entries.
+  // |lm_costs| are GetLMCosts() of |results|.
   int CalculateSingleKanjiCostOffset(
       const ConversionRequest &request, uint16_t rid,
       absl::string_view input_key, absl::Span<const Result> results,
+      absl::Span<const int> lm_costs,
       absl::flat_hash_map<PrefixPenaltyKey, int> *cache) const;
 
   // Returns true if the suggestion is classified
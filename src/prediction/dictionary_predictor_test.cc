@@ -33,6 +33,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <iterator>
 #include <memory>
 #include <string>
 #include <utility>
@@ -122,6 +123,10 @@ class DictionaryPredictorTestPeer {
     return predictor_.GetLMCost(result, rid);
   }
 
+  std::vector<int> GetLMCosts(absl::Span<const Result> results, int rid) const {
+    return predictor_.GetLMCosts(results, rid);
+  }
+
   void SetPredictionCostForMixedConversion(const ConversionRequest &request,
                                            const Segments &segments,
                                            std::vector<Result> *results) const {
@@ -523,6 +528,34 @@ TEST_F(DictionaryPredictorTest, GetLMCost) {
   }
 }
 
+TEST_F(DictionaryPredictorTest, GetLMCosts) {
+  auto data_and_predictor = std::make_unique<MockDataAndPredictor>();
+  const DictionaryPredictorTestPeer &predictor =
+      data_and_predictor->predictor();
+
+  // Results sharing a few lids, with and without suffix penalties.
+  constexpr PredictionTypes kTypes[] = {
+      prediction::SUFFIX, prediction::REALTIME, prediction::UNIGRAM};
+  std::vector<Result> results;
+  for (int i = 0; i < 60; ++i) {
+    Result result;
+    result.lid = i % 7;
+    result.rid = i % 5;
+    result.wcost = 10 * i;
+    result.types = kTypes[i % std::size(kTypes)];
+    results.push_back(std::move(result));
+  }
+
+  for (const int rid : {0, 3, 42}) {
+    const std::vector<int> costs = predictor.GetLMCosts(results, rid);
+    ASSERT_EQ(costs.size(), results.size());
+    for (size_t i = 0; i < results.size(); ++i) {
+      EXPECT_EQ(costs[i], predictor.GetLMCost(results[i], rid));
+    }
+  }
+  EXPECT_TRUE(predictor.GetLMCosts({}, 0).empty());
+}
+
 TEST_F(DictionaryPredictorTest, SetPredictionCostForMixedConversion) {
   auto data_and_predictor = std::make_unique<MockDataAndPredictor>();
   const DictionaryPredictorTestPeer &predictor =
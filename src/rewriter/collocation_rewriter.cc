@@ -77,8 +77,40 @@ bool CollocationFilter::Exists(const absl::string_view left,
   if (left.empty() || right.empty()) {
     return false;
   }
-  const uint64_t id = Fingerprint(absl::StrCat(left, right));
-  return filter_.Exists(id);
+  FingerprintBuilder builder;
+  builder.Append(left);
+  builder.Append(right);
+  return filter_.Exists(builder.Fingerprint());
+}
+
+int CollocationFilter::FindFirst(
+    const absl::string_view left,
+    const absl::Span<const std::string> rights) const {
+  if (left.empty()) {
+    return -1;
+  }
+  FingerprintBuilder prefix;
+  prefix.Append(left);
+
+  constexpr size_t kBatchSize = 16;
+  uint64_t hashes[kBatchSize];
+  bool exists[kBatchSize];
+  for (size_t begin = 0; begin < rights.size(); begin += kBatchSize) {
+    const size_t size = std::min(kBatchSize, rights.size() - begin);
+    for (size_t i = 0; i < size; ++i) {
+      FingerprintBuilder builder = prefix;
+      builder.Append(rights[begin + i]);
+      hashes[i] = builder.Fingerprint();
+    }
+    filter_.Exists(absl::MakeConstSpan(hashes, size),
+                   absl::MakeSpan(exists, size));
+    for (size_t i = 0; i < size; ++i) {
+      if (exists[i] && !rights[begin + i].empty()) {
+        return static_cast<int>(begin + i);
+      }
+    }
+  }
+  return -1;
 }
 
 absl::StatusOr<SuppressionFilter> SuppressionFilter::Create(
@@ -93,9 +125,11 @@ absl::StatusOr<SuppressionFilter> SuppressionFilter::Create(
 bool SuppressionFilter::Exists(const Segment::Candidate &cand) const {
   // TODO(noriyukit): We should share key generation rule with
   // gen_collocation_suppression_data_main.cc.
-  const uint64_t id =
-      Fingerprint(absl::StrCat(cand.content_value, "\t", cand.content_key));
-  return filter_.Exists(id);
+  FingerprintBuilder builder;
+  builder.Append(cand.content_value);
+  builder.Append("\t");
+  builder.Append(cand.content_key);
+  return filter_.Exists(builder.Fingerprint());
 }
 
 }  // namespace collocation_rewriter_internal
@@ -107,7 +141,6 @@ using ::mozc::collocation_rewriter_internal::SuppressionFilter;
 
 constexpr size_t kCandidateSize = 12;
 constexpr int kMaxCostDiff = 3453;  // -500*log(1/1000)
-
 // For collocation, we use two segments.
 enum SegmentLookupType {
   LEFT,
@@ -595,9 +628,10 @@ bool CollocationRewriter::RewriteFromPrevSegment(
 
   const size_t i_max = std::min(seg->candidates_size(), kCandidateSize);
 
-  // Reuse |curs| and |cur| in the loop as this method is performance critical.
+  // Reuse |curs| and |normalized_curs| in the loop as this method is
+  // performance critical.
   std::vector<std::string> curs;
-  std::string cur;
+  std::vector<std::string> normalized_curs;
   for (size_t i = 0; i < i_max; ++i) {
     if (seg->candidate(i).cost > seg->candidate(0).cost + kMaxCostDiff) {
       continue;
@@ -613,19 +647,22 @@ bool CollocationRewriter::RewriteFromPrevSegment(
       continue;
     }
 
-    for (int j = 0; j < curs.size(); ++j) {
-      cur.clear();
-      CollocationUtil::GetNormalizedScript(curs[j], false, &cur);
-      if (collocation_filter_.Exists(prev, cur)) {
-        if (i != 0) {
-          MOZC_VLOG(3) << prev << cur << " " << seg->candidate(0).value << "->"
-                       << seg->candidate(i).value;
-        }
-        seg->move_candidate(i, 0);
-        seg->mutable_candidate(0)->attributes |=
-            Segment::Candidate::CONTEXT_SENSITIVE;
-        return true;
+    normalized_curs.resize(curs.size());
+    for (size_t j = 0; j < curs.size(); ++j) {
+      normalized_curs[j].clear();
+      CollocationUtil::GetNormalizedScript(curs[j], false, &normalized_curs[j]);
+    }
+    const int found = collocation_filter_.FindFirst(prev, normalized_curs);
+    if (found >= 0) {
+      if (i != 0) {
+        MOZC_VLOG(3) << prev << normalized_curs[found] << " "
+                     << seg->candidate(0).value << "->"
+                     << seg->candidate(i).value;
       }
+      seg->move_candidate(i, 0);
+      seg->mutable_candidate(0)->attributes |=
+          Segment::Candidate::CONTEXT_SENSITIVE;
+      return true;
     }
   }
   return false;
@@ -636,35 +673,39 @@ bool CollocationRewriter::RewriteUsingNextSegment(Segment *next_seg,
   const size_t i_max = std::min(seg->candidates_size(), kCandidateSize);
   const size_t j_max = std::min(next_seg->candidates_size(), kCandidateSize);
 
-  // Cache the results for the next segment
-  std::vector<int> next_seg_ok(j_max);  // Avoiding std::vector<bool>
-  std::vector<std::vector<std::string>> normalized_string(j_max);
-
-  // Reuse |nexts| in the loop as this method is performance critical.
+  // Normalize the forms of the next segment once. |nexts| holds them in the
+  // order of the candidates and |next_indices| holds the candidate index of
+  // each form, so a pair check is a lookup over a flat array.
   std::vector<std::string> nexts;
+  std::vector<size_t> next_indices;
+  // Reuse |contents| in the loop as this method is performance critical.
+  std::vector<std::string> contents;
   for (size_t j = 0; j < j_max; ++j) {
-    next_seg_ok[j] = 0;
-
+    if (next_seg->candidate(j).cost >
+        next_seg->candidate(0).cost + kMaxCostDiff) {
+      continue;
+    }
     if (IsName(next_seg->candidate(j))) {
       continue;
     }
     if (suppression_filter_.Exists(next_seg->candidate(j))) {
       continue;
     }
-    nexts.clear();
+    contents.clear();
     if (!IsNaturalContent(next_seg->candidate(j), next_seg->candidate(0), RIGHT,
-                          &nexts)) {
+                          &contents)) {
       continue;
     }
 
-    next_seg_ok[j] = 1;
-    for (std::vector<std::string>::const_iterator it = nexts.begin();
-         it != nexts.end(); ++it) {
-      normalized_string[j].push_back(std::string());
-      CollocationUtil::GetNormalizedScript(*it, false,
-                                           &normalized_string[j].back());
+    for (const std::string &content : contents) {
+      nexts.emplace_back();
+      CollocationUtil::GetNormalizedScript(content, false, &nexts.back());
+      next_indices.push_back(j);
     }
   }
+  if (nexts.empty()) {
+    return false;
+  }
 
   // Reuse |curs| and |cur| in the loop as this method is performance critical.
   std::vector<std::string> curs;
@@ -687,31 +728,21 @@ bool CollocationRewriter::RewriteUsingNextSegment(Segment *next_seg,
     for (int k = 0; k < curs.size(); ++k) {
       cur.clear();
       CollocationUtil::GetNormalizedScript(curs[k], true, &cur);
-      for (size_t j = 0; j < j_max; ++j) {
-        if (next_seg->candidate(j).cost >
-            next_seg->candidate(0).cost + kMaxCostDiff) {
-          continue;
-        }
-        if (!next_seg_ok[j]) {
-          continue;
-        }
-
-        for (int l = 0; l < normalized_string[j].size(); ++l) {
-          const std::string &next = normalized_string[j][l];
-          if (collocation_filter_.Exists(cur, next)) {
-            DCHECK(VerifyNaturalContent(next_seg->candidate(j),
-                                        next_seg->candidate(0), RIGHT))
-                << "IsNaturalContent() should not fail here.";
-            seg->move_candidate(i, 0);
-            seg->mutable_candidate(0)->attributes |=
-                Segment::Candidate::CONTEXT_SENSITIVE;
-            next_seg->move_candidate(j, 0);
-            next_seg->mutable_candidate(0)->attributes |=
-                Segment::Candidate::CONTEXT_SENSITIVE;
-            return true;
-          }
-        }
+      const int found = collocation_filter_.FindFirst(cur, nexts);
+      if (found < 0) {
+        continue;
       }
+      const size_t j = next_indices[found];
+      DCHECK(VerifyNaturalContent(next_seg->candidate(j),
+                                  next_seg->candidate(0), RIGHT))
+          << "IsNaturalContent() should not fail here.";
+      seg->move_candidate(i, 0);
+      seg->mutable_candidate(0)->attributes |=
+          Segment::Candidate::CONTEXT_SENSITIVE;
+      next_seg->move_candidate(j, 0);
+      next_seg->mutable_candidate(0)->attributes |=
+          Segment::Candidate::CONTEXT_SENSITIVE;
+      return true;
     }
   }
   return false;
@@ -32,6 +32,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <string>
 #include <utility>
 
 #include "absl/status/statusor.h"
@@ -57,6 +58,13 @@ class CollocationFilter {
 
   bool Exists(absl::string_view left, absl::string_view right) const;
 
+  // Returns the index of the first string in `rights` that forms a
+  // collocation with `left`, or -1 if none does. The pairs are hashed from the
+  // fingerprint state of `left` without concatenating the strings, and the
+  // filter is probed in batches.
+  int FindFirst(absl::string_view left,
+                absl::Span<const std::string> rights) const;
+
  private:
   storage::ExistenceFilter filter_;
 };
@@ -0,0 +1,175 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// Measures the time of CollocationRewriter::Rewrite() for two segments with
+// many candidates, and the time of hashing all the candidate pairs with and
+// without building the concatenated strings.
+//
+// Usage:
+//   collocation_rewriter_benchmark_main --candidates=50 --iterations=1000
+
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/log/check.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "base/hash.h"
+#include "base/init_mozc.h"
+#include "base/stopwatch.h"
+#include "converter/segments.h"
+#include "data_manager/oss/oss_data_manager.h"
+#include "dictionary/pos_matcher.h"
+#include "request/conversion_request.h"
+#include "rewriter/collocation_rewriter.h"
+
+ABSL_FLAG(int32_t, candidates, 50, "the number of candidates per segment");
+ABSL_FLAG(int32_t, iterations, 1000, "the number of iterations");
+
+namespace mozc {
+namespace {
+
+// Kanji to build distinct candidate values which are not in the collocation
+// data, so that the rewriter checks all the pairs.
+constexpr absl::string_view kKanji[] = {"亜", "伊", "宇", "江", "尾",
+                                        "加", "木", "区", "毛", "古"};
+
+std::string MakeValue(int index) {
+  std::string value;
+  do {
+    value.append(kKanji[index % std::size(kKanji)]);
+    index /= std::size(kKanji);
+  } while (index > 0);
+  return value;
+}
+
+void AddSegment(absl::string_view key, absl::string_view suffix,
+                int candidates, uint16_t id, Segments *segments) {
+  Segment *segment = segments->add_segment();
+  segment->set_key(key);
+  for (int i = 0; i < candidates; ++i) {
+    Segment::Candidate *candidate = segment->add_candidate();
+    candidate->key = std::string(key);
+    candidate->content_key = std::string(key);
+    candidate->value = absl::StrCat(MakeValue(i), suffix);
+    candidate->content_value = candidate->value;
+    candidate->cost = i;
+    candidate->lid = id;
+    candidate->rid = id;
+  }
+}
+
+void Report(absl::string_view name, absl::Duration elapsed, int count) {
+  std::cout << name << ": " << elapsed / count << " per iteration ("
+            << elapsed << " in total)" << std::endl;
+}
+
+void Run() {
+  const int candidates = absl::GetFlag(FLAGS_candidates);
+  const int iterations = absl::GetFlag(FLAGS_iterations);
+  CHECK_GT(iterations, 0);
+
+  const oss::OssDataManager data_manager;
+  const dictionary::PosMatcher pos_matcher(data_manager.GetPosMatcherData());
+  std::unique_ptr<CollocationRewriter> rewriter =
+      CollocationRewriter::Create(data_manager);
+  CHECK(rewriter);
+
+  Segments segments;
+  AddSegment("ねこを", "を", candidates, pos_matcher.GetUnknownId(),
+             &segments);
+  AddSegment("かいたい", "い", candidates, pos_matcher.GetUnknownId(),
+             &segments);
+
+  const ConversionRequest request;
+  Stopwatch copy_stopwatch;
+  Stopwatch rewrite_stopwatch;
+  for (int i = 0; i < iterations; ++i) {
+    copy_stopwatch.Start();
+    Segments copied = segments;
+    copy_stopwatch.Stop();
+    rewrite_stopwatch.Start();
+    rewriter->Rewrite(request, &copied);
+    rewrite_stopwatch.Stop();
+  }
+  Report("Rewrite", rewrite_stopwatch.GetElapsed(), iterations);
+  Report("Segments copy (excluded)", copy_stopwatch.GetElapsed(), iterations);
+
+  std::vector<std::string> lefts, rights;
+  for (int i = 0; i < candidates; ++i) {
+    lefts.push_back(MakeValue(i));
+    rights.push_back(absl::StrCat(MakeValue(i), "い"));
+  }
+
+  // Accumulate the fingerprints so that the loops are not optimized out.
+  uint64_t concat_sum = 0;
+  const Stopwatch concat_stopwatch = Stopwatch::StartNew();
+  for (int i = 0; i < iterations; ++i) {
+    for (const std::string &left : lefts) {
+      for (const std::string &right : rights) {
+        concat_sum += Fingerprint(absl::StrCat(left, right));
+      }
+    }
+  }
+  Report("Pair hash with StrCat", concat_stopwatch.GetElapsed(), iterations);
+
+  uint64_t builder_sum = 0;
+  const Stopwatch builder_stopwatch = Stopwatch::StartNew();
+  for (int i = 0; i < iterations; ++i) {
+    for (const std::string &left : lefts) {
+      FingerprintBuilder prefix;
+      prefix.Append(left);
+      for (const std::string &right : rights) {
+        FingerprintBuilder builder = prefix;
+        builder.Append(right);
+        builder_sum += builder.Fingerprint();
+      }
+    }
+  }
+  Report("Pair hash with FingerprintBuilder", builder_stopwatch.GetElapsed(),
+         iterations);
+  CHECK_EQ(concat_sum, builder_sum);
+}
+
+}  // namespace
+}  // namespace mozc
+
+int main(int argc, char **argv) {
+  mozc::InitMozc(argv[0], &argc, &argv);
+  mozc::Run();
+  return 0;
+}
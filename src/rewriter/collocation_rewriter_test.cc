@@ -35,6 +35,8 @@
 #include <memory>
 #include <string>
 
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "converter/segments.h"
 #include "data_manager/testing/mock_data_manager.h"
 #include "dictionary/pos_matcher.h"
@@ -325,6 +327,57 @@ TEST_F(CollocationRewriterTest, DoNotPromoteHighCostCandidate) {
   EXPECT_NE(GetTopValue(segments), "猫を飼いたい") << segments.DebugString();
 }
 
+TEST_F(CollocationRewriterTest, ChecksAllPairs) {
+  // Make the following Segments, where the only collocation pair lies beyond
+  // the first 256 pairs checked:
+  // "ねこを"         | "かいたい"
+  // -----------------------------
+  // "亜を"           | "之て" (checked as "之て" and "之")
+  // ...              | ...
+  // "猫を" (12th)     | "飼いたい" (the 11th form)
+  // ...              | ...
+  //
+  // Each of the left candidates is paired with the 23 forms of the right
+  // candidates, so the pair is the 264th one. All the pairs are checked.
+  const uint16_t id = pos_matcher_.GetUnknownId();
+  constexpr absl::string_view kLefts[] = {"亜", "伊", "宇", "江", "尾", "加",
+                                          "木", "区", "毛", "古", "佐"};
+  constexpr absl::string_view kRights[] = {"之", "寸", "世", "曽", "太", "知",
+                                           "津", "手", "戸", "奈", "仁"};
+  auto make_segments = [&](size_t neko_index, Segments *segments) {
+    segments->Clear();
+    Segment *left = segments->add_segment();
+    left->set_key("ねこを");
+    for (size_t i = 0, dummy = 0; i <= std::size(kLefts); ++i) {
+      Segment::Candidate *cand = left->add_candidate();
+      cand->key = "ねこを";
+      cand->content_key = "ねこを";
+      cand->value = absl::StrCat(
+          i == neko_index ? absl::string_view("猫") : kLefts[dummy++], "を");
+      cand->content_value = cand->value;
+      cand->lid = id;
+      cand->rid = id;
+    }
+    Segment *right = segments->add_segment();
+    right->set_key("かいたい");
+    for (size_t i = 0, dummy = 0; i <= std::size(kRights); ++i) {
+      Segment::Candidate *cand = right->add_candidate();
+      cand->key = "かいたい";
+      cand->content_key = "かいたい";
+      cand->value =
+          i == 5 ? "飼いたい" : absl::StrCat(kRights[dummy++], "て");
+      cand->content_value = cand->value;
+      cand->lid = id;
+      cand->rid = id;
+    }
+  };
+
+  Segments segments;
+  make_segments(11, &segments);
+  EXPECT_TRUE(Rewrite(&segments));
+  EXPECT_EQ(GetTopValue(segments), "猫を飼いたい") << segments.DebugString();
+}
+
 TEST_F(CollocationRewriterTest, ImmuneToInvalidSegments) {
   const uint16_t kUnkId = pos_matcher_.GetUnknownId();
   const CandidateData kNekowoCands[] = {
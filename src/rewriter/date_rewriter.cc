@@ -494,11 +494,11 @@ bool ExpandYear(const absl::string_view prefix, int year,
 
   std::string arabic = std::to_string(year);
 
-  std::vector<NumberUtil::NumberString> output;
+  NumberUtil::NumberStringList output;
 
   NumberUtil::ArabicToKanji(arabic, &output);
 
-  for (int i = 0; i < output.size(); i++) {
+  for (size_t i = 0; i < output.size(); i++) {
     if (output[i].style == NumberUtil::NumberString::NUMBER_KANJI) {
       result->push_back(absl::StrCat(prefix, output[i].value));
     }
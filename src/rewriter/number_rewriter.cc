@@ -30,6 +30,7 @@
 #include "rewriter/number_rewriter.h"
 
 #include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <cstdio>
 #include <optional>
@@ -37,7 +38,6 @@
 #include <utility>
 #include <vector>
 
-#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
@@ -245,28 +245,29 @@ bool IsNumberCandidate(const Segment::Candidate &candidate,
 }
 
 void SetNumberInfoToExistingCandidates(
-    const std::vector<NumberUtil::NumberString> &numbers,
-    const PosMatcher &pos_matcher, Segment *segment) {
-  absl::flat_hash_map<std::string, NumberUtil::NumberString> number_map;
-  // Different number style can have the same surface
-  // ex. (123, NUMBER_SEPARATED_ARABIC_HALFWIDTH) and (123, DEFAULT_STYLE)
-  for (const auto &entry : numbers) {
-    number_map.emplace(entry.value, entry);
-  }
-
+    const NumberUtil::NumberStringList &numbers, const PosMatcher &pos_matcher,
+    Segment *segment) {
   for (size_t i = 0; i < segment->candidates_size(); ++i) {
     Segment::Candidate *candidate = segment->mutable_candidate(i);
-    const auto &itr = number_map.find(candidate->value);
-    if (itr == number_map.end()) {
+    // The list has a dozen entries at most, so a linear scan is cheaper than
+    // building a map.  Different number style can have the same surface
+    // ex. (123, NUMBER_SEPARATED_ARABIC_HALFWIDTH) and (123, DEFAULT_STYLE)
+    // and the first one is used.
+    size_t j = 0;
+    while (j < numbers.size() && numbers[j].value != candidate->value) {
+      ++j;
+    }
+    if (j == numbers.size()) {
       continue;
     }
     if (!IsNumberCandidate(*candidate, pos_matcher)) {
       continue;
     }
 
-    candidate->style = itr->second.style;
+    const NumberUtil::NumberStringList::Entry entry = numbers[j];
+    candidate->style = entry.style;
     if (candidate->description.empty()) {
-      candidate->description = itr->second.description;
+      candidate->description = std::string(entry.description);
     }
   }
 }
@@ -417,33 +418,34 @@ int GetInsertPos(int base_pos, const Segment &segment, RewriteType type) {
 }
 
 void InsertHalfArabic(const absl::string_view half_arabic,
-                      std::vector<NumberUtil::NumberString> *output) {
-  output->emplace_back(std::string(half_arabic), "",
-                       NumberUtil::NumberString::DEFAULT_STYLE);
+                      NumberUtil::NumberStringList *output) {
+  output->Add(half_arabic, "", NumberUtil::NumberString::DEFAULT_STYLE);
 }
 
-std::vector<NumberUtil::NumberString> GetNumbersInDefaultOrder(
-    RewriteType type, bool exec_radix_conversion,
-    const absl::string_view arabic_content_value) {
-  std::vector<NumberUtil::NumberString> output;
+// Fills |output| with the numbers converted from |arabic_content_value|.
+// Radix forms, which are rarely selected, are generated only when
+// |exec_radix_conversion| is true.
+void GetNumbersInDefaultOrder(RewriteType type, bool exec_radix_conversion,
+                              const absl::string_view arabic_content_value,
+                              NumberUtil::NumberStringList *output) {
+  output->Clear();
   if (type == ARABIC_FIRST) {
-    InsertHalfArabic(arabic_content_value, &output);
-    NumberUtil::ArabicToWideArabic(arabic_content_value, &output);
-    NumberUtil::ArabicToSeparatedArabic(arabic_content_value, &output);
-    NumberUtil::ArabicToKanji(arabic_content_value, &output);
-    NumberUtil::ArabicToOtherForms(arabic_content_value, &output);
+    InsertHalfArabic(arabic_content_value, output);
+    NumberUtil::ArabicToWideArabic(arabic_content_value, output);
+    NumberUtil::ArabicToSeparatedArabic(arabic_content_value, output);
+    NumberUtil::ArabicToKanji(arabic_content_value, output);
+    NumberUtil::ArabicToOtherForms(arabic_content_value, output);
   } else if (type == KANJI_FIRST) {
-    NumberUtil::ArabicToKanji(arabic_content_value, &output);
-    InsertHalfArabic(arabic_content_value, &output);
-    NumberUtil::ArabicToWideArabic(arabic_content_value, &output);
-    NumberUtil::ArabicToSeparatedArabic(arabic_content_value, &output);
-    NumberUtil::ArabicToOtherForms(arabic_content_value, &output);
+    NumberUtil::ArabicToKanji(arabic_content_value, output);
+    InsertHalfArabic(arabic_content_value, output);
+    NumberUtil::ArabicToWideArabic(arabic_content_value, output);
+    NumberUtil::ArabicToSeparatedArabic(arabic_content_value, output);
+    NumberUtil::ArabicToOtherForms(arabic_content_value, output);
   }
 
   if (exec_radix_conversion) {
-    NumberUtil::ArabicToOtherRadixes(arabic_content_value, &output);
+    NumberUtil::ArabicToOtherRadixes(arabic_content_value, output);
   }
-  return output;
 }
 
 }  // namespace
@@ -499,6 +501,8 @@ bool NumberRewriter::RewriteOneSegment(const ConversionRequest &request,
   const bool should_rarank = ShouldRerankCandidates(request, *segments);
 
   bool modified = false;
+  // Shared by all the candidates to reuse its buffer.
+  NumberUtil::NumberStringList numbers;
   std::vector<RewriteCandidateInfo> rewrite_candidate_infos;
   GetRewriteCandidateInfos(suffix_array_, *seg, pos_matcher_,
                            &rewrite_candidate_infos);
@@ -525,13 +529,12 @@ bool NumberRewriter::RewriteOneSegment(const ConversionRequest &request,
                  << arabic_content_value;
       break;
     }
-    const std::vector<NumberUtil::NumberString> &output =
-        GetNumbersInDefaultOrder(info.type, exec_radix_conversion,
-                                 arabic_content_value);
-    SetNumberInfoToExistingCandidates(output, pos_matcher_, seg);
+    GetNumbersInDefaultOrder(info.type, exec_radix_conversion,
+                             arabic_content_value, &numbers);
+    SetNumberInfoToExistingCandidates(numbers, pos_matcher_, seg);
 
     const std::vector<Segment::Candidate> &number_candidates =
-        GenerateCandidatesToInsert(info.candidate, output, should_rarank);
+        GenerateCandidatesToInsert(info.candidate, numbers, should_rarank);
 
     // Caution!!!: This invocation will update the data inside of the
     // rewrite_candidate_infos. Thus, |info| also can be updated as well
@@ -549,12 +552,13 @@ bool NumberRewriter::RewriteOneSegment(const ConversionRequest &request,
 
 std::vector<Segment::Candidate> NumberRewriter::GenerateCandidatesToInsert(
     const Segment::Candidate &arabic_candidate,
-    const std::vector<NumberUtil::NumberString> &numbers,
-    bool should_rerank) const {
+    const NumberUtil::NumberStringList &numbers, bool should_rerank) const {
   std::vector<Segment::Candidate> converted_numbers;
-  for (const auto &number_string : numbers) {
-    PushBackCandidate(number_string.value, number_string.description,
-                      number_string.style, &converted_numbers);
+  converted_numbers.reserve(numbers.size());
+  for (size_t i = 0; i < numbers.size(); ++i) {
+    const NumberUtil::NumberStringList::Entry entry = numbers[i];
+    PushBackCandidate(entry.value, entry.description, entry.style,
+                      &converted_numbers);
   }
   SetCandidatesInfo(arabic_candidate, &converted_numbers);
   if (should_rerank) {
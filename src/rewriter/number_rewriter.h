@@ -63,8 +63,7 @@ class NumberRewriter : public RewriterInterface {
   void RememberNumberStyle(const Segment::Candidate &candidate);
   std::vector<Segment::Candidate> GenerateCandidatesToInsert(
       const Segment::Candidate &arabic_candidate,
-      const std::vector<NumberUtil::NumberString> &numbers,
-      bool should_rerank) const;
+      const NumberUtil::NumberStringList &numbers, bool should_rerank) const;
   bool ShouldRerankCandidates(const ConversionRequest &request,
                               const Segments &segments) const;
   void RerankCandidates(std::vector<Segment::Candidate> &candidates) const;
@@ -285,28 +285,23 @@ bool TransliterationRewriter::FillT13nsFromComposer(
 // ('n' or 'nn' for "ん", etc)
 bool TransliterationRewriter::FillT13nsFromKey(Segments *segments) const {
   bool modified = false;
+  // Reused across the segments.
+  japanese_util::HiraganaTransliterations forms;
   for (Segment &segment : segments->conversion_segments()) {
     if (segment.key().empty()) {
       continue;
     }
     const std::string &hiragana = segment.key();
-    std::string full_katakana = japanese_util::HiraganaToKatakana(hiragana);
-    std::string ascii = japanese_util::HiraganaToRomanji(hiragana);
-    std::string half_ascii =
-        japanese_util::FullWidthAsciiToHalfWidthAscii(ascii);
-    std::string full_ascii =
-        japanese_util::HalfWidthAsciiToFullWidthAscii(half_ascii);
-    std::string half_katakana =
-        japanese_util::FullWidthToHalfWidth(full_katakana);
-    std::string half_ascii_upper = half_ascii;
-    std::string half_ascii_lower = half_ascii;
-    std::string half_ascii_capitalized = half_ascii;
+    japanese_util::HiraganaToTransliterations(hiragana, &forms);
+    std::string half_ascii_upper = forms.half_romanji;
+    std::string half_ascii_lower = forms.half_romanji;
+    std::string half_ascii_capitalized = forms.half_romanji;
     Util::UpperString(&half_ascii_upper);
     Util::LowerString(&half_ascii_lower);
     Util::CapitalizeString(&half_ascii_capitalized);
-    std::string full_ascii_upper = full_ascii;
-    std::string full_ascii_lower = full_ascii;
-    std::string full_ascii_capitalized = full_ascii;
+    std::string full_ascii_upper = forms.full_romanji;
+    std::string full_ascii_lower = forms.full_romanji;
+    std::string full_ascii_capitalized = forms.full_romanji;
     Util::UpperString(&full_ascii_upper);
     Util::LowerString(&full_ascii_lower);
     Util::CapitalizeString(&full_ascii_capitalized);
@@ -314,13 +309,13 @@ bool TransliterationRewriter::FillT13nsFromKey(Segments *segments) const {
     std::vector<std::string> t13ns;
     t13ns.resize(transliteration::NUM_T13N_TYPES);
     t13ns[transliteration::HIRAGANA] = hiragana;
-    t13ns[transliteration::FULL_KATAKANA] = full_katakana;
-    t13ns[transliteration::HALF_KATAKANA] = half_katakana;
-    t13ns[transliteration::HALF_ASCII] = half_ascii;
+    t13ns[transliteration::FULL_KATAKANA] = forms.full_katakana;
+    t13ns[transliteration::HALF_KATAKANA] = forms.half_katakana;
+    t13ns[transliteration::HALF_ASCII] = forms.half_romanji;
     t13ns[transliteration::HALF_ASCII_UPPER] = half_ascii_upper;
     t13ns[transliteration::HALF_ASCII_LOWER] = half_ascii_lower;
     t13ns[transliteration::HALF_ASCII_CAPITALIZED] = half_ascii_capitalized;
-    t13ns[transliteration::FULL_ASCII] = full_ascii;
+    t13ns[transliteration::FULL_ASCII] = forms.full_romanji;
     t13ns[transliteration::FULL_ASCII_UPPER] = full_ascii_upper;
     t13ns[transliteration::FULL_ASCII_LOWER] = full_ascii_lower;
     t13ns[transliteration::FULL_ASCII_CAPITALIZED] = full_ascii_capitalized;
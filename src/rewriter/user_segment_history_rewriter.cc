@@ -30,6 +30,7 @@
 #include "rewriter/user_segment_history_rewriter.h"
 
 #include <algorithm>
+#include <array>
 #include <cctype>
 #include <cstddef>
 #include <cstdint>
@@ -44,8 +45,8 @@
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
-#include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "base/config_file_stream.h"
 #include "base/file_util.h"
 #include "base/number_util.h"
@@ -149,38 +150,62 @@ inline int GetDefaultCandidateIndex(const Segment &segment) {
   return 0;
 }
 
+// Assigns |strings| joined with tabs to |buffer| and returns it. The buffer is
+// reused across feature keys so that building a key doesn't allocate.
 template <typename... Strings>
-std::string StrJoinWithTabs(const Strings &...strings) {
-  // Make sure we use the string_view overload so the buffer is preallocated.
-  return absl::StrJoin({static_cast<absl::string_view>(strings)...}, "\t");
+absl::string_view AssignJoinedWithTabs(std::string *buffer,
+                                       const Strings &...strings) {
+  buffer->clear();
+  bool first = true;
+  for (const absl::string_view str :
+       {static_cast<absl::string_view>(strings)...}) {
+    if (!first) {
+      buffer->push_back('\t');
+    }
+    first = false;
+    buffer->append(str);
+  }
+  return *buffer;
 }
 
+// Builds the feature keys. Each method writes the key into |buffer| and
+// returns a view of it, which is valid until |buffer| is modified. An empty
+// view is returned when the feature is not applicable.
 class FeatureKey {
  public:
   FeatureKey(const Segments &segments, const PosMatcher &pos_matcher,
              size_t index)
       : segments_(segments), pos_matcher_(pos_matcher), index_(index) {}
 
-  std::string LeftRight(absl::string_view base_key,
-                        absl::string_view base_value) const;
-  std::string LeftLeft(absl::string_view base_key,
-                       absl::string_view base_value) const;
-  std::string RightRight(absl::string_view base_key,
-                         absl::string_view base_value) const;
-  std::string Left(absl::string_view base_key,
-                   absl::string_view base_value) const;
-  std::string Right(absl::string_view base_key,
-                    absl::string_view base_value) const;
-  std::string Current(absl::string_view base_key,
-                      absl::string_view base_value) const;
-  std::string Single(absl::string_view base_key,
-                     absl::string_view base_value) const;
-  std::string LeftNumber(absl::string_view base_key,
-                         absl::string_view base_value) const;
-  std::string RightNumber(absl::string_view base_key,
-                          absl::string_view base_value) const;
-
-  static std::string Number(uint16_t type);
+  absl::string_view LeftRight(absl::string_view base_key,
+                              absl::string_view base_value,
+                              std::string *buffer) const;
+  absl::string_view LeftLeft(absl::string_view base_key,
+                             absl::string_view base_value,
+                             std::string *buffer) const;
+  absl::string_view RightRight(absl::string_view base_key,
+                               absl::string_view base_value,
+                               std::string *buffer) const;
+  absl::string_view Left(absl::string_view base_key,
+                         absl::string_view base_value,
+                         std::string *buffer) const;
+  absl::string_view Right(absl::string_view base_key,
+                          absl::string_view base_value,
+                          std::string *buffer) const;
+  absl::string_view Current(absl::string_view base_key,
+                            absl::string_view base_value,
+                            std::string *buffer) const;
+  absl::string_view Single(absl::string_view base_key,
+                           absl::string_view base_value,
+                           std::string *buffer) const;
+  absl::string_view LeftNumber(absl::string_view base_key,
+                               absl::string_view base_value,
+                               std::string *buffer) const;
+  absl::string_view RightNumber(absl::string_view base_key,
+                                absl::string_view base_value,
+                                std::string *buffer) const;
+
+  static absl::string_view Number(uint16_t type, std::string *buffer);
 
  private:
   const Segments &segments_;
@@ -189,85 +214,95 @@ class FeatureKey {
 };
 
 // Feature "Left Right"
-std::string FeatureKey::LeftRight(absl::string_view base_key,
-                                  absl::string_view base_value) const {
+absl::string_view FeatureKey::LeftRight(absl::string_view base_key,
+                                        absl::string_view base_value,
+                                        std::string *buffer) const {
   if (index_ + 1 >= segments_.segments_size() || index_ <= 0) {
     return "";
   }
   const int j1 = GetDefaultCandidateIndex(segments_.segment(index_ - 1));
   const int j2 = GetDefaultCandidateIndex(segments_.segment(index_ + 1));
-  return StrJoinWithTabs(
-      "LR", base_key, segments_.segment(index_ - 1).candidate(j1).value,
+  return AssignJoinedWithTabs(
+      buffer, "LR", base_key, segments_.segment(index_ - 1).candidate(j1).value,
       base_value, segments_.segment(index_ + 1).candidate(j2).value);
 }
 
 // Feature "Left Left"
-std::string FeatureKey::LeftLeft(absl::string_view base_key,
-                                 absl::string_view base_value) const {
+absl::string_view FeatureKey::LeftLeft(absl::string_view base_key,
+                                       absl::string_view base_value,
+                                       std::string *buffer) const {
   if (index_ < 2) {
     return "";
   }
   const int j1 = GetDefaultCandidateIndex(segments_.segment(index_ - 2));
   const int j2 = GetDefaultCandidateIndex(segments_.segment(index_ - 1));
-  return StrJoinWithTabs(
-      "LL", base_key, segments_.segment(index_ - 2).candidate(j1).value,
+  return AssignJoinedWithTabs(
+      buffer, "LL", base_key, segments_.segment(index_ - 2).candidate(j1).value,
       segments_.segment(index_ - 1).candidate(j2).value, base_value);
 }
 
 // Feature "Right Right"
-std::string FeatureKey::RightRight(absl::string_view base_key,
-                                   absl::string_view base_value) const {
+absl::string_view FeatureKey::RightRight(absl::string_view base_key,
+                                         absl::string_view base_value,
+                                         std::string *buffer) const {
   if (index_ + 2 >= segments_.segments_size()) {
     return "";
   }
   const int j1 = GetDefaultCandidateIndex(segments_.segment(index_ + 1));
   const int j2 = GetDefaultCandidateIndex(segments_.segment(index_ + 2));
-  return StrJoinWithTabs("RR", base_key, base_value,
-                         segments_.segment(index_ + 1).candidate(j1).value,
-                         segments_.segment(index_ + 2).candidate(j2).value);
+  return AssignJoinedWithTabs(
+      buffer, "RR", base_key, base_value,
+      segments_.segment(index_ + 1).candidate(j1).value,
+      segments_.segment(index_ + 2).candidate(j2).value);
 }
 
 // Feature "Left"
-std::string FeatureKey::Left(absl::string_view base_key,
-                             absl::string_view base_value) const {
+absl::string_view FeatureKey::Left(absl::string_view base_key,
+                                   absl::string_view base_value,
+                                   std::string *buffer) const {
   if (index_ < 1) {
     return "";
   }
   const int j = GetDefaultCandidateIndex(segments_.segment(index_ - 1));
-  return StrJoinWithTabs("L", base_key,
-                         segments_.segment(index_ - 1).candidate(j).value,
-                         base_value);
+  return AssignJoinedWithTabs(buffer, "L", base_key,
+                              segments_.segment(index_ - 1).candidate(j).value,
+                              base_value);
 }
 
 // Feature "Right"
-std::string FeatureKey::Right(absl::string_view base_key,
-                              absl::string_view base_value) const {
+absl::string_view FeatureKey::Right(absl::string_view base_key,
+                                    absl::string_view base_value,
+                                    std::string *buffer) const {
   if (index_ + 1 >= segments_.segments_size()) {
     return "";
   }
   const int j = GetDefaultCandidateIndex(segments_.segment(index_ + 1));
-  return StrJoinWithTabs("R", base_key, base_value,
-                         segments_.segment(index_ + 1).candidate(j).value);
+  return AssignJoinedWithTabs(
+      buffer, "R", base_key, base_value,
+      segments_.segment(index_ + 1).candidate(j).value);
 }
 
 // Feature "Current"
-std::string FeatureKey::Current(absl::string_view base_key,
-                                absl::string_view base_value) const {
-  return StrJoinWithTabs("C", base_key, base_value);
+absl::string_view FeatureKey::Current(absl::string_view base_key,
+                                      absl::string_view base_value,
+                                      std::string *buffer) const {
+  return AssignJoinedWithTabs(buffer, "C", base_key, base_value);
 }
 
 // Feature "Single"
-std::string FeatureKey::Single(absl::string_view base_key,
-                               absl::string_view base_value) const {
+absl::string_view FeatureKey::Single(absl::string_view base_key,
+                                     absl::string_view base_value,
+                                     std::string *buffer) const {
   if (segments_.segments_size() - segments_.history_segments_size() != 1) {
     return "";
   }
-  return StrJoinWithTabs("S", base_key, base_value);
+  return AssignJoinedWithTabs(buffer, "S", base_key, base_value);
 }
 
 // Feature "Left Number"
-std::string FeatureKey::LeftNumber(absl::string_view base_key,
-                                   absl::string_view base_value) const {
+absl::string_view FeatureKey::LeftNumber(absl::string_view base_key,
+                                         absl::string_view base_value,
+                                         std::string *buffer) const {
   if (index_ < 1) {
     return "";
   }
@@ -277,14 +312,15 @@ std::string FeatureKey::LeftNumber(absl::string_view base_key,
   if (pos_matcher_.IsNumber(candidate.rid) ||
       pos_matcher_.IsKanjiNumber(candidate.rid) ||
       Util::GetScriptType(candidate.value) == Util::NUMBER) {
-    return StrJoinWithTabs("LN", base_key, base_value);
+    return AssignJoinedWithTabs(buffer, "LN", base_key, base_value);
   }
   return "";
 }
 
 // Feature "Right Number"
-std::string FeatureKey::RightNumber(absl::string_view base_key,
-                                    absl::string_view base_value) const {
+absl::string_view FeatureKey::RightNumber(absl::string_view base_key,
+                                          absl::string_view base_value,
+                                          std::string *buffer) const {
   if (index_ + 1 >= segments_.segments_size()) {
     return "";
   }
@@ -294,17 +330,63 @@ std::string FeatureKey::RightNumber(absl::string_view base_key,
   if (pos_matcher_.IsNumber(candidate.lid) ||
       pos_matcher_.IsKanjiNumber(candidate.lid) ||
       Util::GetScriptType(candidate.value) == Util::NUMBER) {
-    return StrJoinWithTabs("RN", base_key, base_value);
+    return AssignJoinedWithTabs(buffer, "RN", base_key, base_value);
   }
   return "";
 }
 
 // Feature "Number"
 // used for number rewrite
-std::string FeatureKey::Number(uint16_t type) {
-  return StrJoinWithTabs("N", absl::StrCat(type));
+absl::string_view FeatureKey::Number(uint16_t type, std::string *buffer) {
+  const std::string type_str = absl::StrCat(type);
+  return AssignJoinedWithTabs(buffer, "N", type_str);
 }
 
+// Collects the fingerprints of the feature keys of one candidate and looks
+// them up from the storage at once.
+class FeatureLookup {
+ public:
+  explicit FeatureLookup(const LruStorage &storage) : storage_(storage) {}
+
+  void Add(absl::string_view key, uint32_t weight) {
+    if (key.empty()) {
+      return;
+    }
+    DCHECK_LT(size_, kMaxFeatures);
+    fps_[size_] = storage_.Fingerprint(key);
+    weights_[size_] = weight;
+    ++size_;
+  }
+
+  // Returns the best score among the features found in the storage.
+  template <typename ScoreType>
+  ScoreType GetScore() const {
+    std::array<const char *, kMaxFeatures> values;
+    std::array<uint32_t, kMaxFeatures> last_access_times;
+    storage_.LookupMany(absl::MakeConstSpan(fps_.data(), size_),
+                        absl::MakeSpan(values),
+                        absl::MakeSpan(last_access_times));
+    ScoreType score = {0, 0};
+    for (size_t i = 0; i < size_; ++i) {
+      const FeatureValue *v =
+          std::launder(reinterpret_cast<const FeatureValue *>(values[i]));
+      if (v && v->IsValid()) {
+        score.Update({weights_[i], last_access_times[i]});
+      }
+    }
+    return score;
+  }
+
+ private:
+  // GetScore() looks up at most 18 features.
+  static constexpr size_t kMaxFeatures = 18;
+
+  const LruStorage &storage_;
+  std::array<uint64_t, kMaxFeatures> fps_;
+  std::array<uint32_t, kMaxFeatures> weights_;
+  size_t size_ = 0;
+};
+
 bool IsNumberSegment(const Segment &seg) {
   if (seg.key().empty()) {
     return false;
@@ -541,50 +623,52 @@ UserSegmentHistoryRewriter::Score UserSegmentHistoryRewriter::GetScore(
   const uint32_t unigram_weight = (segments_size == 1) ? 36 : 6;
   const uint32_t single_weight = (segments_size == 1) ? 90 : 15;
 
-  Score score = {0, 0};
   FeatureKey fkey(segments, *pos_matcher_, segment_index);
-  score.Update(Fetch(fkey.LeftRight(all_key, all_value), trigram_weight));
-  score.Update(Fetch(fkey.LeftLeft(all_key, all_value), trigram_weight));
-  score.Update(Fetch(fkey.RightRight(all_key, all_value), trigram_weight));
-  score.Update(Fetch(fkey.Left(all_key, all_value), bigram_weight));
-  score.Update(Fetch(fkey.Right(all_key, all_value), bigram_weight));
-  score.Update(Fetch(fkey.Single(all_key, all_value), single_weight));
-  score.Update(
-      Fetch(fkey.LeftNumber(content_key, content_value), bigram_number_weight));
-  score.Update(Fetch(fkey.RightNumber(content_key, content_value),
-                     bigram_number_weight));
+  FeatureLookup lookup(*storage_);
+  std::string buffer;
+  lookup.Add(fkey.LeftRight(all_key, all_value, &buffer), trigram_weight);
+  lookup.Add(fkey.LeftLeft(all_key, all_value, &buffer), trigram_weight);
+  lookup.Add(fkey.RightRight(all_key, all_value, &buffer), trigram_weight);
+  lookup.Add(fkey.Left(all_key, all_value, &buffer), bigram_weight);
+  lookup.Add(fkey.Right(all_key, all_value, &buffer), bigram_weight);
+  lookup.Add(fkey.Single(all_key, all_value, &buffer), single_weight);
+  lookup.Add(fkey.LeftNumber(content_key, content_value, &buffer),
+             bigram_number_weight);
+  lookup.Add(fkey.RightNumber(content_key, content_value, &buffer),
+             bigram_number_weight);
 
   const bool is_replaceable = Replaceable(request, top_candidate, candidate);
   if (!context_sensitive && is_replaceable) {
-    score.Update(Fetch(fkey.Current(all_key, all_value), unigram_weight));
+    lookup.Add(fkey.Current(all_key, all_value, &buffer), unigram_weight);
   }
 
   if (!is_replaceable) {
-    return score;
+    return lookup.GetScore<Score>();
   }
 
-  score.Update(
-      Fetch(fkey.LeftRight(content_key, content_value), trigram_weight / 2));
-  score.Update(
-      Fetch(fkey.LeftLeft(content_key, content_value), trigram_weight / 2));
-  score.Update(
-      Fetch(fkey.RightRight(content_key, content_value), trigram_weight / 2));
-  score.Update(Fetch(fkey.Left(content_key, content_value), bigram_weight / 2));
-  score.Update(
-      Fetch(fkey.Right(content_key, content_value), bigram_weight / 2));
-  score.Update(
-      Fetch(fkey.Single(content_key, content_value), single_weight / 2));
-  score.Update(Fetch(fkey.LeftNumber(content_key, content_value),
-                     bigram_number_weight / 2));
-  score.Update(Fetch(fkey.RightNumber(content_key, content_value),
-                     bigram_number_weight / 2));
+  lookup.Add(fkey.LeftRight(content_key, content_value, &buffer),
+             trigram_weight / 2);
+  lookup.Add(fkey.LeftLeft(content_key, content_value, &buffer),
+             trigram_weight / 2);
+  lookup.Add(fkey.RightRight(content_key, content_value, &buffer),
+             trigram_weight / 2);
+  lookup.Add(fkey.Left(content_key, content_value, &buffer),
+             bigram_weight / 2);
+  lookup.Add(fkey.Right(content_key, content_value, &buffer),
+             bigram_weight / 2);
+  lookup.Add(fkey.Single(content_key, content_value, &buffer),
+             single_weight / 2);
+  lookup.Add(fkey.LeftNumber(content_key, content_value, &buffer),
+             bigram_number_weight / 2);
+  lookup.Add(fkey.RightNumber(content_key, content_value, &buffer),
+             bigram_number_weight / 2);
 
   if (!context_sensitive) {
-    score.Update(
-        Fetch(fkey.Current(content_key, content_value), unigram_weight / 2));
+    lookup.Add(fkey.Current(content_key, content_value, &buffer),
+               unigram_weight / 2);
   }
 
-  return score;
+  return lookup.GetScore<Score>();
 }
 
 // Returns true if |lhs| candidate can be replaceable with |rhs|.
@@ -609,6 +693,7 @@ bool UserSegmentHistoryRewriter::Replaceable(
 void UserSegmentHistoryRewriter::RememberNumberPreference(
     const Segment &segment) {
   const Segment::Candidate &candidate = segment.candidate(0);
+  std::string buffer;
 
   if ((candidate.style ==
        NumberUtil::NumberString::NUMBER_SEPARATED_ARABIC_HALFWIDTH) ||
@@ -624,11 +709,13 @@ void UserSegmentHistoryRewriter::RememberNumberPreference(
     // However, access time is count by second, so
     // separated and default is learned at same time
     // This problem is solved by workaround on lookup.
-    Insert(FeatureKey::Number(NumberUtil::NumberString::DEFAULT_STYLE), true);
+    Insert(FeatureKey::Number(NumberUtil::NumberString::DEFAULT_STYLE,
+                              &buffer),
+           true);
   }
 
   // Always insert for numbers
-  Insert(FeatureKey::Number(candidate.style), true);
+  Insert(FeatureKey::Number(candidate.style, &buffer), true);
 }
 
 void UserSegmentHistoryRewriter::RememberFirstCandidate(
@@ -665,32 +752,33 @@ void UserSegmentHistoryRewriter::RememberFirstCandidate(
        Replaceable(request, seg.candidate(top_index), candidate));
 
   FeatureKey fkey(segments, *pos_matcher_, segment_index);
-  Insert(fkey.LeftRight(all_key, all_value), force_insert);
-  Insert(fkey.LeftLeft(all_key, all_value), force_insert);
-  Insert(fkey.RightRight(all_key, all_value), force_insert);
-  Insert(fkey.Left(all_key, all_value), force_insert);
-  Insert(fkey.Right(all_key, all_value), force_insert);
-  Insert(fkey.LeftNumber(all_key, all_value), force_insert);
-  Insert(fkey.RightNumber(all_key, all_value), force_insert);
-  Insert(fkey.Single(all_key, all_value), force_insert);
+  std::string buffer;
+  Insert(fkey.LeftRight(all_key, all_value, &buffer), force_insert);
+  Insert(fkey.LeftLeft(all_key, all_value, &buffer), force_insert);
+  Insert(fkey.RightRight(all_key, all_value, &buffer), force_insert);
+  Insert(fkey.Left(all_key, all_value, &buffer), force_insert);
+  Insert(fkey.Right(all_key, all_value, &buffer), force_insert);
+  Insert(fkey.LeftNumber(all_key, all_value, &buffer), force_insert);
+  Insert(fkey.RightNumber(all_key, all_value, &buffer), force_insert);
+  Insert(fkey.Single(all_key, all_value, &buffer), force_insert);
 
   if (!context_sensitive && is_replaceable_with_top) {
-    Insert(fkey.Current(all_key, all_value), force_insert);
+    Insert(fkey.Current(all_key, all_value, &buffer), force_insert);
   }
 
   // save content value
   if (all_value != content_value && all_key != content_key &&
       is_replaceable_with_top) {
-    Insert(fkey.LeftRight(content_key, content_value), force_insert);
-    Insert(fkey.LeftLeft(content_key, content_value), force_insert);
-    Insert(fkey.RightRight(content_key, content_value), force_insert);
-    Insert(fkey.Left(content_key, content_value), force_insert);
-    Insert(fkey.Right(content_key, content_value), force_insert);
-    Insert(fkey.LeftNumber(content_key, content_value), force_insert);
-    Insert(fkey.RightNumber(content_key, content_value), force_insert);
-    Insert(fkey.Single(content_key, content_value), force_insert);
+    Insert(fkey.LeftRight(content_key, content_value, &buffer), force_insert);
+    Insert(fkey.LeftLeft(content_key, content_value, &buffer), force_insert);
+    Insert(fkey.RightRight(content_key, content_value, &buffer), force_insert);
+    Insert(fkey.Left(content_key, content_value, &buffer), force_insert);
+    Insert(fkey.Right(content_key, content_value, &buffer), force_insert);
+    Insert(fkey.LeftNumber(content_key, content_value, &buffer), force_insert);
+    Insert(fkey.RightNumber(content_key, content_value, &buffer), force_insert);
+    Insert(fkey.Single(content_key, content_value, &buffer), force_insert);
     if (!context_sensitive) {
-      Insert(fkey.Current(content_key, content_value), force_insert);
+      Insert(fkey.Current(content_key, content_value, &buffer), force_insert);
     }
   }
 
@@ -699,9 +787,10 @@ void UserSegmentHistoryRewriter::RememberFirstCandidate(
   absl::string_view close_bracket_value;
   if (Util::IsOpenBracket(content_key, &close_bracket_key) &&
       Util::IsOpenBracket(content_value, &close_bracket_value)) {
-    Insert(fkey.Single(close_bracket_key, close_bracket_value), force_insert);
+    Insert(fkey.Single(close_bracket_key, close_bracket_value, &buffer),
+           force_insert);
     if (!context_sensitive) {
-      Insert(fkey.Current(close_bracket_key, close_bracket_value),
+      Insert(fkey.Current(close_bracket_key, close_bracket_value, &buffer),
              force_insert);
     }
   }
@@ -905,6 +994,7 @@ void UserSegmentHistoryRewriter::InsertTriggerKey(const Segment &segment) {
 
 bool UserSegmentHistoryRewriter::RewriteNumber(Segment *segment) const {
   std::vector<ScoreCandidate> scores;
+  std::string buffer;
   for (size_t l = 0;
        l < segment->candidates_size() + segment->meta_candidates_size(); ++l) {
     int j = static_cast<int>(l);
@@ -912,7 +1002,8 @@ bool UserSegmentHistoryRewriter::RewriteNumber(Segment *segment) const {
       j -= static_cast<int>(segment->candidates_size() +
                             segment->meta_candidates_size());
     }
-    Score score = Fetch(FeatureKey::Number(segment->candidate(j).style), 10);
+    Score score =
+        Fetch(FeatureKey::Number(segment->candidate(j).style, &buffer), 10);
 
     if (score.score) {
       // Workaround for separated arabic.
@@ -957,6 +1048,11 @@ bool UserSegmentHistoryRewriter::Rewrite(const ConversionRequest &request,
         Segment::Candidate::BEST_CANDIDATE;
   }
 
+  // Nothing has been learned yet.
+  if (storage_->used_size() == 0) {
+    return false;
+  }
+
   bool modified = false;
   for (size_t i = segments->history_segments_size();
        i < segments->segments_size(); ++i) {
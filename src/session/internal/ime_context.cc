@@ -32,6 +32,8 @@
 
 #include "session/internal/ime_context.h"
 
+#include <memory>
+
 #include "absl/log/check.h"
 #include "composer/composer.h"
 #include "protocol/commands.pb.h"
@@ -116,5 +118,30 @@ void ImeContext::CopyContext(const ImeContext &src, ImeContext *dest) {
   *dest->mutable_output() = src.output();
 }
 
+std::unique_ptr<ImeContext> ImeContext::CreateUndoSnapshot() {
+  auto snapshot = std::make_unique<ImeContext>();
+
+  snapshot->create_time_ = create_time_;
+  snapshot->last_command_time_ = last_command_time_;
+
+  // The cloned composer and converter already refer to the same request and
+  // config, so there is no need to call SetRequest() or SetConfig(), which
+  // would also rebuild the key event transformer table. The cloned converter
+  // shares the segments until either converter modifies them.
+  snapshot->composer_ = std::make_unique<composer::Composer>(composer());
+  snapshot->converter_.reset(converter_->Clone());
+  snapshot->key_event_transformer_ = key_event_transformer_;
+
+  snapshot->request_ = request_;
+  snapshot->config_ = config_;
+  snapshot->key_map_manager_ = key_map_manager_;
+
+  snapshot->state_ = state_;
+  snapshot->client_capability_ = client_capability_;
+  snapshot->application_info_ = application_info_;
+  snapshot->output_.Swap(&output_);
+  return snapshot;
+}
+
 }  // namespace session
 }  // namespace mozc
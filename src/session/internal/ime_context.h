@@ -131,6 +131,13 @@ class ImeContext final {
   // consistency with other classes.
   static void CopyContext(const ImeContext &src, ImeContext *dest);
 
+  // Creates a snapshot of this context for the undo stack.  Unlike
+  // CopyContext, the snapshot is built from the members directly instead of
+  // overwriting a freshly initialized context, and the last output is moved
+  // into the snapshot.  The caller must store a new output to this context
+  // afterwards.
+  std::unique_ptr<ImeContext> CreateUndoSnapshot();
+
  private:
   // TODO(team): Actual use of |create_time_| is to keep the time when the
   // session holding this instance is created and not the time when this
@@ -192,5 +192,45 @@ TEST(ImeContextTest, CopyContext) {
   }
 }
 
+TEST(ImeContextTest, CreateUndoSnapshot) {
+  composer::Table table;
+  table.AddRule("a", "あ", "");
+  table.AddRule("n", "ん", "");
+  table.AddRule("na", "な", "");
+  const commands::Request request;
+  config::Config config;
+
+  MockConverter converter;
+
+  ImeContext source;
+  source.set_create_time(absl::FromUnixSeconds(100));
+  source.set_composer(std::make_unique<Composer>(&table, &request, &config));
+  source.set_converter(
+      std::make_unique<SessionConverter>(&converter, &request, &config));
+  source.SetRequest(&request);
+  source.SetConfig(&config);
+  source.set_state(ImeContext::COMPOSITION);
+  source.mutable_composer()->InsertCharacter("a");
+  source.mutable_client_capability()->set_text_deletion(
+      commands::Capability::DELETE_PRECEDING_TEXT);
+  source.mutable_output()->mutable_result()->set_value("庵");
+
+  std::unique_ptr<ImeContext> snapshot = source.CreateUndoSnapshot();
+  EXPECT_EQ(snapshot->create_time(), absl::FromUnixSeconds(100));
+  EXPECT_EQ(snapshot->state(), ImeContext::COMPOSITION);
+  EXPECT_EQ(snapshot->composer().GetStringForSubmission(), "あ");
+  EXPECT_EQ(snapshot->client_capability().text_deletion(),
+            commands::Capability::DELETE_PRECEDING_TEXT);
+  EXPECT_EQ(&snapshot->GetConfig(), &config);
+  EXPECT_EQ(snapshot->output().result().value(), "庵");
+  // The output is moved to the snapshot.
+  EXPECT_FALSE(source.output().has_result());
+
+  // The snapshot is independent from the source.
+  source.mutable_composer()->InsertCharacter("n");
+  EXPECT_EQ(source.composer().GetStringForSubmission(), "あｎ");
+  EXPECT_EQ(snapshot->composer().GetStringForSubmission(), "あ");
+}
+
 }  // namespace session
 }  // namespace mozc
@@ -44,6 +44,7 @@
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
 #include "base/clock.h"
+#include "base/strings/unicode.h"
 #include "base/util.h"
 #include "composer/composer.h"
 #include "composer/key_event_util.h"
@@ -53,6 +54,7 @@
 #include "engine/user_data_manager_interface.h"
 #include "protocol/commands.pb.h"
 #include "protocol/config.pb.h"
+#include "protocol/state.pb.h"
 #include "session/internal/ime_context.h"
 #include "session/internal/key_event_transformer.h"
 #include "session/internal/keymap.h"
@@ -247,11 +249,10 @@ void Session::InitContext(ImeContext *context) const {
 }
 
 void Session::PushUndoContext() {
-  // Copy the current context and push it to the undo stack.
-  auto prev_context = std::make_unique<ImeContext>();
-  InitContext(prev_context.get());
-  ImeContext::CopyContext(*context_, prev_context.get());
-  undo_contexts_.push_back(std::move(prev_context));
+  // Take a snapshot of the current context and push it to the undo stack.
+  // The last output is moved to the snapshot; the caller replaces it with
+  // StoreResultForUndo().
+  undo_contexts_.push_back(context_->CreateUndoSnapshot());
   // If the stack size exceeds the limitation, purge the oldest entries.
   while (undo_contexts_.size() > kMultipleUndoMaxSize) {
     undo_contexts_.pop_front();
@@ -267,6 +268,14 @@ void Session::PopUndoContext() {
   undo_contexts_.pop_back();
 }
 
+void Session::StoreResultForUndo(const commands::Output &output) {
+  commands::Output *last_output = context_->mutable_output();
+  last_output->Clear();
+  if (output.has_result()) {
+    *last_output->mutable_result() = output.result();
+  }
+}
+
 void Session::ClearUndoContext() { undo_contexts_.clear(); }
 
 bool Session::HasUndoContext() const { return !undo_contexts_.empty(); }
@@ -284,6 +293,7 @@ void Session::EnsureIMEIsOn() {
 }
 
 bool Session::SendCommand(commands::Command *command) {
+  ++input_sequence_;
   UpdateTime();
   UpdatePreferences(command);
   if (!command->input().has_command()) {
@@ -503,6 +513,7 @@ bool Session::TestSendKey(commands::Command *command) {
 }
 
 bool Session::SendKey(commands::Command *command) {
+  ++input_sequence_;
   UpdateTime();
   UpdatePreferences(command);
   TransformInput(command->mutable_input());
@@ -1201,6 +1212,57 @@ void Session::SetKeyMapManager(
   context_->SetKeyMapManager(key_map_manager);
 }
 
+void Session::SaveSnapshot(protocol::SessionSnapshot *snapshot) const {
+  const composer::Composer &composer = context_->composer();
+  snapshot->set_activated(context_->state() != ImeContext::DIRECT);
+  snapshot->set_mode(ToCompositionMode(composer.GetInputMode()));
+  snapshot->set_input_sequence(input_sequence_);
+  // The snapshots are written to a local file, so the text typed into password
+  // fields or in incognito mode must not be included.
+  if (composer.GetInputFieldType() == commands::Context::PASSWORD ||
+      context_->GetConfig().incognito_mode()) {
+    return;
+  }
+  if (!composer.Empty()) {
+    snapshot->set_raw_text(composer.GetRawString());
+    snapshot->set_preedit(composer.GetStringForPreedit());
+    snapshot->set_cursor(composer.GetCursor());
+  }
+  snapshot->set_history_text(context_->converter().GetHistoryText());
+}
+
+void Session::RestoreSnapshot(const protocol::SessionSnapshot &snapshot,
+                              commands::Command *command) {
+  input_sequence_ = snapshot.input_sequence();
+  if (!snapshot.history_text().empty()) {
+    context_->mutable_converter()->RestoreHistory(snapshot.history_text());
+  }
+
+  composer::Composer *composer = context_->mutable_composer();
+  if (snapshot.has_mode()) {
+    ApplyInputMode(snapshot.mode(), composer);
+  }
+  if (!snapshot.activated()) {
+    SetSessionState(ImeContext::DIRECT, context_.get());
+  } else if (snapshot.preedit().empty()) {
+    SetSessionState(ImeContext::PRECOMPOSITION, context_.get());
+  } else {
+    // Typing the raw text again rebuilds the pending romaji as well. When it
+    // doesn't reproduce the preedit (e.g. kana input), falls back to the
+    // preedit itself.
+    for (const absl::string_view c : Utf8AsChars(snapshot.raw_text())) {
+      composer->InsertCharacter(std::string(c));
+    }
+    if (composer->GetStringForPreedit() != snapshot.preedit()) {
+      composer->EditErase();
+      composer->InsertCharacterPreedit(snapshot.preedit());
+    }
+    composer->MoveCursorTo(snapshot.cursor());
+    context_->set_state(ImeContext::COMPOSITION);
+  }
+  OutputFromState(command);
+}
+
 bool Session::GetStatus(commands::Command *command) {
   OutputMode(command);
   return true;
@@ -1402,8 +1464,8 @@ bool Session::CommitCandidate(commands::Command *command) {
         context_->mutable_composer()->DeleteRange(0, consumed_key_size);
         // Don't clear the undo context, which we've just updated.
         MoveCursorToEndInternal(command, false);
-        // Copy the previous output for Undo.
-        *context_->mutable_output() = command->output();
+        // Keep the result for Undo.
+        StoreResultForUndo(command->output());
         return true;
       }
     }
@@ -1422,8 +1484,8 @@ bool Session::CommitCandidate(commands::Command *command) {
     }
   }
   Output(command);
-  // Copy the previous output for Undo.
-  *context_->mutable_output() = command->output();
+  // Keep the result for Undo.
+  StoreResultForUndo(command->output());
   return true;
 }
 
@@ -1813,8 +1875,8 @@ bool Session::CommitInternal(commands::Command *command,
   }
 
   Output(command);
-  // Copy the previous output for Undo.
-  *context_->mutable_output() = command->output();
+  // Keep the result for Undo.
+  StoreResultForUndo(command->output());
   return true;
 }
 
@@ -1872,8 +1934,8 @@ bool Session::CommitFirstSuggestion(commands::Command *command) {
   }
 
   Output(command);
-  // Copy the previous output for Undo.
-  *context_->mutable_output() = command->output();
+  // Keep the result for Undo.
+  StoreResultForUndo(command->output());
   return true;
 }
 
@@ -1907,8 +1969,8 @@ bool Session::CommitSegment(commands::Command *command) {
     }
   }
   Output(command);
-  // Copy the previous output for Undo.
-  *context_->mutable_output() = command->output();
+  // Keep the result for Undo.
+  StoreResultForUndo(command->output());
   return true;
 }
 
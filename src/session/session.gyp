@@ -99,6 +99,7 @@
       'sources': [
         'session_handler.cc',
         'session_observer_handler.cc',
+        'session_snapshot_storage.cc',
       ],
       'dependencies': [
         '<(mozc_oss_src_dir)/base/absl.gyp:absl_strings',
@@ -110,6 +111,7 @@
         '<(mozc_oss_src_dir)/protocol/protocol.gyp:commands_proto',
         '<(mozc_oss_src_dir)/protocol/protocol.gyp:config_proto',
         '<(mozc_oss_src_dir)/protocol/protocol.gyp:engine_builder_proto',
+        '<(mozc_oss_src_dir)/protocol/protocol.gyp:state_proto',
         '<(mozc_oss_src_dir)/protocol/protocol.gyp:user_dictionary_storage_proto',
         '<(mozc_oss_src_dir)/usage_stats/usage_stats_base.gyp:usage_stats',
         ':session_watch_dog',
@@ -33,6 +33,7 @@
 #define MOZC_SESSION_SESSION_H_
 
 #include <cstddef>
+#include <cstdint>
 #include <deque>
 #include <memory>
 #include <string>
@@ -43,6 +44,7 @@
 #include "engine/engine_interface.h"
 #include "protocol/commands.pb.h"
 #include "protocol/config.pb.h"
+#include "protocol/state.pb.h"
 #include "session/internal/ime_context.h"
 #include "session/internal/keymap.h"
 #include "session/session_interface.h"
@@ -267,6 +269,22 @@ class Session : public SessionInterface {
 
   const ImeContext &context() const;
 
+  // Fills |snapshot| with the compact state required to restore this session
+  // after the server restarts. The id, timestamp and fingerprints are left to
+  // the caller. The composition and the history are omitted for password
+  // fields and in incognito mode.
+  void SaveSnapshot(protocol::SessionSnapshot *snapshot) const;
+
+  // Restores the state saved by SaveSnapshot() and fills the output of
+  // |command| with it. The config, request, key map and table must be set in
+  // advance.
+  void RestoreSnapshot(const protocol::SessionSnapshot &snapshot,
+                       commands::Command *command);
+
+  // Returns the number of the SendKey() and SendCommand() calls, which is
+  // also saved in the snapshot.
+  uint64_t input_sequence() const { return input_sequence_; }
+
  private:
   FRIEND_TEST(SessionTest, OutputInitialComposition);
   FRIEND_TEST(SessionTest, IsFullWidthInsertSpace);
@@ -281,6 +299,8 @@ class Session : public SessionInterface {
 
   std::unique_ptr<ImeContext> context_;
 
+  uint64_t input_sequence_ = 0;
+
   // Undo stack. *begin is the oldest, and *back is the newest.
   std::deque<std::unique_ptr<ImeContext>> undo_contexts_;
 
@@ -288,6 +308,10 @@ class Session : public SessionInterface {
 
   void PushUndoContext();
   void PopUndoContext();
+  // Keeps the result of |output| in the current context so that Undo can
+  // delete the committed text later.  Only the result is stored since the
+  // rest of the output is never read back.
+  void StoreResultForUndo(const commands::Output &output);
   // Clear the undo context.
   // This should be called when the composer's preedit or cursor position
   // is updated by non-undo related operations. This achieves intuitive
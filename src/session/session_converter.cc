@@ -34,6 +34,7 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -142,7 +143,7 @@ SessionConverter::SessionConverter(const ConverterInterface *converter,
                                    const Request *request, const Config *config)
     : SessionConverterInterface(),
       converter_(converter),
-      segments_(),
+      segments_(std::make_shared<Segments>()),
       incognito_segments_(),
       segment_index_(0),
       result_(),
@@ -182,10 +183,11 @@ bool SessionConverter::ConvertWithPreferences(
   DCHECK(CheckState(COMPOSITION | SUGGESTION | CONVERSION));
 
   ConversionRequest conversion_request(&composer, request_, config_);
-  SetConversionPreferences(preferences, &segments_, &conversion_request);
+  SetConversionPreferences(preferences, mutable_segments(),
+                           &conversion_request);
   SetRequestType(ConversionRequest::CONVERSION, &conversion_request);
 
-  if (!converter_->StartConversion(conversion_request, &segments_)) {
+  if (!converter_->StartConversion(conversion_request, mutable_segments())) {
     LOG(WARNING) << "StartConversion() failed";
     ResetState();
     return false;
@@ -293,9 +295,9 @@ bool SessionConverter::ConvertToTransliteration(
     // preedit as a single segment.  We should modify
     // converter/converter.cc to enable to accept mozc::Segment::FIXED
     // from the session layer.
-    if (segments_.conversion_segments_size() != 1) {
+    if (segments().conversion_segments_size() != 1) {
       std::string composition;
-      GetPreedit(0, segments_.conversion_segments_size(), &composition);
+      GetPreedit(0, segments().conversion_segments_size(), &composition);
       ResizeSegmentWidth(composer, Util::CharsLen(composition));
     }
 
@@ -337,11 +339,10 @@ bool SessionConverter::ConvertToHalfWidth(const composer::Composer &composer) {
     composition = GetSelectedCandidate(segment_index_).value;
   }
 
-  // TODO(komatsu): make a function to return a logical sum of ScriptType.
   // If composition_ is "あｂｃ", it should be treated as Katakana.
-  if (Util::ContainsScriptType(composition, Util::KATAKANA) ||
-      Util::ContainsScriptType(composition, Util::HIRAGANA) ||
-      Util::ContainsScriptType(composition, Util::KANJI) ||
+  constexpr uint32_t kKanaKanjiMask =
+      (1 << Util::KATAKANA) | (1 << Util::HIRAGANA) | (1 << Util::KANJI);
+  if ((Util::GetScriptTypeMask(composition) & kKanaKanjiMask) != 0 ||
       Util::IsKanaSymbolContained(composition)) {
     return ConvertToTransliteration(composer, transliteration::HALF_KATAKANA);
   } else {
@@ -369,14 +370,14 @@ bool SessionConverter::SwitchKanaType(const composer::Composer &composer) {
     // preedit as a single segment.  We should modify
     // converter/converter.cc to enable to accept mozc::Segment::FIXED
     // from the session layer.
-    if (segments_.conversion_segments_size() != 1) {
+    if (segments().conversion_segments_size() != 1) {
       std::string composition;
-      GetPreedit(0, segments_.conversion_segments_size(), &composition);
+      GetPreedit(0, segments().conversion_segments_size(), &composition);
       const ConversionRequest conversion_request(&composer, request_, config_);
-      if (!converter_->ResizeSegment(&segments_, conversion_request, 0,
+      if (!converter_->ResizeSegment(mutable_segments(), conversion_request, 0,
                                      Util::CharsLen(composition))) {
         LOG(WARNING) << "ResizeSegment failed for segments.";
-        DLOG(WARNING) << segments_.DebugString();
+        DLOG(WARNING) << segments().DebugString();
       }
       UpdateCandidateList();
     }
@@ -454,9 +455,10 @@ bool SessionConverter::SuggestWithPreferences(
 
   ConversionRequest conversion_request(&composer, request_, &context, config_);
   // Initialize the conversion request and segments for suggestion.
-  SetConversionPreferences(preferences, &segments_, &conversion_request);
+  SetConversionPreferences(preferences, mutable_segments(),
+                           &conversion_request);
 
-  segments_.clear_conversion_segments();
+  mutable_segments()->clear_conversion_segments();
 
   const size_t cursor = composer.GetCursor();
 
@@ -490,12 +492,15 @@ bool SessionConverter::SuggestWithPreferences(
   // Start actual suggestion/prediction.
   bool result;
   if (use_partial_composition) {
-    result = converter_->StartPartialPrediction(conversion_request, &segments_);
+    result = converter_->StartPartialPrediction(conversion_request,
+                                                mutable_segments());
   } else {
     if (use_prediction_candidate) {
-      result = converter_->StartPrediction(conversion_request, &segments_);
+      result =
+          converter_->StartPrediction(conversion_request, mutable_segments());
     } else {
-      result = converter_->StartSuggestion(conversion_request, &segments_);
+      result =
+          converter_->StartSuggestion(conversion_request, mutable_segments());
     }
   }
   if (!result) {
@@ -503,7 +508,7 @@ bool SessionConverter::SuggestWithPreferences(
         << "Start(Partial?)(Suggestion|Prediction)ForRequest() returns no "
            "suggestions.";
     // Clear segments and keep the context
-    converter_->CancelConversion(&segments_);
+    converter_->CancelConversion(mutable_segments());
     return false;
   }
   // Fill incognito candidates if required.
@@ -528,11 +533,11 @@ bool SessionConverter::SuggestWithPreferences(
       // TODO(noriyukit): Check if fall through here is ok.
     }
   }
-  DCHECK_EQ(1, segments_.conversion_segments_size());
+  DCHECK_EQ(1, segments().conversion_segments_size());
 
   // Copy current suggestions so that we can merge
   // prediction/suggestions later
-  previous_suggestions_ = segments_.conversion_segment(0);
+  previous_suggestions_ = segments().conversion_segment(0);
 
   // Overwrite the request type to SUGGESTION.
   // Without this logic, a candidate gets focused that is unexpected behavior.
@@ -566,7 +571,8 @@ bool SessionConverter::PredictWithPreferences(
 
   // Initialize the segments and conversion_request for prediction
   ConversionRequest conversion_request(&composer, request_, config_);
-  SetConversionPreferences(preferences, &segments_, &conversion_request);
+  SetConversionPreferences(preferences, mutable_segments(),
+                           &conversion_request);
   SetRequestType(ConversionRequest::PREDICTION, &conversion_request);
   SetUseActualConverterForRealtimeConversion(*request_, &conversion_request);
 
@@ -578,10 +584,10 @@ bool SessionConverter::PredictWithPreferences(
        candidate_list_.size() > 0 && candidate_list_.focused() &&
        candidate_list_.focused_index() == candidate_list_.last_index());
 
-  segments_.clear_conversion_segments();
+  mutable_segments()->clear_conversion_segments();
 
   if (predict_expand || predict_first) {
-    if (!converter_->StartPrediction(conversion_request, &segments_)) {
+    if (!converter_->StartPrediction(conversion_request, mutable_segments())) {
       LOG(WARNING) << "StartPrediction() failed";
       // TODO(komatsu): Perform refactoring after checking the stability test.
       //
@@ -596,7 +602,8 @@ bool SessionConverter::PredictWithPreferences(
 
   // Merge suggestions and prediction
   std::string preedit = composer.GetStringForPreedit();
-  PrependCandidates(previous_suggestions_, std::move(preedit), &segments_);
+  PrependCandidates(previous_suggestions_, std::move(preedit),
+                    mutable_segments());
 
   segment_index_ = 0;
   state_ = PREDICTION;
@@ -636,7 +643,7 @@ void SessionConverter::Cancel() {
   ResetResult();
 
   // Clear segments and keep the context
-  converter_->CancelConversion(&segments_);
+  converter_->CancelConversion(mutable_segments());
   ResetState();
 }
 
@@ -645,7 +652,7 @@ void SessionConverter::Reset() {
 
   // Even if composition mode, call ResetConversion
   // in order to clear history segments.
-  converter_->ResetConversion(&segments_);
+  converter_->ResetConversion(mutable_segments());
 
   if (CheckState(COMPOSITION)) {
     return;
@@ -661,21 +668,21 @@ void SessionConverter::Commit(const composer::Composer &composer,
   DCHECK(CheckState(PREDICTION | CONVERSION));
   ResetResult();
 
-  if (!UpdateResult(0, segments_.conversion_segments_size(), nullptr)) {
+  if (!UpdateResult(0, segments().conversion_segments_size(), nullptr)) {
     Cancel();
     ResetState();
     return;
   }
 
-  for (size_t i = 0; i < segments_.conversion_segments_size(); ++i) {
-    if (!converter_->CommitSegmentValue(&segments_, i,
+  for (size_t i = 0; i < segments().conversion_segments_size(); ++i) {
+    if (!converter_->CommitSegmentValue(mutable_segments(), i,
                                         GetCandidateIndexForConverter(i))) {
       LOG(WARNING) << "Failed to commit segment " << i;
     }
   }
   CommitUsageStats(state_, context);
   ConversionRequest conversion_request(&composer, request_, &context, config_);
-  converter_->FinishConversion(conversion_request, &segments_);
+  converter_->FinishConversion(conversion_request, mutable_segments());
   ResetState();
 }
 
@@ -687,7 +694,7 @@ bool SessionConverter::CommitSuggestionInternal(
   ResetResult();
   const std::string preedit = composer.GetStringForPreedit();
 
-  if (!UpdateResult(0, segments_.conversion_segments_size(),
+  if (!UpdateResult(0, segments().conversion_segments_size(),
                     consumed_key_size)) {
     // Do not need to call Cancel like Commit because the current
     // state is SUGGESTION.
@@ -703,7 +710,7 @@ bool SessionConverter::CommitSuggestionInternal(
       *consumed_key_size < composer.GetLength()) {
     // A candidate was chosen from partial suggestion.
     if (!converter_->CommitPartialSuggestionSegmentValue(
-            &segments_, 0, GetCandidateIndexForConverter(0),
+            mutable_segments(), 0, GetCandidateIndexForConverter(0),
             Util::Utf8SubString(preedit, 0, *consumed_key_size),
             Util::Utf8SubString(preedit, *consumed_key_size,
                                 preedit_length - *consumed_key_size))) {
@@ -714,10 +721,10 @@ bool SessionConverter::CommitSuggestionInternal(
     InitializeSelectedCandidateIndices();
     // One or more segments must exist because new segment is inserted
     // just after the committed segment.
-    DCHECK_GT(segments_.conversion_segments_size(), 0);
+    DCHECK_GT(segments().conversion_segments_size(), 0);
   } else {
     // Not partial suggestion so let's reset the state.
-    if (!converter_->CommitSegmentValue(&segments_, 0,
+    if (!converter_->CommitSegmentValue(mutable_segments(), 0,
                                         GetCandidateIndexForConverter(0))) {
       LOG(WARNING) << "CommitSegmentValue failed";
       return false;
@@ -725,8 +732,8 @@ bool SessionConverter::CommitSuggestionInternal(
     CommitUsageStats(SessionConverterInterface::SUGGESTION, context);
     ConversionRequest conversion_request(&composer, request_, &context,
                                          config_);
-    converter_->FinishConversion(conversion_request, &segments_);
-    DCHECK_EQ(0, segments_.conversion_segments_size());
+    converter_->FinishConversion(conversion_request, mutable_segments());
+    DCHECK_EQ(0, segments().conversion_segments_size());
     ResetState();
   }
   return true;
@@ -777,13 +784,13 @@ void SessionConverter::CommitSegmentsInternal(
     const composer::Composer &composer, const commands::Context &context,
     size_t segments_to_commit, size_t *consumed_key_size) {
   DCHECK(CheckState(PREDICTION | CONVERSION));
-  DCHECK(segments_.conversion_segments_size() >= segments_to_commit);
+  DCHECK(segments().conversion_segments_size() >= segments_to_commit);
   ResetResult();
   candidate_list_visible_ = false;
   *consumed_key_size = 0;
 
   // If the number of segments is one, just call Commit.
-  if (segments_.conversion_segments_size() == segments_to_commit) {
+  if (segments().conversion_segments_size() == segments_to_commit) {
     Commit(composer, context);
     return;
   }
@@ -800,7 +807,7 @@ void SessionConverter::CommitSegmentsInternal(
   std::vector<size_t> candidate_ids;
   for (size_t i = 0; i < segments_to_commit; ++i) {
     // Get the i-th (0 origin) conversion segment and the selected candidate.
-    Segment *segment = segments_.mutable_conversion_segment(i);
+    Segment *segment = mutable_segments()->mutable_conversion_segment(i);
     if (!segment) {
       LOG(ERROR) << "There is no segment on position " << i;
       return;
@@ -813,7 +820,7 @@ void SessionConverter::CommitSegmentsInternal(
     // Collect candidate's id for each segment.
     candidate_ids.push_back(GetCandidateIndexForConverter(i));
   }
-  if (!converter_->CommitSegments(&segments_, candidate_ids)) {
+  if (!converter_->CommitSegments(mutable_segments(), candidate_ids)) {
     LOG(WARNING) << "CommitSegments failed";
   }
 
@@ -845,14 +852,14 @@ void SessionConverter::CommitPreedit(const composer::Composer &composer,
   SessionOutput::FillCursorOffsetResult(
       CalculateCursorOffset(normalized_preedit), &result_);
   InitSegmentsFromString(std::move(key), std::move(normalized_preedit),
-                         &segments_);
+                         mutable_segments());
   CommitUsageStats(SessionConverterInterface::COMPOSITION, context);
   ConversionRequest conversion_request(&composer, request_, &context, config_);
   // the request mode is CONVERSION, as the user experience
   // is similar to conversion. UserHistoryPredictor distinguishes
   // CONVERSION from SUGGESTION now.
   SetRequestType(ConversionRequest::CONVERSION, &conversion_request);
-  converter_->FinishConversion(conversion_request, &segments_);
+  converter_->FinishConversion(conversion_request, mutable_segments());
   ResetState();
 }
 
@@ -872,7 +879,9 @@ void SessionConverter::CommitHead(size_t count,
                                         &result_);
 }
 
-void SessionConverter::Revert() { converter_->RevertConversion(&segments_); }
+void SessionConverter::Revert() {
+  converter_->RevertConversion(mutable_segments());
+}
 
 void SessionConverter::SegmentFocusInternal(size_t index) {
   DCHECK(CheckState(PREDICTION | CONVERSION));
@@ -892,7 +901,7 @@ void SessionConverter::SegmentFocusInternal(size_t index) {
 }
 
 void SessionConverter::SegmentFocusRight() {
-  if (segment_index_ + 1 >= segments_.conversion_segments_size()) {
+  if (segment_index_ + 1 >= segments().conversion_segments_size()) {
     // If |segment_index_| is at the tail of the segments,
     // focus on the head.
     SegmentFocusLeftEdge();
@@ -902,7 +911,7 @@ void SessionConverter::SegmentFocusRight() {
 }
 
 void SessionConverter::SegmentFocusLast() {
-  const size_t r_edge = segments_.conversion_segments_size() - 1;
+  const size_t r_edge = segments().conversion_segments_size() - 1;
   SegmentFocusInternal(r_edge);
 }
 
@@ -928,15 +937,15 @@ void SessionConverter::ResizeSegmentWidth(const composer::Composer &composer,
   ResetResult();
 
   const ConversionRequest conversion_request(&composer, request_, config_);
-  if (!converter_->ResizeSegment(&segments_, conversion_request, segment_index_,
-                                 delta)) {
+  if (!converter_->ResizeSegment(mutable_segments(), conversion_request,
+                                 segment_index_, delta)) {
     return;
   }
 
   UpdateCandidateList();
   // Clears selected index of a focused segment and trailing segments.
   // TODO(hsumita): Keep the indices if the segment type is FIXED_VALUE.
-  selected_candidate_indices_.resize(segments_.conversion_segments_size());
+  selected_candidate_indices_.resize(segments().conversion_segments_size());
   std::fill(selected_candidate_indices_.begin() + segment_index_ + 1,
             selected_candidate_indices_.end(), 0);
   UpdateSelectedCandidateIndex();
@@ -960,7 +969,7 @@ SessionConverter::GetSelectedCandidateOfFocusedSegment() const {
 }
 
 const Segment::Candidate *SessionConverter::GetCandidateById(int id) const {
-  const Segment &segment = segments_.conversion_segment(segment_index_);
+  const Segment &segment = segments().conversion_segment(segment_index_);
   if (!segment.is_valid_index(id)) {
     return nullptr;
   }
@@ -1160,7 +1169,7 @@ void SessionConverter::FillOutput(const composer::Composer &composer,
   // For debug. Removed candidate words through the conversion process.
   if (CheckState(SUGGESTION | PREDICTION | CONVERSION)) {
     SessionOutput::FillRemovedCandidates(
-        segments_.conversion_segment(segment_index_),
+        segments().conversion_segment(segment_index_),
         output->mutable_removed_candidate_words_for_debug());
   }
 }
@@ -1185,6 +1194,7 @@ SessionConverter *SessionConverter::Clone() const {
   // moment it's ok because the current design guarantees that the converter is
   // singleton. However, we should refactor such bad design; see also the
   // comment right above.
+  // Shares the segments; either converter copies them before modifying them.
   session_converter->segments_ = segments_;
   session_converter->incognito_segments_ = incognito_segments_;
   session_converter->segment_index_ = segment_index_;
@@ -1207,6 +1217,18 @@ SessionConverter *SessionConverter::Clone() const {
   return session_converter;
 }
 
+Segments *SessionConverter::mutable_segments() {
+  if (segments_.use_count() > 1) {
+    // The copy doesn't include the cached lattice, which only matters for the
+    // converter that keeps converting, so the lattice moves to the copy.
+    auto segments = std::make_shared<Segments>(*segments_);
+    std::swap(*segments->mutable_cached_lattice(),
+              *segments_->mutable_cached_lattice());
+    segments_ = std::move(segments);
+  }
+  return segments_.get();
+}
+
 void SessionConverter::ResetResult() { result_.Clear(); }
 
 void SessionConverter::ResetState() {
@@ -1222,7 +1244,7 @@ void SessionConverter::ResetState() {
 void SessionConverter::SegmentFocus() {
   DCHECK(CheckState(SUGGESTION | PREDICTION | CONVERSION));
   if (!converter_->FocusSegmentValue(
-          &segments_, segment_index_,
+          mutable_segments(), segment_index_,
           GetCandidateIndexForConverter(segment_index_))) {
     LOG(ERROR) << "FocusSegmentValue failed";
   }
@@ -1231,7 +1253,7 @@ void SessionConverter::SegmentFocus() {
 void SessionConverter::SegmentFix() {
   DCHECK(CheckState(SUGGESTION | PREDICTION | CONVERSION));
   if (!converter_->CommitSegmentValue(
-          &segments_, segment_index_,
+          mutable_segments(), segment_index_,
           GetCandidateIndexForConverter(segment_index_))) {
     LOG(WARNING) << "CommitSegmentValue failed";
   }
@@ -1240,14 +1262,14 @@ void SessionConverter::SegmentFix() {
 void SessionConverter::GetPreedit(const size_t index, const size_t size,
                                   std::string *preedit) const {
   DCHECK(CheckState(SUGGESTION | PREDICTION | CONVERSION));
-  DCHECK(index + size <= segments_.conversion_segments_size());
+  DCHECK(index + size <= segments().conversion_segments_size());
   DCHECK(preedit);
 
   preedit->clear();
   for (size_t i = index; i < size; ++i) {
     if (CheckState(CONVERSION)) {
       // In conversion mode, all the key of candidates is same.
-      preedit->append(segments_.conversion_segment(i).key());
+      preedit->append(segments().conversion_segment(i).key());
     } else {
       DCHECK(CheckState(SUGGESTION | PREDICTION));
       // In suggestion or prediction modes, each key may have
@@ -1262,7 +1284,7 @@ void SessionConverter::GetPreedit(const size_t index, const size_t size,
 void SessionConverter::GetConversion(const size_t index, const size_t size,
                                      std::string *conversion) const {
   DCHECK(CheckState(SUGGESTION | PREDICTION | CONVERSION));
-  DCHECK(index + size <= segments_.conversion_segments_size());
+  DCHECK(index + size <= segments().conversion_segments_size());
   DCHECK(conversion);
 
   conversion->clear();
@@ -1274,7 +1296,7 @@ void SessionConverter::GetConversion(const size_t index, const size_t size,
 void SessionConverter::UpdateResultTokens(const size_t index,
                                           const size_t size) {
   DCHECK(CheckState(SUGGESTION | PREDICTION | CONVERSION));
-  DCHECK(index + size <= segments_.conversion_segments_size());
+  DCHECK(index + size <= segments().conversion_segments_size());
 
   auto add_tokens = [this](absl::string_view content_key,
                            absl::string_view content_value,
@@ -1293,7 +1315,7 @@ void SessionConverter::UpdateResultTokens(const size_t index,
   for (size_t i = index; i < size; ++i) {
     const int cand_idx = GetCandidateIndexForConverter(i);
     const Segment::Candidate &candidate =
-        segments_.conversion_segment(i).candidate(cand_idx);
+        segments().conversion_segment(i).candidate(cand_idx);
     const int first_token_idx = result_.tokens_size();
 
     if (Segment::Candidate::InnerSegmentIterator it(&candidate); !it.Done()) {
@@ -1318,11 +1340,11 @@ void SessionConverter::UpdateResultTokens(const size_t index,
 size_t SessionConverter::GetConsumedPreeditSize(const size_t index,
                                                 const size_t size) const {
   DCHECK(CheckState(SUGGESTION | PREDICTION | CONVERSION));
-  DCHECK(index + size <= segments_.conversion_segments_size());
+  DCHECK(index + size <= segments().conversion_segments_size());
 
   if (CheckState(SUGGESTION | PREDICTION)) {
     DCHECK_EQ(1, size);
-    const Segment &segment = segments_.conversion_segment(0);
+    const Segment &segment = segments().conversion_segment(0);
     const int id = GetCandidateIndexForConverter(0);
     const Segment::Candidate &candidate = segment.candidate(id);
     return (candidate.attributes & Segment::Candidate::PARTIALLY_KEY_CONSUMED)
@@ -1335,10 +1357,10 @@ size_t SessionConverter::GetConsumedPreeditSize(const size_t index,
   for (size_t i = index; i < size; ++i) {
     const int id = GetCandidateIndexForConverter(i);
     const Segment::Candidate &candidate =
-        segments_.conversion_segment(i).candidate(id);
+        segments().conversion_segment(i).candidate(id);
     DCHECK(
         !(candidate.attributes & Segment::Candidate::PARTIALLY_KEY_CONSUMED));
-    result += Util::CharsLen(segments_.conversion_segment(i).key());
+    result += Util::CharsLen(segments().conversion_segment(i).key());
   }
   return result;
 }
@@ -1350,7 +1372,7 @@ bool SessionConverter::MaybePerformCommandCandidate(const size_t index,
   for (size_t i = index; i < size; ++i) {
     const int id = GetCandidateIndexForConverter(i);
     const Segment::Candidate &candidate =
-        segments_.conversion_segment(i).candidate(id);
+        segments().conversion_segment(i).candidate(id);
     if (candidate.attributes & Segment::Candidate::COMMAND_CANDIDATE) {
       switch (candidate.command) {
         case Segment::Candidate::DEFAULT_COMMAND:
@@ -1416,8 +1438,8 @@ void SessionConverter::AppendCandidateList() {
   // cannot be decided).
   const bool add_meta_candidates = (candidate_list_.size() == 0);
 
-  DCHECK_LT(segment_index_, segments_.conversion_segments_size());
-  const Segment &segment = segments_.conversion_segment(segment_index_);
+  DCHECK_LT(segment_index_, segments().conversion_segments_size());
+  const Segment &segment = segments().conversion_segment(segment_index_);
 
   auto get_candidate_dedup_key =
       [](const Segment::Candidate &c) -> const std::string & {
@@ -1502,7 +1524,7 @@ std::string SessionConverter::GetSelectedCandidateValue(
   DCHECK(CheckState(SUGGESTION | PREDICTION | CONVERSION));
   const int id = GetCandidateIndexForConverter(segment_index);
   const Segment::Candidate &candidate =
-      segments_.conversion_segment(segment_index).candidate(id);
+      segments().conversion_segment(segment_index).candidate(id);
   if (candidate.attributes & Segment::Candidate::COMMAND_CANDIDATE) {
     // Return an empty string, however this path should not be reached.
     return "";
@@ -1514,12 +1536,12 @@ const Segment::Candidate &SessionConverter::GetSelectedCandidate(
     const size_t segment_index) const {
   DCHECK(CheckState(SUGGESTION | PREDICTION | CONVERSION));
   const int id = GetCandidateIndexForConverter(segment_index);
-  return segments_.conversion_segment(segment_index).candidate(id);
+  return segments().conversion_segment(segment_index).candidate(id);
 }
 
 void SessionConverter::FillConversion(commands::Preedit *preedit) const {
   DCHECK(CheckState(PREDICTION | CONVERSION));
-  SessionOutput::FillConversion(segments_, segment_index_,
+  SessionOutput::FillConversion(segments(), segment_index_,
                                 candidate_list_.focused_id(), preedit);
 }
 
@@ -1543,15 +1565,16 @@ void SessionConverter::FillCandidates(commands::Candidates *candidates) const {
   // Temporarily added to see if this condition is really satisfied in the
   // real world or not.
 #ifdef CHANNEL_DEV
-  CHECK_LT(0, segments_.conversion_segments_size());
+  CHECK_LT(0, segments().conversion_segments_size());
 #endif  // CHANNEL_DEV
-  if (segment_index_ >= segments_.conversion_segments_size()) {
+  if (segment_index_ >= segments().conversion_segments_size()) {
     LOG(WARNING) << "Invalid segment_index_: " << segment_index_
-                 << ", segments_size: " << segments_.conversion_segments_size();
+                 << ", segments_size: "
+                 << segments().conversion_segments_size();
     return;
   }
 
-  const Segment &segment = segments_.conversion_segment(segment_index_);
+  const Segment &segment = segments().conversion_segment(segment_index_);
   SessionOutput::FillCandidates(segment, candidate_list_, position, candidates);
 
   // Shortcut keys
@@ -1636,12 +1659,13 @@ void SessionConverter::FillAllCandidateWords(
       break;
   }
 
-  if (segment_index_ >= segments_.conversion_segments_size()) {
+  if (segment_index_ >= segments().conversion_segments_size()) {
     LOG(WARNING) << "Invalid segment_index_: " << segment_index_
-                 << ", segments_size: " << segments_.conversion_segments_size();
+                 << ", segments_size: "
+                 << segments().conversion_segments_size();
     return;
   }
-  const Segment &segment = segments_.conversion_segment(segment_index_);
+  const Segment &segment = segments().conversion_segment(segment_index_);
   SessionOutput::FillAllCandidateWords(segment, candidate_list_, category,
                                        candidates);
 }
@@ -1683,7 +1707,7 @@ void SessionConverter::OnStartComposition(const commands::Context &context) {
   if (!context.has_preceding_text()) {
     // In this case, reset history segments when the revision is mismatched.
     if (revision_changed) {
-      converter_->ResetConversion(&segments_);
+      converter_->ResetConversion(mutable_segments());
     }
     return;
   }
@@ -1692,22 +1716,13 @@ void SessionConverter::OnStartComposition(const commands::Context &context) {
   // If preceding text is empty, it is OK to reset the history segments by
   // calling ResetConversion.
   if (preceding_text.empty()) {
-    converter_->ResetConversion(&segments_);
+    converter_->ResetConversion(mutable_segments());
     return;
   }
 
   // Hereafter, we keep the existing history segments as long as it is
   // consistent with the preceding text even when revision_changed is true.
-  std::string history_text;
-  for (const Segment &segment : segments_) {
-    if (segment.segment_type() != Segment::HISTORY) {
-      break;
-    }
-    if (segment.candidates_size() == 0) {
-      break;
-    }
-    history_text.append(segment.candidate(0).value);
-  }
+  const std::string history_text = GetHistoryText();
 
   if (!history_text.empty()) {
     // Compare |preceding_text| with |history_text| to check if the history
@@ -1729,11 +1744,33 @@ void SessionConverter::OnStartComposition(const commands::Context &context) {
 
   // Here we reconstruct history segments from |preceding_text| regardless
   // of revision mismatch. If it fails the history segments is cleared anyway.
-  if (!converter_->ReconstructHistory(&segments_, preceding_text)) {
+  if (!converter_->ReconstructHistory(mutable_segments(), preceding_text)) {
     LOG(WARNING) << "ReconstructHistory failed.";
     DLOG(WARNING) << "preceding_text: " << preceding_text
-                  << ", segments: " << segments_.DebugString();
+                  << ", segments: " << segments().DebugString();
+  }
+}
+
+std::string SessionConverter::GetHistoryText() const {
+  std::string history_text;
+  for (const Segment &segment : segments()) {
+    if (segment.segment_type() != Segment::HISTORY) {
+      break;
+    }
+    if (segment.candidates_size() == 0) {
+      break;
+    }
+    history_text.append(segment.candidate(0).value);
   }
+  return history_text;
+}
+
+bool SessionConverter::RestoreHistory(absl::string_view history_text) {
+  if (!converter_->ReconstructHistory(mutable_segments(), history_text)) {
+    LOG(WARNING) << "ReconstructHistory failed.";
+    return false;
+  }
+  return true;
 }
 
 void SessionConverter::UpdateSelectedCandidateIndex() {
@@ -1752,7 +1789,7 @@ void SessionConverter::UpdateSelectedCandidateIndex() {
 
 void SessionConverter::InitializeSelectedCandidateIndices() {
   selected_candidate_indices_.clear();
-  selected_candidate_indices_.resize(segments_.conversion_segments_size());
+  selected_candidate_indices_.resize(segments().conversion_segments_size());
 }
 
 void SessionConverter::UpdateCandidateStats(absl::string_view base_name,
@@ -1786,7 +1823,7 @@ void SessionConverter::CommitUsageStats(
       commit_segment_size = 1;
       break;
     case CONVERSION:
-      commit_segment_size = segments_.conversion_segments_size();
+      commit_segment_size = segments().conversion_segments_size();
       break;
     default:
       LOG(DFATAL) << "Unexpected state: " << commit_state;
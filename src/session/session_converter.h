@@ -35,6 +35,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <limits>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -240,6 +241,9 @@ class SessionConverter : public SessionConverterInterface {
   // Set setting by the context.
   void OnStartComposition(const commands::Context &context) override;
 
+  std::string GetHistoryText() const override;
+  bool RestoreHistory(absl::string_view history_text) override;
+
   // Fills conversion request and segments with the conversion preferences.
   static void SetConversionPreferences(const ConversionPreferences &preferences,
                                        Segments *segments,
@@ -363,9 +367,17 @@ class SessionConverter : public SessionConverterInterface {
   // Creates a config for incognito mode from the current config.
   config::Config CreateIncognitoConfig();
 
+  // Returns the segments for read-only access.
+  const Segments &segments() const { return *segments_; }
+  // Returns the segments for modification, copying them first if they are
+  // shared with a clone.
+  Segments *mutable_segments();
+
   const ConverterInterface *converter_;
-  // Conversion stats used by converter_.
-  Segments segments_;
+  // Conversion stats used by converter_. Clone() shares them with the clone
+  // (e.g. an undo snapshot), and mutable_segments() copies them on the first
+  // modification after that.
+  std::shared_ptr<Segments> segments_;
 
   // Segments for Text Conversion API to fill incognito_candidate_words
   // Note:
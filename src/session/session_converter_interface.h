@@ -232,6 +232,13 @@ class SessionConverterInterface {
   // Update the internal state by the context.
   virtual void OnStartComposition(const commands::Context &context) = 0;
 
+  // Returns the committed text kept as the history segments.
+  virtual std::string GetHistoryText() const = 0;
+
+  // Reconstructs the history segments from |history_text|, e.g., when the
+  // session is restored from its snapshot.
+  virtual bool RestoreHistory(absl::string_view history_text) = 0;
+
   // Clone instance.
   // Callee object doesn't have the ownership of the cloned instance.
   virtual SessionConverterInterface *Clone() const = 0;
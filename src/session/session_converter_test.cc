@@ -125,16 +125,16 @@ class SessionConverterTest : public testing::TestWithTempUserProfile {
 
   static void GetSegments(const SessionConverter &converter, Segments *dest) {
     CHECK(dest);
-    *dest = converter.segments_;
+    *dest = converter.segments();
   }
 
   static const Segments &GetSegments(const SessionConverter &converter) {
-    return converter.segments_;
+    return converter.segments();
   }
 
   static void SetSegments(const Segments &src, SessionConverter *converter) {
     CHECK(converter);
-    converter->segments_ = src;
+    *converter->mutable_segments() = src;
   }
 
   static const commands::Result &GetResult(const SessionConverter &converter) {
@@ -2734,6 +2734,30 @@ TEST_F(SessionConverterTest, Clone) {
   }
 }
 
+TEST_F(SessionConverterTest, CloneSharesSegmentsUntilModified) {
+  MockConverter mock_converter;
+  SessionConverter src(&mock_converter, request_.get(), config_.get());
+  Segments segments;
+  SetKamaboko(&segments);
+  EXPECT_CALL(mock_converter, StartConversion(_, _))
+      .WillOnce(DoAll(SetArgPointee<1>(segments), Return(true)));
+  EXPECT_TRUE(src.Convert(*composer_));
+
+  std::unique_ptr<SessionConverter> dest(src.Clone());
+  EXPECT_EQ(&GetSegments(src), &GetSegments(*dest));
+
+  // Cancel() modifies the segments of the source only.
+  EXPECT_CALL(mock_converter, CancelConversion(_))
+      .WillOnce(
+          [](Segments *segments) { segments->clear_conversion_segments(); });
+  src.Cancel();
+  EXPECT_NE(&GetSegments(src), &GetSegments(*dest));
+  EXPECT_EQ(GetSegments(src).conversion_segments_size(), 0);
+  EXPECT_EQ(GetSegments(*dest).conversion_segments_size(),
+            segments.conversion_segments_size());
+  EXPECT_TRUE(dest->IsActive());
+}
+
 // Suggest() in the suggestion state was not accepted.  (http://b/1948334)
 TEST_F(SessionConverterTest, Issue1948334) {
   MockConverter mock_converter;
@@ -37,6 +37,7 @@
 #include <cstdint>
 #include <limits>
 #include <memory>
+#include <optional>
 #include <utility>
 #include <vector>
 
@@ -45,7 +46,10 @@
 #include "absl/random/random.h"
 #include "absl/time/time.h"
 #include "base/clock.h"
+#include "base/file_util.h"
+#include "base/hash.h"
 #include "base/stopwatch.h"
+#include "base/system_util.h"
 #include "base/version.h"
 #include "base/vlog.h"
 #include "composer/table.h"
@@ -58,12 +62,14 @@
 #include "protocol/commands.pb.h"
 #include "protocol/config.pb.h"
 #include "protocol/engine_builder.pb.h"
+#include "protocol/state.pb.h"
 #include "protocol/user_dictionary_storage.pb.h"
 #include "session/common.h"
 #include "session/internal/keymap.h"
 #include "session/session.h"
 #include "session/session_observer_handler.h"
 #include "session/session_observer_interface.h"
+#include "session/session_snapshot_storage.h"
 #include "usage_stats/usage_stats.h"
 
 #ifndef MOZC_DISABLE_SESSION_WATCHDOG
@@ -104,11 +110,18 @@ ABSL_FLAG(int32_t, last_create_session_timeout, 300,
 
 ABSL_FLAG(bool, restricted, false, "Launch server with restricted setting");
 
+ABSL_FLAG(int32_t, session_snapshot_interval, 0,
+          "minimum interval (sec) to checkpoint session snapshots to a local "
+          "file on Cleanup, from which sessions are restored after the server "
+          "restarts. 0 disables the snapshots");
+
 namespace mozc {
 namespace {
 
 using mozc::usage_stats::UsageStats;
 
+constexpr char kSessionSnapshotFile[] = "session_snapshot.db";
+
 bool IsApplicationAlive(const session::Session *session) {
 #ifndef MOZC_DISABLE_SESSION_WATCHDOG
   const commands::ApplicationInfo &info = session->application_info();
@@ -167,6 +180,21 @@ SessionHandler::SessionHandler(std::unique_ptr<EngineInterface> engine)
       std::max(2, std::min(absl::GetFlag(FLAGS_max_session_size), 128));
   session_map_ = std::make_unique<SessionMap>(max_session_size_);
 
+  request_fingerprint_ = Fingerprint(request_->SerializeAsString());
+  config_fingerprint_ = Fingerprint(config_->SerializeAsString());
+  if (absl::GetFlag(FLAGS_session_snapshot_interval) > 0) {
+    snapshot_interval_ =
+        absl::Seconds(absl::GetFlag(FLAGS_session_snapshot_interval));
+    snapshot_storage_ = std::make_unique<session::SessionSnapshotStorage>(
+        FileUtil::JoinPath(SystemUtil::GetUserProfileDirectory(),
+                           kSessionSnapshotFile));
+    snapshot_storage_->Load();
+    // Snapshots of the sessions which would have been removed by Cleanup().
+    snapshot_storage_->EraseOlderThan(
+        Clock::GetAbslTime() -
+        absl::Seconds(absl::GetFlag(FLAGS_last_command_timeout)));
+  }
+
   if (!engine_) {
     return;
   }
@@ -198,6 +226,8 @@ void SessionHandler::UpdateSessions(const config::Config &config,
 
   config_ = std::make_unique<config::Config>(config);
   request_ = std::make_unique<commands::Request>(request);
+  request_fingerprint_ = Fingerprint(request_->SerializeAsString());
+  config_fingerprint_ = Fingerprint(config_->SerializeAsString());
   const composer::Table *table = nullptr;
   table = table_manager_->GetTable(*request_, *config_);
 
@@ -232,6 +262,7 @@ bool SessionHandler::SyncData(commands::Command *command) {
 
 bool SessionHandler::Shutdown(commands::Command *command) {
   MOZC_VLOG(1) << "Shutdown server";
+  SaveSnapshots();
   SyncData(command);
   is_available_ = false;
   UsageStats::IncrementCount("ShutDown");
@@ -439,6 +470,7 @@ bool SessionHandler::SendKey(commands::Command *command) {
     return false;
   }
   (*session)->SendKey(command);
+  UpdateSnapshot(id, **session, command->mutable_output());
   MaybeUpdateConfig(command);
   return true;
 }
@@ -462,6 +494,7 @@ bool SessionHandler::SendCommand(commands::Command *command) {
     return false;
   }
   (*session)->SendCommand(command);
+  UpdateSnapshot(id, **session, command->mutable_output());
   MaybeUpdateConfig(command);
   return true;
 }
@@ -521,6 +554,9 @@ bool SessionHandler::CreateSession(commands::Command *command) {
     }
 
     oldest_element->value.reset();
+    if (snapshot_storage_) {
+      snapshot_storage_->Erase(oldest_element->key);
+    }
     session_map_->Erase(oldest_element->key);
     MOZC_VLOG(1) << "Session is FULL, oldest SessionID " << oldest_element->key
                  << " is removed";
@@ -554,6 +590,13 @@ bool SessionHandler::CreateSession(commands::Command *command) {
   // including the newly created one.
   UpdateSessions(*config::ConfigHandler::GetConfig(), *request_);
 
+  // The client specifies the id of the session it lost when the previous
+  // server process terminated.
+  if (command->input().id() != 0 &&
+      RestoreSession(command->input().id(), element->value.get(), command)) {
+    UpdateSnapshot(new_id, *element->value, command->mutable_output());
+  }
+
   // session is not empty.
   last_session_empty_time_ = absl::InfinitePast();
 
@@ -631,6 +674,13 @@ bool SessionHandler::Cleanup(commands::Command *command) {
     MOZC_VLOG(1) << "Session ID " << remove_ids[i] << " is removed by server";
   }
 
+  if (snapshot_storage_) {
+    snapshot_storage_->EraseOlderThan(current_time - last_command_timeout);
+    if (current_time - last_snapshot_save_time_ >= snapshot_interval_) {
+      SaveSnapshots();
+    }
+  }
+
   // Sync all data. This is a regression bug fix http://b/3033708
   engine_->Sync();
 
@@ -716,6 +766,54 @@ SessionID SessionHandler::CreateNewSessionID() {
   }
 }
 
+void SessionHandler::UpdateSnapshot(SessionID id,
+                                    const session::Session &session,
+                                    commands::Output *output) {
+  if (!snapshot_storage_) {
+    return;
+  }
+  output->set_input_sequence(session.input_sequence());
+  const absl::Time current_time = Clock::GetAbslTime();
+  protocol::SessionSnapshot snapshot;
+  session.SaveSnapshot(&snapshot);
+  snapshot.set_id(id);
+  snapshot.set_timestamp(absl::ToUnixSeconds(current_time));
+  snapshot.set_request_fingerprint(request_fingerprint_);
+  snapshot.set_config_fingerprint(config_fingerprint_);
+  snapshot_storage_->Update(std::move(snapshot));
+}
+
+void SessionHandler::SaveSnapshots() {
+  if (!snapshot_storage_) {
+    return;
+  }
+  snapshot_storage_->Save();
+  last_snapshot_save_time_ = Clock::GetAbslTime();
+}
+
+bool SessionHandler::RestoreSession(SessionID id, session::Session *session,
+                                    commands::Command *command) {
+  if (!snapshot_storage_) {
+    return false;
+  }
+  std::optional<protocol::SessionSnapshot> snapshot =
+      snapshot_storage_->Take(id);
+  if (!snapshot.has_value()) {
+    return false;
+  }
+  // The composition depends on the request and config (e.g., the romaji
+  // table), so the client has to replay its history in that case.
+  if (snapshot->request_fingerprint() != request_fingerprint_ ||
+      snapshot->config_fingerprint() != config_fingerprint_) {
+    MOZC_VLOG(1) << "Snapshot of SessionID " << id << " is obsolete";
+    return false;
+  }
+  session->RestoreSnapshot(*snapshot, command);
+  command->mutable_output()->set_session_restored(true);
+  MOZC_VLOG(1) << "SessionID " << id << " is restored from the snapshot";
+  return true;
+}
+
 bool SessionHandler::DeleteSessionID(SessionID id) {
   std::unique_ptr<session::Session> *session = session_map_->MutableLookup(id);
   if (session == nullptr || !*session) {
@@ -725,6 +823,9 @@ bool SessionHandler::DeleteSessionID(SessionID id) {
   session->reset();
 
   session_map_->Erase(id);  // remove from LRU
+  if (snapshot_storage_) {
+    snapshot_storage_->Erase(id);
+  }
 
   // if session gets empty, save the timestamp
   if (last_session_empty_time_ == absl::InfinitePast() &&
@@ -51,6 +51,7 @@
 #include "session/session_handler_interface.h"
 #include "session/session_observer_handler.h"
 #include "session/session_observer_interface.h"
+#include "session/session_snapshot_storage.h"
 #include "storage/lru_cache.h"
 #include "testing/friend_test.h"
 
@@ -139,6 +140,18 @@ class SessionHandler : public SessionHandlerInterface {
   SessionID CreateNewSessionID();
   bool DeleteSessionID(SessionID id);
 
+  // Updates the snapshot of the session |id| in memory and sets its input
+  // sequence to |output|. The snapshots are written to the file on Cleanup()
+  // and Shutdown(), not on every key event.
+  void UpdateSnapshot(SessionID id, const session::Session &session,
+                      commands::Output *output);
+  // Writes the snapshots to the file regardless of the snapshot interval.
+  void SaveSnapshots();
+  // Restores |session| from the snapshot of the session |id| created by the
+  // previous server process. Returns false if there is no valid snapshot.
+  bool RestoreSession(SessionID id, session::Session *session,
+                      commands::Command *command);
+
   std::unique_ptr<SessionMap> session_map_;
 #ifndef MOZC_DISABLE_SESSION_WATCHDOG
   std::optional<SessionWatchDog> session_watch_dog_;
@@ -159,6 +172,15 @@ class SessionHandler : public SessionHandlerInterface {
   std::unique_ptr<keymap::KeyMapManager> key_map_manager_;
   std::unique_ptr<engine::SupplementalModelInterface> supplemental_model_;
 
+  // Snapshots of the sessions to restore them after the server restarts.
+  // nullptr if the snapshots are disabled.
+  std::unique_ptr<session::SessionSnapshotStorage> snapshot_storage_;
+  absl::Duration snapshot_interval_ = absl::ZeroDuration();
+  absl::Time last_snapshot_save_time_ = absl::InfinitePast();
+  // Fingerprints of request_ and config_ recorded in the snapshots.
+  uint64_t request_fingerprint_ = 0;
+  uint64_t config_fingerprint_ = 0;
+
   absl::BitGen bitgen_;
 };
 
@@ -48,6 +48,8 @@
 #include "absl/time/time.h"
 #include "base/clock.h"
 #include "base/clock_mock.h"
+#include "base/file_util.h"
+#include "base/system_util.h"
 #include "composer/query.h"
 #include "config/config_handler.h"
 #include "converter/segments.h"
@@ -76,6 +78,7 @@ ABSL_DECLARE_FLAG(int32_t, max_session_size);
 ABSL_DECLARE_FLAG(int32_t, create_session_min_interval);
 ABSL_DECLARE_FLAG(int32_t, last_command_timeout);
 ABSL_DECLARE_FLAG(int32_t, last_create_session_timeout);
+ABSL_DECLARE_FLAG(int32_t, session_snapshot_interval);
 
 namespace mozc {
 namespace {
@@ -579,6 +582,134 @@ TEST_F(SessionHandlerTest, UpdateComposition) {
   }
 }
 
+TEST_F(SessionHandlerTest, RestoreSessionFromSnapshot) {
+  absl::SetFlag(&FLAGS_session_snapshot_interval, 1);
+  config::Config config;
+  config::ConfigHandler::GetConfig(&config);
+  config::ConfigHandler::SetConfig(config);
+
+  uint64_t session_id = 0;
+  {
+    SessionHandler handler(CreateMockDataEngine());
+    EXPECT_TRUE(CreateSession(handler, &session_id));
+    {
+      commands::Command command;
+      commands::Input *input = command.mutable_input();
+      input->set_id(session_id);
+      input->set_type(commands::Input::SEND_KEY);
+      input->mutable_key()->set_special_key(commands::KeyEvent::ON);
+      EXPECT_TRUE(handler.EvalCommand(&command));
+    }
+    {
+      commands::Command command;
+      commands::Input *input = command.mutable_input();
+      input->set_id(session_id);
+      input->set_type(commands::Input::SEND_KEY);
+      input->mutable_key()->set_key_code('a');
+      EXPECT_TRUE(handler.EvalCommand(&command));
+      EXPECT_EQ(command.output().preedit().segment(0).value(), "あ");
+      EXPECT_EQ(command.output().input_sequence(), 2);
+    }
+    commands::Command command;
+    command.mutable_input()->set_type(commands::Input::SHUTDOWN);
+    EXPECT_TRUE(handler.EvalCommand(&command));
+  }
+
+  // The restarted server restores the composition of the lost session.
+  SessionHandler handler(CreateMockDataEngine());
+  {
+    commands::Command command;
+    command.mutable_input()->set_type(commands::Input::CREATE_SESSION);
+    command.mutable_input()->set_id(session_id);
+    EXPECT_TRUE(handler.EvalCommand(&command));
+    EXPECT_TRUE(command.output().session_restored());
+    ASSERT_EQ(command.output().preedit().segment_size(), 1);
+    EXPECT_EQ(command.output().preedit().segment(0).value(), "あ");
+    // The client checks it against the last input sequence it received.
+    EXPECT_EQ(command.output().input_sequence(), 2);
+  }
+  // The snapshot is consumed by the restoration.
+  {
+    commands::Command command;
+    command.mutable_input()->set_type(commands::Input::CREATE_SESSION);
+    command.mutable_input()->set_id(session_id);
+    EXPECT_TRUE(handler.EvalCommand(&command));
+    EXPECT_FALSE(command.output().session_restored());
+  }
+}
+
+TEST_F(SessionHandlerTest, SnapshotsAreWrittenOnCleanup) {
+  absl::SetFlag(&FLAGS_session_snapshot_interval, 1);
+  const std::string filename = FileUtil::JoinPath(
+      SystemUtil::GetUserProfileDirectory(), "session_snapshot.db");
+
+  SessionHandler handler(CreateMockDataEngine());
+  uint64_t session_id = 0;
+  EXPECT_TRUE(CreateSession(handler, &session_id));
+  {
+    commands::Command command;
+    commands::Input *input = command.mutable_input();
+    input->set_id(session_id);
+    input->set_type(commands::Input::SEND_KEY);
+    input->mutable_key()->set_special_key(commands::KeyEvent::ON);
+    EXPECT_TRUE(handler.EvalCommand(&command));
+  }
+  {
+    commands::Command command;
+    commands::Input *input = command.mutable_input();
+    input->set_id(session_id);
+    input->set_type(commands::Input::SEND_KEY);
+    input->mutable_key()->set_key_code('a');
+    EXPECT_TRUE(handler.EvalCommand(&command));
+  }
+  // Key events don't write the file.
+  EXPECT_FALSE(FileUtil::FileExists(filename).ok());
+
+  commands::Command command;
+  command.mutable_input()->set_type(commands::Input::CLEANUP);
+  EXPECT_TRUE(handler.EvalCommand(&command));
+  EXPECT_OK(FileUtil::FileExists(filename));
+}
+
+TEST_F(SessionHandlerTest, SnapshotsAreDisabledByDefault) {
+  uint64_t session_id = 0;
+  {
+    SessionHandler handler(CreateMockDataEngine());
+    EXPECT_TRUE(CreateSession(handler, &session_id));
+    {
+      commands::Command command;
+      commands::Input *input = command.mutable_input();
+      input->set_id(session_id);
+      input->set_type(commands::Input::SEND_KEY);
+      input->mutable_key()->set_special_key(commands::KeyEvent::ON);
+      EXPECT_TRUE(handler.EvalCommand(&command));
+    }
+    {
+      commands::Command command;
+      commands::Input *input = command.mutable_input();
+      input->set_id(session_id);
+      input->set_type(commands::Input::SEND_KEY);
+      input->mutable_key()->set_key_code('a');
+      EXPECT_TRUE(handler.EvalCommand(&command));
+      EXPECT_FALSE(command.output().has_input_sequence());
+    }
+    commands::Command command;
+    command.mutable_input()->set_type(commands::Input::SHUTDOWN);
+    EXPECT_TRUE(handler.EvalCommand(&command));
+  }
+  EXPECT_FALSE(FileUtil::FileExists(
+                   FileUtil::JoinPath(SystemUtil::GetUserProfileDirectory(),
+                                      "session_snapshot.db"))
+                   .ok());
+
+  SessionHandler handler(CreateMockDataEngine());
+  commands::Command command;
+  command.mutable_input()->set_type(commands::Input::CREATE_SESSION);
+  command.mutable_input()->set_id(session_id);
+  EXPECT_TRUE(handler.EvalCommand(&command));
+  EXPECT_FALSE(command.output().session_restored());
+}
+
 TEST_F(SessionHandlerTest, KeyMapTest) {
   config::Config config;
   config::ConfigHandler::GetConfig(&config);
@@ -49,6 +49,7 @@ ABSL_DECLARE_FLAG(int32_t, watch_dog_interval);
 ABSL_DECLARE_FLAG(int32_t, last_command_timeout);
 ABSL_DECLARE_FLAG(int32_t, last_create_session_timeout);
 ABSL_DECLARE_FLAG(bool, restricted);
+ABSL_DECLARE_FLAG(int32_t, session_snapshot_interval);
 
 namespace mozc {
 namespace session {
@@ -111,6 +112,8 @@ void SessionHandlerTestBase::SetUp() {
   flags_last_create_session_timeout_backup_ =
       absl::GetFlag(FLAGS_last_create_session_timeout);
   flags_restricted_backup_ = absl::GetFlag(FLAGS_restricted);
+  flags_session_snapshot_interval_backup_ =
+      absl::GetFlag(FLAGS_session_snapshot_interval);
 
   ConfigHandler::GetConfig(&config_backup_);
   ClearState();
@@ -129,6 +132,8 @@ void SessionHandlerTestBase::TearDown() {
   absl::SetFlag(&FLAGS_last_create_session_timeout,
                 flags_last_create_session_timeout_backup_);
   absl::SetFlag(&FLAGS_restricted, flags_restricted_backup_);
+  absl::SetFlag(&FLAGS_session_snapshot_interval,
+                flags_session_snapshot_interval_backup_);
 }
 
 void SessionHandlerTestBase::ClearState() {
@@ -76,6 +76,7 @@ class SessionHandlerTestBase : public ::mozc::testing::TestWithTempUserProfile {
   int32_t flags_last_command_timeout_backup_;
   int32_t flags_last_create_session_timeout_backup_;
   bool flags_restricted_backup_;
+  int32_t flags_session_snapshot_interval_backup_;
   usage_stats::scoped_usage_stats_enabler usage_stats_enabler_;
 };
 
@@ -0,0 +1,138 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "session/session_snapshot_storage.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "base/file_util.h"
+#include "protocol/state.pb.h"
+
+namespace mozc {
+namespace session {
+
+bool SessionSnapshotStorage::Load() {
+  snapshots_.clear();
+  modified_ = false;
+
+  absl::StatusOr<std::string> contents = FileUtil::GetContents(filename_);
+  if (!contents.ok()) {
+    return false;
+  }
+  protocol::SessionSnapshots snapshots;
+  if (!snapshots.ParseFromString(*contents)) {
+    LOG(ERROR) << "Broken session snapshots: " << filename_;
+    return false;
+  }
+  for (protocol::SessionSnapshot &snapshot : *snapshots.mutable_snapshots()) {
+    const uint64_t id = snapshot.id();
+    snapshots_[id] = std::move(snapshot);
+  }
+  return true;
+}
+
+bool SessionSnapshotStorage::Save() {
+  if (!modified_) {
+    return true;
+  }
+
+  // |modified_| is kept on failure so that the next Save() retries.
+  if (snapshots_.empty()) {
+    if (absl::Status s = FileUtil::UnlinkIfExists(filename_); !s.ok()) {
+      LOG(ERROR) << "Cannot remove " << filename_ << ": " << s;
+      return false;
+    }
+    modified_ = false;
+    return true;
+  }
+
+  protocol::SessionSnapshots snapshots;
+  for (const auto &[id, snapshot] : snapshots_) {
+    *snapshots.add_snapshots() = snapshot;
+  }
+  const std::string tmp_filename = filename_ + ".tmp";
+  if (absl::Status s =
+          FileUtil::SetContents(tmp_filename, snapshots.SerializeAsString());
+      !s.ok()) {
+    LOG(ERROR) << "Cannot write " << tmp_filename << ": " << s;
+    return false;
+  }
+  if (absl::Status s = FileUtil::AtomicRename(tmp_filename, filename_);
+      !s.ok()) {
+    LOG(ERROR) << "AtomicRename failed: " << s << "; from: " << tmp_filename
+               << ", to: " << filename_;
+    return false;
+  }
+  modified_ = false;
+  return true;
+}
+
+void SessionSnapshotStorage::Update(protocol::SessionSnapshot snapshot) {
+  const uint64_t id = snapshot.id();
+  snapshots_[id] = std::move(snapshot);
+  modified_ = true;
+}
+
+void SessionSnapshotStorage::Erase(uint64_t id) {
+  if (snapshots_.erase(id) > 0) {
+    modified_ = true;
+  }
+}
+
+std::optional<protocol::SessionSnapshot> SessionSnapshotStorage::Take(
+    uint64_t id) {
+  auto node = snapshots_.extract(id);
+  if (node.empty()) {
+    return std::nullopt;
+  }
+  modified_ = true;
+  return std::move(node.mapped());
+}
+
+void SessionSnapshotStorage::EraseOlderThan(absl::Time time) {
+  const int64_t timestamp = absl::ToUnixSeconds(time);
+  const size_t erased = absl::erase_if(snapshots_, [timestamp](const auto &it) {
+    return static_cast<int64_t>(it.second.timestamp()) < timestamp;
+  });
+  if (erased > 0) {
+    modified_ = true;
+  }
+}
+
+}  // namespace session
+}  // namespace mozc
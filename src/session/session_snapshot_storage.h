@@ -0,0 +1,93 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// Storage of the session snapshots used to restore sessions after the server
+// restarts.
+
+#ifndef MOZC_SESSION_SESSION_SNAPSHOT_STORAGE_H_
+#define MOZC_SESSION_SESSION_SNAPSHOT_STORAGE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/time/time.h"
+#include "protocol/state.pb.h"
+
+namespace mozc {
+namespace session {
+
+// Keeps the latest snapshot of each session and persists them to a local
+// file. SessionHandler restores a session from its snapshot when the client
+// reconnects after the server restarts, instead of letting the client replay
+// its input history.
+class SessionSnapshotStorage final {
+ public:
+  explicit SessionSnapshotStorage(std::string filename)
+      : filename_(std::move(filename)) {}
+  SessionSnapshotStorage(const SessionSnapshotStorage &) = delete;
+  SessionSnapshotStorage &operator=(const SessionSnapshotStorage &) = delete;
+
+  // Loads the snapshots from the file, replacing the current ones. Returns
+  // false if the file doesn't exist or is broken.
+  bool Load();
+
+  // Writes the snapshots to the file if they are modified since the last
+  // Load() or successful Save(). The file is replaced atomically.
+  bool Save();
+
+  // Replaces the snapshot of |snapshot.id()|.
+  void Update(protocol::SessionSnapshot snapshot);
+
+  // Removes the snapshot of |id|.
+  void Erase(uint64_t id);
+
+  // Removes the snapshot of |id| and returns it.
+  std::optional<protocol::SessionSnapshot> Take(uint64_t id);
+
+  // Removes the snapshots taken before |time|.
+  void EraseOlderThan(absl::Time time);
+
+  size_t size() const { return snapshots_.size(); }
+  bool modified() const { return modified_; }
+
+ private:
+  std::string filename_;
+  absl::flat_hash_map<uint64_t, protocol::SessionSnapshot> snapshots_;
+  bool modified_ = false;
+};
+
+}  // namespace session
+}  // namespace mozc
+
+#endif  // MOZC_SESSION_SESSION_SNAPSHOT_STORAGE_H_
@@ -0,0 +1,149 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "session/session_snapshot_storage.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "absl/time/time.h"
+#include "base/file/temp_dir.h"
+#include "base/file_util.h"
+#include "protocol/state.pb.h"
+#include "testing/gmock.h"
+#include "testing/gunit.h"
+#include "testing/mozctest.h"
+
+namespace mozc {
+namespace session {
+namespace {
+
+protocol::SessionSnapshot MakeSnapshot(uint64_t id, int64_t timestamp,
+                                       const std::string &preedit) {
+  protocol::SessionSnapshot snapshot;
+  snapshot.set_id(id);
+  snapshot.set_timestamp(timestamp);
+  snapshot.set_activated(true);
+  snapshot.set_preedit(preedit);
+  return snapshot;
+}
+
+TEST(SessionSnapshotStorageTest, SaveAndLoad) {
+  TempDirectory temp_dir = testing::MakeTempDirectoryOrDie();
+  const std::string filename =
+      FileUtil::JoinPath(temp_dir.path(), "session_snapshot.db");
+
+  SessionSnapshotStorage storage(filename);
+  EXPECT_FALSE(storage.Load());
+  EXPECT_EQ(storage.size(), 0);
+
+  storage.Update(MakeSnapshot(1, 100, "a"));
+  storage.Update(MakeSnapshot(2, 200, "b"));
+  storage.Update(MakeSnapshot(1, 300, "c"));
+  EXPECT_EQ(storage.size(), 2);
+  EXPECT_TRUE(storage.modified());
+  EXPECT_TRUE(storage.Save());
+  EXPECT_FALSE(storage.modified());
+  EXPECT_OK(FileUtil::FileExists(filename));
+  EXPECT_FALSE(FileUtil::FileExists(filename + ".tmp").ok());
+
+  SessionSnapshotStorage storage2(filename);
+  ASSERT_TRUE(storage2.Load());
+  EXPECT_EQ(storage2.size(), 2);
+
+  std::optional<protocol::SessionSnapshot> snapshot = storage2.Take(1);
+  ASSERT_TRUE(snapshot.has_value());
+  EXPECT_EQ(snapshot->timestamp(), 300);
+  EXPECT_EQ(snapshot->preedit(), "c");
+  EXPECT_FALSE(storage2.Take(1).has_value());
+  EXPECT_FALSE(storage2.Take(3).has_value());
+  EXPECT_EQ(storage2.size(), 1);
+
+  // Removing the last snapshot removes the file.
+  storage2.Erase(2);
+  EXPECT_EQ(storage2.size(), 0);
+  EXPECT_TRUE(storage2.Save());
+  EXPECT_FALSE(FileUtil::FileExists(filename).ok());
+}
+
+TEST(SessionSnapshotStorageTest, EraseOlderThan) {
+  TempDirectory temp_dir = testing::MakeTempDirectoryOrDie();
+  SessionSnapshotStorage storage(
+      FileUtil::JoinPath(temp_dir.path(), "session_snapshot.db"));
+
+  storage.Update(MakeSnapshot(1, 100, "a"));
+  storage.Update(MakeSnapshot(2, 200, "b"));
+  storage.Update(MakeSnapshot(3, 300, "c"));
+  ASSERT_TRUE(storage.Save());
+
+  storage.EraseOlderThan(absl::FromUnixSeconds(50));
+  EXPECT_FALSE(storage.modified());
+  storage.EraseOlderThan(absl::FromUnixSeconds(200));
+  EXPECT_TRUE(storage.modified());
+  EXPECT_EQ(storage.size(), 2);
+  EXPECT_FALSE(storage.Take(1).has_value());
+  EXPECT_TRUE(storage.Take(2).has_value());
+  EXPECT_TRUE(storage.Take(3).has_value());
+}
+
+TEST(SessionSnapshotStorageTest, KeepModifiedOnSaveFailure) {
+  TempDirectory temp_dir = testing::MakeTempDirectoryOrDie();
+  // The directory doesn't exist, so the file cannot be written.
+  const std::string dirname = FileUtil::JoinPath(temp_dir.path(), "dir");
+  const std::string filename =
+      FileUtil::JoinPath(dirname, "session_snapshot.db");
+
+  SessionSnapshotStorage storage(filename);
+  storage.Update(MakeSnapshot(1, 100, "a"));
+  EXPECT_FALSE(storage.Save());
+  EXPECT_TRUE(storage.modified());
+
+  // The next Save() retries.
+  ASSERT_OK(FileUtil::CreateDirectory(dirname));
+  EXPECT_TRUE(storage.Save());
+  EXPECT_FALSE(storage.modified());
+  EXPECT_OK(FileUtil::FileExists(filename));
+}
+
+TEST(SessionSnapshotStorageTest, BrokenFile) {
+  TempDirectory temp_dir = testing::MakeTempDirectoryOrDie();
+  const std::string filename =
+      FileUtil::JoinPath(temp_dir.path(), "session_snapshot.db");
+  ASSERT_OK(FileUtil::SetContents(filename, "\xff\xff\xff"));
+
+  SessionSnapshotStorage storage(filename);
+  EXPECT_FALSE(storage.Load());
+  EXPECT_EQ(storage.size(), 0);
+}
+
+}  // namespace
+}  // namespace session
+}  // namespace mozc
@@ -60,6 +60,7 @@
 #include "protocol/candidates.pb.h"
 #include "protocol/commands.pb.h"
 #include "protocol/config.pb.h"
+#include "protocol/state.pb.h"
 #include "request/conversion_request.h"
 #include "request/request_test_util.h"
 #include "rewriter/transliteration_rewriter.h"
@@ -9333,6 +9334,59 @@ TEST_F(SessionTest, BackKeyCommitsPreeditInPasswordMode) {
   EXPECT_FALSE(command.output().has_preedit());
 }
 
+TEST_F(SessionTest, SaveSnapshotOmitsPrivateText) {
+  MockConverter converter;
+  MockEngine engine;
+  EXPECT_CALL(engine, GetConverter()).WillRepeatedly(Return(&converter));
+
+  {
+    Session session(&engine);
+    InitSessionToPrecomposition(&session);
+    commands::Command command;
+    InsertCharacterChars("aiu", &session, &command);
+    protocol::SessionSnapshot snapshot;
+    session.SaveSnapshot(&snapshot);
+    EXPECT_TRUE(snapshot.activated());
+    EXPECT_EQ(snapshot.raw_text(), "aiu");
+    EXPECT_EQ(snapshot.preedit(), "あいう");
+  }
+  {
+    // Password field.
+    Session session(&engine);
+    InitSessionToPrecomposition(&session);
+    SwitchInputFieldType(commands::Context::PASSWORD, &session);
+    SwitchInputMode(commands::HALF_ASCII, &session);
+    commands::Command command;
+    SendKey("m", &session, &command);
+    EXPECT_EQ(GetComposition(command), "m");
+    protocol::SessionSnapshot snapshot;
+    session.SaveSnapshot(&snapshot);
+    EXPECT_TRUE(snapshot.activated());
+    EXPECT_EQ(snapshot.mode(), commands::HALF_ASCII);
+    EXPECT_FALSE(snapshot.has_raw_text());
+    EXPECT_FALSE(snapshot.has_preedit());
+    EXPECT_FALSE(snapshot.has_history_text());
+  }
+  {
+    // Incognito mode.
+    config::Config config;
+    config::ConfigHandler::GetDefaultConfig(&config);
+    config.set_incognito_mode(true);
+    Session session(&engine);
+    session.SetConfig(&config);
+    InitSessionToPrecomposition(&session);
+    commands::Command command;
+    InsertCharacterChars("aiu", &session, &command);
+    EXPECT_EQ(GetComposition(command), "あいう");
+    protocol::SessionSnapshot snapshot;
+    session.SaveSnapshot(&snapshot);
+    EXPECT_TRUE(snapshot.activated());
+    EXPECT_FALSE(snapshot.has_raw_text());
+    EXPECT_FALSE(snapshot.has_preedit());
+    EXPECT_FALSE(snapshot.has_history_text());
+  }
+}
+
 TEST_F(SessionTest, EditCancel) {
   MockConverter converter;
   MockEngine engine;
@@ -139,6 +139,7 @@
       'type': 'executable',
       'sources': [
         'session_observer_handler_test.cc',
+        'session_snapshot_storage_test.cc',
         'session_usage_observer_test.cc',
         'session_usage_stats_util_test.cc',
       ],
@@ -148,6 +149,7 @@
         '<(mozc_oss_src_dir)/config/config.gyp:config_handler',
         '<(mozc_oss_src_dir)/config/config.gyp:stats_config_util',
         '<(mozc_oss_src_dir)/protocol/protocol.gyp:commands_proto',
+        '<(mozc_oss_src_dir)/protocol/protocol.gyp:state_proto',
         '<(mozc_oss_src_dir)/testing/testing.gyp:gtest_main',
         '<(mozc_oss_src_dir)/testing/testing.gyp:mozctest',
         '<(mozc_oss_src_dir)/usage_stats/usage_stats_base.gyp:usage_stats',
@@ -39,9 +39,9 @@
 #include <utility>
 #include <vector>
 
+#include "absl/base/prefetch.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
-#include "absl/numeric/bits.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
@@ -51,74 +51,17 @@
 
 namespace mozc {
 namespace storage {
-namespace existence_filter_internal {
 namespace {
 
-struct BlockDimensions {
-  explicit BlockDimensions(uint32_t bits) {
-    count = bits >> kBlockShift;
-    const uint32_t bits_in_last_block = bits & kBlockMask;
-    if (bits_in_last_block) {
-      ++count;
-      last_size = (bits_in_last_block + 31) / 32;
-    } else {
-      last_size = kBlockWords;
-    }
-  }
-
-  uint32_t count;
-  uint32_t last_size;
-};
-
-}  // namespace
-
-BlockBitmap::BlockBitmap(const uint32_t size, absl::Span<const uint32_t> buf) {
-  const BlockDimensions dimensions(size);
-  blocks_.reserve(dimensions.count);
-  for (uint32_t i = 0; i < dimensions.count - 1; ++i) {
-    blocks_.push_back(buf.subspan(0, kBlockWords));
-    buf.remove_prefix(kBlockWords);
-  }
-  blocks_.push_back(buf.subspan(0, dimensions.last_size));
-}
-
-BlockBitmapBuilder::BlockBitmapBuilder(uint32_t size) {
-  CHECK_GT(size, 0);
-  const BlockDimensions dimensions(size);
-
-  // Allocate the block array
-  CHECK_GT(dimensions.count, 0);
-  blocks_.reserve(dimensions.count);
-  for (uint32_t i = 0; i < dimensions.count - 1; ++i) {
-    blocks_.emplace_back(kBlockWords, 0);
-  }
-  blocks_.emplace_back(dimensions.last_size, 0);
-}
+using ::mozc::storage::existence_filter_internal::kBlockBits;
+using ::mozc::storage::existence_filter_internal::kBlockWords;
+using ::mozc::storage::existence_filter_internal::kNumHashes;
+using ::mozc::storage::existence_filter_internal::MakeBlockMask;
 
-std::string::iterator BlockBitmapBuilder::SerializeTo(
-    std::string::iterator it) {
-  for (const auto& block : blocks_) {
-    for (const uint32_t i : block) {
-      it = StoreUnaligned<uint32_t>(i, it);
-    }
-  }
-  return it;
-}
-
-BlockBitmap BlockBitmapBuilder::Build() const {
-  std::vector<absl::Span<const uint32_t>> blocks;
-  blocks.reserve(blocks_.size());
-  for (const auto& block : blocks_) {
-    blocks.push_back(block);
-  }
-  return BlockBitmap(std::move(blocks));
-}
-
-}  // namespace existence_filter_internal
-
-namespace {
-
-constexpr uint32_t kHeaderSize = 3;
+// The header consists of three words (size, expected_nelts and num_hashes),
+// padded to one block so that the blocks keep the alignment of the buffer.
+constexpr uint32_t kHeaderSize = kBlockWords;
+constexpr uint32_t kHeaderFields = 3;
 
 absl::StatusOr<ExistenceFilterParams> ReadHeader(
     absl::Span<const uint32_t> buf) {
@@ -132,18 +75,29 @@ absl::StatusOr<ExistenceFilterParams> ReadHeader(
   params.size = *it++;
   params.expected_nelts = *it++;
   params.num_hashes = *it++;
-  if (params.num_hashes >= 8 || params.num_hashes <= 0) {
+  if (params.num_hashes != kNumHashes) {
     return absl::InvalidArgumentError("Bad number of hashes (header.k)");
   }
+  if (params.size == 0 || params.size % kBlockBits != 0) {
+    return absl::InvalidArgumentError("Bad filter size (header.m)");
+  }
   return params;
 }
 
-constexpr uint32_t BitsToWords(uint32_t bits) {
-  uint32_t words = (bits + 31) >> 5;
-  if (bits > 0 && words == 0) {
-    words = 1 << (32 - 5);  // possible overflow
+constexpr uint32_t RoundUpToBlockBits(uint64_t bits) {
+  const uint64_t num_blocks = std::max<uint64_t>(
+      1, (bits + kBlockBits - 1) / kBlockBits);
+  return static_cast<uint32_t>(num_blocks * kBlockBits);
+}
+
+bool TestBlock(const uint32_t *block, uint64_t hash) {
+  uint32_t mask[kBlockWords];
+  MakeBlockMask(hash, mask);
+  uint32_t missing = 0;
+  for (int i = 0; i < kBlockWords; ++i) {
+    missing |= mask[i] & ~block[i];
   }
-  return words;
+  return missing == 0;
 }
 
 }  // namespace
@@ -155,14 +109,25 @@ std::ostream& operator<<(std::ostream& os,
 }
 
 bool ExistenceFilter::Exists(uint64_t hash) const {
-  for (int i = 0; i < params_.num_hashes; ++i) {
-    hash = absl::rotl(hash, 8);
-    const uint32_t index = hash % params_.size;
-    if (!rep_.Get(index)) {
-      return false;
-    }
+  if (blocks_.empty()) {
+    return false;
+  }
+  return TestBlock(GetBlock(hash), hash);
+}
+
+void ExistenceFilter::Exists(absl::Span<const uint64_t> hashes,
+                             absl::Span<bool> results) const {
+  DCHECK_EQ(hashes.size(), results.size());
+  if (blocks_.empty()) {
+    std::fill(results.begin(), results.end(), false);
+    return;
+  }
+  for (const uint64_t hash : hashes) {
+    absl::PrefetchToLocalCache(GetBlock(hash));
+  }
+  for (size_t i = 0; i < hashes.size(); ++i) {
+    results[i] = TestBlock(GetBlock(hashes[i]), hashes[i]);
   }
-  return true;
 }
 
 absl::StatusOr<ExistenceFilter> ExistenceFilter::Read(
@@ -178,39 +143,47 @@ absl::StatusOr<ExistenceFilter> ExistenceFilter::Read(
 
   MOZC_VLOG(1) << "Reading bloom filter with params: " << params;
 
-  if (buf.size() < BitsToWords(params.size)) {
+  const uint32_t words = params.size / 32;
+  if (buf.size() < words) {
     return absl::InvalidArgumentError("Not enough bufsize: could not read");
   }
 
-  return ExistenceFilter(std::move(params), buf);
+  return ExistenceFilter(std::move(params), buf.subspan(0, words));
+}
+
+ExistenceFilterBuilder::ExistenceFilterBuilder(ExistenceFilterParams params)
+    : params_(std::move(params)) {
+  CHECK_GT(params_.size, 0);
+  params_.size = RoundUpToBlockBits(params_.size);
+  params_.num_hashes = kNumHashes;
+  blocks_.resize(params_.size / 32, 0);
 }
 
 ExistenceFilterBuilder ExistenceFilterBuilder::CreateOptimal(
     size_t size_in_bytes, uint32_t estimated_insertions) {
   CHECK_LT(size_in_bytes, (1 << 29)) << "Requested size is too big";
   CHECK_GT(estimated_insertions, 0);
-  const uint32_t m = std::max<size_t>(1, size_in_bytes * 8);
+  // MinFilterSizeInBytesForErrorRate() estimates the size for a classic Bloom
+  // filter. Confining the probes to one block makes the bits less uniformly
+  // used, so reserve 1/4 more bits to keep the false positive rate.
+  const uint64_t bits = std::max<uint64_t>(1, size_in_bytes * 8);
+  const uint32_t m = RoundUpToBlockBits(bits + bits / 4);
   const uint32_t n = estimated_insertions;
 
-  int optimal_k =
-      static_cast<int>((static_cast<float>(m) / n * log(2.0)) + 0.5);
-  if (optimal_k < 1) {
-    optimal_k = 1;
-  }
-  if (optimal_k > 7) {
-    optimal_k = 7;
-  }
-
-  MOZC_VLOG(1) << "optimal_k: " << optimal_k;
+  MOZC_VLOG(1) << "num_blocks: " << m / kBlockBits;
 
-  return ExistenceFilterBuilder({m, n, optimal_k});
+  return ExistenceFilterBuilder({m, n, kNumHashes});
 }
 
 void ExistenceFilterBuilder::Insert(uint64_t hash) {
-  for (int i = 0; i < params_.num_hashes; ++i) {
-    hash = absl::rotl(hash, 8);
-    const uint32_t index = hash % params_.size;
-    rep_.Set(index);
+  const uint32_t num_blocks = params_.size / kBlockBits;
+  uint32_t *block =
+      blocks_.data() +
+      existence_filter_internal::BlockIndex(hash, num_blocks) * kBlockWords;
+  uint32_t mask[kBlockWords];
+  MakeBlockMask(hash, mask);
+  for (int i = 0; i < kBlockWords; ++i) {
+    block[i] |= mask[i];
   }
 }
 
@@ -230,7 +203,7 @@ size_t ExistenceFilterBuilder::MinFilterSizeInBytesForErrorRate(
 
 std::string ExistenceFilterBuilder::SerializeAsString() {
   const size_t required_bytes =
-      (kHeaderSize + BitsToWords(params_.size)) * sizeof(uint32_t);
+      (kHeaderSize + blocks_.size()) * sizeof(uint32_t);
   std::string buf;
   buf.resize(required_bytes);
 
@@ -239,11 +212,16 @@ std::string ExistenceFilterBuilder::SerializeAsString() {
   it = StoreUnaligned<uint32_t>(params_.size, it);
   it = StoreUnaligned<uint32_t>(params_.expected_nelts, it);
   it = StoreUnaligned<uint32_t>(params_.num_hashes, it);
+  for (uint32_t i = kHeaderFields; i < kHeaderSize; ++i) {
+    it = StoreUnaligned<uint32_t>(0, it);
+  }
   // This method is called on data generation and we can call LOG(INFO) here.
   LOG(INFO) << "Header written: " << params_;
 
-  // write bitmap
-  it = rep_.SerializeTo(it);
+  // write blocks
+  for (const uint32_t word : blocks_) {
+    it = StoreUnaligned<uint32_t>(word, it);
+  }
 
   if (it != buf.end()) {
     LOG(ERROR) << "Wrote " << std::distance(buf.begin(), it)
@@ -253,7 +231,7 @@ std::string ExistenceFilterBuilder::SerializeAsString() {
 }
 
 ExistenceFilter ExistenceFilterBuilder::Build() const {
-  return ExistenceFilter(params_, rep_.Build());
+  return ExistenceFilter(params_, blocks_);
 }
 
 }  // namespace storage
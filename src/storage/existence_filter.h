@@ -46,58 +46,37 @@ namespace mozc {
 namespace storage {
 namespace existence_filter_internal {
 
-inline constexpr int kBlockShift = 21;  // 2^21 bits == 256KB block
-inline constexpr int kBlockBits = 1 << kBlockShift;
-inline constexpr int kBlockMask = kBlockBits - 1;
-inline constexpr int kBlockBytes = kBlockBits >> 3;
-inline constexpr int kBlockWords = kBlockBits >> 5;
-
-// BlockBitmap is an immutable view, directly referencing data given to the
-// constructors.
-class BlockBitmap {
- public:
-  BlockBitmap() = default;
-  BlockBitmap(uint32_t size,
-              absl::Span<const uint32_t> buf ABSL_ATTRIBUTE_LIFETIME_BOUND);
-  explicit BlockBitmap(std::vector<absl::Span<const uint32_t>> blocks
-                           ABSL_ATTRIBUTE_LIFETIME_BOUND)
-      : blocks_(std::move(blocks)) {}
-
-  inline bool Get(uint32_t index) const {
-    const uint32_t bindex = index >> kBlockShift;
-    const uint32_t windex = (index & kBlockMask) >> 5;
-    const uint32_t bitpos = index & 31;
-    return (blocks_[bindex][windex] >> bitpos) & 1;
-  }
-
- protected:
-  // Array of blocks. Each block has kBlockBits region except for last block.
-  std::vector<absl::Span<const uint32_t>> blocks_;
+// The filter is a split block Bloom filter.  The bit vector is divided into
+// 512-bit blocks so that each block fits in one 64-byte cache line.  The upper
+// 32 bits of a hash select a block, and the lower 32 bits select one bit in
+// each of the eight 64-bit lanes of the block.  Thus a lookup reads exactly
+// one cache line, and the probes in a block are independent of each other.
+inline constexpr int kBlockWords = 16;
+inline constexpr int kBlockBits = kBlockWords * 32;
+inline constexpr int kNumHashes = 8;
+
+// Multipliers to derive the bit position in each lane from the lower 32 bits
+// of the hash.  They must be odd.
+inline constexpr uint32_t kSalts[kNumHashes] = {
+    0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+    0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U,
 };
 
-// BlockBitmapBuilder is a utility class to create a BlockBitmap data.
-class BlockBitmapBuilder {
- public:
-  explicit BlockBitmapBuilder(uint32_t size);
-
-  void clear();
-
-  inline void Set(uint32_t index) {
-    const uint32_t bindex = index >> kBlockShift;
-    const uint32_t windex = (index & kBlockMask) >> 5;
-    const uint32_t bitpos = index & 31;
-    blocks_[bindex][windex] |= (static_cast<uint32_t>(1) << bitpos);
+// Returns the index of the block for `hash`.
+inline uint32_t BlockIndex(uint64_t hash, uint32_t num_blocks) {
+  return static_cast<uint32_t>(((hash >> 32) * num_blocks) >> 32);
+}
+
+// Fills `mask` with the bits to set or test in the block for `hash`.  The loop
+// has no branches so that compilers can vectorize it.
+inline void MakeBlockMask(uint64_t hash, uint32_t (&mask)[kBlockWords]) {
+  const uint32_t key = static_cast<uint32_t>(hash);
+  for (int i = 0; i < kNumHashes; ++i) {
+    const uint64_t bit = uint64_t{1} << ((key * kSalts[i]) >> 26);
+    mask[2 * i] = static_cast<uint32_t>(bit);
+    mask[2 * i + 1] = static_cast<uint32_t>(bit >> 32);
   }
-
-  // Serializes the bitmap to the area indicated by `it`.
-  std::string::iterator SerializeTo(std::string::iterator it);
-  // Builds a BlockBitmap from the underlying data. It doesn't copy the data, so
-  // any changes will be visible to the returned bitmap.
-  BlockBitmap Build() const ABSL_ATTRIBUTE_LIFETIME_BOUND;
-
- private:
-  std::vector<std::vector<uint32_t>> blocks_;
-};
+}
 
 }  // namespace existence_filter_internal
 
@@ -110,10 +89,11 @@ struct ExistenceFilterParams {
                  params.size, params.expected_nelts, params.num_hashes);
   }
 
-  uint32_t size;            // the number of bits in the bit vector
+  uint32_t size;            // the number of bits in the bit vector. It is a
+                            // multiple of the block size.
   uint32_t expected_nelts;  // the number of values that will be stored
   int num_hashes;  // the number of hash values to use per insert/lookup.
-                   // num_hashes must be less than 8.
+                   // It is always existence_filter_internal::kNumHashes.
 };
 
 // For Mozc's LOG().
@@ -124,15 +104,14 @@ class ExistenceFilter {
  public:
   ExistenceFilter() = default;
 
-  // Constructs a new ExistenceFilter view from the parameters and the
-  // BlockBitmap buffer.
+  // Constructs a new ExistenceFilter view from the parameters and the blocks.
+  // The size of `blocks` must be `params.size / 32`.
   ExistenceFilter(ExistenceFilterParams params,
-                  const absl::Span<const uint32_t> buf
+                  const absl::Span<const uint32_t> blocks
                       ABSL_ATTRIBUTE_LIFETIME_BOUND)
-      : params_(std::move(params)), rep_(params_.size, buf) {}
-  ExistenceFilter(ExistenceFilterParams params,
-                  existence_filter_internal::BlockBitmap rep)
-      : params_(std::move(params)), rep_(std::move(rep)) {}
+      : params_(std::move(params)),
+        num_blocks_(params_.size / existence_filter_internal::kBlockBits),
+        blocks_(blocks) {}
 
   // Read Existence filter from buf.
   static absl::StatusOr<ExistenceFilter> Read(
@@ -142,9 +121,22 @@ class ExistenceFilter {
   // It may return some false positives
   bool Exists(uint64_t hash) const;
 
+  // Batched version of Exists(). Sets `results[i]` to `Exists(hashes[i])`.
+  // The blocks for all the hashes are prefetched before they are tested, so
+  // the cache misses overlap. `results` must be as large as `hashes`.
+  void Exists(absl::Span<const uint64_t> hashes,
+              absl::Span<bool> results) const;
+
  private:
+  const uint32_t* GetBlock(uint64_t hash) const {
+    return blocks_.data() +
+           existence_filter_internal::BlockIndex(hash, num_blocks_) *
+               existence_filter_internal::kBlockWords;
+  }
+
   ExistenceFilterParams params_;
-  existence_filter_internal::BlockBitmap rep_;  // points to bitmap
+  uint32_t num_blocks_ = 0;
+  absl::Span<const uint32_t> blocks_;
 };
 
 // ExistenceFilterBuilder is a utility class to construct ExistenceFilter data.
@@ -152,14 +144,13 @@ class ExistenceFilter {
 // CreateOptimal function to create an instance.
 class ExistenceFilterBuilder {
  public:
-  explicit ExistenceFilterBuilder(ExistenceFilterParams params)
-      : params_(std::move(params)), rep_(params_.size) {}
+  // `params.size` is rounded up to a multiple of the block size.
+  explicit ExistenceFilterBuilder(ExistenceFilterParams params);
 
   static ExistenceFilterBuilder CreateOptimal(size_t size_in_bytes,
                                               uint32_t estimated_insertions);
 
   // Inserts a hash value into the filter
-  // We generate 'k' separate internal hash values
   void Insert(uint64_t hash);
 
   // Writes the existence filter to a buffer and returns it.
@@ -175,7 +166,7 @@ class ExistenceFilterBuilder {
 
  private:
   ExistenceFilterParams params_;
-  existence_filter_internal::BlockBitmapBuilder rep_;
+  std::vector<uint32_t> blocks_;
 };
 
 }  // namespace storage
@@ -32,6 +32,7 @@
 #include <cstdint>
 #include <cstring>
 #include <iterator>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -39,6 +40,7 @@
 #include "absl/log/log.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "base/hash.h"
 #include "testing/gmock.h"
 #include "testing/gunit.h"
@@ -157,6 +159,48 @@ TEST(ExistenceFilterTest, InsertAndExistsTest) {
   }
 }
 
+TEST(ExistenceFilterTest, BatchedExists) {
+  ExistenceFilterBuilder builder = ExistenceFilterBuilder::CreateOptimal(
+      ExistenceFilterBuilder::MinFilterSizeInBytesForErrorRate(0.0001, 100),
+      100);
+  std::vector<uint64_t> hashes;
+  for (int i = 0; i < 100; ++i) {
+    const uint64_t hash = Fingerprint(i);
+    hashes.push_back(hash);
+    if (i % 2 == 0) {
+      builder.Insert(hash);
+    }
+  }
+
+  const ExistenceFilter filter = builder.Build();
+  std::unique_ptr<bool[]> results(new bool[hashes.size()]);
+  filter.Exists(hashes, absl::MakeSpan(results.get(), hashes.size()));
+  for (int i = 0; i < hashes.size(); ++i) {
+    EXPECT_EQ(results[i], filter.Exists(hashes[i])) << i;
+    if (i % 2 == 0) {
+      EXPECT_TRUE(results[i]) << i;
+    }
+  }
+}
+
+TEST(ExistenceFilterTest, ReadInvalidData) {
+  ExistenceFilterBuilder builder = ExistenceFilterBuilder::CreateOptimal(64, 8);
+  builder.Insert(Fingerprint("a"));
+  const std::string buf = builder.SerializeAsString();
+  std::vector<uint32_t> aligned_buf = StringToAlignedBuffer(buf);
+  EXPECT_OK(ExistenceFilter::Read(aligned_buf));
+
+  // Truncated blocks.
+  EXPECT_FALSE(
+      ExistenceFilter::Read(absl::MakeConstSpan(aligned_buf).subspan(
+                                0, aligned_buf.size() - 1))
+          .ok());
+
+  // The number of hashes of the old bitmap format is rejected.
+  aligned_buf[2] = 7;
+  EXPECT_FALSE(ExistenceFilter::Read(aligned_buf).ok());
+}
+
 }  // namespace
 }  // namespace storage
 }  // namespace mozc
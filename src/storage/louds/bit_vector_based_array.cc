@@ -31,6 +31,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <string>
 
 #include "absl/log/check.h"
 #include "base/bits.h"
@@ -60,6 +61,30 @@ void BitVectorBasedArray::Open(const uint8_t *image) {
   data_ = reinterpret_cast<const char *>(image + index_length);
 }
 
+bool BitVectorBasedArray::OpenWithIndexImage(const uint8_t *image,
+                                             const uint8_t *index_image,
+                                             size_t index_image_size) {
+  const int index_length = LoadUnalignedAdvance<uint32_t>(image);
+  const int base_length = LoadUnalignedAdvance<uint32_t>(image);
+  const int step_length = LoadUnalignedAdvance<uint32_t>(image);
+  // Check 0 padding.
+  CHECK_EQ(LoadUnalignedAdvance<uint32_t>(image), 0);
+
+  if (index_.InitFromImage(image, index_length, index_image,
+                           index_image_size) == 0) {
+    Close();
+    return false;
+  }
+  base_length_ = base_length;
+  step_length_ = step_length;
+  data_ = reinterpret_cast<const char *>(image + index_length);
+  return true;
+}
+
+void BitVectorBasedArray::AppendIndexImage(std::string *output) const {
+  index_.AppendIndexImage(output);
+}
+
 void BitVectorBasedArray::Close() {
   index_.Reset();
   base_length_ = 0;
@@ -32,6 +32,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <string>
 
 #include "storage/louds/simple_succinct_bit_vector_index.h"
 
@@ -48,6 +49,17 @@ class BitVectorBasedArray {
   BitVectorBasedArray &operator=(const BitVectorBasedArray &) = delete;
 
   void Open(const uint8_t *image);
+
+  // Opens the image with the bit vector index precomputed by
+  // AppendIndexImage(), without computing or allocating it.  |index_image|
+  // needs to be aligned to 32-bits and to outlive this instance.  Returns
+  // false if |index_image| is broken or doesn't match |image|.
+  bool OpenWithIndexImage(const uint8_t *image, const uint8_t *index_image,
+                          size_t index_image_size);
+
+  // Appends the bit vector index built by Open() to |output|.
+  void AppendIndexImage(std::string *output) const;
+
   void Close();
 
   // Returns a pointer to the element and its length.
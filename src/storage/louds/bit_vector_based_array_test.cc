@@ -31,8 +31,10 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <iterator>
 #include <string>
+#include <vector>
 
 #include "storage/louds/bit_vector_based_array_builder.h"
 #include "testing/gunit.h"
@@ -83,4 +85,39 @@ TEST_F(BitVectorBasedArrayTest, Get) {
 
   array.Close();
 }
+
+TEST_F(BitVectorBasedArrayTest, OpenWithIndexImage) {
+  BitVectorBasedArrayBuilder builder;
+  for (int i = 0; i < 100; ++i) {
+    builder.Add(std::string(i % 7, 'a' + i % 26));
+  }
+  builder.SetSize(4, 2);
+  builder.Build();
+  const uint8_t* image =
+      reinterpret_cast<const uint8_t*>(builder.image().data());
+
+  BitVectorBasedArray expected;
+  expected.Open(image);
+  std::string index_image;
+  expected.AppendIndexImage(&index_image);
+
+  // Copy the index image to an aligned buffer.
+  std::vector<uint32_t> buffer(index_image.size() / 4);
+  memcpy(buffer.data(), index_image.data(), index_image.size());
+
+  BitVectorBasedArray array;
+  ASSERT_TRUE(array.OpenWithIndexImage(
+      image, reinterpret_cast<const uint8_t*>(buffer.data()),
+      index_image.size()));
+  for (size_t i = 0; i < 100; ++i) {
+    size_t expected_length, length;
+    const char* expected_result = expected.Get(i, &expected_length);
+    const char* result = array.Get(i, &length);
+    EXPECT_EQ(std::string(result, length),
+              std::string(expected_result, expected_length));
+  }
+
+  array.Close();
+  expected.Close();
+}
 }  // namespace
@@ -31,6 +31,9 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <string>
+
+#include "base/bits.h"
 
 namespace mozc {
 namespace storage {
@@ -64,25 +67,75 @@ void Louds::Init(const uint8_t *image, int length, size_t bitvec_lb0_cache_size,
 
   if (select0_cache_size > 0) {
     // Precompute Select0(i) + 1 for i in (0, select0_cache_size).
-    select_cache_[0] = 0;
+    int *select0_cache = select_cache_.get();
+    select0_cache[0] = 0;
     for (size_t i = 1; i < select0_cache_size; ++i) {
-      select_cache_[i] = index_.Select0(i) + 1;
+      select0_cache[i] = index_.Select0(i) + 1;
     }
+    select0_cache_ptr_ = select0_cache;
   }
 
   if (select1_cache_size > 0) {
     // Precompute Select1(i) for i in (0, select1_cache_size).
-    select1_cache_ptr_ = select_cache_.get() + select0_cache_size;
-    select1_cache_ptr_[0] = 0;
+    int *select1_cache = select_cache_.get() + select0_cache_size;
+    select1_cache[0] = 0;
     for (size_t i = 1; i < select1_cache_size; ++i) {
-      select1_cache_ptr_[i] = index_.Select1(i);
+      select1_cache[i] = index_.Select1(i);
     }
+    select1_cache_ptr_ = select1_cache;
+  }
+}
+
+size_t Louds::InitFromImage(const uint8_t *image, int length,
+                            const uint8_t *index_image,
+                            size_t index_image_size) {
+  // The index image is the bit vector index followed by the select caches:
+  // [bit vector index image]
+  // [select0 cache size: 4 bytes]
+  // [select1 cache size: 4 bytes]
+  // [select0 cache: "select0 cache size" * 4 bytes]
+  // [select1 cache: "select1 cache size" * 4 bytes]
+  Reset();
+  const size_t index_size =
+      index_.InitFromImage(image, length, index_image, index_image_size);
+  if (index_size == 0 || index_image_size - index_size < 8) {
+    Reset();
+    return 0;
+  }
+  const uint8_t *ptr = index_image + index_size;
+  const size_t select0_cache_size = LoadUnalignedAdvance<uint32_t>(ptr);
+  const size_t select1_cache_size = LoadUnalignedAdvance<uint32_t>(ptr);
+  const size_t total_size =
+      index_size + 8 + (select0_cache_size + select1_cache_size) * 4;
+  if (select0_cache_size > index_.GetNum0Bits() ||
+      select1_cache_size > index_.GetNum1Bits() ||
+      index_image_size < total_size) {
+    Reset();
+    return 0;
   }
+  select0_cache_size_ = select0_cache_size;
+  select1_cache_size_ = select1_cache_size;
+  select0_cache_ptr_ = reinterpret_cast<const int *>(ptr);
+  select1_cache_ptr_ = select0_cache_ptr_ + select0_cache_size;
+  return total_size;
+}
+
+void Louds::AppendIndexImage(std::string *output) const {
+  index_.AppendIndexImage(output);
+  const uint32_t sizes[2] = {static_cast<uint32_t>(select0_cache_size_),
+                             static_cast<uint32_t>(select1_cache_size_)};
+  output->append(reinterpret_cast<const char *>(sizes), sizeof(sizes));
+  output->append(reinterpret_cast<const char *>(select0_cache_ptr_),
+                 select0_cache_size_ * sizeof(int));
+  output->append(reinterpret_cast<const char *>(select1_cache_ptr_),
+                 select1_cache_size_ * sizeof(int));
 }
 
 void Louds::Reset() {
   index_.Reset();
   select_cache_.reset();
+  select0_cache_ptr_ = nullptr;
+  select1_cache_ptr_ = nullptr;
   select0_cache_size_ = 0;
   select1_cache_size_ = 0;
 }
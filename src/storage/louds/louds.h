@@ -33,6 +33,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <string>
 
 #include "storage/louds/simple_succinct_bit_vector_index.h"
 
@@ -96,6 +97,18 @@ class Louds {
             size_t bitvec_lb1_cache_size, size_t select0_cache_size,
             size_t select1_cache_size);
 
+  // Initializes this LOUDS from bit array and |index_image| written by
+  // AppendIndexImage(), so that neither the bit vector index nor the select
+  // caches are computed or allocated.  |index_image| needs to be aligned to
+  // 32-bits and to outlive this instance.  Returns the number of bytes of
+  // |index_image| consumed, or 0 if |index_image| is broken.
+  size_t InitFromImage(const uint8_t *image, int length,
+                       const uint8_t *index_image, size_t index_image_size);
+
+  // Appends the bit vector index and the select caches built by Init() to
+  // |output|.  The size of the appended image is a multiple of 4.
+  void AppendIndexImage(std::string *output) const;
+
   // Explicitly clears the internal bit array.
   void Reset();
 
@@ -122,7 +135,7 @@ class Louds {
   // REQUIRES: |node| is valid.
   void MoveToFirstChild(Node *node) const {
     node->edge_index_ = node->node_id_ < select0_cache_size_
-                            ? select_cache_[node->node_id_]
+                            ? select0_cache_ptr_[node->node_id_]
                             : index_.Select0(node->node_id_) + 1;
     node->node_id_ = node->edge_index_ - node->node_id_ + 1;
   }
@@ -157,12 +170,17 @@ class Louds {
     return index_.Get(node.edge_index_) != 0;
   }
 
+  // Returns the number of nodes, excluding the super root.
+  int GetNumNodes() const { return index_.GetNum1Bits(); }
+
  private:
   SimpleSuccinctBitVectorIndex index_;
   size_t select0_cache_size_ = 0;
   size_t select1_cache_size_ = 0;
+  // Select caches point either to |select_cache_| or to the index image.
   std::unique_ptr<int[]> select_cache_;
-  int *select1_cache_ptr_;  // = select_cache_.get() + select0_cache_size_
+  const int *select0_cache_ptr_ = nullptr;
+  const int *select1_cache_ptr_ = nullptr;
 };
 
 }  // namespace louds
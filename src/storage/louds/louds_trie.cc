@@ -31,6 +31,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <string>
 
 #include "absl/log/check.h"
 #include "absl/strings/string_view.h"
@@ -42,11 +43,17 @@ namespace mozc {
 namespace storage {
 namespace louds {
 
-bool LoudsTrie::Open(const uint8_t *image, size_t louds_lb0_cache_size,
-                     size_t louds_lb1_cache_size,
-                     size_t louds_select0_cache_size,
-                     size_t louds_select1_cache_size,
-                     size_t termvec_lb1_cache_size) {
+namespace {
+
+struct TrieImage {
+  const uint8_t *louds_image;
+  int louds_size;
+  const uint8_t *terminal_image;
+  int terminal_size;
+  const char *edge_character;
+};
+
+TrieImage ParseTrieImage(const uint8_t *image) {
   // Reads a binary image data, which is compatible with rx.
   // The format is as follows:
   // [trie size: little endian 4byte int]
@@ -76,21 +83,60 @@ bool LoudsTrie::Open(const uint8_t *image, size_t louds_lb0_cache_size,
   CHECK_EQ(num_character_bits, 8);
   CHECK_GT(edge_character_size, 0);
 
-  const uint8_t *louds_image = image;
-  const uint8_t *terminal_image = louds_image + louds_size;
-  const uint8_t *edge_character = terminal_image + terminal_size;
+  TrieImage result;
+  result.louds_image = image;
+  result.louds_size = louds_size;
+  result.terminal_image = image + louds_size;
+  result.terminal_size = terminal_size;
+  result.edge_character =
+      reinterpret_cast<const char *>(result.terminal_image + terminal_size);
+  return result;
+}
 
-  louds_.Init(louds_image, louds_size, louds_lb0_cache_size,
+}  // namespace
+
+bool LoudsTrie::Open(const uint8_t *image, size_t louds_lb0_cache_size,
+                     size_t louds_lb1_cache_size,
+                     size_t louds_select0_cache_size,
+                     size_t louds_select1_cache_size,
+                     size_t termvec_lb1_cache_size) {
+  const TrieImage trie = ParseTrieImage(image);
+  louds_.Init(trie.louds_image, trie.louds_size, louds_lb0_cache_size,
               louds_lb1_cache_size, louds_select0_cache_size,
               louds_select1_cache_size);
-  terminal_bit_vector_.Init(terminal_image, terminal_size,
+  terminal_bit_vector_.Init(trie.terminal_image, trie.terminal_size,
                             0,  // Select0 is not carried out.
                             termvec_lb1_cache_size);
-  edge_character_ = reinterpret_cast<const char *>(edge_character);
+  edge_character_ = trie.edge_character;
+
+  return true;
+}
 
+bool LoudsTrie::OpenWithIndexImage(const uint8_t *image,
+                                   const uint8_t *index_image,
+                                   size_t index_image_size) {
+  // The index image is the LOUDS index followed by the terminal bit vector
+  // index; see AppendIndexImage().
+  const TrieImage trie = ParseTrieImage(image);
+  const size_t louds_index_size = louds_.InitFromImage(
+      trie.louds_image, trie.louds_size, index_image, index_image_size);
+  if (louds_index_size == 0 ||
+      terminal_bit_vector_.InitFromImage(
+          trie.terminal_image, trie.terminal_size,
+          index_image + louds_index_size,
+          index_image_size - louds_index_size) == 0) {
+    Close();
+    return false;
+  }
+  edge_character_ = trie.edge_character;
   return true;
 }
 
+void LoudsTrie::AppendIndexImage(std::string *output) const {
+  louds_.AppendIndexImage(output);
+  terminal_bit_vector_.AppendIndexImage(output);
+}
+
 void LoudsTrie::Close() {
   louds_.Reset();
   terminal_bit_vector_.Reset();
@@ -32,6 +32,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <string>
 
 #include "absl/strings/string_view.h"
 #include "storage/louds/louds.h"
@@ -65,6 +66,17 @@ class LoudsTrie {
 
   bool Open(const uint8_t *data) { return Open(data, 0, 0, 0, 0, 0); }
 
+  // Opens the binary image with the rank/select directories precomputed by
+  // AppendIndexImage(), so that opening needs neither computation nor memory
+  // allocation.  The |index_image| needs to be aligned to 32-bits, and the
+  // caller keeps it alive until Close is invoked, as well as |image|.
+  // Returns false if |index_image| is broken or doesn't match |image|.
+  bool OpenWithIndexImage(const uint8_t *image, const uint8_t *index_image,
+                          size_t index_image_size);
+
+  // Appends the rank/select directories built by Open() to |output|.
+  void AppendIndexImage(std::string *output) const;
+
   // Destructs the internal data structure explicitly (the destructor will do
   // clean up too).
   void Close();
@@ -76,6 +88,12 @@ class LoudsTrie {
   // and non-terminal nodes).
   bool IsValidNode(const Node &node) const { return louds_.IsValidNode(node); }
 
+  // Returns the number of nodes, which is the largest node ID.
+  int GetNumNodes() const { return louds_.GetNumNodes(); }
+
+  // Returns the number of keys, which is the number of terminal nodes.
+  int GetNumKeys() const { return terminal_bit_vector_.GetNum1Bits(); }
+
   // Returns true if |node| is a terminal node.
   bool IsTerminalNode(const Node &node) const {
     return terminal_bit_vector_.Get(node.node_id() - 1) != 0;
@@ -31,6 +31,8 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <string>
 #include <vector>
 
 #include "absl/strings/string_view.h"
@@ -529,6 +531,58 @@ TEST_P(LoudsTrieTest, RestoreKeyString) {
 }
 INSTANTIATE_TEST_CASE(GenRestoreKeyStringTest);
 
+TEST_P(LoudsTrieTest, OpenWithIndexImage) {
+  LoudsTrieBuilder builder;
+  builder.Add("aa");
+  builder.Add("ab");
+  builder.Add("abc");
+  builder.Add("abcd");
+  builder.Add("abcde");
+  builder.Add("abcdef");
+  builder.Add("abcea");
+  builder.Add("abcef");
+  builder.Add("abd");
+  builder.Add("ebd");
+  builder.Build();
+  const uint8_t *image =
+      reinterpret_cast<const uint8_t *>(builder.image().data());
+
+  const CacheSizeParam &param = GetParam();
+  std::string index_image;
+  {
+    LoudsTrie trie;
+    trie.Open(image, param.louds_lb0_cache_size, param.louds_lb1_cache_size,
+              param.louds_select0_cache_size, param.louds_select1_cache_size,
+              param.termvec_lb1_cache_size);
+    trie.AppendIndexImage(&index_image);
+  }
+  ASSERT_EQ(index_image.size() % 4, 0);
+
+  // Copy the index image to an aligned buffer.
+  std::vector<uint32_t> buffer(index_image.size() / 4);
+  memcpy(buffer.data(), index_image.data(), index_image.size());
+  const uint8_t *index_ptr = reinterpret_cast<const uint8_t *>(buffer.data());
+
+  LoudsTrie trie;
+  ASSERT_TRUE(trie.OpenWithIndexImage(image, index_ptr, index_image.size()));
+  char buffer_for_key[LoudsTrie::kMaxDepth + 1];
+  for (const std::string key : {"aa", "ab", "abc", "abcd", "abcde", "abcdef",
+                                "abcea", "abcef", "abd", "ebd"}) {
+    EXPECT_TRUE(trie.HasKey(key)) << key;
+    const int id = trie.ExactSearch(key);
+    EXPECT_EQ(id, builder.GetId(key)) << key;
+    EXPECT_EQ(trie.RestoreKeyString(id, buffer_for_key), key);
+  }
+  EXPECT_FALSE(trie.HasKey("abce"));
+  EXPECT_FALSE(trie.HasKey("e"));
+
+  // A truncated index image is rejected.
+  EXPECT_FALSE(
+      trie.OpenWithIndexImage(image, index_ptr, index_image.size() - 4));
+  trie.Close();
+}
+INSTANTIATE_TEST_CASE(GenOpenWithIndexImageTest);
+
 }  // namespace
 }  // namespace louds
 }  // namespace storage
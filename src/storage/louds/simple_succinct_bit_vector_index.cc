@@ -33,10 +33,12 @@
 #include <cstddef>
 #include <cstdint>
 #include <iterator>
+#include <string>
 #include <vector>
 
 #include "absl/log/check.h"
 #include "absl/numeric/bits.h"
+#include "absl/types/span.h"
 #include "base/bits.h"
 
 namespace mozc {
@@ -53,7 +55,7 @@ class ZeroBitIndexIterator {
   using reference = const int &;
   using iterator_category = std::forward_iterator_tag;
 
-  ZeroBitIndexIterator(const std::vector<int> &index, int chunk_size,
+  ZeroBitIndexIterator(absl::Span<const int> index, int chunk_size,
                        const int *ptr)
       : data_{index.data()}, chunk_size_{chunk_size}, ptr_{ptr} {}
 
@@ -122,13 +124,15 @@ void InitIndex(const uint8_t *data, int length, int chunk_size,
   CHECK_EQ(chunk_length + 1, index->size());
 }
 
-void InitLowerBound0Cache(const std::vector<int> &index, int chunk_size,
+// Lower bound caches store the offsets of the lower bounds in the index,
+// rather than pointers, so that they can be serialized as is.
+void InitLowerBound0Cache(absl::Span<const int> index, int chunk_size,
                           size_t increment, size_t size,
-                          std::vector<const int *> *cache) {
+                          std::vector<int> *cache) {
   DCHECK_GT(increment, 0);
   cache->clear();
   cache->reserve(size + 2);
-  cache->push_back(index.data());
+  cache->push_back(0);
   for (size_t i = 1; i <= size; ++i) {
     const int target_index = increment * i;
     const int *ptr =
@@ -137,25 +141,51 @@ void InitLowerBound0Cache(const std::vector<int> &index, int chunk_size,
                                               index.data() + index.size()),
                          target_index)
             .ptr();
-    cache->push_back(ptr);
+    cache->push_back(ptr - index.data());
   }
-  cache->push_back(index.data() + index.size());
+  cache->push_back(index.size());
 }
 
-void InitLowerBound1Cache(const std::vector<int> &index, int chunk_size,
+void InitLowerBound1Cache(absl::Span<const int> index, int chunk_size,
                           size_t increment, size_t size,
-                          std::vector<const int *> *cache) {
+                          std::vector<int> *cache) {
   DCHECK_GT(increment, 0);
   cache->clear();
   cache->reserve(size + 2);
-  cache->push_back(index.data());
+  cache->push_back(0);
   for (size_t i = 1; i <= size; ++i) {
     const int target_index = increment * i;
     const int *ptr = std::lower_bound(index.data(), index.data() + index.size(),
                                       target_index);
-    cache->push_back(ptr);
+    cache->push_back(ptr - index.data());
   }
-  cache->push_back(index.data() + index.size());
+  cache->push_back(index.size());
+}
+
+// The index image consists of 32-bit words as follows:
+// [chunk size]
+// [lb0 cache increment]
+// [lb1 cache increment]
+// [index size]
+// [lb0 cache size]
+// [lb1 cache size]
+// [index: "index size" words]
+// [lb0 cache: "lb0 cache size" words]
+// [lb1 cache: "lb1 cache size" words]
+constexpr size_t kIndexImageHeaderWords = 6;
+
+void AppendWords(absl::Span<const int> words, std::string *output) {
+  output->append(reinterpret_cast<const char *>(words.data()),
+                 words.size() * sizeof(int));
+}
+
+// Returns true if |cache| is a valid lower bound cache on an index of
+// |index_size| entries.
+bool IsValidLowerBoundCache(absl::Span<const int> cache, int index_size) {
+  if (cache.size() < 2 || cache.front() != 0 || cache.back() != index_size) {
+    return false;
+  }
+  return std::is_sorted(cache.begin(), cache.end());
 }
 
 }  // namespace
@@ -165,7 +195,8 @@ void SimpleSuccinctBitVectorIndex::Init(const uint8_t *data, int length,
                                         size_t lb1_cache_size) {
   data_ = data;
   length_ = length;
-  InitIndex(data, length, chunk_size_, &index_);
+  InitIndex(data, length, chunk_size_, &index_buffer_);
+  index_ = index_buffer_;
 
   // TODO(noriyukit): Currently, we simply use uniform increment width for lower
   // bound cache.  Nonuniform increment width may improve performance.
@@ -175,7 +206,8 @@ void SimpleSuccinctBitVectorIndex::Init(const uint8_t *data, int length,
     lb0_cache_increment_ = 1;
   }
   InitLowerBound0Cache(index_, chunk_size_, lb0_cache_increment_,
-                       lb0_cache_size, &lb0_cache_);
+                       lb0_cache_size, &lb0_cache_buffer_);
+  lb0_cache_ = lb0_cache_buffer_;
 
   lb1_cache_increment_ =
       lb1_cache_size == 0 ? GetNum1Bits() : GetNum1Bits() / lb1_cache_size;
@@ -183,17 +215,83 @@ void SimpleSuccinctBitVectorIndex::Init(const uint8_t *data, int length,
     lb1_cache_increment_ = 1;
   }
   InitLowerBound1Cache(index_, chunk_size_, lb1_cache_increment_,
-                       lb1_cache_size, &lb1_cache_);
+                       lb1_cache_size, &lb1_cache_buffer_);
+  lb1_cache_ = lb1_cache_buffer_;
+}
+
+size_t SimpleSuccinctBitVectorIndex::InitFromImage(const uint8_t *data,
+                                                   int length,
+                                                   const uint8_t *image,
+                                                   size_t image_size) {
+  DCHECK_EQ(reinterpret_cast<uintptr_t>(image) % 4, 0);
+  Reset();
+  if (image_size < kIndexImageHeaderWords * 4) {
+    return 0;
+  }
+  const uint8_t *ptr = image;
+  const int chunk_size = LoadUnalignedAdvance<uint32_t>(ptr);
+  const int lb0_cache_increment = LoadUnalignedAdvance<uint32_t>(ptr);
+  const int lb1_cache_increment = LoadUnalignedAdvance<uint32_t>(ptr);
+  const size_t index_size = LoadUnalignedAdvance<uint32_t>(ptr);
+  const size_t lb0_cache_size = LoadUnalignedAdvance<uint32_t>(ptr);
+  const size_t lb1_cache_size = LoadUnalignedAdvance<uint32_t>(ptr);
+  const size_t num_words =
+      kIndexImageHeaderWords + index_size + lb0_cache_size + lb1_cache_size;
+  // The number of chunks with ceiling, plus a sentinel; see InitIndex().
+  const size_t expected_index_size =
+      (length + chunk_size_ - 1) / chunk_size_ + 1;
+  if (chunk_size != chunk_size_ || lb0_cache_increment <= 0 ||
+      lb1_cache_increment <= 0 || image_size < num_words * 4 ||
+      index_size != expected_index_size) {
+    return 0;
+  }
+
+  const int *words = reinterpret_cast<const int *>(ptr);
+  const absl::Span<const int> index(words, index_size);
+  const absl::Span<const int> lb0_cache(words + index_size, lb0_cache_size);
+  const absl::Span<const int> lb1_cache(words + index_size + lb0_cache_size,
+                                        lb1_cache_size);
+  if (!IsValidLowerBoundCache(lb0_cache, index_size) ||
+      !IsValidLowerBoundCache(lb1_cache, index_size)) {
+    return 0;
+  }
+
+  data_ = data;
+  length_ = length;
+  index_ = index;
+  lb0_cache_ = lb0_cache;
+  lb0_cache_increment_ = lb0_cache_increment;
+  lb1_cache_ = lb1_cache;
+  lb1_cache_increment_ = lb1_cache_increment;
+  return num_words * 4;
+}
+
+void SimpleSuccinctBitVectorIndex::AppendIndexImage(std::string *output) const {
+  const int header[kIndexImageHeaderWords] = {
+      chunk_size_,
+      lb0_cache_increment_,
+      lb1_cache_increment_,
+      static_cast<int>(index_.size()),
+      static_cast<int>(lb0_cache_.size()),
+      static_cast<int>(lb1_cache_.size()),
+  };
+  AppendWords(header, output);
+  AppendWords(index_, output);
+  AppendWords(lb0_cache_, output);
+  AppendWords(lb1_cache_, output);
 }
 
 void SimpleSuccinctBitVectorIndex::Reset() {
   data_ = nullptr;
   length_ = 0;
-  index_.clear();
+  index_ = {};
+  index_buffer_.clear();
   lb0_cache_increment_ = 1;
-  lb0_cache_.clear();
+  lb0_cache_ = {};
+  lb0_cache_buffer_.clear();
   lb1_cache_increment_ = 1;
-  lb1_cache_.clear();
+  lb1_cache_ = {};
+  lb1_cache_buffer_.clear();
 }
 
 int SimpleSuccinctBitVectorIndex::Rank1(int n) const {
@@ -227,11 +325,12 @@ int SimpleSuccinctBitVectorIndex::Select0(int n) const {
 
   // Binary search on chunks.
   const int *chunk_ptr =
-      std::lower_bound(ZeroBitIndexIterator(index_, chunk_size_,
-                                            lb0_cache_[lb0_cache_index]),
-                       ZeroBitIndexIterator(index_, chunk_size_,
-                                            lb0_cache_[lb0_cache_index + 1]),
-                       n)
+      std::lower_bound(
+          ZeroBitIndexIterator(index_, chunk_size_,
+                               index_.data() + lb0_cache_[lb0_cache_index]),
+          ZeroBitIndexIterator(index_, chunk_size_,
+                               index_.data() + lb0_cache_[lb0_cache_index + 1]),
+          n)
           .ptr();
   const int chunk_index = (chunk_ptr - index_.data()) - 1;
   DCHECK_GE(chunk_index, 0);
@@ -271,8 +370,9 @@ int SimpleSuccinctBitVectorIndex::Select1(int n) const {
   DCHECK_GE(lb1_cache_index, 0);
 
   // Binary search on chunks.
-  const int *chunk_ptr = std::lower_bound(lb1_cache_[lb1_cache_index],
-                                          lb1_cache_[lb1_cache_index + 1], n);
+  const int *chunk_ptr =
+      std::lower_bound(index_.data() + lb1_cache_[lb1_cache_index],
+                       index_.data() + lb1_cache_[lb1_cache_index + 1], n);
   const int chunk_index = (chunk_ptr - index_.data()) - 1;
   DCHECK_GE(chunk_index, 0);
   n -= index_[chunk_index];
@@ -32,8 +32,11 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <string>
 #include <vector>
 
+#include "absl/types/span.h"
+
 namespace mozc {
 namespace storage {
 namespace louds {
@@ -59,6 +62,15 @@ class SimpleSuccinctBitVectorIndex {
         lb0_cache_increment_(1),
         lb1_cache_increment_(1) {}
 
+  // Not copyable, as the views below may point to the buffers of this
+  // instance. Moving keeps them valid since the buffers move their storage.
+  SimpleSuccinctBitVectorIndex(const SimpleSuccinctBitVectorIndex &) = delete;
+  SimpleSuccinctBitVectorIndex &operator=(
+      const SimpleSuccinctBitVectorIndex &) = delete;
+  SimpleSuccinctBitVectorIndex(SimpleSuccinctBitVectorIndex &&) = default;
+  SimpleSuccinctBitVectorIndex &operator=(SimpleSuccinctBitVectorIndex &&) =
+      default;
+
   // Initializes the index. This class doesn't have the ownership of the memory
   // pointed by data, so it is caller's responsibility to manage its life time.
   // The 'data' needs to be aligned to 32-bits.
@@ -67,6 +79,18 @@ class SimpleSuccinctBitVectorIndex {
 
   void Init(const uint8_t *data, int length) { Init(data, length, 0, 0); }
 
+  // Initializes the index from |image| written by AppendIndexImage() for the
+  // same |data|, instead of computing it.  Neither |data| nor |image| is
+  // copied and no memory is allocated, so both need to outlive this instance.
+  // The |image| needs to be aligned to 32-bits.  Returns the number of bytes
+  // of |image| consumed, or 0 if |image| doesn't match |data|.
+  size_t InitFromImage(const uint8_t *data, int length, const uint8_t *image,
+                       size_t image_size);
+
+  // Appends the index and the lower bound caches built by Init() to |output|.
+  // The size of the appended image is a multiple of 4.
+  void AppendIndexImage(std::string *output) const;
+
   // Resets the internal state, especially releases the allocated memory
   // for the index used internally.
   void Reset();
@@ -98,11 +122,17 @@ class SimpleSuccinctBitVectorIndex {
   const uint8_t *data_;
   int length_;
   int chunk_size_;
-  std::vector<int> index_;
-  std::vector<const int *> lb0_cache_;
+  // Views of the index and the lower bound caches, which point either to the
+  // buffers below or to the image passed to InitFromImage().  Lower bound
+  // caches hold offsets into |index_|.
+  absl::Span<const int> index_;
+  absl::Span<const int> lb0_cache_;
   int lb0_cache_increment_;
   int lb1_cache_increment_;
-  std::vector<const int *> lb1_cache_;
+  absl::Span<const int> lb1_cache_;
+  std::vector<int> index_buffer_;
+  std::vector<int> lb0_cache_buffer_;
+  std::vector<int> lb1_cache_buffer_;
 };
 
 }  // namespace louds
@@ -31,8 +31,11 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "testing/gunit.h"
 
@@ -192,4 +195,81 @@ TEST_P(SimpleSuccinctBitVectorIndexTest, Pattern2) {
 }
 INSTANTIATE_TEST_CASE(GenPattern2Test);
 
+TEST_P(SimpleSuccinctBitVectorIndexTest, InitFromImage) {
+  const CacheSizeParam &param = GetParam();
+
+  // Repeat the bit pattern '0b11001010'.
+  const std::string data(1024, '\xCA');
+  const uint8_t *ptr = reinterpret_cast<const uint8_t *>(data.data());
+
+  SimpleSuccinctBitVectorIndex expected;
+  expected.Init(ptr, data.length(), param.first, param.second);
+  std::string image;
+  expected.AppendIndexImage(&image);
+  ASSERT_EQ(image.size() % 4, 0);
+
+  // Copy the image to an aligned buffer.
+  std::vector<uint32_t> buffer(image.size() / 4);
+  memcpy(buffer.data(), image.data(), image.size());
+  const uint8_t *image_ptr = reinterpret_cast<const uint8_t *>(buffer.data());
+
+  SimpleSuccinctBitVectorIndex bit_vector;
+  EXPECT_EQ(bit_vector.InitFromImage(ptr, data.length(), image_ptr,
+                                     image.size()),
+            image.size());
+  EXPECT_EQ(bit_vector.GetNum0Bits(), expected.GetNum0Bits());
+  EXPECT_EQ(bit_vector.GetNum1Bits(), expected.GetNum1Bits());
+  for (int i = 0; i < data.length() * 8; ++i) {
+    EXPECT_EQ(bit_vector.Rank1(i), expected.Rank1(i)) << i;
+  }
+  for (int i = 1; i <= expected.GetNum0Bits(); ++i) {
+    EXPECT_EQ(bit_vector.Select0(i), expected.Select0(i)) << i;
+  }
+  for (int i = 1; i <= expected.GetNum1Bits(); ++i) {
+    EXPECT_EQ(bit_vector.Select1(i), expected.Select1(i)) << i;
+  }
+
+  // The image doesn't match data of a different length.
+  EXPECT_EQ(bit_vector.InitFromImage(ptr, data.length() / 2, image_ptr,
+                                     image.size()),
+            0);
+  // Truncated image.
+  EXPECT_EQ(bit_vector.InitFromImage(ptr, data.length(), image_ptr,
+                                     image.size() - 4),
+            0);
+}
+INSTANTIATE_TEST_CASE(GenInitFromImageTest);
+
+TEST_P(SimpleSuccinctBitVectorIndexTest, Move) {
+  const CacheSizeParam &param = GetParam();
+
+  // Repeat the bit pattern '0b11001010'.
+  const std::string data(1024, '\xCA');
+  const uint8_t *ptr = reinterpret_cast<const uint8_t *>(data.data());
+
+  SimpleSuccinctBitVectorIndex expected;
+  expected.Init(ptr, data.length(), param.first, param.second);
+
+  SimpleSuccinctBitVectorIndex bit_vector;
+  {
+    auto source = std::make_unique<SimpleSuccinctBitVectorIndex>();
+    source->Init(ptr, data.length(), param.first, param.second);
+    SimpleSuccinctBitVectorIndex moved(std::move(*source));
+    source.reset();
+    bit_vector = std::move(moved);
+  }
+  EXPECT_EQ(bit_vector.GetNum1Bits(), expected.GetNum1Bits());
+  for (int i = 0; i < data.length() * 8; ++i) {
+    EXPECT_EQ(bit_vector.Rank1(i), expected.Rank1(i)) << i;
+  }
+  for (int i = 1; i <= expected.GetNum0Bits(); ++i) {
+    EXPECT_EQ(bit_vector.Select0(i), expected.Select0(i)) << i;
+  }
+  for (int i = 1; i <= expected.GetNum1Bits(); ++i) {
+    EXPECT_EQ(bit_vector.Select1(i), expected.Select1(i)) << i;
+  }
+}
+
+INSTANTIATE_TEST_CASE(GenMoveTest);
+
 }  // namespace
@@ -30,6 +30,7 @@
 #include "storage/lru_storage.h"
 
 #include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
@@ -50,6 +51,7 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "base/bits.h"
 #include "base/clock.h"
 #include "base/file_stream.h"
@@ -96,11 +98,18 @@ void Update(char *ptr, uint64_t fp, const char *value, size_t value_size) {
   std::copy_n(value, value_size, ptr);
 }
 
-bool IsOlderThan62Days(uint64_t timestamp) {
-  const uint64_t now = absl::ToUnixSeconds(Clock::GetAbslTime());
+uint64_t GetCurrentTimeStamp() {
+  return absl::ToUnixSeconds(Clock::GetAbslTime());
+}
+
+bool IsOlderThan62Days(uint64_t timestamp, uint64_t now) {
   return (timestamp + k62DaysInSec < now);
 }
 
+bool IsOlderThan62Days(uint64_t timestamp) {
+  return IsOlderThan62Days(timestamp, GetCurrentTimeStamp());
+}
+
 class CompareByTimeStamp {
  public:
   bool operator()(const char *a, const char *b) const {
@@ -399,7 +408,11 @@ void LruStorage::Close() {
 
 const char *LruStorage::Lookup(const absl::string_view key,
                                uint32_t *last_access_time) const {
-  const uint64_t fp = FingerprintWithSeed(key, seed_);
+  return LookupByFingerprint(Fingerprint(key), last_access_time);
+}
+
+const char *LruStorage::LookupByFingerprint(const uint64_t fp,
+                                            uint32_t *last_access_time) const {
   const auto it = lru_map_.find(fp);
   if (it == lru_map_.end()) {
     return nullptr;
@@ -412,6 +425,37 @@ const char *LruStorage::Lookup(const absl::string_view key,
   return GetValue(*it->second);
 }
 
+void LruStorage::LookupMany(absl::Span<const uint64_t> fps,
+                            absl::Span<const char *> values,
+                            absl::Span<uint32_t> last_access_times) const {
+  DCHECK_GE(values.size(), fps.size());
+  DCHECK_GE(last_access_times.size(), fps.size());
+  // Prefetch the buckets of all the fingerprints before probing them, so that
+  // the cache misses for the probes overlap.
+  for (const uint64_t fp : fps) {
+    lru_map_.prefetch(fp);
+  }
+  const uint64_t now = GetCurrentTimeStamp();
+  for (size_t i = 0; i < fps.size(); ++i) {
+    values[i] = nullptr;
+    last_access_times[i] = 0;
+    const auto it = lru_map_.find(fps[i]);
+    if (it == lru_map_.end()) {
+      continue;
+    }
+    const uint32_t timestamp = GetTimeStamp(*it->second);
+    if (IsOlderThan62Days(timestamp, now)) {
+      continue;
+    }
+    values[i] = GetValue(*it->second);
+    last_access_times[i] = timestamp;
+  }
+}
+
+uint64_t LruStorage::Fingerprint(const absl::string_view key) const {
+  return FingerprintWithSeed(key, seed_);
+}
+
 void LruStorage::GetAllValues(std::vector<std::string> *values) const {
   DCHECK(values);
   values->clear();
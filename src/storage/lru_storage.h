@@ -39,6 +39,7 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "base/mmap.h"
 
 namespace mozc {
@@ -67,6 +68,22 @@ class LruStorage {
     return Lookup(key, &last_access_time);
   }
 
+  // Looks up an element by the fingerprint returned by Fingerprint().
+  const char *LookupByFingerprint(uint64_t fp,
+                                  uint32_t *last_access_time) const;
+
+  // Looks up multiple elements at once by fingerprints. For each i, values[i]
+  // is set to the value of fps[i] or nullptr if it doesn't exist, and
+  // last_access_times[i] is set to its timestamp. The sizes of |values| and
+  // |last_access_times| must be equal to or larger than that of |fps|.
+  void LookupMany(absl::Span<const uint64_t> fps,
+                  absl::Span<const char *> values,
+                  absl::Span<uint32_t> last_access_times) const;
+
+  // Returns the fingerprint of |key| used to index the elements. It can be
+  // computed before the lookup, e.g., to batch lookups with LookupMany().
+  uint64_t Fingerprint(absl::string_view key) const;
+
   // A safer lookup for string values (the pointers returned by above Lookup()'s
   // are not null terminated.)
   absl::string_view LookupAsString(const absl::string_view key) const {
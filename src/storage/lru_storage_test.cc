@@ -42,7 +42,9 @@
 
 #include "absl/log/check.h"
 #include "absl/random/random.h"
+#include "absl/strings/string_view.h"
 #include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "base/clock_mock.h"
 #include "base/file/temp_dir.h"
 #include "base/file_util.h"
@@ -557,5 +559,29 @@ TEST_F(LruStorageTest, OldDataAreNotLookedUp) {
   EXPECT_TRUE(storage.Touch("4444"));
 }
 
+TEST_F(LruStorageTest, LookupMany) {
+  ScopedClockMock clock(absl::FromUnixSeconds(1));
+
+  LruStorage storage;
+  TempFile file(testing::MakeTempFileOrDie());
+  ASSERT_TRUE(storage.OpenOrCreate(file.path().c_str(), 4, 4, kSeed));
+  EXPECT_TRUE(storage.Insert("1111", "aaaa"));
+  EXPECT_TRUE(storage.Insert("2222", "bbbb"));
+
+  const uint64_t fps[] = {storage.Fingerprint("2222"),
+                          storage.Fingerprint("3333"),
+                          storage.Fingerprint("1111")};
+  const char *values[3];
+  uint32_t last_access_times[3];
+  storage.LookupMany(fps, absl::MakeSpan(values),
+                     absl::MakeSpan(last_access_times));
+  ASSERT_NE(values[0], nullptr);
+  EXPECT_EQ(absl::string_view(values[0], 4), "bbbb");
+  EXPECT_EQ(values[1], nullptr);
+  ASSERT_NE(values[2], nullptr);
+  EXPECT_EQ(absl::string_view(values[2], 4), "aaaa");
+  EXPECT_EQ(values[2], storage.Lookup("1111"));
+}
+
 }  // namespace storage
 }  // namespace mozc
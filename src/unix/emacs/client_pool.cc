@@ -31,13 +31,16 @@
 
 #include "unix/emacs/client_pool.h"
 
+#include <cstddef>
 #include <memory>
+#include <utility>
 
 namespace mozc {
 namespace emacs {
 namespace {
 
-constexpr int kMaxClients = 64;  // max number of parallel clients
+constexpr int kMaxClients = 64;        // max number of parallel clients
+constexpr size_t kMaxIdleClients = 4;  // max number of clients kept for reuse
 
 }  // namespace
 
@@ -51,11 +54,23 @@ int ClientPool::CreateClient() {
       next_id_ = 1;  // Keep next_id_ to be a positive 28-bit integer.
     }
   }
-  lru_cache_.Insert(next_id_, std::make_shared<Client>());
+  lru_cache_.Insert(next_id_, NewClient());
   return next_id_++;
 }
 
-void ClientPool::DeleteClient(int id) { lru_cache_.Erase(id); }
+void ClientPool::DeleteClient(int id) {
+  const std::shared_ptr<Client> *value = lru_cache_.Lookup(id);
+  if (value == nullptr) {
+    return;
+  }
+  if (idle_clients_.size() < kMaxIdleClients) {
+    // Reuses the client, which skips the connection check to the server.
+    std::shared_ptr<Client> client = *value;
+    client->ReleaseSession();
+    idle_clients_.push_back(std::move(client));
+  }
+  lru_cache_.Erase(id);
+}
 
 std::shared_ptr<ClientPool::Client> ClientPool::GetClient(int id) {
   const std::shared_ptr<Client> *value = lru_cache_.Lookup(id);
@@ -63,11 +78,20 @@ std::shared_ptr<ClientPool::Client> ClientPool::GetClient(int id) {
     lru_cache_.Insert(id, *value);  // Put id at the head of LRU.
     return *value;
   } else {
-    auto client_ptr = std::make_shared<Client>();
+    std::shared_ptr<Client> client_ptr = NewClient();
     lru_cache_.Insert(id, client_ptr);
     return client_ptr;
   }
 }
 
+std::shared_ptr<ClientPool::Client> ClientPool::NewClient() {
+  if (idle_clients_.empty()) {
+    return std::make_shared<Client>();
+  }
+  std::shared_ptr<Client> client = std::move(idle_clients_.back());
+  idle_clients_.pop_back();
+  return client;
+}
+
 }  // namespace emacs
 }  // namespace mozc
@@ -33,6 +33,7 @@
 #define MOZC_UNIX_EMACS_CLIENT_POOL_H_
 
 #include <memory>
+#include <vector>
 
 #include "client/client.h"
 #include "storage/lru_cache.h"
@@ -52,7 +53,8 @@ class ClientPool final {
   int CreateClient();
 
   // Deletes a client.  If the specified session ID is not in this pool,
-  // does nothing.
+  // does nothing.  The client is kept idle for reuse after its session on
+  // the server is deleted.
   void DeleteClient(int id);
 
   // Returns a Client instance.  If the specified session ID is not in this
@@ -60,7 +62,12 @@ class ClientPool final {
   std::shared_ptr<Client> GetClient(int id);
 
  private:
+  // Returns an idle client, whose connection to the server is already
+  // established, or a new client.
+  std::shared_ptr<Client> NewClient();
+
   storage::LruCache<int, std::shared_ptr<Client>> lru_cache_;
+  std::vector<std::shared_ptr<Client>> idle_clients_;
   int next_id_;
 };
 
@@ -76,6 +76,7 @@
       'dependencies': [
         '<(mozc_oss_src_dir)/base/absl.gyp:absl_strings',
         '<(mozc_oss_src_dir)/testing/testing.gyp:gtest_main',
+        '<(mozc_oss_src_dir)/testing/testing.gyp:mozctest',
         '<(mozc_oss_src_dir)/testing/testing.gyp:testing_util',
         'mozc_emacs_helper_lib',
       ],
@@ -32,12 +32,10 @@
 #include <iostream>
 #include <memory>
 #include <string>
-#include <vector>
 
 #include "absl/flags/flag.h"
 #include "absl/log/check.h"
 #include "absl/strings/str_format.h"
-#include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
 #include "base/init_mozc.h"
 #include "base/version.h"
@@ -79,6 +77,8 @@ void ProcessLoop() {
   ClientPool client_pool;
   commands::Command command;
   std::string line;
+  // Reused across the responses to avoid reallocation.
+  std::string buffer;
 
   while (std::getline(std::cin, line)) {
     command.clear_input();
@@ -112,12 +112,14 @@ void ProcessLoop() {
     RemoveUsageData(command.mutable_output());
 
     // Output results.
-    std::vector<std::string> buffer;
+    buffer.clear();
+    absl::StrAppendFormat(&buffer,
+                          "((emacs-event-id . %u)(emacs-session-id . %u)"
+                          "(output . ",
+                          event_id, session_id);
     PrintMessage(command.output(), &buffer);
-    const std::string output = absl::StrJoin(buffer, "");
-    absl::FPrintF(
-        stdout, "((emacs-event-id . %u)(emacs-session-id . %u)(output . %s))\n",
-        event_id, session_id, output);
+    buffer.append("))\n");
+    fwrite(buffer.data(), 1, buffer.size(), stdout);
     fflush(stdout);
   }
 }
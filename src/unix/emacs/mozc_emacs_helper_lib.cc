@@ -42,9 +42,11 @@
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
-#include "absl/strings/str_replace.h"
 #include "absl/strings/string_view.h"
 #include "base/protobuf/descriptor.h"
+#include "base/protobuf/message.h"
+#include "base/protobuf/repeated_field.h"
+#include "base/protobuf/repeated_ptr_field.h"
 #include "base/util.h"
 #include "composer/key_parser.h"
 #include "protocol/candidates.pb.h"
@@ -57,12 +59,101 @@ namespace {
 // forward declaration
 void PrintField(const protobuf::Message &message,
                 const protobuf::Reflection &reflection,
-                const protobuf::FieldDescriptor &field,
-                std::vector<std::string> *output);
+                const protobuf::FieldDescriptor &field, std::string *output);
 void PrintFieldValue(const protobuf::Message &message,
                      const protobuf::Reflection &reflection,
                      const protobuf::FieldDescriptor &field, int index,
-                     std::vector<std::string> *output);
+                     std::string *output);
+void AppendSymbol(absl::string_view symbol, std::string *output);
+
+// Prints the messages in commands::Output without protobuf reflection.
+// Every Print() prints the fields which are set in the order of the field
+// numbers, which is what Reflection::ListFields() returns, so the output is
+// identical to the one of the reflection-based printer.  The messages which
+// are not emitted on usual key events fall back to the reflection.
+class SExprPrinter {
+ public:
+  explicit SExprPrinter(std::string *output) : output_(*output) {}
+
+  void Print(const commands::Output &message);
+  void Print(const commands::Result &message);
+  void Print(const commands::Preedit &message);
+  void Print(const commands::Preedit::Segment &message);
+  void Print(const commands::Candidates &message);
+  void Print(const commands::Candidates::Candidate &message);
+  void Print(const commands::CandidateList &message);
+  void Print(const commands::CandidateWord &message);
+  void Print(const commands::Annotation &message);
+  void Print(const commands::Footer &message);
+  void Print(const protobuf::Message &message) {
+    PrintMessage(message, &output_);
+  }
+
+ private:
+  // Prints "(name . value)".
+  void PrintField(absl::string_view name, int32_t value) {
+    absl::StrAppend(&output_, "(", name, " . ", value, ")");
+  }
+  void PrintField(absl::string_view name, uint32_t value) {
+    absl::StrAppend(&output_, "(", name, " . ", value, ")");
+  }
+  // Emacs doesn't support 64-bit integers.  See PrintFieldValue().
+  void PrintField(absl::string_view name, uint64_t value) {
+    absl::StrAppend(&output_, "(", name, " . \"", value, "\")");
+  }
+  void PrintField(absl::string_view name, bool value) {
+    absl::StrAppend(&output_, "(", name, " . ", value ? "t" : "nil", ")");
+  }
+  void PrintField(absl::string_view name, absl::string_view value) {
+    absl::StrAppend(&output_, "(", name, " . ");
+    AppendQuotedString(value, &output_);
+    output_.push_back(')');
+  }
+  template <typename Enum>
+  void PrintEnumField(absl::string_view name, Enum value) {
+    absl::StrAppend(&output_, "(", name, " . ");
+    AppendSymbol(protobuf::GetEnumDescriptor<Enum>()
+                     ->FindValueByNumber(value)
+                     ->name(),
+                 &output_);
+    output_.push_back(')');
+  }
+  template <typename Message>
+  void PrintMessageField(absl::string_view name, const Message &value) {
+    absl::StrAppend(&output_, "(", name, " . ");
+    Print(value);
+    output_.push_back(')');
+  }
+
+  // Prints "(name value...)".  The caller must check that |values| are not
+  // empty.
+  template <typename Message>
+  void PrintRepeatedMessageField(
+      absl::string_view name,
+      const protobuf::RepeatedPtrField<Message> &values) {
+    absl::StrAppend(&output_, "(", name, " ");
+    for (const Message &value : values) {
+      Print(value);
+    }
+    output_.push_back(')');
+  }
+  template <typename Enum>
+  void PrintRepeatedEnumField(absl::string_view name,
+                              const protobuf::RepeatedField<int> &values) {
+    absl::StrAppend(&output_, "(", name, " ");
+    const protobuf::EnumDescriptor *descriptor =
+        protobuf::GetEnumDescriptor<Enum>();
+    for (int i = 0; i < values.size(); ++i) {
+      if (i != 0) {
+        output_.push_back(' ');
+      }
+      AppendSymbol(descriptor->FindValueByNumber(values[i])->name(), &output_);
+    }
+    output_.push_back(')');
+  }
+
+  std::string &output_;
+};
 }  // namespace
 
 // Parses a line, which must be a single complete command in form of:
@@ -80,7 +171,7 @@ void ParseInputLine(absl::string_view line, uint32_t *event_id,
   CHECK(session_id);
   CHECK(input);
 
-  std::vector<std::string> tokens;
+  std::vector<absl::string_view> tokens;
   if (!TokenizeSExpr(line, &tokens) ||
       tokens.size() < 4 ||  // Must be at least '(' EVENT_ID COMMAND ')'.
       tokens.front() != "(" || tokens.back() != ")") {
@@ -93,7 +184,7 @@ void ParseInputLine(absl::string_view line, uint32_t *event_id,
   }
 
   // Read a command.
-  const std::string &func = tokens[2];
+  const absl::string_view func = tokens[2];
   if (func == "SendKey") {  // SendKey is a most-frequently-used command.
     input->set_type(commands::Input::SEND_KEY);
   } else if (func == "CreateSession") {
@@ -143,7 +234,7 @@ void ParseInputLine(absl::string_view line, uint32_t *event_id,
           if (!absl::SimpleAtoi(tokens[i], &key_code) || key_code > 255) {
             ErrorExit(kErrWrongTypeArgument, "Wrong character code");
           }
-          keys.push_back(std::string(1, static_cast<char>(key_code)));
+          keys.emplace_back(1, static_cast<char>(key_code));
         } else if (tokens[i][0] == '\"') {  // String literal
           if (!key_string.empty()) {
             ErrorExit(kErrWrongTypeArgument, "Wrong number of key strings");
@@ -152,7 +243,7 @@ void ParseInputLine(absl::string_view line, uint32_t *event_id,
             ErrorExit(kErrWrongTypeArgument, "Wrong key string literal");
           }
         } else {  // Key symbol
-          keys.push_back(tokens[i]);
+          keys.emplace_back(tokens[i]);
         }
       }
       if (!KeyParser::ParseKeyVector(keys, input->mutable_key()) &&
@@ -177,22 +268,26 @@ void ParseInputLine(absl::string_view line, uint32_t *event_id,
 // - other types are expressed as is
 //
 // Input parameter 'message' is a protocol buffer to be output.
-// 'output' is a text buffer to output 'message'.
+// The S-expression is appended to 'output'.
 //
 // This function never outputs newlines except for ones in strings.
-void PrintMessage(const protobuf::Message &message,
-                  std::vector<std::string> *output) {
+void PrintMessage(const protobuf::Message &message, std::string *output) {
   DCHECK(output);
 
   const protobuf::Reflection *reflection = message.GetReflection();
   std::vector<const protobuf::FieldDescriptor *> fields;
   reflection->ListFields(message, &fields);
 
-  output->push_back("(");
-  for (int i = 0; i < fields.size(); ++i) {
-    PrintField(message, *reflection, *fields[i], output);
+  output->push_back('(');
+  for (const protobuf::FieldDescriptor *field : fields) {
+    PrintField(message, *reflection, *field, output);
   }
-  output->push_back(")");
+  output->push_back(')');
+}
+
+void PrintMessage(const commands::Output &message, std::string *output) {
+  DCHECK(output);
+  SExprPrinter(output).Print(message);
 }
 
 // Utilities
@@ -212,8 +307,22 @@ std::string NormalizeSymbol(std::string symbol) {
 //
 // Control characters, including newline('\n'), in a given string remain as is.
 std::string QuoteString(absl::string_view str) {
-  return absl::StrCat(
-      "\"", absl::StrReplaceAll(str, {{"\\", "\\\\"}, {"\"", "\\\""}}), "\"");
+  std::string result;
+  AppendQuotedString(str, &result);
+  return result;
+}
+
+void AppendQuotedString(absl::string_view str, std::string *output) {
+  DCHECK(output);
+  output->reserve(output->size() + str.size() + 2);
+  output->push_back('\"');
+  for (const char c : str) {
+    if (c == '\\' || c == '\"') {
+      output->push_back('\\');
+    }
+    output->push_back(c);
+  }
+  output->push_back('\"');
 }
 
 // Unquotes and unescapes a double-quoted string.
@@ -289,10 +398,11 @@ bool UnquoteString(absl::string_view input, std::string *output) {
 // This function implements very simple tokenization and is NOT conforming to
 // the definition of S expression.  For example, this function does not return
 // an error for the input "\'".
-bool TokenizeSExpr(absl::string_view input, std::vector<std::string> *output) {
+bool TokenizeSExpr(absl::string_view input,
+                   std::vector<absl::string_view> *output) {
   DCHECK(output);
 
-  std::vector<std::string> results;
+  std::vector<absl::string_view> results;
 
   for (auto it = input.begin(); it != input.end(); ++it) {
     if (absl::ascii_isspace(*it)) {
@@ -315,7 +425,7 @@ bool TokenizeSExpr(absl::string_view input, std::vector<std::string> *output) {
       case ']':   // vector parentheses
       case '\'':  // quote
       case '`':   // quasiquote
-        results.emplace_back(1, *it);
+        results.push_back(input.substr(it - input.begin(), 1));
         break;
       case '\"': {  // string
         const auto start = it++;
@@ -331,7 +441,8 @@ bool TokenizeSExpr(absl::string_view input, std::vector<std::string> *output) {
             break;
           }
         }
-        results.emplace_back(start, it + 1);
+        results.push_back(
+            input.substr(start - input.begin(), it + 1 - start));
         break;
       }
       default: {  // must be atom
@@ -359,7 +470,7 @@ bool TokenizeSExpr(absl::string_view input, std::vector<std::string> *output) {
             break;
           }
         }
-        results.emplace_back(start, it);
+        results.push_back(input.substr(start - input.begin(), it - start));
         --it;  // Put the last char back.
         break;
       }
@@ -390,6 +501,13 @@ bool RemoveUsageData(commands::Output *output) {
 
 namespace {
 
+// Appends a symbol normalized by the same rules as NormalizeSymbol().
+void AppendSymbol(absl::string_view symbol, std::string *output) {
+  for (const char c : symbol) {
+    output->push_back(c == '_' ? '-' : absl::ascii_tolower(c));
+  }
+}
+
 // Prints one entry of a protocol buffer in S-expression.
 // An entry is a cons cell of key and value.
 //
@@ -397,31 +515,30 @@ namespace {
 // 'reflection' must be a reflection object of 'message'.  'field' is
 // a field descriptor in 'message' to be output.  'field' can have both of
 // a single value and repeated values.
-// 'output' is a pseudo output stream to output field's key and value(s).
+// 'output' is a text buffer to output field's key and value(s).
 void PrintField(const protobuf::Message &message,
                 const protobuf::Reflection &reflection,
-                const protobuf::FieldDescriptor &field,
-                std::vector<std::string> *output) {
-  output->push_back("(");
-  output->push_back(NormalizeSymbol(field.name()));
+                const protobuf::FieldDescriptor &field, std::string *output) {
+  output->push_back('(');
+  AppendSymbol(field.name(), output);
 
   if (!field.is_repeated()) {
-    output->push_back(" . ");  // Print an object as a value.
+    output->append(" . ");  // Print an object as a value.
     PrintFieldValue(message, reflection, field, -1 /* dummy arg */, output);
   } else {
-    output->push_back(" ");  // Print objects as a list.
+    output->push_back(' ');  // Print objects as a list.
     const int count = reflection.FieldSize(message, &field);
     const bool is_message =
         field.cpp_type() == protobuf::FieldDescriptor::CPPTYPE_MESSAGE;
     for (int i = 0; i < count; ++i) {
       if (i != 0 && !is_message) {
-        output->push_back(" ");
+        output->push_back(' ');
       }
       PrintFieldValue(message, reflection, field, i, output);
     }
   }
 
-  output->push_back(")");
+  output->push_back(')');
 }
 
 // Prints a value of a field of a protocol buffer in S-expression.
@@ -436,11 +553,11 @@ void PrintField(const protobuf::Message &message,
 // a field descriptor in 'message' to be output.  'field' can have both of
 // a single value and repeated values.  If 'field' has repeated values,
 // 'index' specifies its index to be output.  Otherwise, 'index' is ignored.
-// 'output' is a pseudo output stream to output the value.
+// 'output' is a text buffer to output the value.
 void PrintFieldValue(const protobuf::Message &message,
                      const protobuf::Reflection &reflection,
                      const protobuf::FieldDescriptor &field, int index,
-                     std::vector<std::string> *output) {
+                     std::string *output) {
 #define GET_FIELD_VALUE(METHOD_TYPE)                                 \
   (field.is_repeated()                                               \
        ? reflection.GetRepeated##METHOD_TYPE(message, &field, index) \
@@ -450,8 +567,9 @@ void PrintFieldValue(const protobuf::Message &message,
     // Number (integer and floating point)
 #define PRINT_FIELD_VALUE(PROTO_CPP_TYPE, METHOD_TYPE, CPP_TYPE, FORMAT) \
   case protobuf::FieldDescriptor::CPPTYPE_##PROTO_CPP_TYPE:              \
-    output->push_back(absl::StrFormat(                                   \
-        FORMAT, static_cast<CPP_TYPE>(GET_FIELD_VALUE(METHOD_TYPE))));   \
+    absl::StrAppendFormat(                                               \
+        output, FORMAT,                                                  \
+        static_cast<CPP_TYPE>(GET_FIELD_VALUE(METHOD_TYPE)));            \
     break;
 
     // Since Emacs does not support 64-bit integers, it supports only
@@ -468,11 +586,11 @@ void PrintFieldValue(const protobuf::Message &message,
 #undef PRINT_FIELD_VALUE
 
     case protobuf::FieldDescriptor::CPPTYPE_BOOL:  // bool
-      output->push_back(GET_FIELD_VALUE(Bool) ? "t" : "nil");
+      output->append(GET_FIELD_VALUE(Bool) ? "t" : "nil");
       break;
 
     case protobuf::FieldDescriptor::CPPTYPE_ENUM:  // enum
-      output->push_back(NormalizeSymbol(GET_FIELD_VALUE(Enum)->name()));
+      AppendSymbol(GET_FIELD_VALUE(Enum)->name(), output);
       break;
 
     case protobuf::FieldDescriptor::CPPTYPE_STRING: {  // string
@@ -482,7 +600,7 @@ void PrintFieldValue(const protobuf::Message &message,
               ? reflection.GetRepeatedStringReference(message, &field, index,
                                                       &scratch)
               : reflection.GetStringReference(message, &field, &scratch);
-      output->push_back(QuoteString(str));
+      AppendQuotedString(str, output);
       break;
     }
 
@@ -495,6 +613,282 @@ void PrintFieldValue(const protobuf::Message &message,
 #undef GET_FIELD_VALUE
 }
 
+void SExprPrinter::Print(const commands::Output &message) {
+  output_.push_back('(');
+  if (message.has_id()) {
+    PrintField("id", message.id());
+  }
+  if (message.has_mode()) {
+    PrintEnumField("mode", message.mode());
+  }
+  if (message.has_consumed()) {
+    PrintField("consumed", message.consumed());
+  }
+  if (message.has_result()) {
+    PrintMessageField("result", message.result());
+  }
+  if (message.has_preedit()) {
+    PrintMessageField("preedit", message.preedit());
+  }
+  if (message.has_candidates()) {
+    PrintMessageField("candidates", message.candidates());
+  }
+  if (message.has_key()) {
+    PrintMessageField("key", message.key());
+  }
+  if (message.has_url()) {
+    PrintField("url", message.url());
+  }
+  if (message.has_config()) {
+    PrintMessageField("config", message.config());
+  }
+  if (message.has_preedit_method()) {
+    PrintEnumField("preedit-method", message.preedit_method());
+  }
+  if (message.has_error_code()) {
+    PrintEnumField("error-code", message.error_code());
+  }
+  if (message.has_status()) {
+    PrintMessageField("status", message.status());
+  }
+  if (message.has_all_candidate_words()) {
+    PrintMessageField("all-candidate-words", message.all_candidate_words());
+  }
+  if (message.has_deletion_range()) {
+    PrintMessageField("deletion-range", message.deletion_range());
+  }
+  if (message.has_launch_tool_mode()) {
+    PrintEnumField("launch-tool-mode", message.launch_tool_mode());
+  }
+  if (message.has_callback()) {
+    PrintMessageField("callback", message.callback());
+  }
+  if (message.has_user_dictionary_command_status()) {
+    PrintMessageField("user-dictionary-command-status",
+                      message.user_dictionary_command_status());
+  }
+  if (message.has_engine_reload_response()) {
+    PrintMessageField("engine-reload-response",
+                      message.engine_reload_response());
+  }
+  if (message.has_removed_candidate_words_for_debug()) {
+    PrintMessageField("removed-candidate-words-for-debug",
+                      message.removed_candidate_words_for_debug());
+  }
+  if (message.has_check_spelling_response()) {
+    PrintMessageField("check-spelling-response",
+                      message.check_spelling_response());
+  }
+  if (message.has_incognito_candidate_words()) {
+    PrintMessageField("incognito-candidate-words",
+                      message.incognito_candidate_words());
+  }
+  if (message.has_server_version()) {
+    PrintMessageField("server-version", message.server_version());
+  }
+  if (message.has_session_restored()) {
+    PrintField("session-restored", message.session_restored());
+  }
+  output_.push_back(')');
+}
+
+void SExprPrinter::Print(const commands::Result &message) {
+  output_.push_back('(');
+  if (message.has_type()) {
+    PrintEnumField("type", message.type());
+  }
+  if (message.has_value()) {
+    PrintField("value", message.value());
+  }
+  if (message.has_key()) {
+    PrintField("key", message.key());
+  }
+  if (message.has_cursor_offset()) {
+    PrintField("cursor-offset", message.cursor_offset());
+  }
+  if (!message.tokens().empty()) {
+    PrintRepeatedMessageField("tokens", message.tokens());
+  }
+  output_.push_back(')');
+}
+
+void SExprPrinter::Print(const commands::Preedit &message) {
+  output_.push_back('(');
+  if (message.has_cursor()) {
+    PrintField("cursor", message.cursor());
+  }
+  if (!message.segment().empty()) {
+    PrintRepeatedMessageField("segment", message.segment());
+  }
+  if (message.has_highlighted_position()) {
+    PrintField("highlighted-position", message.highlighted_position());
+  }
+  if (message.has_is_toggleable()) {
+    PrintField("is-toggleable", message.is_toggleable());
+  }
+  output_.push_back(')');
+}
+
+void SExprPrinter::Print(const commands::Preedit::Segment &message) {
+  output_.push_back('(');
+  if (message.has_annotation()) {
+    PrintEnumField("annotation", message.annotation());
+  }
+  if (message.has_value()) {
+    PrintField("value", message.value());
+  }
+  if (message.has_value_length()) {
+    PrintField("value-length", message.value_length());
+  }
+  if (message.has_key()) {
+    PrintField("key", message.key());
+  }
+  output_.push_back(')');
+}
+
+void SExprPrinter::Print(const commands::Candidates &message) {
+  output_.push_back('(');
+  if (message.has_focused_index()) {
+    PrintField("focused-index", message.focused_index());
+  }
+  if (message.has_size()) {
+    PrintField("size", message.size());
+  }
+  if (!message.candidate().empty()) {
+    PrintRepeatedMessageField("candidate", message.candidate());
+  }
+  if (message.has_position()) {
+    PrintField("position", message.position());
+  }
+  if (message.has_subcandidates()) {
+    PrintMessageField("subcandidates", message.subcandidates());
+  }
+  if (message.has_usages()) {
+    PrintMessageField("usages", message.usages());
+  }
+  if (message.has_category()) {
+    PrintEnumField("category", message.category());
+  }
+  if (message.has_display_type()) {
+    PrintEnumField("display-type", message.display_type());
+  }
+  if (message.has_footer()) {
+    PrintMessageField("footer", message.footer());
+  }
+  if (message.has_direction()) {
+    PrintEnumField("direction", message.direction());
+  }
+  if (message.has_page_size()) {
+    PrintField("page-size", message.page_size());
+  }
+  output_.push_back(')');
+}
+
+void SExprPrinter::Print(const commands::Candidates::Candidate &message) {
+  output_.push_back('(');
+  if (message.has_index()) {
+    PrintField("index", message.index());
+  }
+  if (message.has_value()) {
+    PrintField("value", message.value());
+  }
+  if (message.has_annotation()) {
+    PrintMessageField("annotation", message.annotation());
+  }
+  if (message.has_id()) {
+    PrintField("id", message.id());
+  }
+  if (message.has_information_id()) {
+    PrintField("information-id", message.information_id());
+  }
+  output_.push_back(')');
+}
+
+void SExprPrinter::Print(const commands::CandidateList &message) {
+  output_.push_back('(');
+  if (message.has_focused_index()) {
+    PrintField("focused-index", message.focused_index());
+  }
+  if (!message.candidates().empty()) {
+    PrintRepeatedMessageField("candidates", message.candidates());
+  }
+  if (message.has_category()) {
+    PrintEnumField("category", message.category());
+  }
+  output_.push_back(')');
+}
+
+void SExprPrinter::Print(const commands::CandidateWord &message) {
+  output_.push_back('(');
+  if (message.has_id()) {
+    PrintField("id", message.id());
+  }
+  if (message.has_index()) {
+    PrintField("index", message.index());
+  }
+  if (message.has_key()) {
+    PrintField("key", message.key());
+  }
+  if (message.has_value()) {
+    PrintField("value", message.value());
+  }
+  if (message.has_annotation()) {
+    PrintMessageField("annotation", message.annotation());
+  }
+  if (!message.attributes().empty()) {
+    PrintRepeatedEnumField<commands::CandidateAttribute>("attributes",
+                                                         message.attributes());
+  }
+  if (message.has_num_segments_in_candidate()) {
+    PrintField("num-segments-in-candidate",
+               message.num_segments_in_candidate());
+  }
+  if (message.has_log()) {
+    PrintField("log", message.log());
+  }
+  output_.push_back(')');
+}
+
+void SExprPrinter::Print(const commands::Annotation &message) {
+  output_.push_back('(');
+  if (message.has_prefix()) {
+    PrintField("prefix", message.prefix());
+  }
+  if (message.has_suffix()) {
+    PrintField("suffix", message.suffix());
+  }
+  if (message.has_description()) {
+    PrintField("description", message.description());
+  }
+  if (message.has_shortcut()) {
+    PrintField("shortcut", message.shortcut());
+  }
+  if (message.has_deletable()) {
+    PrintField("deletable", message.deletable());
+  }
+  if (message.has_a11y_description()) {
+    PrintField("a11y-description", message.a11y_description());
+  }
+  output_.push_back(')');
+}
+
+void SExprPrinter::Print(const commands::Footer &message) {
+  output_.push_back('(');
+  if (message.has_label()) {
+    PrintField("label", message.label());
+  }
+  if (message.has_index_visible()) {
+    PrintField("index-visible", message.index_visible());
+  }
+  if (message.has_logo_visible()) {
+    PrintField("logo-visible", message.logo_visible());
+  }
+  if (message.has_sub_label()) {
+    PrintField("sub-label", message.sub_label());
+  }
+  output_.push_back(')');
+}
+
 }  // namespace
 }  // namespace emacs
 }  // namespace mozc
@@ -71,11 +71,16 @@ void ParseInputLine(absl::string_view line, uint32_t *event_id,
 // - other types are expressed as is
 //
 // Input parameter 'message' is a protocol buffer to be output.
-// 'output' is a text buffer to output 'message'.
+// The S-expression is appended to 'output', so the caller can reuse the
+// buffer across messages.
 //
 // This function never outputs newlines except for ones in strings.
-void PrintMessage(const mozc::protobuf::Message &message,
-                  std::vector<std::string> *output);
+void PrintMessage(const mozc::protobuf::Message &message, std::string *output);
+
+// Same as above, but prints the messages emitted on every key event, e.g.
+// preedit and candidates, without protobuf reflection.  The other messages
+// fall back to the generic version above.  The results are identical.
+void PrintMessage(const mozc::commands::Output &message, std::string *output);
 
 // Utilities
 
@@ -91,6 +96,9 @@ std::string NormalizeSymbol(std::string symbol);
 // Control characters, including newline('\n'), in a given string remain as is.
 std::string QuoteString(absl::string_view str);
 
+// Appends a quoted string to |output|.  See QuoteString().
+void AppendQuotedString(absl::string_view str, std::string *output);
+
 // Unquotes and unescapes a double-quoted string.
 // The input string must begin and end with double quotes.
 bool UnquoteString(absl::string_view input, std::string *output);
@@ -100,7 +108,9 @@ bool UnquoteString(absl::string_view input, std::string *output);
 // This function implements very simple tokenization and is NOT conforming to
 // the definition of S expression.  For example, this function does not return
 // an error for the input "\'".
-bool TokenizeSExpr(absl::string_view input, std::vector<std::string> *output);
+// The tokens point to |input|.
+bool TokenizeSExpr(absl::string_view input,
+                   std::vector<absl::string_view> *output);
 
 // Prints an error message in S-expression and terminates with status code 1.
 void ErrorExit(absl::string_view error, absl::string_view message);
@@ -34,14 +34,16 @@
 #include <vector>
 
 #include "absl/strings/str_cat.h"
-#include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
+#include "base/protobuf/descriptor.h"
 #include "base/protobuf/message.h"
 #include "protocol/candidates.pb.h"
 #include "protocol/commands.pb.h"
 #include "testing/gmock.h"
 #include "testing/gunit.h"
+#include "testing/mozctest.h"
 #include "testing/testing_util.h"
+#include "unix/emacs/client_pool.h"
 
 namespace mozc::emacs {
 namespace {
@@ -64,9 +66,8 @@ class MozcEmacsHelperLibTest : public ::testing::Test {
 
   void PrintAndTestSexpr(const protobuf::Message &message,
                          absl::string_view sexpr) {
-    std::vector<std::string> buffer;
-    PrintMessage(message, &buffer);
-    const std::string output = absl::StrJoin(buffer, "");
+    std::string output;
+    PrintMessage(message, &output);
     EXPECT_EQ(output, sexpr);
   }
 
@@ -223,6 +224,76 @@ TEST_F(MozcEmacsHelperLibTest, PrintMessage) {
                     "(modifier-keys key-down shift))))");
 }
 
+// Sets all the fields of |message| recursively with reflection.
+void FillAllFields(int depth, protobuf::Message *message) {
+  const protobuf::Descriptor *descriptor = message->GetDescriptor();
+  const protobuf::Reflection *reflection = message->GetReflection();
+  for (int i = 0; i < descriptor->field_count(); ++i) {
+    const protobuf::FieldDescriptor *field = descriptor->field(i);
+    const int count = field->is_repeated() ? 2 : 1;
+    for (int j = 0; j < count; ++j) {
+      const bool repeated = field->is_repeated();
+      switch (field->cpp_type()) {
+#define SET_FIELD_VALUE(PROTO_CPP_TYPE, METHOD_TYPE, VALUE)         \
+  case protobuf::FieldDescriptor::CPPTYPE_##PROTO_CPP_TYPE:         \
+    if (repeated) {                                                 \
+      reflection->Add##METHOD_TYPE(message, field, VALUE);          \
+    } else {                                                        \
+      reflection->Set##METHOD_TYPE(message, field, VALUE);          \
+    }                                                               \
+    break;
+        SET_FIELD_VALUE(INT32, Int32, -i - j);
+        SET_FIELD_VALUE(INT64, Int64, -i - j);
+        SET_FIELD_VALUE(UINT32, UInt32, i + j);
+        SET_FIELD_VALUE(UINT64, UInt64, i + j);
+        SET_FIELD_VALUE(DOUBLE, Double, i + 0.5);
+        SET_FIELD_VALUE(FLOAT, Float, j + 0.25f);
+        SET_FIELD_VALUE(BOOL, Bool, j % 2 == 0);
+        SET_FIELD_VALUE(
+            ENUM, Enum,
+            field->enum_type()->value(j % field->enum_type()->value_count()));
+        SET_FIELD_VALUE(STRING, String, absl::StrCat("\"", field->name(), j));
+#undef SET_FIELD_VALUE
+        case protobuf::FieldDescriptor::CPPTYPE_MESSAGE:
+          if (depth > 0) {
+            protobuf::Message *child =
+                repeated ? reflection->AddMessage(message, field)
+                         : reflection->MutableMessage(message, field);
+            FillAllFields(depth - 1, child);
+          }
+          break;
+      }
+    }
+  }
+}
+
+TEST_F(MozcEmacsHelperLibTest, PrintOutputMessage) {
+  // The reflection-free printer for Output prints exactly the same as the
+  // generic one.  This also verifies that the printer knows all the fields.
+  commands::Output output;
+  std::string expected;
+  std::string actual;
+  for (int depth = 0; depth < 5; ++depth) {
+    output.Clear();
+    FillAllFields(depth, &output);
+    expected.clear();
+    PrintMessage(static_cast<const protobuf::Message &>(output), &expected);
+    actual.clear();
+    PrintMessage(output, &actual);
+    EXPECT_EQ(actual, expected) << "depth: " << depth;
+  }
+
+  // Appends to the buffer.
+  output.Clear();
+  output.set_consumed(true);
+  output.mutable_candidates()->add_candidate()->set_value("\\");
+  actual = "(output . ";
+  PrintMessage(output, &actual);
+  EXPECT_EQ(actual,
+            "(output . ((consumed . t)"
+            "(candidates . ((candidate ((value . \"\\\\\"))))))");
+}
+
 TEST_F(MozcEmacsHelperLibTest, NormalizeSymbol) {
   EXPECT_EQ(NormalizeSymbol("PAGE_UP"), "page-up");
   EXPECT_EQ(NormalizeSymbol("PAGE_DOWN"), "page-down");
@@ -237,6 +308,10 @@ TEST_F(MozcEmacsHelperLibTest, QuoteString) {
   EXPECT_EQ(QuoteString("\"abc\""), "\"\\\"abc\\\"\"");
   EXPECT_EQ(QuoteString("\\\""), "\"\\\\\\\"\"");
   EXPECT_EQ(QuoteString("\t\n\v\f\r "), "\"\t\n\v\f\r \"");
+
+  std::string output = "(";
+  AppendQuotedString("a\"b", &output);
+  EXPECT_EQ(output, "(\"a\\\"b\"");
 }
 
 TEST_F(MozcEmacsHelperLibTest, UnquoteString) {
@@ -261,7 +336,7 @@ TEST_F(MozcEmacsHelperLibTest, TokenizeSExpr) {
   constexpr absl::string_view kGolden[] = {
       "(", "'", "abc", "\" \t\\r\\\n\\\"\"", "-x0", "\"い\"", "p", ")"};
 
-  std::vector<std::string> output;
+  std::vector<absl::string_view> output;
   EXPECT_TRUE(TokenizeSExpr(kInput, &output));
   EXPECT_THAT(output, ElementsAreArray(kGolden));
 
@@ -295,5 +370,25 @@ TEST_F(MozcEmacsHelperLibTest, RemoveUsageDataTest) {
   }
 }
 
+class ClientPoolTest : public testing::TestWithTempUserProfile {};
+
+TEST_F(ClientPoolTest, ReuseDeletedClient) {
+  ClientPool client_pool;
+  const int id1 = client_pool.CreateClient();
+  const int id2 = client_pool.CreateClient();
+  EXPECT_NE(id1, id2);
+  const ClientPool::Client *client1 = client_pool.GetClient(id1).get();
+  EXPECT_NE(client1, client_pool.GetClient(id2).get());
+
+  // The deleted client is reused for a new session.
+  client_pool.DeleteClient(id1);
+  const int id3 = client_pool.CreateClient();
+  EXPECT_NE(id3, id1);
+  EXPECT_EQ(client_pool.GetClient(id3).get(), client1);
+
+  // An unknown id gets a new client.
+  EXPECT_NE(client_pool.GetClient(12345).get(), client1);
+}
+
 }  // namespace
 }  // namespace mozc::emacs